@@ -0,0 +1,41 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "average.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+void averageQuaternions(benchmark::State & state) {
+	std::vector<Eigen::Quaterniond> quaternions = randomQuaternions(state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::averageQuaternions<double>(quaternions));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(averageQuaternions)->RangeMultiplier(8)->Range(8, 4096);
+
+void averagePositions(benchmark::State & state) {
+	std::vector<Eigen::Vector3d> positions = randomPositions(state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::averagePositions<double>(positions));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(averagePositions)->RangeMultiplier(8)->Range(8, 4096);
+
+void averageIsometriesCovariance(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(state.range(0));
+	Eigen::Matrix<double, 6, 6> covariance;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::averageIsometries<double>(isometries, covariance));
+		benchmark::DoNotOptimize(covariance);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(averageIsometriesCovariance)->RangeMultiplier(8)->Range(8, 4096);
+
+}
+}
@@ -0,0 +1,68 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "camera.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	Eigen::Matrix3Xf const & cloud() {
+		static Eigen::Matrix3Xf const result = randomCloud<float>(1000000);
+		return result;
+	}
+
+	BrownConrady<float> distortion() {
+		BrownConrady<float> result;
+		result.k1 = -0.12f;
+		result.k2 = 0.05f;
+		result.p1 = 0.001f;
+		result.p2 = -0.002f;
+		return result;
+	}
+
+	Eigen::Matrix<std::uint16_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> depthImage() {
+		Eigen::Matrix<std::uint16_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> result(480, 640);
+		for (Eigen::Index row = 0; row < result.rows(); ++row) {
+			for (Eigen::Index col = 0; col < result.cols(); ++col) result(row, col) = (row * 7 + col * 13) % 97 == 0 ? 0 : 800 + (row + col) % 400;
+		}
+		return result;
+	}
+}
+
+void cameraProject(benchmark::State & state) {
+	Eigen::Matrix3Xf const & points = cloud();
+	PinholeCamera<float> camera{500, 500, 320, 240, state.range(0) ? distortion() : BrownConrady<float>{}};
+	Eigen::Isometry3f camera_from_points = Eigen::Translation3f{0, 0, 2} * Eigen::AngleAxisf{0.1f, Eigen::Vector3f::UnitY()};
+	Eigen::Matrix2Xf pixels;
+	for (auto _ : state) {
+		camera.project(points, camera_from_points, pixels, 1);
+		benchmark::DoNotOptimize(pixels.data());
+	}
+	state.SetItemsProcessed(state.iterations() * points.cols());
+}
+BENCHMARK(cameraProject)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+void depthImageToCloud(benchmark::State & state) {
+	auto depth = depthImage();
+	PinholeCamera<float> camera{500, 500, 319.5f, 239.5f, state.range(0) ? distortion() : BrownConrady<float>{}};
+	DepthCloudConverter<float> converter{camera, depth.cols(), depth.rows()};
+	Eigen::Isometry3f world_from_camera = Eigen::Translation3f{0.1f, 0.2f, 1} * Eigen::AngleAxisf{0.3f, Eigen::Vector3f::UnitX()};
+	DepthCloudOptions options;
+	options.depth_scale = 0.001;
+	options.threads     = state.range(1);
+	Eigen::Matrix3Xf points;
+	for (auto _ : state) {
+		converter.convert(depth, world_from_camera, points, options);
+		benchmark::DoNotOptimize(points.data());
+	}
+	state.SetItemsProcessed(state.iterations() * depth.size());
+}
+BENCHMARK(depthImageToCloud)->Args({0, 1})->Args({1, 1})->Args({0, 0})->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+}
+}
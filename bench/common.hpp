@@ -0,0 +1,63 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <random>
+#include <vector>
+
+namespace dr {
+namespace bench {
+
+/// Generate reproducible random unit quaternions.
+inline std::vector<Eigen::Quaterniond> randomQuaternions(std::size_t count, unsigned int seed = 0) {
+	std::mt19937 generator(seed);
+	std::normal_distribution<double> distribution;
+	std::vector<Eigen::Quaterniond> result;
+	result.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		Eigen::Quaterniond quaternion{distribution(generator), distribution(generator), distribution(generator), distribution(generator)};
+		result.push_back(quaternion.normalized());
+	}
+	return result;
+}
+
+/// Generate reproducible random positions in a cube of the given size around the origin.
+inline std::vector<Eigen::Vector3d> randomPositions(std::size_t count, double size = 1, unsigned int seed = 0) {
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> distribution(-size / 2, size / 2);
+	std::vector<Eigen::Vector3d> result;
+	result.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		result.emplace_back(distribution(generator), distribution(generator), distribution(generator));
+	}
+	return result;
+}
+
+/// Generate a reproducible random point cloud in a cube of the given size around the origin, one point per column.
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, Eigen::Dynamic> randomCloud(std::size_t count, Scalar size = 1, unsigned int seed = 0) {
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<Scalar> distribution(-size / 2, size / 2);
+	Eigen::Matrix<Scalar, 3, Eigen::Dynamic> result(3, count);
+	for (std::size_t i = 0; i < count; ++i) {
+		result.col(i) << distribution(generator), distribution(generator), distribution(generator);
+	}
+	return result;
+}
+
+/// Generate reproducible random isometries.
+inline std::vector<Eigen::Isometry3d> randomIsometries(std::size_t count, unsigned int seed = 0) {
+	std::vector<Eigen::Quaterniond> rotations = randomQuaternions(count, seed);
+	std::vector<Eigen::Vector3d> positions    = randomPositions(count, 1, seed + 1);
+	std::vector<Eigen::Isometry3d> result;
+	result.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		result.push_back(Eigen::Translation3d{positions[i]} * rotations[i]);
+	}
+	return result;
+}
+
+}
+}
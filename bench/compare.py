@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# Copyright 2014-2022, Fizyr B.V.
+
+"""
+Compare google-benchmark JSON results against a baseline.
+
+Produce the JSON files with:
+  dr_eigen_bench --benchmark_out=results.json --benchmark_out_format=json --benchmark_repetitions=5
+
+Benchmarks that are slower than the baseline by more than the threshold are reported as regressions,
+and the script exits with status 1 if there are any.
+When the results contain repetitions, the median is compared.
+"""
+
+import argparse
+import json
+import statistics
+import sys
+
+TIME_UNITS = {
+	'ns': 1e0,
+	'us': 1e3,
+	'ms': 1e6,
+	's':  1e9,
+}
+
+
+def load_times(path, metric):
+	"""Load the time per iteration in nanoseconds of every benchmark in a result file."""
+	with open(path) as file:
+		data = json.load(file)
+
+	medians = {}
+	iterations = {}
+	for benchmark in data.get('benchmarks', []):
+		if benchmark.get('error_occurred'):
+			continue
+		name = benchmark.get('run_name', benchmark['name'])
+		time = benchmark[metric] * TIME_UNITS[benchmark.get('time_unit', 'ns')]
+		if benchmark.get('run_type') == 'aggregate':
+			if benchmark.get('aggregate_name') == 'median':
+				medians[name] = time
+		else:
+			iterations.setdefault(name, []).append(time)
+
+	times = {name: statistics.median(values) for name, values in iterations.items()}
+	times.update(medians)
+	return times
+
+
+def format_time(nanoseconds):
+	for unit in ('s', 'ms', 'us'):
+		if nanoseconds >= TIME_UNITS[unit]:
+			return '{:.3g} {}'.format(nanoseconds / TIME_UNITS[unit], unit)
+	return '{:.3g} ns'.format(nanoseconds)
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+	parser.add_argument('baseline', help='the JSON results to compare against')
+	parser.add_argument('current',  help='the JSON results to check')
+	parser.add_argument('--threshold', type=float, default=0.10, help='the allowed slowdown as fraction of the baseline time (default: %(default)s)')
+	parser.add_argument('--metric', choices=('real_time', 'cpu_time'), default='real_time', help='the time to compare (default: %(default)s)')
+	args = parser.parse_args()
+
+	baseline = load_times(args.baseline, args.metric)
+	current  = load_times(args.current,  args.metric)
+
+	regressions = []
+	width = max((len(name) for name in set(baseline) | set(current)), default=0)
+	print('{:<{}}  {:>10}  {:>10}  {:>8}'.format('benchmark', width, 'baseline', 'current', 'change'))
+	for name in sorted(current):
+		if name not in baseline:
+			print('{:<{}}  {:>10}  {:>10}  {:>8}'.format(name, width, '-', format_time(current[name]), 'new'))
+			continue
+		change = current[name] / baseline[name] - 1 if baseline[name] > 0 else 0
+		regressed = change > args.threshold
+		if regressed:
+			regressions.append(name)
+		print('{:<{}}  {:>10}  {:>10}  {:>+7.1f}%{}'.format(name, width, format_time(baseline[name]), format_time(current[name]), change * 100, '  REGRESSION' if regressed else ''))
+
+	for name in sorted(set(baseline) - set(current)):
+		print('{:<{}}  {:>10}  {:>10}  {:>8}'.format(name, width, format_time(baseline[name]), '-', 'missing'))
+
+	if regressions:
+		print('\n{} benchmark(s) slower than the baseline by more than {:.0f}%:'.format(len(regressions), args.threshold * 100), file=sys.stderr)
+		for name in regressions:
+			print('  ' + name, file=sys.stderr)
+		return 1
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main())
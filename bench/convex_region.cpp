@@ -0,0 +1,49 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "convex_region.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	Eigen::Matrix3Xf const & cloud() {
+		static Eigen::Matrix3Xf const result = randomCloud<float>(1000000, 4);
+		return result;
+	}
+
+	ConvexRegion<float> frustum() {
+		Eigen::Isometry3f camera = Eigen::Translation3f{0, 0, -2} * Eigen::AngleAxisf{0.1f, Eigen::Vector3f::UnitY()};
+		return ConvexRegion<float>::fromFrustum(camera, 1.2f, 0.9f, 0.5f, 3.0f);
+	}
+}
+
+void convexRegionContains(benchmark::State & state) {
+	Eigen::Matrix3Xf const & points = cloud();
+	ConvexRegion<float> region = frustum();
+	Eigen::Array<bool, Eigen::Dynamic, 1> inside;
+	for (auto _ : state) {
+		region.contains(points, inside, state.range(0));
+		benchmark::DoNotOptimize(inside.data());
+	}
+	state.SetItemsProcessed(state.iterations() * points.cols());
+}
+BENCHMARK(convexRegionContains)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void convexRegionIntersectsBox(benchmark::State & state) {
+	Eigen::Matrix3Xf const & points = cloud();
+	ConvexRegion<float> region = frustum();
+	Eigen::Index index = 0;
+	for (auto _ : state) {
+		Eigen::Vector3f center = points.col(index);
+		index = (index + 1) % points.cols();
+		benchmark::DoNotOptimize(region.intersects(Eigen::AlignedBox3f{center, center + Eigen::Vector3f::Constant(0.1f)}));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(convexRegionIntersectsBox);
+
+}
+}
@@ -0,0 +1,48 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "downsample.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	Eigen::Matrix3Xf const & cloud() {
+		static Eigen::Matrix3Xf const result = randomCloud<float>(1000000);
+		return result;
+	}
+}
+
+void voxelDownsampleCentroids(benchmark::State & state) {
+	Eigen::Matrix3Xf const & points = cloud();
+	VoxelDownsampler<float> downsampler;
+	VoxelCloud<float> result;
+	VoxelDownsampleOptions options;
+	options.threads = state.range(0);
+	for (auto _ : state) {
+		downsampler.downsample(points, 0.02f, result, options);
+		benchmark::DoNotOptimize(result.points.data());
+	}
+	state.SetItemsProcessed(state.iterations() * points.cols());
+}
+BENCHMARK(voxelDownsampleCentroids)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void voxelDownsampleNormals(benchmark::State & state) {
+	Eigen::Matrix3Xf const & points = cloud();
+	VoxelDownsampler<float> downsampler;
+	VoxelCloud<float> result;
+	VoxelDownsampleOptions options;
+	options.normals = true;
+	options.threads = state.range(0);
+	for (auto _ : state) {
+		downsampler.downsample(points, 0.05f, result, options);
+		benchmark::DoNotOptimize(result.normals.data());
+	}
+	state.SetItemsProcessed(state.iterations() * points.cols());
+}
+BENCHMARK(voxelDownsampleNormals)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
+}
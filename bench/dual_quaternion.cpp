@@ -0,0 +1,78 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "average.hpp"
+#include "dual_quaternion.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+void composeIsometry(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(1024);
+	Eigen::Isometry3d result = Eigen::Isometry3d::Identity();
+	std::size_t i = 0;
+	for (auto _ : state) {
+		result = result * isometries[i++ % isometries.size()];
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(composeIsometry);
+
+void composeDualQuaternion(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(1024);
+	std::vector<DualQuaterniond> transforms(isometries.begin(), isometries.end());
+	DualQuaterniond result;
+	std::size_t i = 0;
+	for (auto _ : state) {
+		result = result * transforms[i++ % transforms.size()];
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(composeDualQuaternion);
+
+void averageIsometries(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::averageIsometries<double>(isometries));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(averageIsometries)->RangeMultiplier(8)->Range(8, 4096);
+
+void blendIsometries(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(blendDualQuaternions<double>(isometries));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(blendIsometries)->RangeMultiplier(8)->Range(8, 4096);
+
+void blendDualQuaternions(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(state.range(0));
+	std::vector<DualQuaterniond> transforms(isometries.begin(), isometries.end());
+	std::vector<double> weights(transforms.size(), 1.0);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::blendDualQuaternions<double>(transforms, weights));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(blendDualQuaternions)->RangeMultiplier(8)->Range(8, 4096);
+
+void interpolateIsometryScrew(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(1024);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::interpolateIsometryScrew(isometries[i % 1024], isometries[(i + 1) % 1024], 0.3));
+		++i;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(interpolateIsometryScrew);
+
+}
+}
@@ -0,0 +1,44 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "eigen.hpp"
+#include "interpolate.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+void rpyToQuaternion(benchmark::State & state) {
+	std::vector<Eigen::Vector3d> angles = randomPositions(1024, 6);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::rpyToQuaternion(angles[i++ % angles.size()]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(rpyToQuaternion);
+
+void quaternionToRpy(benchmark::State & state) {
+	std::vector<Eigen::Quaterniond> quaternions = randomQuaternions(1024);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::quaternionToRpy(quaternions[i++ % quaternions.size()]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(quaternionToRpy);
+
+void interpolateIsometry(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(1024);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::interpolateIsometry(isometries[i % 1024], isometries[(i + 1) % 1024], 0.3));
+		++i;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(interpolateIsometry);
+
+}
+}
@@ -0,0 +1,99 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "kd_tree.hpp"
+#include "voxel_hash.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	/// Number of points in the benchmark clouds: one million points in a unit cube.
+	constexpr std::size_t cloud_size = 1000000;
+
+	/// Radius giving roughly 30 neighbours per query in the benchmark clouds.
+	constexpr float query_radius = 0.02f;
+
+	Eigen::Matrix3Xf const & cloud() {
+		static Eigen::Matrix3Xf const result = randomCloud<float>(cloud_size);
+		return result;
+	}
+
+	Eigen::Matrix3Xf const & queries() {
+		static Eigen::Matrix3Xf const result = randomCloud<float>(4096, 1, 1);
+		return result;
+	}
+}
+
+void kdTreeBuild(benchmark::State & state) {
+	KdTree<float> tree;
+	for (auto _ : state) {
+		tree.build(cloud(), 16, state.range(0));
+		benchmark::DoNotOptimize(tree.nodes());
+	}
+	state.SetItemsProcessed(state.iterations() * cloud_size);
+}
+BENCHMARK(kdTreeBuild)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void kdTreeKnn(benchmark::State & state) {
+	KdTree<float> tree{cloud()};
+	std::vector<Neighbor<float>> result;
+	std::size_t i = 0;
+	for (auto _ : state) {
+		tree.knn(queries().col(i++ % queries().cols()), state.range(0), result);
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(kdTreeKnn)->Arg(1)->Arg(8)->Arg(32);
+
+void kdTreeKnnBatch(benchmark::State & state) {
+	KdTree<float> tree{cloud()};
+	Eigen::Matrix<Eigen::Index, Eigen::Dynamic, Eigen::Dynamic> indices;
+	Eigen::MatrixXf distances;
+	for (auto _ : state) {
+		tree.knn(queries(), 8, indices, distances, state.range(0));
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * queries().cols());
+}
+BENCHMARK(kdTreeKnnBatch)->Arg(1)->Arg(0)->UseRealTime();
+
+void kdTreeRadius(benchmark::State & state) {
+	KdTree<float> tree{cloud()};
+	std::vector<Neighbor<float>> result;
+	std::size_t i = 0;
+	for (auto _ : state) {
+		tree.radius(queries().col(i++ % queries().cols()), query_radius, result);
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(kdTreeRadius);
+
+void voxelHashBuild(benchmark::State & state) {
+	VoxelHash<float> grid;
+	for (auto _ : state) {
+		grid.build(cloud(), query_radius);
+		benchmark::DoNotOptimize(grid.voxels());
+	}
+	state.SetItemsProcessed(state.iterations() * cloud_size);
+}
+BENCHMARK(voxelHashBuild)->Unit(benchmark::kMillisecond);
+
+void voxelHashRadius(benchmark::State & state) {
+	VoxelHash<float> grid{cloud(), query_radius};
+	std::vector<Neighbor<float>> result;
+	std::size_t i = 0;
+	for (auto _ : state) {
+		grid.radius(queries().col(i++ % queries().cols()), query_radius, result);
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(voxelHashRadius);
+
+}
+}
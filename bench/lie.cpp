@@ -0,0 +1,98 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "lie.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	/// Rotation vectors with angles spread over [0, scale * pi].
+	std::vector<Eigen::Vector3d> randomRotationVectors(std::size_t count, double scale) {
+		return randomPositions(count, 2 * scale * M_PI / std::sqrt(3.0));
+	}
+}
+
+void so3ExpAngleAxis(benchmark::State & state) {
+	std::vector<Eigen::Vector3d> rotations = randomRotationVectors(1024, state.range(0) / 1000.0);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		Eigen::Vector3d const & rotation = rotations[i++ % rotations.size()];
+		double angle = rotation.norm();
+		benchmark::DoNotOptimize(Eigen::Quaterniond(Eigen::AngleAxisd(angle, rotation / angle)));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(so3ExpAngleAxis)->Arg(1)->Arg(1000);
+
+void so3Exp(benchmark::State & state) {
+	std::vector<Eigen::Vector3d> rotations = randomRotationVectors(1024, state.range(0) / 1000.0);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::so3Exp(rotations[i++ % rotations.size()]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(so3Exp)->Arg(1)->Arg(1000);
+
+void so3LogAngleAxis(benchmark::State & state) {
+	std::vector<Eigen::Quaterniond> quaternions = randomQuaternions(1024);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		Eigen::AngleAxisd angle_axis(quaternions[i++ % quaternions.size()]);
+		benchmark::DoNotOptimize(Eigen::Vector3d(angle_axis.angle() * angle_axis.axis()));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(so3LogAngleAxis);
+
+void so3Log(benchmark::State & state) {
+	std::vector<Eigen::Quaterniond> quaternions = randomQuaternions(1024);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::so3Log(quaternions[i++ % quaternions.size()]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(so3Log);
+
+void se3Exp(benchmark::State & state) {
+	std::vector<Eigen::Vector3d> rotations    = randomRotationVectors(1024, state.range(0) / 1000.0);
+	std::vector<Eigen::Vector3d> translations = randomPositions(1024);
+	std::vector<Eigen::Matrix<double, 6, 1>> tangents(1024);
+	for (std::size_t i = 0; i < tangents.size(); ++i) tangents[i] << translations[i], rotations[i];
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::se3Exp(tangents[i++ % tangents.size()]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(se3Exp)->Arg(1)->Arg(1000);
+
+void se3Log(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> isometries = randomIsometries(1024);
+	std::size_t i = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::se3Log(isometries[i++ % isometries.size()]));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(se3Log);
+
+void so3ExpBatch(benchmark::State & state) {
+	std::vector<Eigen::Vector3d> vectors = randomRotationVectors(state.range(0), 0.01);
+	Eigen::Matrix3Xd rotations(3, vectors.size());
+	for (std::size_t i = 0; i < vectors.size(); ++i) rotations.col(i) = vectors[i];
+	std::vector<Eigen::Quaterniond> output(vectors.size());
+	for (auto _ : state) {
+		dr::so3Exp(rotations, output.begin());
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(so3ExpBatch)->Arg(4096);
+
+}
+}
@@ -0,0 +1,5 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
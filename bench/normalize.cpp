@@ -0,0 +1,58 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "normalize.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	/// Random unit quaternions scaled by a factor close to one, like quaternions read from text files.
+	std::vector<Eigen::Quaterniond> const & quaternions() {
+		static std::vector<Eigen::Quaterniond> const result = [] {
+			std::vector<Eigen::Quaterniond> result = randomQuaternions(1000000);
+			for (std::size_t i = 0; i < result.size(); ++i) result[i].coeffs() *= 1 + 1e-4 * double(i % 7);
+			return result;
+		}();
+		return result;
+	}
+}
+
+void normalizeQuaternionsBatch(benchmark::State & state) {
+	std::vector<Eigen::Quaterniond> input = quaternions();
+	for (auto _ : state) {
+		normalizeQuaternions(input, state.range(0));
+		benchmark::DoNotOptimize(input.data());
+	}
+	state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(normalizeQuaternionsBatch)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void canonicalizeQuaternionsBatch(benchmark::State & state) {
+	std::vector<Eigen::Quaterniond> input = quaternions();
+	for (auto _ : state) {
+		canonicalizeQuaternions(input, Eigen::Quaterniond::Identity(), state.range(0));
+		benchmark::DoNotOptimize(input.data());
+	}
+	state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(canonicalizeQuaternionsBatch)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void orthonormalizeRotationsBatch(benchmark::State & state) {
+	std::vector<Eigen::Matrix3d> matrices;
+	for (std::size_t i = 0; i < 100000; ++i) matrices.push_back(quaternions()[i].toRotationMatrix());
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::vector<Eigen::Matrix3d> input = matrices;
+		state.ResumeTiming();
+		orthonormalizeRotations(input, state.range(0));
+		benchmark::DoNotOptimize(input.data());
+	}
+	state.SetItemsProcessed(state.iterations() * matrices.size());
+}
+BENCHMARK(orthonormalizeRotationsBatch)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
+}
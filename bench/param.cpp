@@ -0,0 +1,137 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "param.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	XmlRpc::XmlRpcValue const & poseParameters() {
+		static XmlRpc::XmlRpcValue const result = [] {
+			std::vector<Eigen::Isometry3d> isometries = randomIsometries(10000);
+			XmlRpc::XmlRpcValue result;
+			result.setSize(isometries.size());
+			for (std::size_t i = 0; i < isometries.size(); ++i) {
+				XmlRpc::XmlRpcValue & value = result[int(i)];
+				Eigen::Quaterniond orientation{isometries[i].linear()};
+				value["parent_frame"]     = "world";
+				value["child_frame"]      = "camera";
+				value["position"]["x"]    = isometries[i].translation().x();
+				value["position"]["y"]    = isometries[i].translation().y();
+				value["position"]["z"]    = isometries[i].translation().z();
+				value["orientation"]["x"] = orientation.x();
+				value["orientation"]["y"] = orientation.y();
+				value["orientation"]["z"] = orientation.z();
+				value["orientation"]["w"] = orientation.w();
+			}
+			return result;
+		}();
+		return result;
+	}
+
+	XmlRpc::XmlRpcValue vectorParameter(Eigen::Vector3d const & vector) {
+		XmlRpc::XmlRpcValue result;
+		result["x"] = vector.x();
+		result["y"] = vector.y();
+		result["z"] = vector.z();
+		return result;
+	}
+
+	/// Benchmark converting a single parameter value.
+	template<typename T>
+	void benchmarkParameter(benchmark::State & state, XmlRpc::XmlRpcValue const & value) {
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(fromXmlRpc<T>(value));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+}
+
+void paramVector(benchmark::State & state) {
+	benchmarkParameter<Eigen::Vector3d>(state, vectorParameter({1, 2, 3}));
+}
+BENCHMARK(paramVector);
+
+void paramQuaternion(benchmark::State & state) {
+	Eigen::Quaterniond quaternion = randomQuaternions(1)[0];
+	XmlRpc::XmlRpcValue value;
+	value["w"] = quaternion.w();
+	value["x"] = quaternion.x();
+	value["y"] = quaternion.y();
+	value["z"] = quaternion.z();
+	benchmarkParameter<Eigen::Quaterniond>(state, value);
+}
+BENCHMARK(paramQuaternion);
+
+void paramQuaternionRpy(benchmark::State & state) {
+	XmlRpc::XmlRpcValue value;
+	value["r"] = 0.1;
+	value["p"] = 0.2;
+	value["y"] = 0.3;
+	benchmarkParameter<Eigen::Quaterniond>(state, value);
+}
+BENCHMARK(paramQuaternionRpy);
+
+void paramIsometry(benchmark::State & state) {
+	Eigen::Isometry3d isometry = randomIsometries(1)[0];
+	Eigen::Quaterniond orientation{isometry.linear()};
+	XmlRpc::XmlRpcValue value;
+	value["position"]         = vectorParameter(isometry.translation());
+	value["orientation"]["x"] = orientation.x();
+	value["orientation"]["y"] = orientation.y();
+	value["orientation"]["z"] = orientation.z();
+	value["orientation"]["w"] = orientation.w();
+	benchmarkParameter<Eigen::Isometry3d>(state, value);
+}
+BENCHMARK(paramIsometry);
+
+void paramPose(benchmark::State & state) {
+	benchmarkParameter<Pose>(state, poseParameters()[0]);
+}
+BENCHMARK(paramPose);
+
+void paramAlignedBox(benchmark::State & state) {
+	XmlRpc::XmlRpcValue value;
+	value["center"]     = vectorParameter({1, 2, 3});
+	value["dimensions"] = vectorParameter({0.5, 0.5, 0.2});
+	benchmarkParameter<Eigen::AlignedBox3d>(state, value);
+}
+BENCHMARK(paramAlignedBox);
+
+void paramMatrix6d(benchmark::State & state) {
+	XmlRpc::XmlRpcValue value;
+	value.setSize(6);
+	for (int row = 0; row < 6; ++row) {
+		value[row].setSize(6);
+		for (int col = 0; col < 6; ++col) value[row][col] = row == col ? 1.0 : 0.01 * (row + col);
+	}
+	benchmarkParameter<Eigen::Matrix<double, 6, 6>>(state, value);
+}
+BENCHMARK(paramMatrix6d);
+
+void paramPosesSingle(benchmark::State & state) {
+	XmlRpc::XmlRpcValue const & input = poseParameters();
+	for (auto _ : state) {
+		std::vector<Pose> poses;
+		for (int i = 0; i < input.size(); ++i) poses.push_back(fromXmlRpc<Pose>(input[i]));
+		benchmark::DoNotOptimize(poses.data());
+	}
+	state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(paramPosesSingle)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void paramPosesBulk(benchmark::State & state) {
+	XmlRpc::XmlRpcValue const & input = poseParameters();
+	for (auto _ : state) {
+		std::vector<Pose> poses = fromXmlRpc<std::vector<Pose>>(input);
+		benchmark::DoNotOptimize(poses.data());
+	}
+	state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(paramPosesBulk)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
+}
@@ -0,0 +1,53 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "pose_cluster.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	/// Candidate poses: groups of 10 poses jittered around random centers.
+	std::vector<Eigen::Isometry3d> candidates(std::size_t count) {
+		std::vector<Eigen::Isometry3d> centers = randomIsometries(count / 10);
+		std::vector<Eigen::Isometry3d> jitter  = randomIsometries(count, 1);
+		std::vector<Eigen::Isometry3d> result;
+		result.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			Eigen::Matrix<double, 6, 1> tangent = 1e-3 * se3Log<double>(jitter[i]);
+			result.push_back(centers[i % centers.size()] * se3Exp(tangent));
+		}
+		return result;
+	}
+}
+
+void clusterPoses(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> poses = candidates(state.range(0));
+	PoseClusterOptions options;
+	options.translation_threshold = 0.005;
+	options.rotation_threshold    = 0.05;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::clusterPoses(poses, options));
+	}
+	state.SetItemsProcessed(state.iterations() * poses.size());
+}
+BENCHMARK(clusterPoses)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+void suppressNonMaxima(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> poses = candidates(state.range(0));
+	std::vector<double> scores(poses.size());
+	for (std::size_t i = 0; i < scores.size(); ++i) scores[i] = (i * 7919) % 1000;
+	PoseClusterOptions options;
+	options.translation_threshold = 0.005;
+	options.rotation_threshold    = 0.05;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(dr::suppressNonMaxima(poses, scores, options));
+	}
+	state.SetItemsProcessed(state.iterations() * poses.size());
+}
+BENCHMARK(suppressNonMaxima)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+}
+}
@@ -0,0 +1,68 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "pose_log.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	std::string const & poseLogPath() {
+		static std::string const path = [] {
+			std::string path = "/tmp/dr_eigen_bench_pose_log.bin";
+			PoseLogWriter writer{path, PoseLogType::pose, PoseLogWriterOptions{true, false, 1 << 16}};
+			std::int64_t timestamp = 0;
+			for (Eigen::Isometry3d const & isometry : randomIsometries(100000)) {
+				writer.append(timestamp, Pose{PoseHeader{"world", "camera"}, isometry});
+				timestamp += 1000000;
+			}
+			return path;
+		}();
+		return path;
+	}
+}
+
+void poseLogWrite(benchmark::State & state) {
+	std::vector<Eigen::Isometry3d> const input = randomIsometries(100000);
+	std::string path = "/tmp/dr_eigen_bench_pose_log_write.bin";
+	for (auto _ : state) {
+		PoseLogWriter writer{path, PoseLogType::pose};
+		for (Eigen::Isometry3d const & isometry : input) writer.append(Pose{PoseHeader{"world", "camera"}, isometry});
+		writer.close();
+	}
+	std::remove(path.c_str());
+	state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(poseLogWrite)->Unit(benchmark::kMillisecond);
+
+void poseLogReadIsometries(benchmark::State & state) {
+	std::string const & path = poseLogPath();
+	std::size_t count = 0;
+	for (auto _ : state) {
+		PoseLogReader reader{path};
+		Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+		for (std::size_t i = 0; i < reader.size(); ++i) sum += reader.isometry(i).translation();
+		benchmark::DoNotOptimize(sum.data());
+		count = reader.size();
+	}
+	state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(poseLogReadIsometries)->Unit(benchmark::kMillisecond);
+
+void poseLogLowerBound(benchmark::State & state) {
+	PoseLogReader reader{poseLogPath()};
+	std::int64_t timestamp = 0;
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(reader.lowerBound(timestamp));
+		timestamp = (timestamp + std::int64_t(7919) * 1000003) % (std::int64_t(100000) * 1000000);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(poseLogLowerBound);
+
+}
+}
@@ -0,0 +1,168 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "ros.hpp"
+#include "tf.hpp"
+
+#include <benchmark/benchmark.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	/// Benchmark a conversion of every element of a list of inputs.
+	template<typename Input, typename Conversion>
+	void benchmarkConversion(benchmark::State & state, std::vector<Input> const & inputs, Conversion && conversion) {
+		std::size_t i = 0;
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(conversion(inputs[i++ % inputs.size()]));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename Output, typename Input, typename Conversion>
+	std::vector<Output> convertAll(std::vector<Input> const & inputs, Conversion && conversion) {
+		std::vector<Output> result;
+		result.reserve(inputs.size());
+		for (Input const & input : inputs) result.push_back(conversion(input));
+		return result;
+	}
+}
+
+void eigenToRosPoint(benchmark::State & state) {
+	benchmarkConversion(state, randomPositions(1024), [] (Eigen::Vector3d const & vector) { return toRosPoint(vector); });
+}
+BENCHMARK(eigenToRosPoint);
+
+void rosPointToEigen(benchmark::State & state) {
+	std::vector<geometry_msgs::Point> points = convertAll<geometry_msgs::Point>(randomPositions(1024), [] (Eigen::Vector3d const & vector) { return toRosPoint(vector); });
+	benchmarkConversion(state, points, [] (geometry_msgs::Point const & point) { return toEigen(point); });
+}
+BENCHMARK(rosPointToEigen);
+
+void eigenToRosPoint32(benchmark::State & state) {
+	std::vector<Eigen::Vector3f> vectors = convertAll<Eigen::Vector3f>(randomPositions(1024), [] (Eigen::Vector3d const & vector) { return vector.cast<float>(); });
+	benchmarkConversion(state, vectors, [] (Eigen::Vector3f const & vector) { return toRosPoint32(vector); });
+}
+BENCHMARK(eigenToRosPoint32);
+
+void rosPoint32ToEigen(benchmark::State & state) {
+	std::vector<geometry_msgs::Point32> points = convertAll<geometry_msgs::Point32>(randomPositions(1024), [] (Eigen::Vector3d const & vector) { return toRosPoint32(vector.cast<float>()); });
+	benchmarkConversion(state, points, [] (geometry_msgs::Point32 const & point) { return toEigen(point); });
+}
+BENCHMARK(rosPoint32ToEigen);
+
+void eigenToRosVector3(benchmark::State & state) {
+	benchmarkConversion(state, randomPositions(1024), [] (Eigen::Vector3d const & vector) { return toRosVector3(vector); });
+}
+BENCHMARK(eigenToRosVector3);
+
+void rosVector3ToEigen(benchmark::State & state) {
+	std::vector<geometry_msgs::Vector3> vectors = convertAll<geometry_msgs::Vector3>(randomPositions(1024), [] (Eigen::Vector3d const & vector) { return toRosVector3(vector); });
+	benchmarkConversion(state, vectors, [] (geometry_msgs::Vector3 const & vector) { return toEigen(vector); });
+}
+BENCHMARK(rosVector3ToEigen);
+
+void eigenToRosQuaternion(benchmark::State & state) {
+	benchmarkConversion(state, randomQuaternions(1024), [] (Eigen::Quaterniond const & quaternion) { return toRosQuaternion(quaternion); });
+}
+BENCHMARK(eigenToRosQuaternion);
+
+void rosQuaternionToEigen(benchmark::State & state) {
+	std::vector<geometry_msgs::Quaternion> quaternions = convertAll<geometry_msgs::Quaternion>(randomQuaternions(1024), [] (Eigen::Quaterniond const & quaternion) { return toRosQuaternion(quaternion); });
+	NormalizeMode mode = NormalizeMode(state.range(0));
+	benchmarkConversion(state, quaternions, [mode] (geometry_msgs::Quaternion const & quaternion) { return toEigen(quaternion, mode); });
+}
+BENCHMARK(rosQuaternionToEigen)->Arg(int(NormalizeMode::as_is))->Arg(int(NormalizeMode::normalize));
+
+void angleAxisToRosQuaternion(benchmark::State & state) {
+	std::vector<Eigen::AngleAxisd> rotations = convertAll<Eigen::AngleAxisd>(randomQuaternions(1024), [] (Eigen::Quaterniond const & quaternion) { return Eigen::AngleAxisd{quaternion}; });
+	benchmarkConversion(state, rotations, [] (Eigen::AngleAxisd const & rotation) { return toRosQuaternion(rotation); });
+}
+BENCHMARK(angleAxisToRosQuaternion);
+
+void eigenToRosPose(benchmark::State & state) {
+	benchmarkConversion(state, randomIsometries(1024), [] (Eigen::Isometry3d const & isometry) { return toRosPose(isometry); });
+}
+BENCHMARK(eigenToRosPose);
+
+void rosPoseToEigen(benchmark::State & state) {
+	std::vector<geometry_msgs::Pose> poses = convertAll<geometry_msgs::Pose>(randomIsometries(1024), [] (Eigen::Isometry3d const & isometry) { return toRosPose(isometry); });
+	benchmarkConversion(state, poses, [] (geometry_msgs::Pose const & pose) { return toEigen(pose); });
+}
+BENCHMARK(rosPoseToEigen);
+
+void eigenToRosPoseStamped(benchmark::State & state) {
+	// A fixed time, so the benchmark does not measure the clock.
+	ros::Time time{1};
+	benchmarkConversion(state, randomIsometries(1024), [time] (Eigen::Isometry3d const & isometry) { return toRosPoseStamped(isometry, "world", time); });
+}
+BENCHMARK(eigenToRosPoseStamped);
+
+void eigenToRosTransform(benchmark::State & state) {
+	benchmarkConversion(state, randomIsometries(1024), [] (Eigen::Isometry3d const & isometry) { return toRosTransform(isometry); });
+}
+BENCHMARK(eigenToRosTransform);
+
+void rosTransformToEigen(benchmark::State & state) {
+	std::vector<geometry_msgs::Transform> transforms = convertAll<geometry_msgs::Transform>(randomIsometries(1024), [] (Eigen::Isometry3d const & isometry) { return toRosTransform(isometry); });
+	benchmarkConversion(state, transforms, [] (geometry_msgs::Transform const & transform) { return toEigen(transform); });
+}
+BENCHMARK(rosTransformToEigen);
+
+void eigenToTfTransform(benchmark::State & state) {
+	benchmarkConversion(state, randomIsometries(1024), [] (Eigen::Isometry3d const & isometry) { return toTfTransform(isometry); });
+}
+BENCHMARK(eigenToTfTransform);
+
+void tfTransformToEigen(benchmark::State & state) {
+	std::vector<tf::Transform> transforms = convertAll<tf::Transform>(randomIsometries(1024), [] (Eigen::Isometry3d const & isometry) { return toTfTransform(isometry); });
+	benchmarkConversion(state, transforms, [] (tf::Transform const & transform) { return toEigen(transform); });
+}
+BENCHMARK(tfTransformToEigen);
+
+void eigenToTfStampedTransform(benchmark::State & state) {
+	// A fixed time, so the benchmark does not measure the clock.
+	ros::Time time{1};
+	benchmarkConversion(state, randomIsometries(1024), [time] (Eigen::Isometry3d const & isometry) { return toTfStampedTransform(isometry, "world", "tool", time); });
+}
+BENCHMARK(eigenToTfStampedTransform);
+
+void eigenToTfVector3(benchmark::State & state) {
+	benchmarkConversion(state, randomPositions(1024), [] (Eigen::Vector3d const & vector) { return toTfVector3(vector); });
+}
+BENCHMARK(eigenToTfVector3);
+
+void tfVector3ToEigen(benchmark::State & state) {
+	std::vector<tf::Vector3> vectors = convertAll<tf::Vector3>(randomPositions(1024), [] (Eigen::Vector3d const & vector) { return toTfVector3(vector); });
+	benchmarkConversion(state, vectors, [] (tf::Vector3 const & vector) { return toEigen(vector); });
+}
+BENCHMARK(tfVector3ToEigen);
+
+void eigenToTfQuaternion(benchmark::State & state) {
+	benchmarkConversion(state, randomQuaternions(1024), [] (Eigen::Quaterniond const & quaternion) { return toTfQuaternion(quaternion); });
+}
+BENCHMARK(eigenToTfQuaternion);
+
+void tfQuaternionToEigen(benchmark::State & state) {
+	std::vector<tf::Quaternion> quaternions = convertAll<tf::Quaternion>(randomQuaternions(1024), [] (Eigen::Quaterniond const & quaternion) { return toTfQuaternion(quaternion); });
+	NormalizeMode mode = NormalizeMode(state.range(0));
+	benchmarkConversion(state, quaternions, [mode] (tf::Quaternion const & quaternion) { return toEigen(quaternion, mode); });
+}
+BENCHMARK(tfQuaternionToEigen)->Arg(int(NormalizeMode::as_is))->Arg(int(NormalizeMode::normalize));
+
+void eigenToTfMatrix(benchmark::State & state) {
+	std::vector<Eigen::Matrix3d> matrices = convertAll<Eigen::Matrix3d>(randomQuaternions(1024), [] (Eigen::Quaterniond const & quaternion) { return quaternion.toRotationMatrix(); });
+	benchmarkConversion(state, matrices, [] (Eigen::Matrix3d const & matrix) { return toTfMatrix3x3(matrix); });
+}
+BENCHMARK(eigenToTfMatrix);
+
+void tfMatrixToEigen(benchmark::State & state) {
+	std::vector<tf::Matrix3x3> matrices = convertAll<tf::Matrix3x3>(randomQuaternions(1024), [] (Eigen::Quaterniond const & quaternion) { return toTfMatrix3x3(quaternion.toRotationMatrix()); });
+	NormalizeMode mode = NormalizeMode(state.range(0));
+	benchmarkConversion(state, matrices, [mode] (tf::Matrix3x3 const & matrix) { return toEigen(matrix, mode); });
+}
+BENCHMARK(tfMatrixToEigen)->Arg(int(NormalizeMode::as_is))->Arg(int(NormalizeMode::normalize));
+
+}
+}
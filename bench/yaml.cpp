@@ -0,0 +1,95 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "common.hpp"
+#include "yaml.hpp"
+#include "yaml_reader.hpp"
+#include "yaml_writer.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace dr {
+namespace bench {
+
+namespace {
+	std::vector<Pose> const & poses() {
+		static std::vector<Pose> const result = [] {
+			std::vector<Pose> result;
+			for (Eigen::Isometry3d const & isometry : randomIsometries(10000)) result.push_back(Pose{PoseHeader{"world", "camera"}, isometry});
+			return result;
+		}();
+		return result;
+	}
+}
+
+void yamlAppendPoses(benchmark::State & state) {
+	std::vector<Pose> const & input = poses();
+	std::string output;
+	for (auto _ : state) {
+		output.clear();
+		for (Pose const & pose : input) {
+			output.append("- ");
+			appendYaml(output, pose, "  ");
+			output.push_back('\n');
+		}
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * input.size());
+	state.SetBytesProcessed(state.iterations() * output.size());
+}
+BENCHMARK(yamlAppendPoses)->Unit(benchmark::kMillisecond);
+
+void yamlToYamlPoses(benchmark::State & state) {
+	std::vector<Pose> const & input = poses();
+	for (auto _ : state) {
+		std::string output;
+		for (Pose const & pose : input) {
+			output += "- ";
+			output += toYaml(pose, "  ");
+			output += '\n';
+		}
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(yamlToYamlPoses)->Unit(benchmark::kMillisecond);
+
+void yamlWriterPoses(benchmark::State & state) {
+	std::vector<Pose> const & input = poses();
+	int fd = ::open("/dev/null", O_WRONLY);
+	PoseYamlWriterOptions options;
+	options.background_flush = state.range(0);
+	for (auto _ : state) {
+		PoseYamlWriter writer{fd, options};
+		writer.beginSequence();
+		for (Pose const & pose : input) writer.write(pose);
+		writer.close();
+	}
+	::close(fd);
+	state.SetItemsProcessed(state.iterations() * input.size());
+}
+BENCHMARK(yamlWriterPoses)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void yamlReadPoses(benchmark::State & state) {
+	std::string text;
+	for (Pose const & pose : poses()) {
+		text.append("-\n");
+		appendYaml(text, pose, "  ");
+		text.push_back('\n');
+	}
+
+	std::vector<Pose> output;
+	for (auto _ : state) {
+		output.clear();
+		posesFromYaml(YamlDocument::parse(text).root(), output);
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * output.size());
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(yamlReadPoses)->Unit(benchmark::kMillisecond);
+
+}
+}
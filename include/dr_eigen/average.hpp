@@ -5,11 +5,18 @@
 #include <Eigen/Geometry>
 #include <Eigen/Eigenvalues>
 
+#include "instrument.hpp"
+#include "lie.hpp"
+
+#include <iterator>
+#include <vector>
+
 namespace dr {
 
 /// Calculate average orientation using quaternions
 template<typename DataType, typename ForwardIterator>
 Eigen::Quaternion<DataType> averageQuaternions(ForwardIterator const & begin, ForwardIterator const & end) {
+	DR_EIGEN_INSTRUMENT_SCOPE(average_quaternions, std::distance(begin, end));
 
 	if (begin == end) {
 		throw std::logic_error("Cannot average orientations over an empty range.");
@@ -47,6 +54,7 @@ typename Eigen::Quaternion<DataType> averageQuaternions(Container const & contai
 /// Calculate average position
 template<typename DataType, typename ForwardIterator>
 Eigen::Matrix<DataType, 3, 1> averagePositions(ForwardIterator const & begin, ForwardIterator const & end) {
+	DR_EIGEN_INSTRUMENT_SCOPE(average_positions, std::distance(begin, end));
 	if (begin == end) {
 		throw std::logic_error("Cannot average orientations over an empty range.");
 	}
@@ -74,6 +82,7 @@ typename Eigen::Matrix<DataType, 3, 1> averagePositions(Container const & contai
 
 template<typename DataType, typename ForwardIterator>
 Eigen::Transform<DataType, 3, Eigen::Isometry> averageIsometries(ForwardIterator const & begin, ForwardIterator const & end) {
+	DR_EIGEN_INSTRUMENT_SCOPE(average_isometries, std::distance(begin, end));
 
 	std::vector<Eigen::Vector3d> positions;
 	std::vector<Eigen::Quaterniond> quaternions;
@@ -91,4 +100,350 @@ Eigen::Transform<DataType, 3, Eigen::Isometry> averageIsometries(Container const
 	return averageIsometries<DataType>(container.begin(), container.end());
 }
 
+/// Single pass accumulator for the mean and covariance of poses.
+/**
+ * Positions and quaternions are accumulated with Welford's online algorithm,
+ * and accumulators filled on different threads or batches can be merged afterwards.
+ *
+ * The mean rotation is the same chordal mean as calculated by averageQuaternions.
+ * The covariance is expressed in the tangent space of SO(3) x R3 at the mean:
+ * the position in the parent frame and the rotation vector v such that a sample equals mean * so3Exp(v).
+ * The rotation covariance is a first order approximation derived from the quaternion moments,
+ * which is accurate for concentrated rotations such as repeated detections of the same object.
+ */
+template<typename DataType>
+class PoseAccumulator {
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	using Vector3    = Eigen::Matrix<DataType, 3, 1>;
+	using Matrix3    = Eigen::Matrix<DataType, 3, 3>;
+	using Matrix6    = Eigen::Matrix<DataType, 6, 6>;
+	using Quaternion = Eigen::Quaternion<DataType>;
+	using Isometry3  = Eigen::Transform<DataType, 3, Eigen::Isometry>;
+
+	/// Construct an empty accumulator.
+	PoseAccumulator() : count_(0), mean_(Vector7::Zero()), moment_(Matrix7::Zero()), reference_(Quaternion::Identity()) {}
+
+	/// Add a sample.
+	void add(Vector3 const & position, Quaternion const & rotation) {
+		if (count_ == 0) reference_ = rotation;
+
+		Vector7 sample;
+		sample.template head<3>() = position;
+		// Flip the quaternion to the hemisphere of the first sample, since q and -q represent the same rotation.
+		sample.template tail<4>() = reference_.dot(rotation) < 0 ? Eigen::Matrix<DataType, 4, 1>(-rotation.coeffs()) : rotation.coeffs();
+
+		++count_;
+		Vector7 delta = sample - mean_;
+		mean_   += delta / DataType(count_);
+		moment_ += delta * (sample - mean_).transpose();
+	}
+
+	/// Add a sample.
+	void add(Isometry3 const & isometry) {
+		add(isometry.translation(), Quaternion(isometry.rotation()));
+	}
+
+	/// Merge the samples of another accumulator into this one.
+	void merge(PoseAccumulator const & other) {
+		if (other.count_ == 0) return;
+		if (count_ == 0) {
+			*this = other;
+			return;
+		}
+
+		// Bring the quaternions of the other accumulator to the same hemisphere.
+		Vector7 other_mean   = other.mean_;
+		Matrix7 other_moment = other.moment_;
+		if (reference_.dot(other.reference_) < 0) {
+			other_mean.template tail<4>() *= -1;
+			other_moment.template topRightCorner<3, 4>()   *= -1;
+			other_moment.template bottomLeftCorner<4, 3>() *= -1;
+		}
+
+		std::size_t count = count_ + other.count_;
+		Vector7 delta = other_mean - mean_;
+		mean_   += delta * (DataType(other.count_) / DataType(count));
+		moment_ += other_moment + delta * delta.transpose() * (DataType(count_) * DataType(other.count_) / DataType(count));
+		count_ = count;
+	}
+
+	/// Get the number of samples.
+	std::size_t count() const { return count_; }
+
+	/// Get the mean position.
+	Vector3 position() const {
+		ensureNotEmpty();
+		return mean_.template head<3>();
+	}
+
+	/// Get the mean rotation.
+	Quaternion rotation() const {
+		ensureNotEmpty();
+		Eigen::SelfAdjointEigenSolver<Eigen::Matrix<DataType, 4, 4>> solver(scatter());
+		Eigen::Matrix<DataType, 4, 1> largest = solver.eigenvectors().col(3);
+		if (largest.dot(mean_.template tail<4>()) < 0) largest = -largest;
+		return Quaternion(largest);
+	}
+
+	/// Get the mean pose.
+	Isometry3 mean() const {
+		return Eigen::Translation<DataType, 3>(position()) * rotation();
+	}
+
+	/// Get the sample covariance of the position.
+	Matrix3 positionCovariance() const {
+		return covariance().template topLeftCorner<3, 3>();
+	}
+
+	/// Get the sample covariance of the rotation vector.
+	Matrix3 rotationCovariance() const {
+		return covariance().template bottomRightCorner<3, 3>();
+	}
+
+	/// Get the joint 6x6 sample covariance of the position and the rotation vector, in that order.
+	/**
+	 * The covariance is zero if there are less than two samples.
+	 */
+	Matrix6 covariance() const {
+		ensureNotEmpty();
+		if (count_ < 2) return Matrix6::Zero();
+
+		// Orthonormal basis of the quaternion tangent space at the mean:
+		// for a small rotation vector v, mean * so3Exp(v) ~= mean + tangent * v / 2.
+		Quaternion mean = rotation();
+		Eigen::Matrix<DataType, 4, 3> tangent;
+		tangent.col(0) = (mean * Quaternion(0, 1, 0, 0)).coeffs();
+		tangent.col(1) = (mean * Quaternion(0, 0, 1, 0)).coeffs();
+		tangent.col(2) = (mean * Quaternion(0, 0, 0, 1)).coeffs();
+
+		DataType scale = DataType(1) / DataType(count_ - 1);
+		Matrix6 result;
+		result.template topLeftCorner<3, 3>()     = scale * moment_.template topLeftCorner<3, 3>();
+		result.template topRightCorner<3, 3>()    = 2 * scale * moment_.template topRightCorner<3, 4>() * tangent;
+		result.template bottomLeftCorner<3, 3>()  = result.template topRightCorner<3, 3>().transpose();
+		result.template bottomRightCorner<3, 3>() = 4 * tangent.transpose() * (DataType(count_) * scale * scatter()) * tangent;
+		return result;
+	}
+
+private:
+	using Vector7 = Eigen::Matrix<DataType, 7, 1>;
+	using Matrix7 = Eigen::Matrix<DataType, 7, 7>;
+
+	void ensureNotEmpty() const {
+		if (count_ == 0) throw std::logic_error("Cannot average poses over an empty range.");
+	}
+
+	/// Get the uncentered second moment of the quaternions, which does not depend on their signs.
+	Eigen::Matrix<DataType, 4, 4> scatter() const {
+		Eigen::Matrix<DataType, 4, 1> mean = mean_.template tail<4>();
+		return moment_.template bottomRightCorner<4, 4>() / DataType(count_) + mean * mean.transpose();
+	}
+
+	/// The number of samples.
+	std::size_t count_;
+
+	/// The mean of the positions and quaternion coefficients.
+	Vector7 mean_;
+
+	/// The sum of the outer products of the deviations from the mean.
+	Matrix7 moment_;
+
+	/// The hemisphere that all quaternions are flipped to.
+	Quaternion reference_;
+};
+
+/// Calculate the average position and its sample covariance in a single pass.
+template<typename DataType, typename ForwardIterator>
+Eigen::Matrix<DataType, 3, 1> averagePositions(ForwardIterator const & begin, ForwardIterator const & end, Eigen::Matrix<DataType, 3, 3> & covariance) {
+	DR_EIGEN_INSTRUMENT_SCOPE(average_positions, std::distance(begin, end));
+	if (begin == end) {
+		throw std::logic_error("Cannot average positions over an empty range.");
+	}
+
+	Eigen::Matrix<DataType, 3, 1> mean   = Eigen::Matrix<DataType, 3, 1>::Zero();
+	Eigen::Matrix<DataType, 3, 3> moment = Eigen::Matrix<DataType, 3, 3>::Zero();
+	uint count(0);
+	for (ForwardIterator it = begin; it != end; ++it) {
+		Eigen::Matrix<DataType, 3, 1> position(it->x(), it->y(), it->z());
+		++count;
+		Eigen::Matrix<DataType, 3, 1> delta = position - mean;
+		mean   += delta / DataType(count);
+		moment += delta * (position - mean).transpose();
+	}
+
+	if (count < 2) {
+		covariance.setZero();
+	} else {
+		covariance = moment / DataType(count - 1);
+	}
+	return mean;
+}
+
+/// Overloaded function to calculate the average position and its covariance for some container types.
+template<typename DataType, typename Container>
+Eigen::Matrix<DataType, 3, 1> averagePositions(Container const & container, Eigen::Matrix<DataType, 3, 3> & covariance) {
+	return averagePositions<DataType>(container.begin(), container.end(), covariance);
+}
+
+/// Calculate the average orientation and the covariance of the rotation vectors around it in a single pass.
+template<typename DataType, typename ForwardIterator>
+Eigen::Quaternion<DataType> averageQuaternions(ForwardIterator const & begin, ForwardIterator const & end, Eigen::Matrix<DataType, 3, 3> & covariance) {
+	DR_EIGEN_INSTRUMENT_SCOPE(average_quaternions, std::distance(begin, end));
+	PoseAccumulator<DataType> accumulator;
+	for (ForwardIterator it = begin; it != end; ++it) {
+		accumulator.add(Eigen::Matrix<DataType, 3, 1>::Zero(), Eigen::Quaternion<DataType>(*it));
+	}
+	covariance = accumulator.rotationCovariance();
+	return accumulator.rotation();
+}
+
+/// Overloaded function to calculate the average quaternion and its covariance for some container types.
+template<typename DataType, typename Container>
+Eigen::Quaternion<DataType> averageQuaternions(Container const & container, Eigen::Matrix<DataType, 3, 3> & covariance) {
+	return averageQuaternions<DataType>(container.begin(), container.end(), covariance);
+}
+
+/// Calculate the average isometry and its 6x6 covariance in a single pass.
+/**
+ * See PoseAccumulator for the definition of the covariance.
+ */
+template<typename DataType, typename ForwardIterator>
+Eigen::Transform<DataType, 3, Eigen::Isometry> averageIsometries(ForwardIterator const & begin, ForwardIterator const & end, Eigen::Matrix<DataType, 6, 6> & covariance) {
+	DR_EIGEN_INSTRUMENT_SCOPE(average_isometries, std::distance(begin, end));
+	PoseAccumulator<DataType> accumulator;
+	for (ForwardIterator it = begin; it != end; ++it) {
+		accumulator.add(*it);
+	}
+	covariance = accumulator.covariance();
+	return accumulator.mean();
+}
+
+/// Overloaded function to calculate the average isometry and its covariance for some container types.
+template<typename DataType, typename Container>
+Eigen::Transform<DataType, 3, Eigen::Isometry> averageIsometries(Container const & container, Eigen::Matrix<DataType, 6, 6> & covariance) {
+	return averageIsometries<DataType>(container.begin(), container.end(), covariance);
+}
+
+/// Space in which the Karcher mean of isometries is computed.
+enum class KarcherSpace {
+	/// Rotations on SO(3) and translations in R3, averaged independently.
+	so3_r3,
+
+	/// Rigid transformations on SE(3), with rotation and translation coupled.
+	se3,
+};
+
+/// Result of an iterative Karcher mean computation.
+template<typename DataType>
+struct KarcherMeanResult {
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	/// The mean isometry.
+	Eigen::Transform<DataType, 3, Eigen::Isometry> mean;
+
+	/// The number of update steps performed.
+	int iterations;
+
+	/// The norm of the last update step.
+	DataType residual;
+
+	/// True if the last update step was within the tolerance.
+	bool converged;
+};
+
+/// Calculate the Karcher (geodesic) mean of isometries.
+/**
+ * The mean minimizes the sum of squared geodesic distances to all isometries.
+ * It is found by repeatedly averaging the tangent vectors of all isometries around the current mean,
+ * starting from the chordal mean calculated by averageIsometries.
+ *
+ * In the so3_r3 space, the translation is the arithmetic mean and only the rotation is refined.
+ */
+template<typename DataType, typename ForwardIterator>
+KarcherMeanResult<DataType> karcherMean(
+	ForwardIterator const & begin,             ///< Iterator to the first isometry.
+	ForwardIterator const & end,               ///< Iterator past the last isometry.
+	KarcherSpace space = KarcherSpace::so3_r3, ///< The space to compute the mean in.
+	DataType tolerance = 1e-12,                ///< Stop when the norm of the update step is below this value.
+	int max_iterations = 20                    ///< Maximum number of update steps.
+) {
+	DR_EIGEN_INSTRUMENT_SCOPE(average_isometries, std::distance(begin, end));
+	using Quaternion = Eigen::Quaternion<DataType>;
+	using Vector3    = Eigen::Matrix<DataType, 3, 1>;
+	using Vector6    = Eigen::Matrix<DataType, 6, 1>;
+
+	if (begin == end) {
+		throw std::logic_error("Cannot average isometries over an empty range.");
+	}
+
+	// Convert the rotations once, rather than every iteration.
+	std::vector<Quaternion> rotations;
+	std::vector<Vector3> translations;
+	for (ForwardIterator it = begin; it != end; ++it) {
+		rotations.push_back(Quaternion(it->rotation()));
+		translations.push_back(it->translation());
+	}
+	DataType count = rotations.size();
+
+	KarcherMeanResult<DataType> result;
+	result.mean       = averageIsometries<DataType>(begin, end);
+	result.iterations = 0;
+	result.residual   = 0;
+	result.converged  = false;
+
+	Quaternion mean_rotation(result.mean.rotation());
+	Vector3 mean_translation = result.mean.translation();
+
+	// Tangent vectors of all isometries around the current mean, reused every iteration.
+	Eigen::Matrix<DataType, 6, Eigen::Dynamic> residuals(6, rotations.size());
+
+	while (result.iterations < max_iterations) {
+		Quaternion inverse = mean_rotation.conjugate();
+		for (std::size_t i = 0; i < rotations.size(); ++i) {
+			Vector3 rotation = so3Log(Quaternion(inverse * rotations[i]));
+			if (space == KarcherSpace::se3) {
+				residuals.col(i).template head<3>() = so3LeftJacobianInverse(rotation) * (inverse * (translations[i] - mean_translation));
+			} else {
+				residuals.col(i).template head<3>() = translations[i] - mean_translation;
+			}
+			residuals.col(i).template tail<3>() = rotation;
+		}
+
+		Vector6 step = residuals.rowwise().sum() / count;
+		++result.iterations;
+		result.residual = step.norm();
+
+		if (space == KarcherSpace::se3) {
+			Eigen::Transform<DataType, 3, Eigen::Isometry> update = se3Exp(step);
+			mean_translation += mean_rotation * update.translation();
+			mean_rotation     = mean_rotation * Quaternion(update.rotation());
+		} else {
+			mean_translation += step.template head<3>();
+			mean_rotation     = mean_rotation * so3Exp<DataType>(step.template tail<3>());
+		}
+		mean_rotation.normalize();
+
+		if (result.residual <= tolerance) {
+			result.converged = true;
+			break;
+		}
+	}
+
+	result.mean = Eigen::Translation<DataType, 3>(mean_translation) * mean_rotation;
+	return result;
+}
+
+/// Overloaded function to calculate the Karcher mean for some container types.
+template<typename DataType, typename Container>
+KarcherMeanResult<DataType> karcherMean(
+	Container const & container,
+	KarcherSpace space = KarcherSpace::so3_r3,
+	DataType tolerance = 1e-12,
+	int max_iterations = 20
+) {
+	return karcherMean<DataType>(container.begin(), container.end(), space, tolerance, max_iterations);
+}
+
 }
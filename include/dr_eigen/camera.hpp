@@ -0,0 +1,389 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "parallel.hpp"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+/// Brown-Conrady lens distortion with radial and tangential terms.
+/**
+ * The coefficients follow the order and meaning of the plumb_bob model of OpenCV and sensor_msgs/CameraInfo: k1, k2, p1, p2, k3.
+ * Distortion works on normalized image coordinates, which are the X and Y coordinates of a point divided by its Z coordinate.
+ */
+template<typename Scalar>
+struct BrownConrady {
+	using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+	/// Number of fixed point iterations used to invert the distortion.
+	static constexpr int undistort_iterations = 20;
+
+	Scalar k1 = 0; ///< First radial coefficient.
+	Scalar k2 = 0; ///< Second radial coefficient.
+	Scalar p1 = 0; ///< First tangential coefficient.
+	Scalar p2 = 0; ///< Second tangential coefficient.
+	Scalar k3 = 0; ///< Third radial coefficient.
+
+	/// Check if all coefficients are zero, so distortion does nothing.
+	bool isZero() const {
+		return k1 == 0 && k2 == 0 && p1 == 0 && p2 == 0 && k3 == 0;
+	}
+
+	/// Distort normalized coordinates in place.
+	void distort(Eigen::Ref<Array> x, Eigen::Ref<Array> y) const {
+		BlockArray radial, dx, dy;
+		for (Eigen::Index begin = 0; begin < x.size(); begin += block_size) {
+			Eigen::Index count = std::min<Eigen::Index>(x.size() - begin, block_size);
+			auto block_x = x.segment(begin, count);
+			auto block_y = y.segment(begin, count);
+			terms(block_x, block_y, radial, dx, dy);
+			block_x = block_x * radial + dx;
+			block_y = block_y * radial + dy;
+		}
+	}
+
+	/// Undistort normalized coordinates in place with a fixed number of fixed point iterations.
+	/**
+	 * This converges for the distortion of normal lenses within the image, but not for the heavy distortion of fisheye lenses.
+	 */
+	void undistort(Eigen::Ref<Array> x, Eigen::Ref<Array> y) const {
+		BlockArray distorted_x, distorted_y, radial, dx, dy;
+		for (Eigen::Index begin = 0; begin < x.size(); begin += block_size) {
+			Eigen::Index count = std::min<Eigen::Index>(x.size() - begin, block_size);
+			auto block_x = x.segment(begin, count);
+			auto block_y = y.segment(begin, count);
+			distorted_x = block_x;
+			distorted_y = block_y;
+			for (int i = 0; i < undistort_iterations; ++i) {
+				terms(block_x, block_y, radial, dx, dy);
+				block_x = (distorted_x - dx) / radial;
+				block_y = (distorted_y - dy) / radial;
+			}
+		}
+	}
+
+private:
+	/// Number of coordinates processed at once, so the intermediate results fit in arrays on the stack.
+	static constexpr int block_size = 64;
+
+	/// An array of at most block_size coordinates that never allocates.
+	using BlockArray = Eigen::Array<Scalar, Eigen::Dynamic, 1, Eigen::ColMajor, block_size, 1>;
+
+	/// Compute the radial factor and the tangential offsets of a block of coordinates.
+	template<typename X, typename Y>
+	void terms(X const & x, Y const & y, BlockArray & radial, BlockArray & dx, BlockArray & dy) const {
+		BlockArray r2 = x.square() + y.square();
+		BlockArray xy = 2 * x * y;
+		radial = 1 + r2 * (k1 + r2 * (k2 + r2 * k3));
+		dx     = p1 * xy + p2 * (r2 + 2 * x.square());
+		dy     = p1 * (r2 + 2 * y.square()) + p2 * xy;
+	}
+};
+
+/// Pinhole camera model with optional Brown-Conrady distortion.
+/**
+ * The camera looks along its Z axis, with the X axis to the right and the Y axis down in the image.
+ * Pixel coordinates are (column, row), with the center of the first pixel at (0, 0).
+ *
+ * The batched functions take the transform from the frame of the points to the camera frame (or back) as argument,
+ * and apply it in the same pass as the projection, so every point is read from memory once.
+ * They process the points in blocks that are transposed so every coordinate is contiguous, which lets the arithmetic vectorize.
+ */
+template<typename Scalar>
+class PinholeCamera {
+public:
+	using Vector2    = Eigen::Matrix<Scalar, 2, 1>;
+	using Vector3    = Eigen::Matrix<Scalar, 3, 1>;
+	using Matrix3    = Eigen::Matrix<Scalar, 3, 3>;
+	using Matrix2X   = Eigen::Matrix<Scalar, 2, Eigen::Dynamic>;
+	using Matrix3X   = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+	using VectorX    = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+	using Isometry3  = Eigen::Transform<Scalar, 3, Eigen::Isometry>;
+	using Distortion = BrownConrady<Scalar>;
+
+	/// Construct a camera from its intrinsic parameters.
+	/**
+	 * \throws std::invalid_argument if a focal length is not positive.
+	 */
+	PinholeCamera(Scalar fx, Scalar fy, Scalar cx, Scalar cy, Distortion const & distortion = {}) :
+		fx_{fx}, fy_{fy}, cx_{cx}, cy_{cy}, distortion_{distortion}
+	{
+		if (!(fx > 0 && fy > 0)) throw std::invalid_argument("focal lengths must be positive, got " + std::to_string(fx) + " and " + std::to_string(fy));
+	}
+
+	/// Construct a camera from a camera matrix such as the K matrix of sensor_msgs/CameraInfo.
+	/**
+	 * \throws std::invalid_argument if a focal length is not positive.
+	 */
+	explicit PinholeCamera(Matrix3 const & camera_matrix, Distortion const & distortion = {}) :
+		PinholeCamera(camera_matrix(0, 0), camera_matrix(1, 1), camera_matrix(0, 2), camera_matrix(1, 2), distortion) {}
+
+	Scalar fx() const { return fx_; } ///< Get the horizontal focal length in pixels.
+	Scalar fy() const { return fy_; } ///< Get the vertical focal length in pixels.
+	Scalar cx() const { return cx_; } ///< Get the horizontal coordinate of the principal point.
+	Scalar cy() const { return cy_; } ///< Get the vertical coordinate of the principal point.
+
+	/// Get the lens distortion.
+	Distortion const & distortion() const { return distortion_; }
+
+	/// Get the camera matrix.
+	Matrix3 matrix() const {
+		Matrix3 result;
+		result << fx_, 0, cx_, 0, fy_, cy_, 0, 0, 1;
+		return result;
+	}
+
+	/// Project a point in the camera frame to pixel coordinates.
+	/**
+	 * Points that are not in front of the camera give NaN coordinates.
+	 */
+	Vector2 project(Vector3 const & point) const {
+		if (!(point.z() > 0)) return Vector2::Constant(std::numeric_limits<Scalar>::quiet_NaN());
+		Eigen::Array<Scalar, 1, 1> x{point.x() / point.z()};
+		Eigen::Array<Scalar, 1, 1> y{point.y() / point.z()};
+		if (!distortion_.isZero()) distortion_.distort(x, y);
+		return Vector2{fx_ * x(0) + cx_, fy_ * y(0) + cy_};
+	}
+
+	/// Get the undistorted normalized coordinates of a pixel, which is the point on the ray through the pixel with Z = 1.
+	Vector3 ray(Vector2 const & pixel) const {
+		Eigen::Array<Scalar, 1, 1> x{(pixel.x() - cx_) / fx_};
+		Eigen::Array<Scalar, 1, 1> y{(pixel.y() - cy_) / fy_};
+		if (!distortion_.isZero()) distortion_.undistort(x, y);
+		return Vector3{x(0), y(0), 1};
+	}
+
+	/// Back-project a pixel with a depth along the Z axis to a point in the camera frame.
+	Vector3 unproject(Vector2 const & pixel, Scalar depth) const {
+		return ray(pixel) * depth;
+	}
+
+	/// Transform and project a set of points to pixel coordinates in parallel.
+	/**
+	 * Points that are not in front of the camera give NaN coordinates.
+	 */
+	void project(
+		Matrix3X const & points,                ///< The points, one per column.
+		Isometry3 const & camera_from_points,   ///< The transform from the frame of the points to the camera frame.
+		Matrix2X & pixels,                      ///< The pixel coordinates, one per column.
+		unsigned int threads = 0                ///< Number of threads, zero to use defaultThreadCount().
+	) const {
+		pixels.resize(2, points.cols());
+		parallelFor(points.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			// The scratch buffers are allocated once per chunk.
+			Eigen::Matrix<Scalar, Eigen::Dynamic, 3> camera(block_size, 3);
+			Eigen::Matrix<Scalar, Eigen::Dynamic, 2> image(block_size, 2);
+			Eigen::Array<Scalar, Eigen::Dynamic, 1> x(block_size);
+			Eigen::Array<Scalar, Eigen::Dynamic, 1> y(block_size);
+			for (std::size_t block = begin; block < end; block += block_size) {
+				Eigen::Index count = std::min(end - block, block_size);
+				camera.topRows(count) = points.middleCols(block, count).transpose().lazyProduct(camera_from_points.linear().transpose());
+				camera.topRows(count).rowwise() += camera_from_points.translation().transpose();
+
+				auto z = camera.col(2).head(count).array();
+				Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+				x.head(count) = (z > 0).select(camera.col(0).head(count).array() / z, nan);
+				y.head(count) = (z > 0).select(camera.col(1).head(count).array() / z, nan);
+				if (!distortion_.isZero()) distortion_.distort(x.head(count), y.head(count));
+				image.col(0).head(count) = (fx_ * x.head(count) + cx_).matrix();
+				image.col(1).head(count) = (fy_ * y.head(count) + cy_).matrix();
+				pixels.middleCols(block, count) = image.topRows(count).transpose();
+			}
+		}, threads, 4 * block_size);
+	}
+
+	/// Back-project a set of pixels with depths and transform them in parallel.
+	/**
+	 * \throws std::invalid_argument if the number of depths does not match the number of pixels.
+	 */
+	void unproject(
+		Matrix2X const & pixels,                ///< The pixel coordinates, one per column.
+		VectorX const & depths,                 ///< The depth of every pixel along the Z axis of the camera.
+		Isometry3 const & target_from_camera,   ///< The transform from the camera frame to the frame of the resulting points.
+		Matrix3X & points,                      ///< The points, one per column.
+		unsigned int threads = 0                ///< Number of threads, zero to use defaultThreadCount().
+	) const {
+		if (depths.size() != pixels.cols()) throw std::invalid_argument("got " + std::to_string(depths.size()) + " depths for " + std::to_string(pixels.cols()) + " pixels");
+		points.resize(3, pixels.cols());
+		parallelFor(pixels.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			// The scratch buffers are allocated once per chunk.
+			Eigen::Matrix<Scalar, Eigen::Dynamic, 2> image(block_size, 2);
+			Eigen::Matrix<Scalar, Eigen::Dynamic, 3> camera(block_size, 3);
+			Eigen::Array<Scalar, Eigen::Dynamic, 1> x(block_size);
+			Eigen::Array<Scalar, Eigen::Dynamic, 1> y(block_size);
+			for (std::size_t block = begin; block < end; block += block_size) {
+				Eigen::Index count = std::min(end - block, block_size);
+				image.topRows(count) = pixels.middleCols(block, count).transpose();
+				x.head(count) = (image.col(0).head(count).array() - cx_) / fx_;
+				y.head(count) = (image.col(1).head(count).array() - cy_) / fy_;
+				if (!distortion_.isZero()) distortion_.undistort(x.head(count), y.head(count));
+
+				auto depth = depths.segment(block, count).array();
+				camera.col(0).head(count) = (x.head(count) * depth).matrix();
+				camera.col(1).head(count) = (y.head(count) * depth).matrix();
+				camera.col(2).head(count) = depth.matrix();
+				points.middleCols(block, count) = target_from_camera.linear().lazyProduct(camera.topRows(count).transpose());
+				points.middleCols(block, count).colwise() += target_from_camera.translation();
+			}
+		}, threads, 4 * block_size);
+	}
+
+private:
+	/// Number of points processed at once by the batched functions.
+	static constexpr std::size_t block_size = 256;
+
+	Scalar fx_;
+	Scalar fy_;
+	Scalar cx_;
+	Scalar cy_;
+	Distortion distortion_;
+};
+
+template<typename Scalar>
+constexpr std::size_t PinholeCamera<Scalar>::block_size;
+
+/// Options for converting depth images to point clouds.
+struct DepthCloudOptions {
+	/// Factor to convert depth values to the unit of the points, for example 0.001 for depth images in millimeters.
+	double depth_scale = 1;
+
+	/// Keep one column per pixel in row-major order, with NaN for pixels without valid depth.
+	/**
+	 * Otherwise only the pixels with valid depth are converted, still in row-major order.
+	 */
+	bool organized = false;
+
+	/// Number of threads, zero to use defaultThreadCount().
+	unsigned int threads = 0;
+};
+
+/// Converts depth images of a fixed size to point clouds.
+/**
+ * The undistorted ray of every pixel is computed once on construction,
+ * so converting a frame costs a multiplication by the depth and the transform to the target frame, regardless of the distortion.
+ * For cameras without distortion the rays are separable, and only one coordinate per column and one per row is stored.
+ *
+ * Depths are taken along the Z axis of the camera.
+ * A depth is valid if it is finite and positive, so both zero and NaN mark missing measurements.
+ */
+template<typename Scalar>
+class DepthCloudConverter {
+public:
+	using Matrix3X  = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+	using Isometry3 = Eigen::Transform<Scalar, 3, Eigen::Isometry>;
+	using Array     = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+	/// Construct a converter for images of a camera with the given size.
+	DepthCloudConverter(PinholeCamera<Scalar> const & camera, Eigen::Index width, Eigen::Index height) : width_{width}, height_{height} {
+		if (width < 0 || height < 0) throw std::invalid_argument("image size must not be negative, got " + std::to_string(width) + "x" + std::to_string(height));
+		separable_ = camera.distortion().isZero();
+		if (separable_) {
+			x_ = (Array::LinSpaced(width, 0, Scalar(width - 1)) - camera.cx()) / camera.fx();
+			y_ = (Array::LinSpaced(height, 0, Scalar(height - 1)) - camera.cy()) / camera.fy();
+			return;
+		}
+
+		x_.resize(width * height);
+		y_.resize(width * height);
+		for (Eigen::Index row = 0; row < height; ++row) {
+			x_.segment(row * width, width) = (Array::LinSpaced(width, 0, Scalar(width - 1)) - camera.cx()) / camera.fx();
+			y_.segment(row * width, width).setConstant((row - camera.cy()) / camera.fy());
+		}
+		camera.distortion().undistort(x_, y_);
+	}
+
+	Eigen::Index width()  const { return width_;  } ///< Get the width of the images.
+	Eigen::Index height() const { return height_; } ///< Get the height of the images.
+
+	/// Convert a depth image to a point cloud in parallel.
+	/**
+	 * The depth image is any Eigen expression with one row per image row, such as an Eigen::Map over the data of an image message.
+	 *
+	 * \throws std::invalid_argument if the size of the image does not match the converter.
+	 */
+	template<typename Derived>
+	void convert(
+		Eigen::DenseBase<Derived> const & depth, ///< The depth image.
+		Isometry3 const & target_from_camera,    ///< The transform from the camera frame to the frame of the resulting points.
+		Matrix3X & points,                       ///< The points, one per column.
+		DepthCloudOptions const & options = {}   ///< The conversion options.
+	) const {
+		if (depth.cols() != width_ || depth.rows() != height_) {
+			throw std::invalid_argument("depth image is " + std::to_string(depth.cols()) + "x" + std::to_string(depth.rows()) + ", expected " + std::to_string(width_) + "x" + std::to_string(height_));
+		}
+
+		// Determine the first output column of every chunk of rows.
+		std::size_t chunks = parallelChunks(height_, options.threads, min_rows);
+		std::vector<Eigen::Index> offsets(chunks + 1, 0);
+		if (options.organized) {
+			for (std::size_t chunk = 0; chunk <= chunks; ++chunk) offsets[chunk] = width_ * Eigen::Index(height_ * chunk / chunks);
+		} else {
+			parallelFor(height_, [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+				Eigen::Index count = 0;
+				for (std::size_t row = begin; row < end; ++row) {
+					for (Eigen::Index col = 0; col < width_; ++col) count += valid(depth(row, col));
+				}
+				offsets[chunk + 1] = count;
+			}, options.threads, min_rows);
+			for (std::size_t chunk = 0; chunk < chunks; ++chunk) offsets[chunk + 1] += offsets[chunk];
+		}
+		points.resize(3, offsets[chunks]);
+
+		Scalar scale = options.depth_scale;
+		parallelFor(height_, [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			Eigen::Matrix<Scalar, Eigen::Dynamic, 3> camera(width_, 3);
+			Eigen::Index output = offsets[chunk];
+			for (std::size_t row = begin; row < end; ++row) {
+				// Back-project the row into a contiguous block, then transform the whole block at once.
+				Eigen::Index count = 0;
+				for (Eigen::Index col = 0; col < width_; ++col) {
+					Scalar value = scale * Scalar(depth(row, col));
+					bool is_valid = valid(depth(row, col));
+					if (!is_valid && !options.organized) continue;
+					if (!is_valid) value = std::numeric_limits<Scalar>::quiet_NaN();
+					Eigen::Index index = separable_ ? col : row * width_ + col;
+					camera(count, 0) = x_(index) * value;
+					camera(count, 1) = (separable_ ? y_(row) : y_(index)) * value;
+					camera(count, 2) = value;
+					++count;
+				}
+				points.middleCols(output, count) = target_from_camera.linear().lazyProduct(camera.topRows(count).transpose());
+				points.middleCols(output, count).colwise() += target_from_camera.translation();
+				output += count;
+			}
+		}, options.threads, min_rows);
+	}
+
+private:
+	/// Minimum number of rows per thread.
+	static constexpr std::size_t min_rows = 16;
+
+	/// Check if a depth value is a valid measurement.
+	template<typename Depth>
+	static bool valid(Depth depth) {
+		return depth > 0 && std::isfinite(double(depth));
+	}
+
+	Eigen::Index width_;
+	Eigen::Index height_;
+
+	/// True if the rays are stored per column and per row instead of per pixel.
+	bool separable_;
+
+	/// The X coordinate of the ray through every column, or every pixel in row-major order if the rays are not separable.
+	Array x_;
+
+	/// The Y coordinate of the ray through every row, or every pixel in row-major order if the rays are not separable.
+	Array y_;
+};
+
+}
@@ -0,0 +1,252 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "parallel.hpp"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+/// Relation between an aligned box and a convex region.
+enum class RegionIntersection {
+	/// The box is completely outside the region.
+	outside,
+
+	/// The box may intersect the boundary of the region.
+	/**
+	 * This is a conservative answer: boxes near the edges or corners of the region may be reported as intersecting while being outside.
+	 */
+	intersecting,
+
+	/// The box is completely inside the region.
+	inside,
+};
+
+/// Convex region defined as the intersection of half spaces.
+/**
+ * Every plane bounds the region with its normal pointing outwards:
+ * a point is inside the region if its signed distance to every plane is zero or less.
+ * A region without planes contains all of space.
+ *
+ * The planes are stored as structure of arrays: one column per normal component and a column of offsets.
+ * Checking a point against all planes is a small matrix-vector product,
+ * and a whole cloud is checked in blocks of points against one plane at a time.
+ */
+template<typename Scalar>
+class ConvexRegion {
+public:
+	using Vector3     = Eigen::Matrix<Scalar, 3, 1>;
+	using Matrix3X    = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+	using Plane       = Eigen::Hyperplane<Scalar, 3>;
+	using AlignedBox3 = Eigen::AlignedBox<Scalar, 3>;
+	using Isometry3   = Eigen::Transform<Scalar, 3, Eigen::Isometry>;
+
+	/// Construct a region without planes, containing all of space.
+	ConvexRegion() = default;
+
+	/// Construct a region from planes with outward pointing normals.
+	explicit ConvexRegion(std::vector<Plane> const & planes) {
+		normals_.resize(planes.size(), 3);
+		offsets_.resize(planes.size());
+		for (std::size_t i = 0; i < planes.size(); ++i) {
+			normals_.row(i) = planes[i].normal().transpose();
+			offsets_(i)     = planes[i].offset();
+		}
+	}
+
+	/// Construct a region from an aligned box, optionally placed with a pose to get an oriented box.
+	static ConvexRegion fromBox(AlignedBox3 const & box, Isometry3 const & pose = Isometry3::Identity()) {
+		std::vector<Plane> planes;
+		for (int axis = 0; axis < 3; ++axis) {
+			Vector3 normal = pose.linear().col(axis);
+			planes.push_back(Plane( normal, pose * box.max()));
+			planes.push_back(Plane(-normal, pose * box.min()));
+		}
+		return ConvexRegion(planes);
+	}
+
+	/// Construct a region from a camera view frustum.
+	/**
+	 * The camera looks along its Z axis, with the X axis to the right and the Y axis down in the image.
+	 *
+	 * \throws std::invalid_argument if a field of view is not in (0, pi) or the clipping distances are invalid.
+	 */
+	static ConvexRegion fromFrustum(
+		Isometry3 const & camera_pose, ///< The pose of the camera.
+		Scalar horizontal_fov,         ///< The full horizontal field of view in radians.
+		Scalar vertical_fov,           ///< The full vertical field of view in radians.
+		Scalar near,                   ///< The distance of the near clipping plane along the Z axis.
+		Scalar far                     ///< The distance of the far clipping plane along the Z axis.
+	) {
+		// Pi, as M_PI is not part of standard C++.
+		double const half_turn = 3.14159265358979323846;
+		if (!(horizontal_fov > 0 && horizontal_fov < half_turn)) throw std::invalid_argument("horizontal field of view must be in (0, pi), got " + std::to_string(horizontal_fov));
+		if (!(vertical_fov > 0 && vertical_fov < half_turn)) throw std::invalid_argument("vertical field of view must be in (0, pi), got " + std::to_string(vertical_fov));
+		if (!(near >= 0 && far > near)) throw std::invalid_argument("invalid clipping distances: near " + std::to_string(near) + ", far " + std::to_string(far));
+
+		Scalar h_cos = std::cos(horizontal_fov / 2);
+		Scalar h_sin = std::sin(horizontal_fov / 2);
+		Scalar v_cos = std::cos(vertical_fov / 2);
+		Scalar v_sin = std::sin(vertical_fov / 2);
+		std::vector<Plane> planes = {
+			Plane(Vector3( h_cos,  0,     -h_sin), 0),
+			Plane(Vector3(-h_cos,  0,     -h_sin), 0),
+			Plane(Vector3( 0,      v_cos, -v_sin), 0),
+			Plane(Vector3( 0,     -v_cos, -v_sin), 0),
+			Plane(Vector3( 0,      0,     -1),     near),
+			Plane(Vector3( 0,      0,      1),     -far),
+		};
+		return ConvexRegion(planes).transformed(camera_pose);
+	}
+
+	/// Add a plane with an outward pointing normal.
+	void addPlane(Plane const & plane) {
+		Eigen::Index index = size();
+		normals_.conservativeResize(index + 1, 3);
+		offsets_.conservativeResize(index + 1);
+		normals_.row(index) = plane.normal().transpose();
+		offsets_(index)     = plane.offset();
+	}
+
+	/// Get the number of planes.
+	Eigen::Index size() const { return offsets_.size(); }
+
+	/// Get a plane.
+	Plane plane(Eigen::Index index) const {
+		return Plane(normals_.row(index).transpose(), offsets_(index));
+	}
+
+	/// Get the region transformed by an isometry.
+	ConvexRegion transformed(Isometry3 const & transform) const {
+		ConvexRegion result;
+		result.normals_ = normals_ * transform.linear().transpose();
+		result.offsets_ = offsets_ - result.normals_ * transform.translation();
+		return result;
+	}
+
+	/// Get the largest signed distance of a point to the planes.
+	/**
+	 * The result is zero or less for points inside the region.
+	 * Inside the region, its negation is the distance to the boundary.
+	 * Outside the region, it is a lower bound of the distance to the region.
+	 */
+	Scalar signedDistance(Vector3 const & point) const {
+		if (size() == 0) return -std::numeric_limits<Scalar>::infinity();
+		return (normals_.lazyProduct(point) + offsets_).maxCoeff();
+	}
+
+	/// Check if a point is inside the region.
+	bool contains(Vector3 const & point) const {
+		return size() == 0 || (normals_.lazyProduct(point) + offsets_).maxCoeff() <= 0;
+	}
+
+	/// Check for every column of a matrix if the point is inside the region, in parallel.
+	/**
+	 * The points are processed in blocks that are checked against one plane at a time,
+	 * so the inner loop runs over contiguous coordinates and vectorizes.
+	 */
+	void contains(Matrix3X const & points, Eigen::Array<bool, Eigen::Dynamic, 1> & result, unsigned int threads = 0) const {
+		result.resize(points.cols());
+		if (size() == 0) {
+			result.setConstant(true);
+			return;
+		}
+		parallelFor(points.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			// Transpose every block so each coordinate is contiguous, then accumulate the largest distance plane by plane.
+			Eigen::Matrix<Scalar, Eigen::Dynamic, 3> block_points(block_size, 3);
+			Eigen::Array<Scalar, Eigen::Dynamic, 1> maximum(block_size);
+			for (std::size_t block = begin; block < end; block += block_size) {
+				Eigen::Index count = std::min(end - block, block_size);
+				block_points.topRows(count) = points.middleCols(block, count).transpose();
+				auto x = block_points.col(0).head(count).array();
+				auto y = block_points.col(1).head(count).array();
+				auto z = block_points.col(2).head(count).array();
+				maximum.head(count) = normals_(0, 0) * x + normals_(0, 1) * y + normals_(0, 2) * z + offsets_(0);
+				for (Eigen::Index i = 1; i < size(); ++i) {
+					maximum.head(count) = maximum.head(count).max(normals_(i, 0) * x + normals_(i, 1) * y + normals_(i, 2) * z + offsets_(i));
+				}
+				result.segment(block, count) = maximum.head(count) <= 0;
+			}
+		}, threads, 4 * block_size);
+	}
+
+	/// Get the points inside the region, one per column, in their original order.
+	Matrix3X crop(Matrix3X const & points, unsigned int threads = 0) const {
+		Eigen::Array<bool, Eigen::Dynamic, 1> inside;
+		contains(points, inside, threads);
+		Matrix3X result(3, inside.count());
+		Eigen::Index index = 0;
+		for (Eigen::Index i = 0; i < points.cols(); ++i) {
+			if (inside(i)) result.col(index++) = points.col(i);
+		}
+		return result;
+	}
+
+	/// Clip a line segment to the region.
+	/**
+	 * On success, the end points are moved to the part of the segment inside the region.
+	 *
+	 * \return False if the segment is completely outside the region, in which case the end points are not modified.
+	 */
+	bool clip(Vector3 & start, Vector3 & end) const {
+		Vector3 direction = end - start;
+		Eigen::Matrix<Scalar, Eigen::Dynamic, 1> distances = normals_ * start + offsets_;
+		Eigen::Matrix<Scalar, Eigen::Dynamic, 1> rates     = normals_ * direction;
+
+		Scalar enter = 0;
+		Scalar leave = 1;
+		for (Eigen::Index i = 0; i < size(); ++i) {
+			if (rates(i) == 0) {
+				if (distances(i) > 0) return false;
+				continue;
+			}
+			Scalar t = -distances(i) / rates(i);
+			if (rates(i) > 0) leave = std::min(leave, t);
+			else              enter = std::max(enter, t);
+			if (enter > leave) return false;
+		}
+
+		Vector3 origin = start;
+		start = origin + enter * direction;
+		end   = origin + leave * direction;
+		return true;
+	}
+
+	/// Determine if an aligned box is inside, outside or intersecting the region.
+	/**
+	 * The box is tested against every plane with its center and half extent, vectorized over the planes.
+	 */
+	RegionIntersection intersects(AlignedBox3 const & box) const {
+		if (size() == 0) return RegionIntersection::inside;
+		Vector3 center = box.center();
+		Vector3 extent = box.sizes() / 2;
+		auto distances = (normals_.lazyProduct(center) + offsets_).array();
+		auto radii     = normals_.cwiseAbs().lazyProduct(extent).array();
+		if ((distances - radii).maxCoeff() > 0) return RegionIntersection::outside;
+		if ((distances + radii).maxCoeff() <= 0) return RegionIntersection::inside;
+		return RegionIntersection::intersecting;
+	}
+
+private:
+	/// Number of points processed with one matrix product when checking clouds.
+	static constexpr std::size_t block_size = 256;
+
+	/// The outward pointing normals of the planes, one per row, stored column-major so every component is contiguous.
+	Eigen::Matrix<Scalar, Eigen::Dynamic, 3> normals_;
+
+	/// The offsets of the planes.
+	Eigen::Matrix<Scalar, Eigen::Dynamic, 1> offsets_;
+};
+
+template<typename Scalar>
+constexpr std::size_t ConvexRegion<Scalar>::block_size;
+
+}
@@ -0,0 +1,239 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "parallel.hpp"
+#include "voxel_hash.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dr {
+
+/// Options for voxel grid downsampling.
+struct VoxelDownsampleOptions {
+	/// Compute the normal of every voxel from the covariance of its points.
+	bool normals = false;
+
+	/// Compute the covariance of the points in every voxel.
+	bool covariances = false;
+
+	/// Drop voxels with less points than this.
+	std::size_t min_points = 1;
+
+	/// Number of threads, zero to use defaultThreadCount().
+	unsigned int threads = 0;
+};
+
+/// Point cloud with one point per occupied voxel.
+template<typename Scalar>
+struct VoxelCloud {
+	using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+
+	/// The centroid of the points in every voxel, one per column.
+	Eigen::Matrix<Scalar, 3, Eigen::Dynamic> points;
+
+	/// The normal of every voxel, one per column, if requested.
+	/**
+	 * The normal is the eigenvector of the smallest eigenvalue of the covariance, with arbitrary sign.
+	 * Voxels with less than three points get a zero normal.
+	 */
+	Eigen::Matrix<Scalar, 3, Eigen::Dynamic> normals;
+
+	/// The sample covariance of the points in every voxel, if requested. Zero for voxels with a single point.
+	std::vector<Matrix3, Eigen::aligned_allocator<Matrix3>> covariances;
+
+	/// The number of points in every voxel.
+	std::vector<std::uint32_t> counts;
+};
+
+/// Voxel grid downsampling that replaces the points in every voxel by their centroid.
+/**
+ * This computes what averagePositions() does for every voxel, in a single pass over the points.
+ * Every thread accumulates a contiguous chunk of the points in its own hash table.
+ * The tables are merged at the end, in chunk order, so the order of the voxels does not depend on the number of threads:
+ * voxels are ordered by the first point that falls in them.
+ * The sums of every chunk are added together, so centroids and covariances can differ in the last bits with a different number of threads.
+ *
+ * Points are accumulated relative to the corner of their voxel, which keeps the covariances accurate far from the origin.
+ *
+ * Points with a non-finite coordinate, like the invalid pixels of an organized cloud, are skipped.
+ * Voxel coordinates are limited to 21 bits per axis, so the points must lie within 2^20 voxels of the origin on every axis.
+ *
+ * All buffers are kept between calls, so downsampling frames of similar size reuses the memory of the previous frame.
+ * A single instance must not be used to downsample multiple clouds concurrently.
+ */
+template<typename Scalar>
+class VoxelDownsampler {
+public:
+	using Vector3  = Eigen::Matrix<Scalar, 3, 1>;
+	using Matrix3  = Eigen::Matrix<Scalar, 3, 3>;
+	using Matrix3X = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+
+	/// Downsample a point cloud.
+	/**
+	 * \throws std::invalid_argument if the voxel size is not positive.
+	 * \throws std::out_of_range if a point lies 2^20 voxels or more from the origin on any axis.
+	 */
+	void downsample(
+		Matrix3X const & points,                   ///< The points, one per column.
+		Scalar voxel_size,                         ///< The edge length of the voxels.
+		VoxelCloud<Scalar> & result,               ///< The downsampled cloud. Its storage is reused.
+		VoxelDownsampleOptions const & options = {} ///< The downsampling options.
+	) {
+		if (!(voxel_size > 0)) throw std::invalid_argument("voxel size must be positive, got " + std::to_string(voxel_size));
+		if (points.cols() > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("too many points to downsample: " + std::to_string(points.cols()));
+		bool second_moments = options.normals || options.covariances;
+		Scalar inverse_voxel_size = 1 / voxel_size;
+
+		// The voxel coordinates that fit in the 21 bits per axis of a voxel key.
+		Scalar const voxel_limit = Scalar(1 << 20);
+
+		// Accumulate every chunk in its own table.
+		std::size_t count = points.cols();
+		std::size_t chunks = parallelChunks(count, options.threads, 4096);
+		if (chunks_.size() < chunks) chunks_.resize(chunks);
+		parallelFor(count, [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			Chunk & accumulator = chunks_[chunk];
+			accumulator.table.reset(chunk == 0 ? count : end - begin);
+			accumulator.voxels.clear();
+			accumulator.outer.clear();
+			for (std::size_t i = begin; i < end; ++i) {
+				Vector3 scaled = (points.col(i) * inverse_voxel_size).array().floor().matrix();
+				if (!scaled.allFinite()) continue;
+				if ((scaled.array() < -voxel_limit).any() || (scaled.array() >= voxel_limit).any()) {
+					throw std::out_of_range("point " + std::to_string(i) + " is too far from the origin for a voxel size of " + std::to_string(voxel_size));
+				}
+				Eigen::Vector3i voxel = scaled.template cast<int>();
+				std::uint64_t key = detail::voxelKey(voxel);
+				detail::VoxelTable::Slot & slot = accumulator.table.probe(key);
+				if (slot.key == detail::VoxelTable::empty_key) {
+					slot = detail::VoxelTable::Slot{key, std::uint32_t(accumulator.voxels.size())};
+					accumulator.voxels.push_back(Voxel{key, voxel.template cast<Scalar>() * voxel_size, 0, Vector3::Zero()});
+					if (second_moments) accumulator.outer.push_back(Matrix3::Zero());
+				}
+				Voxel & target = accumulator.voxels[slot.value];
+				Vector3 local  = points.col(i) - target.origin;
+				++target.count;
+				target.sum += local;
+				if (second_moments) accumulator.outer[slot.value] += local * local.transpose();
+			}
+		}, options.threads, 4096);
+
+		// Merge the other tables into the first one, in chunk order.
+		Chunk & merged = chunks_[0];
+		for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+			Chunk const & other = chunks_[chunk];
+			for (std::size_t i = 0; i < other.voxels.size(); ++i) {
+				Voxel const & voxel = other.voxels[i];
+				detail::VoxelTable::Slot & slot = merged.table.probe(voxel.key);
+				if (slot.key == detail::VoxelTable::empty_key) {
+					slot = detail::VoxelTable::Slot{voxel.key, std::uint32_t(merged.voxels.size())};
+					merged.voxels.push_back(voxel);
+					if (second_moments) merged.outer.push_back(other.outer[i]);
+					continue;
+				}
+				Voxel & target = merged.voxels[slot.value];
+				target.count += voxel.count;
+				target.sum   += voxel.sum;
+				if (second_moments) merged.outer[slot.value] += other.outer[i];
+			}
+		}
+
+		// Select the voxels with enough points.
+		selected_.clear();
+		for (std::size_t i = 0; i < merged.voxels.size(); ++i) {
+			if (merged.voxels[i].count >= options.min_points) selected_.push_back(i);
+		}
+
+		std::size_t voxels = selected_.size();
+		result.points.resize(3, voxels);
+		result.normals.resize(3, options.normals ? voxels : 0);
+		result.covariances.resize(options.covariances ? voxels : 0);
+		result.counts.resize(voxels);
+		parallelFor(voxels, [&] (std::size_t begin, std::size_t end, std::size_t) {
+			for (std::size_t i = begin; i < end; ++i) {
+				std::size_t index   = selected_[i];
+				Voxel const & voxel = merged.voxels[index];
+				Vector3 mean = voxel.sum / Scalar(voxel.count);
+				result.points.col(i) = voxel.origin + mean;
+				result.counts[i]     = voxel.count;
+				if (!second_moments) continue;
+
+				Matrix3 covariance = Matrix3::Zero();
+				if (voxel.count > 1) covariance = (merged.outer[index] - voxel.count * mean * mean.transpose()) / Scalar(voxel.count - 1);
+				if (options.covariances) result.covariances[i] = covariance;
+				if (options.normals) {
+					if (voxel.count < 3) {
+						result.normals.col(i).setZero();
+					} else {
+						Eigen::SelfAdjointEigenSolver<Matrix3> solver;
+						solver.computeDirect(covariance);
+						result.normals.col(i) = solver.eigenvectors().col(0).normalized();
+					}
+				}
+			}
+		}, options.threads, 1024);
+	}
+
+private:
+	/// Accumulated points of a voxel, relative to the voxel corner.
+	struct Voxel {
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+		/// The key of the voxel.
+		std::uint64_t key;
+
+		/// The corner of the voxel with the smallest coordinates.
+		Vector3 origin;
+
+		/// The number of points.
+		std::uint32_t count;
+
+		/// The sum of the points relative to the origin.
+		Vector3 sum;
+	};
+
+	/// The hash table and voxels of one chunk.
+	struct Chunk {
+		detail::VoxelTable table;
+		std::vector<Voxel, Eigen::aligned_allocator<Voxel>> voxels;
+
+		/// The sum of the outer products of the points relative to the voxel origin, only filled if needed.
+		std::vector<Matrix3, Eigen::aligned_allocator<Matrix3>> outer;
+	};
+
+	/// Per-chunk accumulators. The first one also holds the merged result.
+	std::vector<Chunk> chunks_;
+
+	/// The indices of the voxels with enough points.
+	std::vector<std::size_t> selected_;
+};
+
+/// Downsample a point cloud by replacing the points in every voxel by their centroid.
+/**
+ * Use a VoxelDownsampler to reuse memory between frames, or to compute normals or covariances.
+ *
+ * \throws std::invalid_argument if the voxel size is not positive.
+ */
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, Eigen::Dynamic> voxelDownsample(
+	Eigen::Matrix<Scalar, 3, Eigen::Dynamic> const & points, ///< The points, one per column.
+	Scalar voxel_size,                                       ///< The edge length of the voxels.
+	unsigned int threads = 0                                 ///< Number of threads, zero to use defaultThreadCount().
+) {
+	VoxelDownsampler<Scalar> downsampler;
+	VoxelCloud<Scalar> result;
+	VoxelDownsampleOptions options;
+	options.threads = threads;
+	downsampler.downsample(points, voxel_size, result, options);
+	return std::move(result.points);
+}
+
+}
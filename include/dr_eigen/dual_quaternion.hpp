@@ -0,0 +1,243 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "eigen.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace dr {
+
+/// A rigid transformation represented as a unit dual quaternion.
+/**
+ * The real part holds the rotation and the dual part holds the translation,
+ * such that the dual part equals 0.5 * t * r, where t is the translation as pure quaternion.
+ */
+template<typename Scalar>
+class DualQuaternion {
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	using Quaternion = Eigen::Quaternion<Scalar>;
+	using Vector3    = Eigen::Matrix<Scalar, 3, 1>;
+	using Isometry3  = Eigen::Transform<Scalar, 3, Eigen::Isometry>;
+
+	/// Construct an identity transformation.
+	DualQuaternion() : real_(Quaternion::Identity()), dual_(0, 0, 0, 0) {}
+
+	/// Construct a dual quaternion from the raw real and dual parts.
+	DualQuaternion(Quaternion const & real, Quaternion const & dual) : real_(real), dual_(dual) {}
+
+	/// Construct a dual quaternion from a rotation and a translation.
+	DualQuaternion(Quaternion const & rotation, Vector3 const & translation) : real_(rotation) {
+		dual_ = Quaternion(0, translation.x(), translation.y(), translation.z()) * rotation;
+		dual_.coeffs() *= Scalar(0.5);
+	}
+
+	/// Construct a dual quaternion from an isometry.
+	explicit DualQuaternion(Isometry3 const & isometry) : DualQuaternion(Quaternion(isometry.rotation()), Vector3(isometry.translation())) {}
+
+	/// Get the identity transformation.
+	static DualQuaternion Identity() { return DualQuaternion(); }
+
+	/// Get the real part.
+	Quaternion const & real() const { return real_; }
+
+	/// Get the real part.
+	Quaternion & real() { return real_; }
+
+	/// Get the dual part.
+	Quaternion const & dual() const { return dual_; }
+
+	/// Get the dual part.
+	Quaternion & dual() { return dual_; }
+
+	/// Get the rotation.
+	Quaternion rotation() const { return real_; }
+
+	/// Get the translation.
+	Vector3 translation() const {
+		return Scalar(2) * (dual_ * real_.conjugate()).vec();
+	}
+
+	/// Convert to an isometry.
+	Isometry3 isometry() const {
+		return Eigen::Translation<Scalar, 3>(translation()) * real_;
+	}
+
+	/// Get the conjugate, which is the inverse for unit dual quaternions.
+	DualQuaternion conjugate() const {
+		return DualQuaternion(real_.conjugate(), dual_.conjugate());
+	}
+
+	/// Get the inverse of a unit dual quaternion.
+	DualQuaternion inverse() const {
+		return conjugate();
+	}
+
+	/// Get the normalized dual quaternion, which represents a proper rigid transformation.
+	DualQuaternion normalized() const {
+		Scalar norm = real_.norm();
+		Quaternion real(real_.coeffs() / norm);
+		Quaternion dual(dual_.coeffs() / norm);
+		// Remove the component of the dual part that is not orthogonal to the real part.
+		dual.coeffs() -= real.dot(dual) * real.coeffs();
+		return DualQuaternion(real, dual);
+	}
+
+	/// Compose two transformations.
+	DualQuaternion operator* (DualQuaternion const & other) const {
+		Quaternion dual_a = real_ * other.dual_;
+		Quaternion dual_b = dual_ * other.real_;
+		return DualQuaternion(real_ * other.real_, Quaternion(dual_a.coeffs() + dual_b.coeffs()));
+	}
+
+	/// Transform a point.
+	Vector3 operator* (Vector3 const & point) const {
+		return real_ * point + translation();
+	}
+
+	/// Check if two dual quaternions represent approximately the same transformation.
+	bool isApprox(DualQuaternion const & other, Scalar precision = Eigen::NumTraits<Scalar>::dummy_precision()) const {
+		Scalar sign = real_.dot(other.real_) < 0 ? -1 : 1;
+		return real_.coeffs().isApprox(sign * other.real_.coeffs(), precision)
+			&& (dual_.coeffs() - sign * other.dual_.coeffs()).norm() <= precision * std::max(Scalar(1), dual_.coeffs().norm());
+	}
+
+private:
+	Quaternion real_;
+	Quaternion dual_;
+};
+
+using DualQuaterniond = DualQuaternion<double>;
+using DualQuaternionf = DualQuaternion<float>;
+
+/// Convert a pose to a dual quaternion, dropping the frame information.
+inline DualQuaterniond toDualQuaternion(Pose const & pose) {
+	return DualQuaterniond(pose.isometry);
+}
+
+/// Convert a dual quaternion to a pose with the given frame information.
+inline Pose toPose(DualQuaterniond const & transform, PoseHeader const & header) {
+	return Pose{header, transform.isometry()};
+}
+
+/// Screw linear interpolation between two transformations.
+/**
+ * At factor 0, the first transformation is returned, at factor 1 the second.
+ * The interpolation follows the constant screw motion from the first to the second transformation.
+ */
+template<typename Scalar>
+DualQuaternion<Scalar> interpolateDualQuaternion(
+	DualQuaternion<Scalar> const & a, ///< The first transformation.
+	DualQuaternion<Scalar> const & b, ///< The second transformation.
+	Scalar factor                     ///< The interpolation factor.
+) {
+	using Quaternion = Eigen::Quaternion<Scalar>;
+	using Vector3    = Eigen::Matrix<Scalar, 3, 1>;
+
+	DualQuaternion<Scalar> difference = a.conjugate() * b;
+	// Take the shortest path.
+	if (difference.real().w() < 0) {
+		difference.real().coeffs() = -difference.real().coeffs();
+		difference.dual().coeffs() = -difference.dual().coeffs();
+	}
+
+	Scalar sine = difference.real().vec().norm();
+
+	// Nearly pure translation: the screw axis is undefined, so interpolate rotation and translation independently.
+	if (sine < Scalar(1e-6)) {
+		Quaternion rotation = Quaternion::Identity().slerp(factor, difference.real());
+		return a * DualQuaternion<Scalar>(rotation, Vector3(factor * difference.translation()));
+	}
+
+	// Screw parameters: rotation angle, axis direction, translation along the axis and the axis moment.
+	Scalar angle     = 2 * std::atan2(sine, difference.real().w());
+	Vector3 axis     = difference.real().vec() / sine;
+	Scalar pitch     = -2 * difference.dual().w() / sine;
+	Vector3 moment   = (difference.dual().vec() - axis * (pitch * difference.real().w() / 2)) / sine;
+
+	Scalar half_angle = factor * angle / 2;
+	Scalar half_pitch = factor * pitch / 2;
+	Scalar s = std::sin(half_angle);
+	Scalar c = std::cos(half_angle);
+
+	Quaternion real;
+	real.w()   = c;
+	real.vec() = s * axis;
+	Quaternion dual;
+	dual.w()   = -half_pitch * s;
+	dual.vec() = s * moment + half_pitch * c * axis;
+
+	return a * DualQuaternion<Scalar>(real, dual);
+}
+
+/// Screw linear interpolation between two isometries.
+/**
+ * At factor 0, the first isometry is returned, at factor 1 the second.
+ * Unlike interpolateIsometry, the translation and rotation are interpolated together along a screw motion.
+ */
+inline Eigen::Isometry3d interpolateIsometryScrew(
+	Eigen::Isometry3d const & a, ///< The first isometry.
+	Eigen::Isometry3d const & b, ///< The second isometry.
+	double factor                ///< The interpolation factor.
+) {
+	return interpolateDualQuaternion(DualQuaterniond(a), DualQuaterniond(b), factor).isometry();
+}
+
+/// Blend a weighted set of transformations with dual quaternion linear blending.
+/**
+ * Every element of the range is converted to a dual quaternion with DualQuaternion<DataType>(*it),
+ * so the range may hold dual quaternions or isometries.
+ * All transformations are accumulated in a single pass.
+ * The weights do not need to be normalized.
+ */
+template<typename DataType, typename ForwardIterator, typename WeightIterator>
+DualQuaternion<DataType> blendDualQuaternions(ForwardIterator const & begin, ForwardIterator const & end, WeightIterator weight) {
+	if (begin == end) {
+		throw std::logic_error("Cannot blend transformations over an empty range.");
+	}
+
+	Eigen::Matrix<DataType, 4, 1> real = Eigen::Matrix<DataType, 4, 1>::Zero();
+	Eigen::Matrix<DataType, 4, 1> dual = Eigen::Matrix<DataType, 4, 1>::Zero();
+	Eigen::Matrix<DataType, 4, 1> pivot = DualQuaternion<DataType>(*begin).real().coeffs();
+
+	for (ForwardIterator it = begin; it != end; ++it, ++weight) {
+		DualQuaternion<DataType> transform(*it);
+
+		// Flip to the hemisphere of the first element, since q and -q represent the same rotation.
+		DataType w = pivot.dot(transform.real().coeffs()) < 0 ? -DataType(*weight) : DataType(*weight);
+		real += w * transform.real().coeffs();
+		dual += w * transform.dual().coeffs();
+	}
+
+	if (real.norm() == 0) {
+		throw std::logic_error("Cannot blend transformations with a total weight of zero.");
+	}
+
+	return DualQuaternion<DataType>(Eigen::Quaternion<DataType>(real), Eigen::Quaternion<DataType>(dual)).normalized();
+}
+
+/// Blend a set of transformations with equal weights using dual quaternion linear blending.
+template<typename DataType, typename Container>
+DualQuaternion<DataType> blendDualQuaternions(Container const & container) {
+	struct UnitWeight {
+		DataType operator* () const { return 1; }
+		UnitWeight & operator++ () { return *this; }
+	};
+	return blendDualQuaternions<DataType>(container.begin(), container.end(), UnitWeight{});
+}
+
+/// Blend a weighted set of transformations using dual quaternion linear blending.
+template<typename DataType, typename Container, typename Weights>
+DualQuaternion<DataType> blendDualQuaternions(Container const & container, Weights const & weights) {
+	if (container.size() != weights.size()) {
+		throw std::logic_error("Number of weights (" + std::to_string(weights.size()) + ") does not match number of transformations (" + std::to_string(container.size()) + ").");
+	}
+	return blendDualQuaternions<DataType>(container.begin(), container.end(), weights.begin());
+}
+
+}
@@ -0,0 +1,99 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "eigen.hpp"
+#include "robust_loss.hpp"
+
+#include <vector>
+
+namespace dr {
+
+/// Options for the hand-eye calibration solver.
+struct HandEyeOptions {
+	/// Maximum number of Gauss-Newton iterations for the nonlinear refinement, zero to only do the linear solve.
+	int max_iterations = 20;
+
+	/// Stop refining when the norm of the update step is below this value.
+	double tolerance = 1e-10;
+
+	/// The robust loss applied to the residual of every motion pair during refinement.
+	RobustLoss loss = RobustLoss::squared;
+
+	/// Residual norm at which the robust loss starts to down-weight a motion pair.
+	double loss_scale = 0.01;
+
+	/// Weight of the translational part of the residual relative to the rotational part (in radians).
+	double translation_weight = 1;
+
+	/// Number of threads used to evaluate the residuals, zero to use defaultThreadCount().
+	unsigned int threads = 0;
+};
+
+/// Result of a hand-eye calibration.
+struct HandEyeResult {
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	/// The refined solution X of AX = XB.
+	Eigen::Isometry3d transform;
+
+	/// The solution of the linear solve that initialized the refinement.
+	Eigen::Isometry3d initial;
+
+	/// The number of refinement iterations performed.
+	int iterations;
+
+	/// True if the refinement converged within the maximum number of iterations.
+	bool converged;
+
+	/// Root mean square of the rotational residuals of the motion pairs, in radians.
+	double rotation_error;
+
+	/// Root mean square of the translational residuals of the motion pairs.
+	double translation_error;
+};
+
+/// Solve the hand-eye calibration problem AX = XB for a set of motion pairs.
+/**
+ * The rotation is initialized with a linear quaternion solve and the translation with a linear least squares solve,
+ * both accumulated in fixed size normal equations.
+ * The solution is then refined with Gauss-Newton iterations on SE(3), optionally with a robust loss.
+ * The residuals of the motion pairs are evaluated in parallel.
+ *
+ * At least two motions with non-parallel rotation axes are needed for a unique solution.
+ *
+ * \throws std::invalid_argument if the number of motions differs or is less than two.
+ */
+HandEyeResult calibrateHandEye(
+	std::vector<Eigen::Isometry3d> const & a, ///< The motions A.
+	std::vector<Eigen::Isometry3d> const & b, ///< The motions B.
+	HandEyeOptions const & options = {}       ///< The solver options.
+);
+
+/// Motion pairs for the hand-eye calibration problem AX = XB.
+struct HandEyeMotions {
+	/// The relative motions of the robot flange.
+	std::vector<Eigen::Isometry3d> a;
+
+	/// The relative motions of the observed target in the camera frame.
+	std::vector<Eigen::Isometry3d> b;
+};
+
+/// Compute the motion pairs for an eye-in-hand calibration.
+/**
+ * For every pair of consecutive samples i and j, A = flange_j^-1 * flange_i and B = target_j * target_i^-1,
+ * so the solution X of AX = XB is the pose of the camera in the flange frame.
+ *
+ * \throws std::invalid_argument if the number of flange and target poses differs.
+ */
+HandEyeMotions handEyeMotions(
+	std::vector<Eigen::Isometry3d> const & flange_poses, ///< The poses of the robot flange in the robot base frame.
+	std::vector<Eigen::Isometry3d> const & target_poses  ///< The poses of the calibration target in the camera frame.
+);
+
+/// Compute the motion pairs for an eye-in-hand calibration.
+HandEyeMotions handEyeMotions(
+	std::vector<Pose> const & flange_poses, ///< The poses of the robot flange in the robot base frame.
+	std::vector<Pose> const & target_poses  ///< The poses of the calibration target in the camera frame.
+);
+
+}
@@ -0,0 +1,379 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "kd_tree.hpp"
+#include "lie.hpp"
+#include "parallel.hpp"
+#include "rigid_fit.hpp"
+#include "robust_loss.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+#include <Eigen/Eigenvalues>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+/// Error metric minimized by ICP.
+enum class IcpMetric {
+	/// Squared distance between corresponding points, minimized in closed form with a rigid fit.
+	point_to_point,
+
+	/// Squared distance from the source point to the tangent plane of the target point, minimized with a linearized least squares step.
+	point_to_plane,
+};
+
+/// Options for ICP.
+struct IcpOptions {
+	/// The error metric.
+	IcpMetric metric = IcpMetric::point_to_point;
+
+	/// Maximum number of iterations.
+	int max_iterations = 30;
+
+	/// Correspondences further apart than this distance are rejected.
+	double max_correspondence_distance = std::numeric_limits<double>::infinity();
+
+	/// Fraction of the correspondences to keep, rejecting the ones with the largest distance (trimmed ICP).
+	double trim_ratio = 1;
+
+	/// The robust loss applied to the residual of every correspondence.
+	RobustLoss loss = RobustLoss::squared;
+
+	/// Residual at which the robust loss starts to down-weight a correspondence.
+	double loss_scale = 0.01;
+
+	/// Stop when the translation of an update step is below this distance.
+	double translation_tolerance = 1e-6;
+
+	/// Stop when the rotation of an update step is below this angle in radians.
+	double rotation_tolerance = 1e-6;
+
+	/// Stop when the relative change of the RMS error between iterations is below this value.
+	double relative_error_tolerance = 1e-8;
+
+	/// Number of neighbours used to estimate target normals for point-to-plane ICP if none were given.
+	std::size_t normal_neighbors = 10;
+
+	/// Number of threads, zero to use defaultThreadCount().
+	unsigned int threads = 0;
+};
+
+/// Result of an ICP alignment.
+template<typename Scalar>
+struct IcpResult {
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	/// The transformation that maps the source cloud onto the target cloud.
+	Eigen::Transform<Scalar, 3, Eigen::Isometry> transform;
+
+	/// The number of iterations performed.
+	int iterations;
+
+	/// True if one of the convergence criteria was met within the maximum number of iterations.
+	bool converged;
+
+	/// Root mean square residual of the accepted correspondences of the last iteration.
+	Scalar rms_error;
+
+	/// The number of accepted correspondences of the last iteration.
+	std::size_t inliers;
+};
+
+/// Estimate the normal of every point from the covariance of its nearest neighbours.
+/**
+ * The normals have unit length, but their sign is arbitrary.
+ * Points with less than three neighbours get a zero normal.
+ */
+template<typename Scalar>
+void estimateNormals(
+	Eigen::Matrix<Scalar, 3, Eigen::Dynamic> const & points,  ///< The points, one per column.
+	KdTree<Scalar> const & tree,                              ///< A k-d tree built over the same points.
+	std::size_t neighbors,                                    ///< The number of neighbours to use, including the point itself.
+	Eigen::Matrix<Scalar, 3, Eigen::Dynamic> & normals,       ///< The output normals, one per column.
+	unsigned int threads = 0                                  ///< Number of threads, zero to use defaultThreadCount().
+) {
+	using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+	using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+	normals.resize(3, points.cols());
+	parallelFor(points.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		std::vector<Neighbor<Scalar>> found;
+		found.reserve(neighbors);
+		for (std::size_t i = begin; i < end; ++i) {
+			tree.knn(points.col(i), neighbors, found);
+			if (found.size() < 3) {
+				normals.col(i).setZero();
+				continue;
+			}
+			Vector3 mean = Vector3::Zero();
+			for (Neighbor<Scalar> const & neighbor : found) mean += points.col(neighbor.index);
+			mean /= found.size();
+			Matrix3 covariance = Matrix3::Zero();
+			for (Neighbor<Scalar> const & neighbor : found) {
+				Vector3 delta = points.col(neighbor.index) - mean;
+				covariance += delta * delta.transpose();
+			}
+			Eigen::SelfAdjointEigenSolver<Matrix3> solver;
+			solver.computeDirect(covariance);
+			normals.col(i) = solver.eigenvectors().col(0).normalized();
+		}
+	}, threads, 256);
+}
+
+/// Iterative closest point registration of source clouds against a fixed target cloud.
+/**
+ * The target cloud is indexed once with a KdTree, so many source clouds can be aligned against it.
+ * Every iteration searches the correspondences in parallel, rejects outliers by distance and trimming,
+ * applies a robust loss, and solves for the update in closed form.
+ *
+ * All buffers and worker threads are kept between calls, so aligning clouds of similar size does not allocate memory or start threads.
+ * A single instance must not be used to align multiple clouds concurrently.
+ */
+template<typename Scalar>
+class Icp {
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	using Vector3   = Eigen::Matrix<Scalar, 3, 1>;
+	using Vector6   = Eigen::Matrix<Scalar, 6, 1>;
+	using Matrix6   = Eigen::Matrix<Scalar, 6, 6>;
+	using Matrix3X  = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+	using Isometry3 = Eigen::Transform<Scalar, 3, Eigen::Isometry>;
+
+	/// Construct an ICP instance without target.
+	Icp() = default;
+
+	/// Construct an ICP instance with a target cloud.
+	explicit Icp(Matrix3X const & target, unsigned int threads = 0) {
+		setTarget(target, threads);
+	}
+
+	/// Set the target cloud and rebuild the neighbour index.
+	/**
+	 * Normals for point-to-plane ICP are estimated on the first alignment that needs them.
+	 */
+	void setTarget(Matrix3X const & target, unsigned int threads = 0) {
+		target_ = target;
+		tree_.build(target_, 16, threads);
+		normals_.resize(3, 0);
+	}
+
+	/// Set the target cloud with known normals and rebuild the neighbour index.
+	/**
+	 * \throws std::invalid_argument if the number of normals differs from the number of points.
+	 */
+	void setTarget(Matrix3X const & target, Matrix3X const & normals, unsigned int threads = 0) {
+		if (normals.cols() != target.cols()) throw std::invalid_argument("number of target normals (" + std::to_string(normals.cols()) + ") differs from number of target points (" + std::to_string(target.cols()) + ")");
+		setTarget(target, threads);
+		normals_ = normals;
+	}
+
+	/// Get the target cloud.
+	Matrix3X const & target() const { return target_; }
+
+	/// Get the neighbour index of the target cloud.
+	KdTree<Scalar> const & index() const { return tree_; }
+
+	/// Align a source cloud to the target cloud.
+	/**
+	 * \throws std::logic_error if no target cloud has been set.
+	 */
+	IcpResult<Scalar> align(Matrix3X const & source, Isometry3 const & initial, IcpOptions const & options = {}) {
+		if (tree_.size() == 0) throw std::logic_error("Cannot run ICP without target points.");
+		bool plane = options.metric == IcpMetric::point_to_plane;
+		if (plane && normals_.cols() != target_.cols()) estimateNormals(target_, tree_, options.normal_neighbors, normals_, options.threads);
+
+		unsigned int threads = options.threads == 0 ? defaultThreadCount() : options.threads;
+		if (!pool_ || pool_->threads() != threads) pool_.reset(new WorkerPool{threads});
+
+		std::size_t count  = source.cols();
+		std::size_t chunks = parallelChunks(count, threads);
+		matches_.resize(count);
+		distances_.resize(count);
+		point_chunks_.resize(chunks);
+		plane_chunks_.resize(chunks);
+
+		IcpResult<Scalar> result;
+		result.transform  = initial;
+		result.iterations = 0;
+		result.converged  = false;
+		result.rms_error  = 0;
+		result.inliers    = 0;
+
+		Scalar previous_error = std::numeric_limits<Scalar>::infinity();
+		while (result.iterations < options.max_iterations) {
+			findCorrespondences(source, result.transform);
+			Scalar threshold = rejectionThreshold(options);
+
+			Isometry3 step;
+			Scalar error = 0;
+			std::size_t inliers = 0;
+			if (plane) {
+				if (!solvePlane(source, result.transform, threshold, options, step, error, inliers)) break;
+			} else {
+				if (!solvePoint(source, result.transform, threshold, options, step, error, inliers)) break;
+			}
+
+			result.transform = step * result.transform;
+			result.rms_error = std::sqrt(error / inliers);
+			result.inliers   = inliers;
+			++result.iterations;
+
+			Scalar angle = Eigen::AngleAxis<Scalar>(step.linear()).angle();
+			bool small_step    = step.translation().norm() < options.translation_tolerance && angle < options.rotation_tolerance;
+			bool small_change  = std::abs(previous_error - result.rms_error) <= options.relative_error_tolerance * result.rms_error;
+			previous_error     = result.rms_error;
+			if (small_step || small_change) {
+				result.converged = true;
+				break;
+			}
+		}
+
+		return result;
+	}
+
+private:
+	/// Normal equations of the linearized point-to-plane problem.
+	struct PlaneSystem {
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+		Matrix6 hessian;
+		Vector6 gradient;
+		Scalar error;
+		std::size_t inliers;
+
+		void clear() {
+			hessian.setZero();
+			gradient.setZero();
+			error   = 0;
+			inliers = 0;
+		}
+	};
+
+	/// Accumulated point-to-point correspondences.
+	struct PointSystem {
+		RigidFitAccumulator<Scalar> fit;
+		Scalar error;
+	};
+
+	/// Find the nearest target point of every transformed source point.
+	void findCorrespondences(Matrix3X const & source, Isometry3 const & transform) {
+		pool_->parallelFor(source.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			for (std::size_t i = begin; i < end; ++i) {
+				Neighbor<Scalar> nearest = tree_.nearest(transform * source.col(i));
+				matches_[i]   = nearest.index;
+				distances_[i] = nearest.squared_distance;
+			}
+		});
+	}
+
+	/// Get the squared distance above which correspondences are rejected.
+	Scalar rejectionThreshold(IcpOptions const & options) {
+		Scalar threshold = Scalar(options.max_correspondence_distance * options.max_correspondence_distance);
+		if (options.trim_ratio < 1 && !distances_.empty()) {
+			std::size_t keep = std::max<std::size_t>(1, std::ceil(options.trim_ratio * distances_.size()));
+			sorted_.assign(distances_.begin(), distances_.end());
+			std::nth_element(sorted_.begin(), sorted_.begin() + keep - 1, sorted_.end());
+			threshold = std::min(threshold, sorted_[keep - 1]);
+		}
+		return threshold;
+	}
+
+	/// Solve a point-to-point step in closed form with a weighted rigid fit.
+	bool solvePoint(Matrix3X const & source, Isometry3 const & transform, Scalar threshold, IcpOptions const & options, Isometry3 & step, Scalar & error, std::size_t & inliers) {
+		pool_->parallelFor(source.cols(), [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			PointSystem & system = point_chunks_[chunk];
+			system.fit.clear();
+			system.error = 0;
+			for (std::size_t i = begin; i < end; ++i) {
+				if (!(distances_[i] <= threshold)) continue;
+				Scalar residual = std::sqrt(distances_[i]);
+				system.fit.add(transform * source.col(i), target_.col(matches_[i]), robustWeight(options.loss, Scalar(options.loss_scale), residual));
+				system.error += distances_[i];
+			}
+		});
+
+		for (std::size_t i = 1; i < point_chunks_.size(); ++i) {
+			point_chunks_[0].fit.merge(point_chunks_[i].fit);
+			point_chunks_[0].error += point_chunks_[i].error;
+		}
+		inliers = point_chunks_[0].fit.count();
+		if (inliers < 3) return false;
+		error = point_chunks_[0].error;
+		step  = point_chunks_[0].fit.solve();
+		return true;
+	}
+
+	/// Solve a point-to-plane step with the normal equations of the problem linearized around the current transform.
+	bool solvePlane(Matrix3X const & source, Isometry3 const & transform, Scalar threshold, IcpOptions const & options, Isometry3 & step, Scalar & error, std::size_t & inliers) {
+		pool_->parallelFor(source.cols(), [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			PlaneSystem & system = plane_chunks_[chunk];
+			system.clear();
+			for (std::size_t i = begin; i < end; ++i) {
+				if (!(distances_[i] <= threshold)) continue;
+				Vector3 point  = transform * source.col(i);
+				Vector3 normal = normals_.col(matches_[i]);
+				Scalar residual = normal.dot(point - target_.col(matches_[i]));
+
+				// Derivative to [translation; rotation] for a small rotation: n.(p + w x p + t - q).
+				Vector6 jacobian;
+				jacobian << normal, point.cross(normal);
+				Scalar weight = robustWeight(options.loss, Scalar(options.loss_scale), std::abs(residual));
+				system.hessian  += weight * jacobian * jacobian.transpose();
+				system.gradient += weight * residual * jacobian;
+				system.error    += residual * residual;
+				++system.inliers;
+			}
+		});
+
+		for (std::size_t i = 1; i < plane_chunks_.size(); ++i) {
+			plane_chunks_[0].hessian  += plane_chunks_[i].hessian;
+			plane_chunks_[0].gradient += plane_chunks_[i].gradient;
+			plane_chunks_[0].error    += plane_chunks_[i].error;
+			plane_chunks_[0].inliers  += plane_chunks_[i].inliers;
+		}
+		inliers = plane_chunks_[0].inliers;
+		if (inliers < 6) return false;
+		error = plane_chunks_[0].error;
+
+		Vector6 update = plane_chunks_[0].hessian.ldlt().solve(-plane_chunks_[0].gradient);
+		step = Eigen::Translation<Scalar, 3>{update.template head<3>()} * so3Exp<Scalar>(update.template tail<3>());
+		return true;
+	}
+
+	/// The target points.
+	Matrix3X target_;
+
+	/// The target normals, empty until needed for point-to-plane ICP.
+	Matrix3X normals_;
+
+	/// The neighbour index of the target points.
+	KdTree<Scalar> tree_;
+
+	/// The worker threads, started on the first alignment.
+	std::unique_ptr<WorkerPool> pool_;
+
+	/// Workspace: the index of the nearest target point of every source point.
+	std::vector<std::size_t> matches_;
+
+	/// Workspace: the squared distance to the nearest target point of every source point.
+	std::vector<Scalar> distances_;
+
+	/// Workspace: copy of the distances for trimming.
+	std::vector<Scalar> sorted_;
+
+	/// Workspace: per-thread point-to-point accumulators.
+	std::vector<PointSystem> point_chunks_;
+
+	/// Workspace: per-thread point-to-plane normal equations.
+	std::vector<PlaneSystem, Eigen::aligned_allocator<PlaneSystem>> plane_chunks_;
+};
+
+}
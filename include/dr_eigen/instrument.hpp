@@ -0,0 +1,235 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+/// A group of hot paths that is instrumented when DR_EIGEN_INSTRUMENT is defined.
+enum class InstrumentProbe : std::size_t {
+	average_quaternions,
+	average_positions,
+	average_isometries,
+	interpolate_rotation,
+	interpolate_isometry,
+	ros_to_eigen,
+	eigen_to_ros,
+	tf_to_eigen,
+	eigen_to_tf,
+	yaml_output,
+	xmlrpc_parse,
+};
+
+/// The number of instrumentation probes.
+constexpr std::size_t instrument_probe_count = 11;
+
+/// Get the name of a probe, as used in the JSON output.
+char const * instrumentProbeName(InstrumentProbe probe);
+
+/// The counters of one probe.
+struct InstrumentCounters {
+	/// The number of calls.
+	std::uint64_t calls = 0;
+
+	/// The number of elements processed, like the number of averaged rotations or converted poses.
+	std::uint64_t elements = 0;
+
+	/// The time spent in the calls, in nanoseconds. Zero for probes that only count calls.
+	std::uint64_t nanoseconds = 0;
+};
+
+/// The counters of all probes, indexed by probe.
+using InstrumentSnapshot = std::array<InstrumentCounters, instrument_probe_count>;
+
+/// Check if the library was compiled with instrumentation.
+/**
+ * Header-only functions, like averaging and the ROS conversions, are compiled as part of the code that uses them.
+ * Catkin packages that depend on dr_eigen get DR_EIGEN_INSTRUMENT defined whenever the library was built with it.
+ * Other code must define it exactly when the library was built with it, since the headers differ otherwise.
+ */
+bool instrumentationEnabled();
+
+/// Sum the counters of all threads, since the last resetInstrumentation().
+InstrumentSnapshot instrumentationSnapshot();
+
+/// Start counting from zero again.
+/**
+ * This does not modify the counters of other threads, it only stores the current totals as new baseline.
+ */
+void resetInstrumentation();
+
+/// Write a snapshot as JSON object, with an object holding calls, elements and nanoseconds for every probe.
+void writeInstrumentationJson(std::ostream & stream, InstrumentSnapshot const & snapshot);
+
+/// Get the current counters as JSON.
+std::string instrumentationJson();
+
+namespace detail {
+	/// The counters of one thread.
+	/**
+	 * Only the owning thread writes the counters, so updates need no atomic read-modify-write.
+	 * They are still atomic, so other threads can read them while they are updated.
+	 */
+	struct InstrumentThreadCounters {
+		std::array<std::array<std::atomic<std::uint64_t>, 3>, instrument_probe_count> counters{};
+
+		/// Probes with an active scope on the owning thread, so nested scopes of the same probe are not counted twice.
+		std::array<bool, instrument_probe_count> active{};
+
+		void add(InstrumentProbe probe, std::uint64_t elements, std::uint64_t nanoseconds) {
+			std::array<std::atomic<std::uint64_t>, 3> & counter = counters[std::size_t(probe)];
+			counter[0].store(counter[0].load(std::memory_order_relaxed) + 1,           std::memory_order_relaxed);
+			counter[1].store(counter[1].load(std::memory_order_relaxed) + elements,    std::memory_order_relaxed);
+			counter[2].store(counter[2].load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+		}
+	};
+
+	/// The counters of all threads that ever used instrumentation.
+	struct InstrumentRegistry {
+		std::mutex mutex;
+
+		/// The counters of all threads. A deque never moves its elements.
+		std::deque<InstrumentThreadCounters> threads;
+
+		/// Counters of finished threads, to be reused by new threads.
+		std::vector<InstrumentThreadCounters *> free;
+
+		/// The totals at the last reset.
+		InstrumentSnapshot baseline{};
+	};
+
+	/// Get the registry.
+	/**
+	 * The registry is defined in the header, so header-only code can be instrumented without linking the library.
+	 * It is never destroyed, since threads may still exit after static destruction.
+	 */
+	inline InstrumentRegistry & instrumentRegistry() {
+		static InstrumentRegistry * registry = new InstrumentRegistry;
+		return *registry;
+	}
+
+	/// Get the counters of the calling thread.
+	/**
+	 * The registry is only locked the first time a thread uses instrumentation, and when it exits.
+	 * Counters of finished threads are reused by new threads, keeping their counts.
+	 */
+	inline InstrumentThreadCounters & instrumentCounters() {
+		struct Handle {
+			InstrumentThreadCounters * counters;
+
+			Handle() {
+				InstrumentRegistry & registry = instrumentRegistry();
+				std::lock_guard<std::mutex> lock{registry.mutex};
+				if (registry.free.empty()) {
+					registry.threads.emplace_back();
+					counters = &registry.threads.back();
+				} else {
+					counters = registry.free.back();
+					registry.free.pop_back();
+				}
+			}
+
+			~Handle() {
+				InstrumentRegistry & registry = instrumentRegistry();
+				std::lock_guard<std::mutex> lock{registry.mutex};
+				registry.free.push_back(counters);
+			}
+		};
+		thread_local Handle handle;
+		return *handle.counters;
+	}
+}
+
+/// Count a call and the time until the end of the scope.
+/**
+ * A scope inside another scope of the same probe on the same thread is not counted,
+ * so functions that call other instrumented functions of the same probe count once.
+ *
+ * Use DR_EIGEN_INSTRUMENT_SCOPE instead of using this class directly,
+ * so the instrumentation disappears when DR_EIGEN_INSTRUMENT is not defined.
+ */
+class InstrumentScope {
+public:
+	InstrumentScope(InstrumentProbe probe, std::uint64_t elements) :
+		counters_{detail::instrumentCounters()},
+		probe_{probe},
+		elements_{elements},
+		nested_{counters_.active[std::size_t(probe)]}
+	{
+		if (nested_) return;
+		counters_.active[std::size_t(probe)] = true;
+		start_ = std::chrono::steady_clock::now();
+	}
+
+	InstrumentScope(InstrumentScope const &) = delete;
+	InstrumentScope & operator=(InstrumentScope const &) = delete;
+
+	~InstrumentScope() {
+		if (nested_) return;
+		std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start_;
+		counters_.add(probe_, elements_, elapsed.count());
+		counters_.active[std::size_t(probe_)] = false;
+	}
+
+private:
+	detail::InstrumentThreadCounters & counters_;
+	InstrumentProbe probe_;
+	std::uint64_t elements_;
+	bool nested_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+/// Count a call without measuring time, for functions that take less time than reading the clock.
+/**
+ * Use DR_EIGEN_INSTRUMENT_COUNT instead of using this class directly,
+ * so the instrumentation disappears when DR_EIGEN_INSTRUMENT is not defined.
+ */
+class InstrumentCountScope {
+public:
+	InstrumentCountScope(InstrumentProbe probe, std::uint64_t elements) :
+		counters_{detail::instrumentCounters()},
+		probe_{probe},
+		nested_{counters_.active[std::size_t(probe)]}
+	{
+		if (nested_) return;
+		counters_.active[std::size_t(probe)] = true;
+		counters_.add(probe, elements, 0);
+	}
+
+	InstrumentCountScope(InstrumentCountScope const &) = delete;
+	InstrumentCountScope & operator=(InstrumentCountScope const &) = delete;
+
+	~InstrumentCountScope() {
+		if (!nested_) counters_.active[std::size_t(probe_)] = false;
+	}
+
+private:
+	detail::InstrumentThreadCounters & counters_;
+	InstrumentProbe probe_;
+	bool nested_;
+};
+
+}
+
+#ifdef DR_EIGEN_INSTRUMENT
+/// Count a call, the elements it processes and its time until the end of the enclosing scope.
+/**
+ * The elements expression is not evaluated when DR_EIGEN_INSTRUMENT is not defined.
+ */
+#define DR_EIGEN_INSTRUMENT_SCOPE(probe, elements) ::dr::InstrumentScope dr_eigen_instrument_scope_{::dr::InstrumentProbe::probe, static_cast<std::uint64_t>(elements)}
+
+/// Count a call and the elements it processes, without measuring time.
+#define DR_EIGEN_INSTRUMENT_COUNT(probe, elements) ::dr::InstrumentCountScope dr_eigen_instrument_scope_{::dr::InstrumentProbe::probe, static_cast<std::uint64_t>(elements)}
+#else
+#define DR_EIGEN_INSTRUMENT_SCOPE(probe, elements) static_cast<void>(0)
+#define DR_EIGEN_INSTRUMENT_COUNT(probe, elements) static_cast<void>(0)
+#endif
@@ -1,6 +1,8 @@
 // Copyright 2014-2022, Fizyr B.V.
 
 #pragma once
+#include "instrument.hpp"
+
 #include <Eigen/Dense>
 #include <Eigen/Geometry>
 
@@ -29,6 +31,7 @@ Eigen::AngleAxis<T> interpolateRotation(
 	Eigen::AngleAxis<T> const & b, ///< The second rotation.
 	double factor                  ///< The interpolation factor.
 ) {
+	DR_EIGEN_INSTRUMENT_SCOPE(interpolate_rotation, 1);
 	Eigen::AngleAxis<T> difference = b * a.inverse();
 	difference.angle() *= factor;
 	return difference * a;
@@ -44,6 +47,7 @@ Eigen::Quaternion<T> interpolateRotation(
 	Eigen::Quaternion<T> const & b, ///< The second rotation.
 	double factor                   ///< The interpolation factor.
 ) {
+	DR_EIGEN_INSTRUMENT_SCOPE(interpolate_rotation, 1);
 	return a.slerp(factor, b);
 }
 
@@ -67,11 +71,12 @@ Eigen::Quaternion<typename Eigen::MatrixBase<Derived1>::Scalar> interpolateRotat
  * At factor 0, the first isometry is returned, at factor 1 the second.
  * The translation will be interpolated linearly and the rotation spherial linearly.
  */
-Eigen::Isometry3d interpolateIsometry(
+inline Eigen::Isometry3d interpolateIsometry(
 	Eigen::Isometry3d const & a, ///< The first isometry.
 	Eigen::Isometry3d const & b, ///< The second isometry.
 	double factor                ///< The interpolation factor.
 ) {
+	DR_EIGEN_INSTRUMENT_SCOPE(interpolate_isometry, 1);
 	return Eigen::Translation3d{interpolateVector(a.translation(), b.translation(), factor)}
 		* interpolateRotation(Eigen::Quaterniond{a.rotation()}, Eigen::Quaterniond{b.rotation()}, factor);
 }
@@ -0,0 +1,347 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "parallel.hpp"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace dr {
+
+/// A neighbour found by a spatial query.
+template<typename Scalar>
+struct Neighbor {
+	/// The index of the point in the original point set.
+	std::size_t index;
+
+	/// The squared distance of the point to the query.
+	Scalar squared_distance;
+
+	bool operator< (Neighbor const & other) const { return squared_distance < other.squared_distance; }
+};
+
+/// Static k-d tree over a point set of fixed dimension for nearest neighbour queries.
+/**
+ * The dimension defaults to 3 for point clouds, but other embeddings can be indexed as well.
+ *
+ * The tree is built once with median splits along the axis with the largest extent.
+ * The nodes are stored contiguously in depth first order and the points are copied in leaf order,
+ * so every leaf scans a contiguous block of memory.
+ * The top levels of the tree are split sequentially, after which the subtrees are built in parallel.
+ *
+ * All queries are const and can run concurrently from multiple threads.
+ */
+template<typename Scalar, int Dimension = 3>
+class KdTree {
+public:
+	using Vector   = Eigen::Matrix<Scalar, Dimension, 1>;
+	using MatrixX  = Eigen::Matrix<Scalar, Dimension, Eigen::Dynamic>;
+	using Neighbor = dr::Neighbor<Scalar>;
+
+	/// Construct an empty tree.
+	KdTree() = default;
+
+	/// Build a tree over a set of points, one point per column.
+	KdTree(
+		MatrixX const & points,      ///< The points.
+		std::size_t leaf_size = 16,   ///< The maximum number of points in a leaf.
+		unsigned int threads  = 0     ///< Number of threads used to build the tree, zero to use defaultThreadCount().
+	) {
+		build(points, leaf_size, threads);
+	}
+
+	/// Rebuild the tree over a new set of points, one point per column.
+	/**
+	 * The storage of the previous tree is reused where possible.
+	 */
+	void build(MatrixX const & points, std::size_t leaf_size = 16, unsigned int threads = 0) {
+		if (points.cols() > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("too many points for a k-d tree: " + std::to_string(points.cols()));
+		leaf_size_ = std::max<std::size_t>(leaf_size, 1);
+		std::size_t count = points.cols();
+
+		order_.resize(count);
+		std::iota(order_.begin(), order_.end(), 0);
+		node_counts_.clear();
+		nodes_.resize(count == 0 ? 0 : nodeCount(count));
+		if (count == 0) {
+			points_.resize(Dimension, 0);
+			return;
+		}
+
+		// Split the top levels sequentially until there is a subtree for every thread.
+		if (threads == 0) threads = defaultThreadCount();
+		std::size_t depth = 0;
+		while ((std::size_t(1) << depth) < 2 * threads && depth < 16) ++depth;
+		std::vector<Task> tasks;
+		splitTop(points, 0, 0, count, depth, tasks);
+
+		parallelFor(tasks.size(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			for (std::size_t i = begin; i < end; ++i) buildSubtree(points, tasks[i].node, tasks[i].begin, tasks[i].end);
+		}, threads, 1);
+
+		// Copy the points in leaf order.
+		points_.resize(Dimension, count);
+		parallelFor(count, [&] (std::size_t begin, std::size_t end, std::size_t) {
+			for (std::size_t i = begin; i < end; ++i) points_.col(i) = points.col(order_[i]);
+		}, threads, 4096);
+	}
+
+	/// Get the number of points in the tree.
+	std::size_t size() const { return order_.size(); }
+
+	/// Get the number of nodes in the tree.
+	std::size_t nodes() const { return nodes_.size(); }
+
+	/// Find the k nearest neighbours of a query point.
+	/**
+	 * The result is sorted by increasing distance and holds less than k neighbours only if the tree has less than k points.
+	 * The result vector is cleared first, so reusing it between queries avoids allocations.
+	 */
+	void knn(Vector const & query, std::size_t k, std::vector<Neighbor> & result) const {
+		result.clear();
+		if (k == 0 || nodes_.empty()) return;
+		searchKnn(0, query, k, result);
+		std::sort_heap(result.begin(), result.end());
+		for (Neighbor & neighbor : result) neighbor.index = order_[neighbor.index];
+	}
+
+	/// Find the nearest neighbour of a query point.
+	/**
+	 * \throws std::logic_error if the tree is empty.
+	 */
+	Neighbor nearest(Vector const & query) const {
+		if (nodes_.empty()) throw std::logic_error("Cannot find the nearest neighbour in an empty k-d tree.");
+		Neighbor result{0, std::numeric_limits<Scalar>::infinity()};
+		searchNearest(0, query, result);
+		result.index = order_[result.index];
+		return result;
+	}
+
+	/// Find all points within a radius of a query point.
+	/**
+	 * The result is not sorted.
+	 * The result vector is cleared first, so reusing it between queries avoids allocations.
+	 */
+	void radius(Vector const & query, Scalar radius, std::vector<Neighbor> & result) const {
+		result.clear();
+		if (nodes_.empty()) return;
+		searchRadius(0, query, radius * radius, result);
+		for (Neighbor & neighbor : result) neighbor.index = order_[neighbor.index];
+	}
+
+	/// Find the k nearest neighbours of every column of a query matrix in parallel.
+	/**
+	 * Column i of the output matrices holds the neighbours of query i, sorted by increasing distance.
+	 * Missing neighbours have index -1 and an infinite distance.
+	 */
+	void knn(
+		MatrixX const & queries,
+		std::size_t k,
+		Eigen::Matrix<Eigen::Index, Eigen::Dynamic, Eigen::Dynamic> & indices,
+		Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> & squared_distances,
+		unsigned int threads = 0
+	) const {
+		indices.resize(k, queries.cols());
+		squared_distances.resize(k, queries.cols());
+		parallelFor(queries.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			std::vector<Neighbor> neighbors;
+			neighbors.reserve(k);
+			for (std::size_t i = begin; i < end; ++i) {
+				knn(queries.col(i), k, neighbors);
+				for (std::size_t j = 0; j < k; ++j) {
+					bool found = j < neighbors.size();
+					indices(j, i)           = found ? Eigen::Index(neighbors[j].index) : -1;
+					squared_distances(j, i) = found ? neighbors[j].squared_distance : std::numeric_limits<Scalar>::infinity();
+				}
+			}
+		}, threads, 64);
+	}
+
+	/// Find all points within a radius of every column of a query matrix in parallel.
+	/**
+	 * Element i of the result holds the unsorted neighbours of query i.
+	 * The inner vectors are reused, so passing the same result between calls avoids most allocations.
+	 */
+	void radius(MatrixX const & queries, Scalar radius, std::vector<std::vector<Neighbor>> & result, unsigned int threads = 0) const {
+		result.resize(queries.cols());
+		parallelFor(queries.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			for (std::size_t i = begin; i < end; ++i) this->radius(queries.col(i), radius, result[i]);
+		}, threads, 64);
+	}
+
+private:
+	/// A node of the tree.
+	struct Node {
+		/// The split value along the split axis.
+		Scalar split;
+
+		/// The split axis, or -1 for a leaf.
+		std::int32_t axis;
+
+		/// The index of the first point of the node, in leaf order.
+		std::uint32_t begin;
+
+		/// The index past the last point of the node, in leaf order.
+		std::uint32_t end;
+
+		/// The index of the right child. The left child directly follows the node.
+		std::uint32_t right;
+	};
+
+	/// A subtree to be built by one thread.
+	struct Task {
+		std::size_t node;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	/// Get the number of nodes in a subtree with a given number of points.
+	/**
+	 * The shape of the tree only depends on the number of points,
+	 * which allows subtrees to be built in parallel into preallocated storage.
+	 */
+	std::size_t nodeCount(std::size_t count) {
+		if (count <= leaf_size_) return 1;
+		auto cached = node_counts_.find(count);
+		if (cached != node_counts_.end()) return cached->second;
+		std::size_t result = 1 + nodeCount(count / 2) + nodeCount(count - count / 2);
+		node_counts_.emplace(count, result);
+		return result;
+	}
+
+	/// Look up the number of nodes in a subtree, without modifying the cache.
+	std::size_t cachedNodeCount(std::size_t count) const {
+		return count <= leaf_size_ ? 1 : node_counts_.at(count);
+	}
+
+	/// Split a node at its median, or turn it into a leaf.
+	/**
+	 * \return The index of the first point of the right child.
+	 */
+	std::size_t splitNode(MatrixX const & points, std::size_t node, std::size_t begin, std::size_t end) {
+		Node & result = nodes_[node];
+		result.begin = begin;
+		result.end   = end;
+		result.axis  = -1;
+		result.split = 0;
+		result.right = 0;
+		if (end - begin <= leaf_size_) return end;
+
+		Vector min = Vector::Constant( std::numeric_limits<Scalar>::infinity());
+		Vector max = Vector::Constant(-std::numeric_limits<Scalar>::infinity());
+		for (std::size_t i = begin; i < end; ++i) {
+			min = min.cwiseMin(points.col(order_[i]));
+			max = max.cwiseMax(points.col(order_[i]));
+		}
+
+		int axis;
+		(max - min).maxCoeff(&axis);
+		std::size_t middle = begin + (end - begin) / 2;
+		std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end, [&] (std::uint32_t a, std::uint32_t b) {
+			return points(axis, a) < points(axis, b);
+		});
+
+		result.axis  = axis;
+		result.split = points(axis, order_[middle]);
+		result.right = node + 1 + cachedNodeCount(middle - begin);
+		return middle;
+	}
+
+	/// Split the top levels of the tree and collect the subtrees below them as tasks.
+	void splitTop(MatrixX const & points, std::size_t node, std::size_t begin, std::size_t end, std::size_t depth, std::vector<Task> & tasks) {
+		if (depth == 0 || end - begin <= leaf_size_) {
+			tasks.push_back(Task{node, begin, end});
+			return;
+		}
+		std::size_t middle = splitNode(points, node, begin, end);
+		splitTop(points, node + 1, begin, middle, depth - 1, tasks);
+		splitTop(points, nodes_[node].right, middle, end, depth - 1, tasks);
+	}
+
+	/// Build a complete subtree.
+	void buildSubtree(MatrixX const & points, std::size_t node, std::size_t begin, std::size_t end) {
+		std::size_t middle = splitNode(points, node, begin, end);
+		if (nodes_[node].axis < 0) return;
+		buildSubtree(points, node + 1, begin, middle);
+		buildSubtree(points, nodes_[node].right, middle, end);
+	}
+
+	void searchKnn(std::size_t index, Vector const & query, std::size_t k, std::vector<Neighbor> & heap) const {
+		Node const & node = nodes_[index];
+		if (node.axis < 0) {
+			for (std::size_t i = node.begin; i < node.end; ++i) {
+				Scalar distance = (points_.col(i) - query).squaredNorm();
+				if (heap.size() < k) {
+					heap.push_back(Neighbor{i, distance});
+					std::push_heap(heap.begin(), heap.end());
+				} else if (distance < heap.front().squared_distance) {
+					std::pop_heap(heap.begin(), heap.end());
+					heap.back() = Neighbor{i, distance};
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+			return;
+		}
+
+		Scalar difference = query[node.axis] - node.split;
+		std::size_t near  = difference < 0 ? index + 1 : node.right;
+		std::size_t far   = difference < 0 ? node.right : index + 1;
+		searchKnn(near, query, k, heap);
+		if (heap.size() < k || difference * difference < heap.front().squared_distance) searchKnn(far, query, k, heap);
+	}
+
+	void searchNearest(std::size_t index, Vector const & query, Neighbor & best) const {
+		Node const & node = nodes_[index];
+		if (node.axis < 0) {
+			for (std::size_t i = node.begin; i < node.end; ++i) {
+				Scalar distance = (points_.col(i) - query).squaredNorm();
+				if (distance < best.squared_distance) best = Neighbor{i, distance};
+			}
+			return;
+		}
+
+		Scalar difference = query[node.axis] - node.split;
+		searchNearest(difference < 0 ? index + 1 : node.right, query, best);
+		if (difference * difference < best.squared_distance) searchNearest(difference < 0 ? node.right : index + 1, query, best);
+	}
+
+	void searchRadius(std::size_t index, Vector const & query, Scalar squared_radius, std::vector<Neighbor> & result) const {
+		Node const & node = nodes_[index];
+		if (node.axis < 0) {
+			for (std::size_t i = node.begin; i < node.end; ++i) {
+				Scalar distance = (points_.col(i) - query).squaredNorm();
+				if (distance <= squared_radius) result.push_back(Neighbor{i, distance});
+			}
+			return;
+		}
+
+		Scalar difference = query[node.axis] - node.split;
+		if (difference <= 0 || difference * difference <= squared_radius) searchRadius(index + 1, query, squared_radius, result);
+		if (difference >= 0 || difference * difference <= squared_radius) searchRadius(node.right, query, squared_radius, result);
+	}
+
+	/// The maximum number of points in a leaf.
+	std::size_t leaf_size_ = 16;
+
+	/// The nodes in depth first order.
+	std::vector<Node> nodes_;
+
+	/// The points in leaf order.
+	MatrixX points_;
+
+	/// The original index of every point in leaf order.
+	std::vector<std::uint32_t> order_;
+
+	/// Cache of the number of nodes for subtree sizes, filled before building.
+	std::map<std::size_t, std::size_t> node_counts_;
+};
+
+}
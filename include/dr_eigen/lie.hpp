@@ -0,0 +1,303 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <cmath>
+
+namespace dr {
+
+/**
+ * Lie group utilities for SO(3) and SE(3).
+ *
+ * Tangent vectors of SO(3) are rotation vectors: the rotation axis scaled by the rotation angle.
+ * Tangent vectors of SE(3) are 6D vectors [rho; phi], with the translational part first and the rotation vector last.
+ *
+ * All functions switch to a Taylor expansion near zero angle.
+ * That avoids trigonometric functions for small angles and the loss of precision of the closed forms near zero.
+ */
+
+namespace detail {
+	/// Angle below which the Lie group functions use a Taylor expansion.
+	template<typename Scalar>
+	constexpr Scalar lieSmallAngle() { return Scalar(0.1); }
+
+	/// Coefficients shared by the SO(3) and SE(3) maps for a given angle.
+	template<typename Scalar>
+	struct LieCoefficients {
+		/// (1 - cos(angle)) / angle^2
+		Scalar b;
+
+		/// (angle - sin(angle)) / angle^3
+		Scalar c;
+
+		LieCoefficients(Scalar angle) {
+			Scalar angle2 = angle * angle;
+			if (angle < lieSmallAngle<Scalar>()) {
+				b = Scalar(1) / 2  - angle2 * (Scalar(1) / 24  - angle2 * (Scalar(1) / 720  - angle2 / 40320));
+				c = Scalar(1) / 6  - angle2 * (Scalar(1) / 120 - angle2 * (Scalar(1) / 5040 - angle2 / 362880));
+			} else {
+				Scalar half_sine = std::sin(angle / 2);
+				b = 2 * half_sine * half_sine / angle2;
+				c = (angle - std::sin(angle)) / (angle2 * angle);
+			}
+		}
+	};
+}
+
+/// Get the skew symmetric matrix of a vector, such that so3Hat(a) * b equals a.cross(b).
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 3> so3Hat(Eigen::Matrix<Scalar, 3, 1> const & vector) {
+	Eigen::Matrix<Scalar, 3, 3> result;
+	result <<
+		0,            -vector.z(),  vector.y(),
+		vector.z(),   0,           -vector.x(),
+		-vector.y(),  vector.x(),   0;
+	return result;
+}
+
+/// Exponential map from a rotation vector to a unit quaternion.
+template<typename Scalar>
+Eigen::Quaternion<Scalar> so3Exp(Eigen::Matrix<Scalar, 3, 1> const & rotation) {
+	Scalar angle2 = rotation.squaredNorm();
+	Scalar angle  = std::sqrt(angle2);
+	Scalar real, factor;
+	if (angle < detail::lieSmallAngle<Scalar>()) {
+		// cos(angle / 2) and sin(angle / 2) / angle.
+		real   = Scalar(1)     - angle2 * (Scalar(1) / 8  - angle2 * (Scalar(1) / 384  - angle2 / 46080));
+		factor = Scalar(1) / 2 - angle2 * (Scalar(1) / 48 - angle2 * (Scalar(1) / 3840 - angle2 / 645120));
+	} else {
+		real   = std::cos(angle / 2);
+		factor = std::sin(angle / 2) / angle;
+	}
+	Eigen::Quaternion<Scalar> result;
+	result.w()   = real;
+	result.vec() = factor * rotation;
+	return result;
+}
+
+/// Logarithmic map from a unit quaternion to the rotation vector of the shortest equivalent rotation.
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 1> so3Log(Eigen::Quaternion<Scalar> const & rotation) {
+	// q and -q are the same rotation, take the one with the smallest angle.
+	Scalar sign  = rotation.w() < 0 ? -1 : 1;
+	Scalar real  = sign * rotation.w();
+	Scalar sine2 = rotation.vec().squaredNorm();
+	Scalar sine  = std::sqrt(sine2);
+	Scalar factor;
+	if (sine2 < Scalar(1e-4) * real * real) {
+		// 2 * atan(x) / x, with x = sine / real = tan(angle / 2) < 0.01.
+		Scalar x2 = sine2 / (real * real);
+		factor = 2 / real * (Scalar(1) - x2 * (Scalar(1) / 3 - x2 * (Scalar(1) / 5 - x2 / 7)));
+	} else {
+		factor = 2 * std::atan2(sine, real) / sine;
+	}
+	return sign * factor * rotation.vec();
+}
+
+/// Logarithmic map from a rotation matrix to a rotation vector.
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 1> so3Log(Eigen::Matrix<Scalar, 3, 3> const & rotation) {
+	return so3Log(Eigen::Quaternion<Scalar>(rotation));
+}
+
+/// Get the left Jacobian of SO(3) at a rotation vector.
+/**
+ * For a small rotation vector d: so3Exp(rotation + d) ~= so3Exp(so3LeftJacobian(rotation) * d) * so3Exp(rotation).
+ */
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 3> so3LeftJacobian(Eigen::Matrix<Scalar, 3, 1> const & rotation) {
+	detail::LieCoefficients<Scalar> coefficients(rotation.norm());
+	Eigen::Matrix<Scalar, 3, 3> hat = so3Hat(rotation);
+	return Eigen::Matrix<Scalar, 3, 3>::Identity() + coefficients.b * hat + coefficients.c * hat * hat;
+}
+
+/// Get the right Jacobian of SO(3) at a rotation vector.
+/**
+ * For a small rotation vector d: so3Exp(rotation + d) ~= so3Exp(rotation) * so3Exp(so3RightJacobian(rotation) * d).
+ */
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 3> so3RightJacobian(Eigen::Matrix<Scalar, 3, 1> const & rotation) {
+	return so3LeftJacobian<Scalar>(-rotation);
+}
+
+/// Get the inverse of the left Jacobian of SO(3) at a rotation vector.
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 3> so3LeftJacobianInverse(Eigen::Matrix<Scalar, 3, 1> const & rotation) {
+	Scalar angle = rotation.norm();
+	Scalar d;
+	if (angle < detail::lieSmallAngle<Scalar>()) {
+		// 1 / angle^2 - (1 + cos(angle)) / (2 * angle * sin(angle))
+		Scalar angle2 = angle * angle;
+		d = Scalar(1) / 12 + angle2 * (Scalar(1) / 720 + angle2 * (Scalar(1) / 30240 + angle2 / 1209600));
+	} else {
+		d = 1 / (angle * angle) - (1 + std::cos(angle)) / (2 * angle * std::sin(angle));
+	}
+	Eigen::Matrix<Scalar, 3, 3> hat = so3Hat(rotation);
+	return Eigen::Matrix<Scalar, 3, 3>::Identity() - hat / 2 + d * hat * hat;
+}
+
+/// Get the inverse of the right Jacobian of SO(3) at a rotation vector.
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 3> so3RightJacobianInverse(Eigen::Matrix<Scalar, 3, 1> const & rotation) {
+	return so3LeftJacobianInverse<Scalar>(-rotation);
+}
+
+/// Exponential map from an SE(3) tangent vector [rho; phi] to an isometry.
+template<typename Scalar>
+Eigen::Transform<Scalar, 3, Eigen::Isometry> se3Exp(Eigen::Matrix<Scalar, 6, 1> const & tangent) {
+	Eigen::Matrix<Scalar, 3, 1> rotation = tangent.template tail<3>();
+	Eigen::Matrix<Scalar, 3, 1> translation = so3LeftJacobian(rotation) * tangent.template head<3>();
+	return Eigen::Translation<Scalar, 3>(translation) * so3Exp(rotation);
+}
+
+/// Logarithmic map from an isometry to an SE(3) tangent vector [rho; phi].
+template<typename Scalar>
+Eigen::Matrix<Scalar, 6, 1> se3Log(Eigen::Transform<Scalar, 3, Eigen::Isometry> const & isometry) {
+	Eigen::Matrix<Scalar, 3, 1> rotation = so3Log(Eigen::Quaternion<Scalar>(isometry.rotation()));
+	Eigen::Matrix<Scalar, 6, 1> result;
+	result.template head<3>() = so3LeftJacobianInverse(rotation) * isometry.translation();
+	result.template tail<3>() = rotation;
+	return result;
+}
+
+namespace detail {
+	/// Get the upper right block of the left Jacobian of SE(3).
+	template<typename Scalar>
+	Eigen::Matrix<Scalar, 3, 3> se3JacobianQ(Eigen::Matrix<Scalar, 6, 1> const & tangent) {
+		Eigen::Matrix<Scalar, 3, 1> rotation = tangent.template tail<3>();
+		Scalar angle  = rotation.norm();
+		Scalar angle2 = angle * angle;
+
+		Scalar c1, c2, c3;
+		if (angle < lieSmallAngle<Scalar>()) {
+			c1 = Scalar(1) / 6   - angle2 * (Scalar(1) / 120  - angle2 * (Scalar(1) / 5040   - angle2 / 362880));
+			c2 = Scalar(1) / 24  - angle2 * (Scalar(1) / 720  - angle2 * (Scalar(1) / 40320  - angle2 / 3628800));
+			c3 = Scalar(1) / 120 - angle2 * (Scalar(1) / 2520 - angle2 * (Scalar(1) / 120960 - angle2 / 9979200));
+		} else {
+			Scalar sine   = std::sin(angle);
+			Scalar cosine = std::cos(angle);
+			c1 = (angle - sine) / (angle2 * angle);
+			c2 = (angle2 + 2 * cosine - 2) / (2 * angle2 * angle2);
+			c3 = (2 * angle - 3 * sine + angle * cosine) / (2 * angle2 * angle2 * angle);
+		}
+
+		Eigen::Matrix<Scalar, 3, 3> rho = so3Hat<Scalar>(tangent.template head<3>());
+		Eigen::Matrix<Scalar, 3, 3> phi = so3Hat(rotation);
+		Eigen::Matrix<Scalar, 3, 3> phi_rho     = phi * rho;
+		Eigen::Matrix<Scalar, 3, 3> phi_rho_phi = phi_rho * phi;
+
+		return rho / 2
+			+ c1 * (phi_rho + rho * phi + phi_rho_phi)
+			+ c2 * (phi * phi_rho + rho * phi * phi - 3 * phi_rho_phi)
+			+ c3 * (phi_rho_phi * phi + phi * phi_rho_phi);
+	}
+}
+
+/// Get the left Jacobian of SE(3) at a tangent vector [rho; phi].
+template<typename Scalar>
+Eigen::Matrix<Scalar, 6, 6> se3LeftJacobian(Eigen::Matrix<Scalar, 6, 1> const & tangent) {
+	Eigen::Matrix<Scalar, 3, 3> jacobian = so3LeftJacobian<Scalar>(tangent.template tail<3>());
+	Eigen::Matrix<Scalar, 6, 6> result;
+	result.template topLeftCorner<3, 3>()     = jacobian;
+	result.template topRightCorner<3, 3>()    = detail::se3JacobianQ(tangent);
+	result.template bottomLeftCorner<3, 3>().setZero();
+	result.template bottomRightCorner<3, 3>() = jacobian;
+	return result;
+}
+
+/// Get the right Jacobian of SE(3) at a tangent vector [rho; phi].
+template<typename Scalar>
+Eigen::Matrix<Scalar, 6, 6> se3RightJacobian(Eigen::Matrix<Scalar, 6, 1> const & tangent) {
+	return se3LeftJacobian<Scalar>(-tangent);
+}
+
+/// Get the inverse of the left Jacobian of SE(3) at a tangent vector [rho; phi].
+template<typename Scalar>
+Eigen::Matrix<Scalar, 6, 6> se3LeftJacobianInverse(Eigen::Matrix<Scalar, 6, 1> const & tangent) {
+	Eigen::Matrix<Scalar, 3, 3> inverse = so3LeftJacobianInverse<Scalar>(tangent.template tail<3>());
+	Eigen::Matrix<Scalar, 6, 6> result;
+	result.template topLeftCorner<3, 3>()     = inverse;
+	result.template topRightCorner<3, 3>()    = -inverse * detail::se3JacobianQ(tangent) * inverse;
+	result.template bottomLeftCorner<3, 3>().setZero();
+	result.template bottomRightCorner<3, 3>() = inverse;
+	return result;
+}
+
+/// Get the inverse of the right Jacobian of SE(3) at a tangent vector [rho; phi].
+template<typename Scalar>
+Eigen::Matrix<Scalar, 6, 6> se3RightJacobianInverse(Eigen::Matrix<Scalar, 6, 1> const & tangent) {
+	return se3LeftJacobianInverse<Scalar>(-tangent);
+}
+
+/// Get the adjoint of an isometry, acting on SE(3) tangent vectors [rho; phi].
+/**
+ * The adjoint satisfies: isometry * se3Exp(tangent) * isometry.inverse() == se3Exp(se3Adjoint(isometry) * tangent).
+ */
+template<typename Scalar>
+Eigen::Matrix<Scalar, 6, 6> se3Adjoint(Eigen::Transform<Scalar, 3, Eigen::Isometry> const & isometry) {
+	Eigen::Matrix<Scalar, 3, 3> rotation = isometry.linear();
+	Eigen::Matrix<Scalar, 6, 6> result;
+	result.template topLeftCorner<3, 3>()     = rotation;
+	result.template topRightCorner<3, 3>()    = so3Hat<Scalar>(isometry.translation()) * rotation;
+	result.template bottomLeftCorner<3, 3>().setZero();
+	result.template bottomRightCorner<3, 3>() = rotation;
+	return result;
+}
+
+/// Apply so3Exp to every column of a 3xN matrix of rotation vectors.
+/**
+ * \return The output iterator past the last written quaternion.
+ */
+template<typename Derived, typename OutputIterator>
+OutputIterator so3Exp(Eigen::MatrixBase<Derived> const & rotations, OutputIterator output) {
+	using Scalar = typename Derived::Scalar;
+	for (Eigen::Index i = 0; i < rotations.cols(); ++i) {
+		*output++ = so3Exp<Scalar>(rotations.col(i));
+	}
+	return output;
+}
+
+/// Apply so3Log to a range of quaternions.
+/**
+ * \return A 3xN matrix with one rotation vector per column.
+ */
+template<typename Scalar, typename ForwardIterator>
+Eigen::Matrix<Scalar, 3, Eigen::Dynamic> so3Log(ForwardIterator const & begin, ForwardIterator const & end) {
+	Eigen::Matrix<Scalar, 3, Eigen::Dynamic> result(3, std::distance(begin, end));
+	Eigen::Index i = 0;
+	for (ForwardIterator it = begin; it != end; ++it) {
+		result.col(i++) = so3Log<Scalar>(*it);
+	}
+	return result;
+}
+
+/// Apply se3Exp to every column of a 6xN matrix of tangent vectors.
+/**
+ * \return The output iterator past the last written isometry.
+ */
+template<typename Derived, typename OutputIterator>
+OutputIterator se3Exp(Eigen::MatrixBase<Derived> const & tangents, OutputIterator output) {
+	using Scalar = typename Derived::Scalar;
+	for (Eigen::Index i = 0; i < tangents.cols(); ++i) {
+		*output++ = se3Exp<Scalar>(tangents.col(i));
+	}
+	return output;
+}
+
+/// Apply se3Log to a range of isometries.
+/**
+ * \return A 6xN matrix with one tangent vector per column.
+ */
+template<typename Scalar, typename ForwardIterator>
+Eigen::Matrix<Scalar, 6, Eigen::Dynamic> se3Log(ForwardIterator const & begin, ForwardIterator const & end) {
+	Eigen::Matrix<Scalar, 6, Eigen::Dynamic> result(6, std::distance(begin, end));
+	Eigen::Index i = 0;
+	for (ForwardIterator it = begin; it != end; ++it) {
+		result.col(i++) = se3Log<Scalar>(*it);
+	}
+	return result;
+}
+
+}
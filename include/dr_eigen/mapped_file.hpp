@@ -0,0 +1,54 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace dr {
+
+/// The expected access pattern of a mapped file, passed to the kernel as a hint.
+enum class MappedFileAccess {
+	/// No hint, use the default read-ahead of the kernel.
+	normal,
+
+	/// The file is read front to back once, like when parsing it.
+	sequential,
+
+	/// The file is read at random offsets, like when doing binary searches.
+	random,
+};
+
+/// A read-only memory mapping of a file.
+class MappedFile {
+public:
+	/// Create an empty mapping.
+	MappedFile() = default;
+
+	/// Map a file into memory.
+	/**
+	 * The access pattern is only a hint for the read-ahead of the kernel, any access remains valid.
+	 * \throws std::system_error if the file can not be opened or mapped.
+	 */
+	explicit MappedFile(std::string const & path, MappedFileAccess access = MappedFileAccess::normal);
+
+	MappedFile(MappedFile && other) noexcept;
+	MappedFile & operator=(MappedFile && other) noexcept;
+	MappedFile(MappedFile const &) = delete;
+	MappedFile & operator=(MappedFile const &) = delete;
+
+	/// Unmap the file.
+	~MappedFile();
+
+	/// The contents of the file.
+	char const * data() const { return data_; }
+
+	/// The size of the file in bytes.
+	std::size_t size() const { return size_; }
+
+private:
+	char const * data_ = nullptr;
+	std::size_t size_  = 0;
+};
+
+}
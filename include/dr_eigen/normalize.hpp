@@ -0,0 +1,155 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "parallel.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+/// How conversions treat rotations that are not exactly normalized.
+enum class NormalizeMode {
+	/// Use the values as they are.
+	as_is,
+
+	/// Normalize quaternions and orthonormalize rotation matrices.
+	normalize,
+};
+
+/// Normalize quaternions stored as the columns of a matrix, in (x, y, z, w) order like Eigen::Quaternion::coeffs().
+/**
+ * Quaternions with zero norm are left unchanged, like Eigen::Quaternion::normalize() does.
+ */
+template<typename Derived>
+void normalizeQuaternions(Eigen::MatrixBase<Derived> & coefficients, unsigned int threads = 0) {
+	static_assert(Derived::RowsAtCompileTime == 4, "quaternion coefficients must be stored in a matrix with four rows");
+	using Scalar = typename Derived::Scalar;
+	parallelFor(coefficients.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		for (std::size_t i = begin; i < end; ++i) {
+			Scalar squared_norm = coefficients.col(i).squaredNorm();
+			if (squared_norm > 0) coefficients.col(i) *= 1 / std::sqrt(squared_norm);
+		}
+	}, threads, 4096);
+}
+
+/// Normalize quaternions in place.
+/**
+ * Quaternions with zero norm are left unchanged, like Eigen::Quaternion::normalize() does.
+ */
+template<typename Scalar>
+void normalizeQuaternions(std::vector<Eigen::Quaternion<Scalar>> & quaternions, unsigned int threads = 0) {
+	static_assert(sizeof(Eigen::Quaternion<Scalar>) == 4 * sizeof(Scalar), "quaternions must be stored as four packed coefficients");
+	if (quaternions.empty()) return;
+	Eigen::Map<Eigen::Matrix<Scalar, 4, Eigen::Dynamic>> coefficients(quaternions.front().coeffs().data(), 4, quaternions.size());
+	normalizeQuaternions(coefficients, threads);
+}
+
+/// Flip the sign of quaternions stored as the columns of a matrix so they lie in the same hemisphere as a reference quaternion.
+/**
+ * A quaternion and its negation represent the same rotation.
+ * After canonicalization, the dot product of every quaternion with the reference is zero or more,
+ * so averaging or interpolating the coefficients does not mix both signs.
+ */
+template<typename Derived>
+void canonicalizeQuaternions(
+	Eigen::MatrixBase<Derived> & coefficients,
+	Eigen::Quaternion<typename Derived::Scalar> const & reference = Eigen::Quaternion<typename Derived::Scalar>::Identity(),
+	unsigned int threads = 0
+) {
+	static_assert(Derived::RowsAtCompileTime == 4, "quaternion coefficients must be stored in a matrix with four rows");
+	parallelFor(coefficients.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		for (std::size_t i = begin; i < end; ++i) {
+			if (reference.coeffs().dot(coefficients.col(i)) < 0) coefficients.col(i) = -coefficients.col(i);
+		}
+	}, threads, 4096);
+}
+
+/// Flip the sign of quaternions in place so they lie in the same hemisphere as a reference quaternion.
+/**
+ * With the default reference, all quaternions get a non-negative w coefficient.
+ */
+template<typename Scalar>
+void canonicalizeQuaternions(
+	std::vector<Eigen::Quaternion<Scalar>> & quaternions,
+	Eigen::Quaternion<Scalar> const & reference = Eigen::Quaternion<Scalar>::Identity(),
+	unsigned int threads = 0
+) {
+	static_assert(sizeof(Eigen::Quaternion<Scalar>) == 4 * sizeof(Scalar), "quaternions must be stored as four packed coefficients");
+	if (quaternions.empty()) return;
+	Eigen::Map<Eigen::Matrix<Scalar, 4, Eigen::Dynamic>> coefficients(quaternions.front().coeffs().data(), 4, quaternions.size());
+	canonicalizeQuaternions(coefficients, reference, threads);
+}
+
+/// Replace a matrix by the nearest rotation matrix in the Frobenius norm.
+/**
+ * This is the orthogonal factor of the polar decomposition, computed with the scaled Newton iteration
+ *
+ *   X <- (g * X + X^-T / g) / 2,  with g = |det(X)|^(-1/3)
+ *
+ * which needs no SVD and converges quadratically: a rotation matrix with accumulated round-off takes one or two iterations.
+ *
+ * \throws std::invalid_argument if the determinant of the matrix is not positive, since then the nearest orthogonal matrix is not a rotation.
+ */
+template<typename Scalar>
+void orthonormalizeRotation(Eigen::Matrix<Scalar, 3, 3> & matrix) {
+	using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+	Scalar tolerance = 8 * std::numeric_limits<Scalar>::epsilon();
+	for (int i = 0; i < 30; ++i) {
+		Scalar determinant = matrix.determinant();
+		if (!(determinant > 0)) throw std::invalid_argument("cannot orthonormalize a matrix with a non-positive determinant: " + std::to_string(determinant));
+		if ((matrix.transpose() * matrix - Matrix3::Identity()).cwiseAbs().maxCoeff() <= tolerance) break;
+		Scalar scale = std::cbrt(1 / determinant);
+		matrix = (scale * matrix + matrix.inverse().transpose() / scale) / 2;
+	}
+}
+
+/// Replace every matrix by the nearest rotation matrix in parallel.
+/**
+ * \throws std::invalid_argument if the determinant of a matrix is not positive.
+ */
+template<typename Scalar>
+void orthonormalizeRotations(std::vector<Eigen::Matrix<Scalar, 3, 3>> & matrices, unsigned int threads = 0) {
+	parallelFor(matrices.size(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		for (std::size_t i = begin; i < end; ++i) orthonormalizeRotation(matrices[i]);
+	}, threads, 1024);
+}
+
+/// Replace the linear part of every isometry by the nearest rotation matrix in parallel.
+/**
+ * \throws std::invalid_argument if the determinant of the linear part of an isometry is not positive.
+ */
+template<typename Scalar>
+void orthonormalizeRotations(std::vector<Eigen::Transform<Scalar, 3, Eigen::Isometry>> & isometries, unsigned int threads = 0) {
+	parallelFor(isometries.size(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		for (std::size_t i = begin; i < end; ++i) {
+			Eigen::Matrix<Scalar, 3, 3> linear = isometries[i].linear();
+			orthonormalizeRotation(linear);
+			isometries[i].linear() = linear;
+		}
+	}, threads, 1024);
+}
+
+/// Normalize a quaternion if the mode asks for it.
+template<typename Scalar>
+Eigen::Quaternion<Scalar> normalize(Eigen::Quaternion<Scalar> const & quaternion, NormalizeMode mode) {
+	return mode == NormalizeMode::normalize ? quaternion.normalized() : quaternion;
+}
+
+/// Orthonormalize a rotation matrix if the mode asks for it.
+/**
+ * \throws std::invalid_argument if the matrix needs to be orthonormalized and its determinant is not positive.
+ */
+template<typename Scalar>
+Eigen::Matrix<Scalar, 3, 3> normalize(Eigen::Matrix<Scalar, 3, 3> matrix, NormalizeMode mode) {
+	if (mode == NormalizeMode::normalize) orthonormalizeRotation(matrix);
+	return matrix;
+}
+
+}
@@ -0,0 +1,200 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dr {
+
+/// Get the number of threads used by parallel algorithms when no thread count is given.
+inline unsigned int defaultThreadCount() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// Get the number of chunks that parallelFor splits a range into.
+/**
+ * Every chunk gets at least min_chunk_size elements, except if the range is smaller than that.
+ * A thread count of zero means defaultThreadCount().
+ */
+inline std::size_t parallelChunks(std::size_t count, unsigned int threads = 0, std::size_t min_chunk_size = 256) {
+	if (threads == 0) threads = defaultThreadCount();
+	std::size_t chunks = count / std::max<std::size_t>(min_chunk_size, 1);
+	return std::max<std::size_t>(1, std::min<std::size_t>(chunks, threads));
+}
+
+/// Run a function over the range [0, count) split into contiguous chunks on multiple threads.
+/**
+ * The function is called as function(begin, end, chunk) for every chunk,
+ * where chunk is the index of the chunk in [0, parallelChunks(count, threads, min_chunk_size)).
+ * That index can be used to select per-thread accumulators that are merged afterwards.
+ *
+ * The first chunk runs on the calling thread.
+ * If a chunk throws, the first exception is rethrown after all chunks finished.
+ */
+template<typename Function>
+void parallelFor(std::size_t count, Function && function, unsigned int threads = 0, std::size_t min_chunk_size = 256) {
+	std::size_t chunks = parallelChunks(count, threads, min_chunk_size);
+	if (chunks == 1) {
+		function(std::size_t(0), count, std::size_t(0));
+		return;
+	}
+
+	std::vector<std::exception_ptr> errors(chunks);
+	auto run = [&] (std::size_t chunk) {
+		try {
+			function(count * chunk / chunks, count * (chunk + 1) / chunks, chunk);
+		} catch (...) {
+			errors[chunk] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(chunks - 1);
+	for (std::size_t chunk = 1; chunk < chunks; ++chunk) workers.emplace_back(run, chunk);
+	run(0);
+	for (std::thread & worker : workers) worker.join();
+
+	for (std::exception_ptr const & error : errors) {
+		if (error) std::rethrow_exception(error);
+	}
+}
+
+/// A fixed set of worker threads for running many parallel loops without starting threads for every loop.
+/**
+ * The loops are split into chunks the same way as with parallelFor,
+ * but the threads are started once and no memory is allocated per loop.
+ *
+ * A pool runs one loop at a time: it must not be used by multiple threads concurrently,
+ * and a loop must not start another loop on the same pool.
+ */
+class WorkerPool {
+public:
+	/// Start the worker threads. A thread count of zero means defaultThreadCount().
+	/**
+	 * The calling thread runs the first chunk of every loop, so threads - 1 workers are started.
+	 */
+	explicit WorkerPool(unsigned int threads = 0) {
+		if (threads == 0) threads = defaultThreadCount();
+		errors_.resize(threads);
+		workers_.reserve(threads - 1);
+		for (std::size_t worker = 1; worker < threads; ++worker) workers_.emplace_back([this, worker] { work(worker); });
+	}
+
+	WorkerPool(WorkerPool const &) = delete;
+	WorkerPool & operator=(WorkerPool const &) = delete;
+
+	/// Stop and join the worker threads.
+	~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			stop_ = true;
+		}
+		start_.notify_all();
+		for (std::thread & worker : workers_) worker.join();
+	}
+
+	/// Get the number of threads used by a loop, including the calling thread.
+	unsigned int threads() const {
+		return workers_.size() + 1;
+	}
+
+	/// Run a function over the range [0, count) split into contiguous chunks on the threads of the pool.
+	/**
+	 * The function is called as for the free parallelFor function,
+	 * with parallelChunks(count, threads(), min_chunk_size) chunks.
+	 *
+	 * If a chunk throws, the first exception is rethrown after all chunks finished.
+	 */
+	template<typename Function>
+	void parallelFor(std::size_t count, Function && function, std::size_t min_chunk_size = 256) {
+		std::size_t chunks = parallelChunks(count, threads(), min_chunk_size);
+		if (chunks == 1) {
+			function(std::size_t(0), count, std::size_t(0));
+			return;
+		}
+
+		using FunctionType = typename std::remove_reference<Function>::type;
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			call_ = [] (void * function, std::size_t begin, std::size_t end, std::size_t chunk) {
+				(*static_cast<FunctionType *>(function))(begin, end, chunk);
+			};
+			function_ = const_cast<void *>(static_cast<void const *>(&function));
+			count_    = count;
+			chunks_   = chunks;
+			pending_  = chunks - 1;
+			++generation_;
+		}
+		start_.notify_all();
+
+		runChunk(0);
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+			done_.wait(lock, [this] { return pending_ == 0; });
+		}
+
+		for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+			if (!errors_[chunk]) continue;
+			std::exception_ptr error = errors_[chunk];
+			std::fill(errors_.begin(), errors_.begin() + chunks, nullptr);
+			std::rethrow_exception(error);
+		}
+	}
+
+private:
+	/// Run one chunk of the current loop, storing its exception.
+	void runChunk(std::size_t chunk) {
+		try {
+			call_(function_, count_ * chunk / chunks_, count_ * (chunk + 1) / chunks_, chunk);
+		} catch (...) {
+			errors_[chunk] = std::current_exception();
+		}
+	}
+
+	/// Wait for loops and run the chunk of this worker.
+	void work(std::size_t worker) {
+		std::size_t seen = 0;
+		std::unique_lock<std::mutex> lock{mutex_};
+		while (true) {
+			start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+			if (stop_) return;
+			seen = generation_;
+			if (worker >= chunks_) continue;
+
+			lock.unlock();
+			runChunk(worker);
+			lock.lock();
+			if (--pending_ == 0) done_.notify_one();
+		}
+	}
+
+	std::mutex mutex_;
+	std::condition_variable start_;
+	std::condition_variable done_;
+	std::vector<std::thread> workers_;
+
+	/// The exception of every chunk of the current loop.
+	std::vector<std::exception_ptr> errors_;
+
+	/// The current loop.
+	void (*call_)(void * function, std::size_t begin, std::size_t end, std::size_t chunk) = nullptr;
+	void * function_     = nullptr;
+	std::size_t count_   = 0;
+	std::size_t chunks_  = 0;
+
+	/// The number of worker chunks of the current loop that did not finish yet.
+	std::size_t pending_ = 0;
+
+	/// Incremented for every loop, so workers can tell a new loop from a spurious wake up.
+	std::size_t generation_ = 0;
+
+	bool stop_ = false;
+};
+
+}
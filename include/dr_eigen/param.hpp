@@ -2,9 +2,41 @@
 
 #pragma once
 #include "eigen.hpp"
+#include "instrument.hpp"
 #include <dr_param/xmlrpc.hpp>
 
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace dr {
+	/// An error for one value in a bulk conversion.
+	struct XmlRpcConversionError {
+		/// The path of the value, like "[3].position.x" or "left_camera.orientation".
+		std::string path;
+
+		/// The error message.
+		std::string message;
+	};
+
+	/// Exception thrown by bulk conversions, holding the errors for all invalid values.
+	class XmlRpcBulkError : public std::runtime_error {
+	public:
+		explicit XmlRpcBulkError(std::string const & type, std::vector<XmlRpcConversionError> errors);
+
+		/// All errors, in the order of the values they belong to.
+		std::vector<XmlRpcConversionError> const & errors() const { return errors_; }
+
+	private:
+		std::vector<XmlRpcConversionError> errors_;
+	};
+
+	/// A map from names to isometries that stores the isometries with the alignment required by Eigen.
+	using IsometryMap = std::map<std::string, Eigen::Isometry3d, std::less<std::string>, Eigen::aligned_allocator<std::pair<std::string const, Eigen::Isometry3d>>>;
+
 	/// Convert an XmlRpcValue to an Eigen::Vector3d.
 	template<> Eigen::Vector3d fromXmlRpc<Eigen::Vector3d>(XmlRpc::XmlRpcValue const & value);
 
@@ -22,4 +54,136 @@ namespace dr {
 
 	/// Convert an XmlRpcValue to a Pose.
 	template<> Pose fromXmlRpc<Pose>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc array to a list of poses.
+	/**
+	 * Large arrays are converted on multiple threads.
+	 * All elements are checked, and the errors of all invalid elements are reported together.
+	 *
+	 * \throws XmlRpcBulkError if any element is not a valid pose.
+	 */
+	template<> std::vector<Pose> fromXmlRpc<std::vector<Pose>>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc array to a list of poses with aligned storage.
+	template<> std::vector<Pose, Eigen::aligned_allocator<Pose>> fromXmlRpc<std::vector<Pose, Eigen::aligned_allocator<Pose>>>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc struct to a map of named isometries.
+	/**
+	 * \throws XmlRpcBulkError if any member is not a valid isometry.
+	 */
+	template<> std::map<std::string, Eigen::Isometry3d> fromXmlRpc<std::map<std::string, Eigen::Isometry3d>>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc struct to a map of named isometries with aligned storage.
+	template<> IsometryMap fromXmlRpc<IsometryMap>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc array to a list of boxes.
+	/**
+	 * \throws XmlRpcBulkError if any element is not a valid box.
+	 */
+	template<> std::vector<Eigen::AlignedBox3d> fromXmlRpc<std::vector<Eigen::AlignedBox3d>>(XmlRpc::XmlRpcValue const & value);
+
+	/// The order of the elements of a matrix in an XmlRpc list.
+	enum class MatrixOrder {
+		/// The list holds the rows of the matrix, or all elements row by row.
+		row_major,
+
+		/// The list holds the columns of the matrix, or all elements column by column.
+		column_major,
+	};
+
+	namespace detail {
+		/// The layout of a matrix in an XmlRpcValue.
+		struct XmlRpcMatrixLayout {
+			/// The list holding the elements, or the rows or columns if nested is true.
+			XmlRpc::XmlRpcValue const * data;
+
+			/// True if data is a list of rows or columns, false if it is a flat list of elements.
+			bool nested;
+
+			/// The number of rows of the matrix.
+			int rows;
+
+			/// The number of columns of the matrix.
+			int cols;
+		};
+
+		/// Determine and check the layout of a matrix in an XmlRpcValue.
+		/**
+		 * Fixed dimensions are passed as their size, dynamic dimensions as Eigen::Dynamic.
+		 * All lists are checked, so the elements can be read without further size checks.
+		 *
+		 * \throws std::runtime_error if the value is not a valid matrix with the given dimensions.
+		 */
+		XmlRpcMatrixLayout xmlRpcMatrixLayout(XmlRpc::XmlRpcValue const & value, int rows, int cols, MatrixOrder order);
+	}
+
+	/// Convert an XmlRpcValue to an Eigen matrix or vector, writing directly into an existing matrix.
+	/**
+	 * The value can be:
+	 *  - a list of rows, or a list of columns for MatrixOrder::column_major,
+	 *  - a flat list of all elements, if the number of rows or columns is fixed at compile time,
+	 *  - a struct with the members rows, cols and data, where data is a flat list of all elements.
+	 *
+	 * Dynamic dimensions of the matrix are resized to the size of the value.
+	 *
+	 * \throws std::runtime_error if the value is not a valid matrix of the right size.
+	 */
+	template<typename Derived>
+	void matrixFromXmlRpc(XmlRpc::XmlRpcValue const & value, Eigen::PlainObjectBase<Derived> & result, MatrixOrder order = MatrixOrder::row_major) {
+		DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, 1);
+		using Scalar = typename Derived::Scalar;
+		detail::XmlRpcMatrixLayout layout = detail::xmlRpcMatrixLayout(value, Derived::RowsAtCompileTime, Derived::ColsAtCompileTime, order);
+		result.resize(layout.rows, layout.cols);
+
+		bool row_major = order == MatrixOrder::row_major;
+		int outer_size = row_major ? layout.rows : layout.cols;
+		int inner_size = row_major ? layout.cols : layout.rows;
+		for (int outer = 0; outer < outer_size; ++outer) {
+			XmlRpc::XmlRpcValue const & list   = layout.nested ? (*layout.data)[outer] : *layout.data;
+			int offset                         = layout.nested ? 0 : outer * inner_size;
+			for (int inner = 0; inner < inner_size; ++inner) {
+				Scalar element = static_cast<Scalar>(fromXmlRpc<double>(list[offset + inner]));
+				if (row_major) result(outer, inner) = element;
+				else           result(inner, outer) = element;
+			}
+		}
+	}
+
+	/// Convert an XmlRpcValue to an Eigen matrix or vector with any scalar type and size.
+	/**
+	 * \see matrixFromXmlRpc(XmlRpc::XmlRpcValue const &, Eigen::PlainObjectBase<Derived> &, MatrixOrder)
+	 */
+	template<typename Matrix>
+	Matrix matrixFromXmlRpc(XmlRpc::XmlRpcValue const & value, MatrixOrder order = MatrixOrder::row_major) {
+		Matrix result;
+		matrixFromXmlRpc(value, result, order);
+		return result;
+	}
+
+	/// Convert an XmlRpc list to an Eigen::Vector2d.
+	template<> Eigen::Vector2d fromXmlRpc<Eigen::Vector2d>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list to an Eigen::Vector4d.
+	template<> Eigen::Vector4d fromXmlRpc<Eigen::Vector4d>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list to a 6D vector.
+	template<> Eigen::Matrix<double, 6, 1> fromXmlRpc<Eigen::Matrix<double, 6, 1>>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list to an Eigen::VectorXd.
+	template<> Eigen::VectorXd fromXmlRpc<Eigen::VectorXd>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list of rows to an Eigen::Matrix2d.
+	template<> Eigen::Matrix2d fromXmlRpc<Eigen::Matrix2d>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list of rows to an Eigen::Matrix3d.
+	template<> Eigen::Matrix3d fromXmlRpc<Eigen::Matrix3d>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list of rows to an Eigen::Matrix4d.
+	template<> Eigen::Matrix4d fromXmlRpc<Eigen::Matrix4d>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list of rows to a 6x6 matrix, like a covariance or stiffness matrix.
+	template<> Eigen::Matrix<double, 6, 6> fromXmlRpc<Eigen::Matrix<double, 6, 6>>(XmlRpc::XmlRpcValue const & value);
+
+	/// Convert an XmlRpc list of rows, or a struct with rows, cols and data, to an Eigen::MatrixXd.
+	template<> Eigen::MatrixXd fromXmlRpc<Eigen::MatrixXd>(XmlRpc::XmlRpcValue const & value);
 }
@@ -0,0 +1,158 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "param.hpp"
+#include "rcu.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+/// A set of named values bound to an XmlRpc struct that can be updated while it is being read.
+/**
+ * Every member of the struct is converted with fromXmlRpc<T>.
+ * On update(), only members whose XmlRpc subtree changed are converted again,
+ * the other values are taken over from the previous snapshot.
+ *
+ * The values are published as immutable snapshots with read-copy-update,
+ * so readers such as control loops never wait for an update.
+ * Listeners registered with onChange() are called after a new snapshot is published,
+ * to invalidate caches that depend on the values, like spatial indices or transform chains.
+ *
+ * The XmlRpc tree typically comes from polling the parameter server, for example with ros::param::getCached().
+ */
+template<typename T>
+class ParamBinding {
+public:
+	/// Values by member name, with an allocator that respects the alignment of fixed-size Eigen types.
+	using ValueMap = std::map<std::string, T, std::less<std::string>, Eigen::aligned_allocator<std::pair<std::string const, T>>>;
+
+	/// An immutable set of values.
+	struct Snapshot {
+		/// The version of the snapshot, incremented for every published change.
+		std::uint64_t version = 0;
+
+		/// The values by member name.
+		ValueMap values;
+
+		/// Get a value by name.
+		/**
+		 * \throws std::out_of_range if there is no value with that name.
+		 */
+		T const & at(std::string const & name) const {
+			auto value = values.find(name);
+			if (value == values.end()) throw std::out_of_range("no parameter binding entry named " + name);
+			return value->second;
+		}
+	};
+
+	/// Guard that keeps a snapshot alive while it is being read.
+	using Reader = typename RcuCell<Snapshot>::Reader;
+
+	/// Function called with the new snapshot and the sorted names of the added, changed and removed values.
+	using Listener = std::function<void (Snapshot const & snapshot, std::vector<std::string> const & changed)>;
+
+	/// Create an empty binding.
+	ParamBinding() : snapshot_{std::unique_ptr<Snapshot const>{new Snapshot}} {}
+
+	/// Create a binding from an XmlRpc struct.
+	/**
+	 * \throws XmlRpcBulkError if any member can not be converted.
+	 */
+	explicit ParamBinding(XmlRpc::XmlRpcValue const & value) : ParamBinding() {
+		update(value);
+	}
+
+	/// Get a guard for the current snapshot. Never waits for updates.
+	Reader read() const {
+		return snapshot_.read();
+	}
+
+	/// Register a function to call when a new snapshot is published.
+	void onChange(Listener listener) {
+		std::lock_guard<std::mutex> lock{mutex_};
+		listeners_.push_back(std::move(listener));
+	}
+
+	/// Update the values from a new version of the XmlRpc struct.
+	/**
+	 * Members with an unchanged subtree are not converted again.
+	 * If nothing changed, no snapshot is published and no listeners are called.
+	 * If any changed member fails to convert, the current snapshot stays in place.
+	 *
+	 * Blocks until readers of the previous snapshot are done,
+	 * so it must not be called while the calling thread holds a Reader of this binding.
+	 *
+	 * \return The sorted names of the added, changed and removed values.
+	 * \throws XmlRpcBulkError if any changed member can not be converted.
+	 */
+	std::vector<std::string> update(XmlRpc::XmlRpcValue const & value) {
+		ensureXmlRpcType(value, XmlRpc::XmlRpcValue::TypeStruct, "dr::ParamBinding");
+		std::lock_guard<std::mutex> lock{mutex_};
+		Snapshot const & current = snapshot_.writerValue();
+
+		std::unique_ptr<Snapshot> next{new Snapshot};
+		next->version = current.version + 1;
+		std::vector<std::string> changed;
+		std::vector<XmlRpcConversionError> errors;
+
+		// XmlRpcValue can only be iterated when it is not const.
+		XmlRpc::XmlRpcValue & members = const_cast<XmlRpc::XmlRpcValue &>(value);
+		for (XmlRpc::XmlRpcValue::iterator member = members.begin(); member != members.end(); ++member) {
+			auto source = sources_.find(member->first);
+			if (source != sources_.end() && source->second == member->second) {
+				next->values.emplace_hint(next->values.end(), member->first, current.values.at(member->first));
+				continue;
+			}
+
+			changed.push_back(member->first);
+			try {
+				next->values.emplace_hint(next->values.end(), member->first, fromXmlRpc<T>(member->second));
+			} catch (std::exception const & e) {
+				errors.push_back({member->first, e.what()});
+			}
+		}
+		if (!errors.empty()) throw XmlRpcBulkError{"dr::ParamBinding", std::move(errors)};
+
+		for (auto const & source : sources_) {
+			if (!value.hasMember(source.first)) changed.push_back(source.first);
+		}
+		if (changed.empty()) return changed;
+		std::sort(changed.begin(), changed.end());
+
+		// Only keep copies of the subtrees that changed, the others are already stored.
+		for (std::string const & name : changed) {
+			if (value.hasMember(name)) sources_[name] = members[name];
+			else sources_.erase(name);
+		}
+
+		Snapshot const & published = *next;
+		snapshot_.publish(std::move(next));
+		for (Listener const & listener : listeners_) listener(published, changed);
+		return changed;
+	}
+
+private:
+	/// Serializes updates and protects the sources and listeners.
+	std::mutex mutex_;
+
+	/// The XmlRpc subtrees the current values were converted from.
+	std::map<std::string, XmlRpc::XmlRpcValue> sources_;
+
+	/// Functions to call when a new snapshot is published.
+	std::vector<Listener> listeners_;
+
+	/// The current snapshot.
+	RcuCell<Snapshot> snapshot_;
+};
+
+}
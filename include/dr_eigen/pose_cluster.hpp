@@ -0,0 +1,211 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "average.hpp"
+#include "parallel.hpp"
+#include "voxel_hash.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dr {
+
+/// Options for pose clustering and non-maximum suppression.
+struct PoseClusterOptions {
+	/// Maximum distance between the positions of two neighbouring poses.
+	double translation_threshold = 0.01;
+
+	/// Maximum rotation angle in radians between two neighbouring poses.
+	double rotation_threshold = 0.1;
+
+	/// Number of threads for the neighbour search, zero to use defaultThreadCount().
+	unsigned int threads = 0;
+};
+
+/// Result of pose clustering.
+template<typename DataType>
+struct PoseClusters {
+	using Isometry3 = Eigen::Transform<DataType, 3, Eigen::Isometry>;
+
+	/// The cluster of every input pose.
+	std::vector<std::size_t> labels;
+
+	/// The indices of the input poses in every cluster, in increasing order.
+	std::vector<std::vector<std::size_t>> members;
+
+	/// The average pose of every cluster, as computed by averageIsometries().
+	std::vector<Isometry3> averages;
+};
+
+namespace detail {
+	/// Neighbour search for poses under a combined translation and rotation threshold.
+	/**
+	 * Positions are indexed in a VoxelHash with the translation threshold as voxel size.
+	 * Rotations are compared with the absolute dot product of unit quaternions, which handles q and -q.
+	 */
+	template<typename DataType>
+	class PoseNeighbors {
+	public:
+		using Isometry3 = Eigen::Transform<DataType, 3, Eigen::Isometry>;
+
+		PoseNeighbors(std::vector<Isometry3> const & poses, PoseClusterOptions const & options) {
+			if (!(options.translation_threshold > 0)) throw std::invalid_argument("translation threshold must be positive, got " + std::to_string(options.translation_threshold));
+			if (!(options.rotation_threshold >= 0)) throw std::invalid_argument("rotation threshold must not be negative, got " + std::to_string(options.rotation_threshold));
+
+			positions_.resize(3, poses.size());
+			quaternions_.resize(4, poses.size());
+			for (std::size_t i = 0; i < poses.size(); ++i) {
+				positions_.col(i)   = poses[i].translation();
+				quaternions_.col(i) = Eigen::Quaternion<DataType>(poses[i].linear()).coeffs();
+			}
+			// Pi, as M_PI is not part of standard C++. Larger rotation thresholds accept any rotation.
+			double const half_turn = 3.14159265358979323846;
+			translation_threshold_ = options.translation_threshold;
+			minimum_dot_           = std::cos(std::min(options.rotation_threshold, half_turn) / 2);
+			grid_.build(positions_, translation_threshold_);
+		}
+
+		/// Find the neighbours of a pose, including the pose itself.
+		template<typename Function>
+		void forEach(std::size_t index, std::vector<Neighbor<DataType>> & buffer, Function && function) const {
+			grid_.radius(positions_.col(index), translation_threshold_, buffer);
+			for (Neighbor<DataType> const & neighbor : buffer) {
+				if (std::abs(quaternions_.col(index).dot(quaternions_.col(neighbor.index))) >= minimum_dot_) function(neighbor.index);
+			}
+		}
+
+	private:
+		Eigen::Matrix<DataType, 3, Eigen::Dynamic> positions_;
+		Eigen::Matrix<DataType, 4, Eigen::Dynamic> quaternions_;
+		VoxelHash<DataType> grid_;
+		DataType translation_threshold_;
+		DataType minimum_dot_;
+	};
+
+	/// Find the root of an element in a union-find forest, halving the path on the way.
+	inline std::uint32_t findRoot(std::vector<std::uint32_t> & parents, std::uint32_t element) {
+		while (parents[element] != element) {
+			parents[element] = parents[parents[element]];
+			element = parents[element];
+		}
+		return element;
+	}
+
+	/// Merge the sets of two elements in a union-find forest, keeping the smallest element as root.
+	inline void unite(std::vector<std::uint32_t> & parents, std::uint32_t a, std::uint32_t b) {
+		a = findRoot(parents, a);
+		b = findRoot(parents, b);
+		if (a < b) parents[b] = a;
+		else if (b < a) parents[a] = b;
+	}
+}
+
+/// Cluster poses by linking every pair within both the translation and the rotation threshold.
+/**
+ * Clusters are the connected components of the neighbour graph (single linkage).
+ * The neighbour search uses a voxel hash on the positions, so the run time is close to linear for well spread poses.
+ * Every thread links the neighbours within its chunk of poses in a shared union-find forest, touching only the elements of its own chunk.
+ * Links to poses in other chunks are collected per thread and added to the forest at the end.
+ *
+ * Clusters are ordered by their first member, so the result does not depend on the number of threads.
+ *
+ * \throws std::invalid_argument if the translation threshold is not positive or the rotation threshold is negative.
+ */
+template<typename DataType>
+PoseClusters<DataType> clusterPoses(
+	std::vector<Eigen::Transform<DataType, 3, Eigen::Isometry>> const & poses, ///< The poses.
+	PoseClusterOptions const & options = {} ///< The clustering options.
+) {
+	detail::PoseNeighbors<DataType> neighbors{poses, options};
+	std::size_t count = poses.size();
+
+	// Roots are the smallest element of their set, so the parents of a chunk stay inside the chunk while only linking within it.
+	std::vector<std::uint32_t> parents(count);
+	std::iota(parents.begin(), parents.end(), 0);
+	std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> crossing(parallelChunks(count, options.threads, 64));
+	parallelFor(count, [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+		std::vector<Neighbor<DataType>> buffer;
+		for (std::size_t i = begin; i < end; ++i) {
+			neighbors.forEach(i, buffer, [&] (std::size_t j) {
+				if (j >= begin && j < end) detail::unite(parents, i, j);
+				// The neighbour relation is symmetric, so every crossing link is found from both sides.
+				else if (j > i) crossing[chunk].emplace_back(i, j);
+			});
+		}
+	}, options.threads, 64);
+
+	for (std::vector<std::pair<std::uint32_t, std::uint32_t>> const & links : crossing) {
+		for (std::pair<std::uint32_t, std::uint32_t> const & link : links) detail::unite(parents, link.first, link.second);
+	}
+
+	// Number the clusters in order of their first member.
+	PoseClusters<DataType> result;
+	result.labels.resize(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		std::uint32_t root = detail::findRoot(parents, i);
+		if (root == i) {
+			result.labels[i] = result.members.size();
+			result.members.emplace_back();
+		} else {
+			result.labels[i] = result.labels[root];
+		}
+		result.members[result.labels[i]].push_back(i);
+	}
+
+	result.averages.resize(result.members.size());
+	parallelFor(result.members.size(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		std::vector<Eigen::Transform<DataType, 3, Eigen::Isometry>> members;
+		for (std::size_t i = begin; i < end; ++i) {
+			members.clear();
+			for (std::size_t member : result.members[i]) members.push_back(poses[member]);
+			result.averages[i] = averageIsometries<DataType>(members);
+		}
+	}, options.threads, 64);
+
+	return result;
+}
+
+/// Greedy non-maximum suppression of scored poses.
+/**
+ * Poses are visited in order of decreasing score.
+ * A pose is kept unless it is within both the translation and the rotation threshold of a pose that was kept before.
+ *
+ * \return The indices of the kept poses, in order of decreasing score.
+ * \throws std::invalid_argument if the number of scores differs from the number of poses, or the thresholds are invalid.
+ */
+template<typename DataType>
+std::vector<std::size_t> suppressNonMaxima(
+	std::vector<Eigen::Transform<DataType, 3, Eigen::Isometry>> const & poses, ///< The poses.
+	std::vector<DataType> const & scores,   ///< The score of every pose, higher is better.
+	PoseClusterOptions const & options = {} ///< The suppression thresholds.
+) {
+	if (scores.size() != poses.size()) throw std::invalid_argument("number of scores (" + std::to_string(scores.size()) + ") differs from number of poses (" + std::to_string(poses.size()) + ")");
+	detail::PoseNeighbors<DataType> neighbors{poses, options};
+
+	std::vector<std::size_t> order(poses.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&] (std::size_t a, std::size_t b) { return scores[a] > scores[b]; });
+
+	std::vector<bool> suppressed(poses.size(), false);
+	std::vector<Neighbor<DataType>> buffer;
+	std::vector<std::size_t> result;
+	for (std::size_t index : order) {
+		if (suppressed[index]) continue;
+		result.push_back(index);
+		neighbors.forEach(index, buffer, [&] (std::size_t neighbor) {
+			suppressed[neighbor] = true;
+		});
+	}
+	return result;
+}
+
+}
@@ -0,0 +1,104 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "eigen.hpp"
+#include "kd_tree.hpp"
+
+#include <vector>
+
+namespace dr {
+
+/// Nearest neighbour index over a fixed set of poses.
+/**
+ * The distance between two poses combines the distance between their positions and the chordal distance between their rotations:
+ *
+ *   d(a, b)^2 = |p_a - p_b|^2 + (2 * rotation_weight)^2 * min(|q_a - q_b|^2, |q_a + q_b|^2)
+ *
+ * The rotation term equals 4 * rotation_weight * sin(angle / 4), which is close to rotation_weight * angle for small angles.
+ * So the rotation weight is the distance that counts as much as a rotation of one radian.
+ * Taking the minimum over both signs of the quaternion makes the distance independent of the sign ambiguity of q and -q.
+ *
+ * The poses are embedded as 7D points in a KdTree.
+ * Every query searches the tree with both signs of the query quaternion and merges the results,
+ * which finds exactly the neighbours under the minimum over both signs.
+ *
+ * All queries are const and can run concurrently from multiple threads.
+ */
+class PoseIndex {
+public:
+	using Neighbor = dr::Neighbor<double>;
+
+	/// Construct an empty index.
+	PoseIndex() = default;
+
+	/// Build an index over a set of poses.
+	/**
+	 * \throws std::invalid_argument if the rotation weight is negative.
+	 */
+	explicit PoseIndex(
+		std::vector<Eigen::Isometry3d> const & poses, ///< The poses to index.
+		double rotation_weight = 1,                   ///< The distance that counts as much as a rotation of one radian.
+		unsigned int threads = 0                      ///< Number of threads used to build the index, zero to use defaultThreadCount().
+	);
+
+	/// Build an index over a set of poses, for example loaded with fromXmlRpc<Pose>.
+	/**
+	 * The frame information of the poses is ignored.
+	 *
+	 * \throws std::invalid_argument if the rotation weight is negative.
+	 */
+	explicit PoseIndex(
+		std::vector<Pose> const & poses, ///< The poses to index.
+		double rotation_weight = 1,      ///< The distance that counts as much as a rotation of one radian.
+		unsigned int threads = 0         ///< Number of threads used to build the index, zero to use defaultThreadCount().
+	);
+
+	/// Get the number of poses in the index.
+	std::size_t size() const { return tree_.size(); }
+
+	/// Get the rotation weight of the distance metric.
+	double rotationWeight() const { return rotation_weight_; }
+
+	/// Get the distance between two poses under the metric of the index.
+	double distance(Eigen::Isometry3d const & a, Eigen::Isometry3d const & b) const;
+
+	/// Find the k nearest poses to a query pose.
+	/**
+	 * The result is sorted by increasing distance and holds the squared distances.
+	 * The result vector is cleared first, so reusing it between queries avoids most allocations.
+	 */
+	void knn(Eigen::Isometry3d const & query, std::size_t k, std::vector<Neighbor> & result) const;
+
+	/// Find the nearest pose to a query pose.
+	/**
+	 * \throws std::logic_error if the index is empty.
+	 */
+	Neighbor nearest(Eigen::Isometry3d const & query) const;
+
+	/// Find all poses within a distance of a query pose.
+	/**
+	 * The result is sorted by index and holds the squared distances.
+	 * The result vector is cleared first, so reusing it between queries avoids most allocations.
+	 */
+	void radius(Eigen::Isometry3d const & query, double radius, std::vector<Neighbor> & result) const;
+
+	/// Find the k nearest poses to every query pose in parallel.
+	void knn(std::vector<Eigen::Isometry3d> const & queries, std::size_t k, std::vector<std::vector<Neighbor>> & result, unsigned int threads = 0) const;
+
+	/// Find all poses within a distance of every query pose in parallel.
+	void radius(std::vector<Eigen::Isometry3d> const & queries, double radius, std::vector<std::vector<Neighbor>> & result, unsigned int threads = 0) const;
+
+private:
+	using Embedding = Eigen::Matrix<double, 7, 1>;
+
+	/// Embed a pose as a 7D point, optionally with the sign of the quaternion flipped.
+	Embedding embed(Eigen::Isometry3d const & pose, bool flip) const;
+
+	/// The distance that counts as much as a rotation of one radian.
+	double rotation_weight_ = 1;
+
+	/// The tree over the embedded poses.
+	KdTree<double, 7> tree_;
+};
+
+}
@@ -0,0 +1,278 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "eigen.hpp"
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dr {
+
+/// The type of the records in a pose log.
+enum class PoseLogType : std::uint32_t {
+	vector     = 1,
+	quaternion = 2,
+	isometry   = 3,
+	pose       = 4,
+};
+
+/// Compact binary log of vectors, quaternions, isometries or poses.
+/**
+ * All values in a pose log are little-endian. A pose log consists of:
+ *
+ * A 64 byte header:
+ *   offset  0: char[8]  magic "DRPOSLOG"
+ *   offset  8: uint32   format version, currently 1
+ *   offset 12: uint32   record type, a PoseLogType
+ *   offset 16: uint32   flags, bit 0 is set if records have a timestamp
+ *   offset 20: uint32   record stride in bytes
+ *   offset 24: uint64   number of records
+ *   offset 32: uint64   file offset of the frame table
+ *   offset 40: 24 bytes reserved, zero
+ *
+ * The records, starting at offset 64, each `stride` bytes, with the fields in this order:
+ *   int64      timestamp in nanoseconds, if the timestamp flag is set
+ *   uint32[2]  parent and child frame as index in the frame table, for pose records only
+ *   double[3]  x, y, z of the position, for vector, isometry and pose records
+ *   double[4]  x, y, z, w of the orientation, for quaternion, isometry and pose records
+ *
+ * The frame table, after the records:
+ *   char[8]    magic "DRFRAMES"
+ *   uint32     number of frame names
+ *   uint32     reserved, zero
+ *   for each frame name: a uint32 length followed by the name without terminating null byte
+ *
+ * Timestamps of the records in a log are non-decreasing.
+ */
+struct PoseLogFormat {
+	/// The size of the header in bytes.
+	static constexpr std::size_t header_size = 64;
+
+	/// The current format version.
+	static constexpr std::uint32_t version = 1;
+
+	/// The flag for records with a timestamp.
+	static constexpr std::uint32_t timestamp_flag = 1;
+
+	/// Get the record stride for a record type.
+	static std::size_t stride(PoseLogType type, bool timestamps);
+};
+
+/// Options for a PoseLogWriter.
+struct PoseLogWriterOptions {
+	/// Store a timestamp with every record.
+	bool timestamps = false;
+
+	/// Append to an existing log instead of replacing it. The existing log must have the same type and timestamp flag.
+	bool append = false;
+
+	/// Size of the record buffer in bytes. The buffer is written out when it is full.
+	std::size_t buffer_size = 1 << 16;
+};
+
+/// Writer for pose logs.
+/**
+ * Records are buffered and written to the end of the file.
+ * The header and frame table are updated by flush() and close(),
+ * so the file is only a complete log after one of those.
+ */
+class PoseLogWriter {
+public:
+	/// Create or open a pose log.
+	/**
+	 * \throws std::system_error if the file can not be opened.
+	 * \throws std::runtime_error if appending to a file that is not a pose log of the same type.
+	 */
+	PoseLogWriter(std::string const & path, PoseLogType type, PoseLogWriterOptions const & options = {});
+
+	PoseLogWriter(PoseLogWriter const &) = delete;
+	PoseLogWriter & operator=(PoseLogWriter const &) = delete;
+
+	/// Close the writer, ignoring errors. Call close() to see errors.
+	~PoseLogWriter();
+
+	/// Append a vector to a vector log.
+	/**
+	 * \throws std::logic_error if the log has a different type or has timestamps.
+	 */
+	void append(Eigen::Vector3d const & vector);
+
+	/// Append a quaternion to a quaternion log.
+	void append(Eigen::Quaterniond const & quaternion);
+
+	/// Append an isometry to an isometry log.
+	void append(Eigen::Isometry3d const & isometry);
+
+	/// Append a pose to a pose log.
+	void append(Pose const & pose);
+
+	/// Append a vector with a timestamp to a vector log.
+	/**
+	 * \throws std::logic_error if the log has a different type or has no timestamps.
+	 * \throws std::invalid_argument if the timestamp is before the timestamp of the last record.
+	 */
+	void append(std::int64_t timestamp, Eigen::Vector3d const & vector);
+
+	/// Append a quaternion with a timestamp to a quaternion log.
+	void append(std::int64_t timestamp, Eigen::Quaterniond const & quaternion);
+
+	/// Append an isometry with a timestamp to an isometry log.
+	void append(std::int64_t timestamp, Eigen::Isometry3d const & isometry);
+
+	/// Append a pose with a timestamp to a pose log.
+	void append(std::int64_t timestamp, Pose const & pose);
+
+	/// The number of records in the log, including records that are not yet written.
+	std::size_t size() const { return count_; }
+
+	/// Write buffered records, the frame table and the header.
+	/**
+	 * \throws std::system_error if writing failed.
+	 */
+	void flush();
+
+	/// Flush and close the file. The writer can not be used anymore after it was closed.
+	/**
+	 * \throws std::system_error if writing failed.
+	 */
+	void close();
+
+private:
+	/// Append a pose with an optional timestamp.
+	void appendPose(std::int64_t const * timestamp, Pose const & pose);
+
+	/// Check that a record can be appended.
+	void checkRecord(PoseLogType type, std::int64_t const * timestamp) const;
+
+	/// Start a record in the buffer and return a pointer to the first byte after the timestamp.
+	char * beginRecord(PoseLogType type, std::int64_t const * timestamp);
+
+	/// Write the buffer if it is full.
+	void maybeFlush();
+
+	/// Write the buffered records to the file.
+	void writeRecords();
+
+	/// Get the index of a frame name, adding it to the frame table if needed.
+	std::uint32_t internFrame(std::string const & name);
+
+	int fd_ = -1;
+	PoseLogType type_;
+	PoseLogWriterOptions options_;
+	std::size_t stride_;
+
+	/// The number of records, including buffered records.
+	std::size_t count_ = 0;
+
+	/// The file offset where the next buffered records are written.
+	std::uint64_t records_end_ = PoseLogFormat::header_size;
+
+	/// The timestamp of the last record.
+	std::int64_t last_timestamp_;
+
+	/// Buffered records.
+	std::vector<char> buffer_;
+
+	/// The frame table.
+	std::vector<std::string> frames_;
+
+	/// Index of the frame table.
+	std::unordered_map<std::string, std::uint32_t> frame_index_;
+};
+
+/// Reader for pose logs.
+/**
+ * The file is memory mapped and records are accessed in place,
+ * so opening a log takes constant time and memory regardless of the number of records.
+ *
+ * Record accessors do not check the index. It must be smaller than size().
+ */
+class PoseLogReader {
+public:
+	/// Open a pose log.
+	/**
+	 * \throws std::system_error if the file can not be read.
+	 * \throws std::runtime_error if the file is not a valid pose log.
+	 */
+	explicit PoseLogReader(std::string const & path);
+
+	/// The type of the records.
+	PoseLogType type() const { return type_; }
+
+	/// Check if the records have timestamps.
+	bool hasTimestamps() const { return timestamps_; }
+
+	/// The number of records.
+	std::size_t size() const { return size_; }
+
+	/// The frame table.
+	std::vector<std::string> const & frames() const { return frames_; }
+
+	/// The timestamp of a record in nanoseconds, or 0 if the records do not have timestamps.
+	std::int64_t timestamp(std::size_t index) const;
+
+	/// The position of a record, or the vector of a vector record.
+	/**
+	 * \throws std::logic_error if the records do not have a position.
+	 */
+	Eigen::Map<Eigen::Vector3d const> position(std::size_t index) const;
+
+	/// The orientation of a record.
+	/**
+	 * \throws std::logic_error if the records do not have an orientation.
+	 */
+	Eigen::Map<Eigen::Quaterniond const> orientation(std::size_t index) const;
+
+	/// The isometry of an isometry or pose record.
+	Eigen::Isometry3d isometry(std::size_t index) const;
+
+	/// The parent frame of a pose record.
+	/**
+	 * \throws std::logic_error if the records are not poses.
+	 * \throws std::runtime_error if the frame index of the record is not in the frame table.
+	 */
+	std::string const & parentFrame(std::size_t index) const;
+
+	/// The child frame of a pose record.
+	std::string const & childFrame(std::size_t index) const;
+
+	/// A pose record.
+	Pose pose(std::size_t index) const;
+
+	/// Find the first record with a timestamp not before the given timestamp, or size() if there is none.
+	/**
+	 * \throws std::logic_error if the records do not have timestamps.
+	 */
+	std::size_t lowerBound(std::int64_t timestamp) const;
+
+	/// Find the first record with a timestamp after the given timestamp, or size() if there is none.
+	std::size_t upperBound(std::int64_t timestamp) const;
+
+private:
+	/// Get a pointer to a record.
+	char const * record(std::size_t index) const { return records_ + index * stride_; }
+
+	/// Get a frame name by the index stored in a record.
+	std::string const & frame(std::size_t index, std::size_t field) const;
+
+	MappedFile file_;
+	PoseLogType type_;
+	bool timestamps_;
+	std::size_t stride_;
+	std::size_t size_;
+
+	/// The first record.
+	char const * records_;
+
+	/// Offset of the position and orientation in a record, or -1 if not present.
+	std::ptrdiff_t position_offset_;
+	std::ptrdiff_t orientation_offset_;
+
+	std::vector<std::string> frames_;
+};
+
+}
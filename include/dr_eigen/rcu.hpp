@@ -0,0 +1,141 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace dr {
+
+/// Tracks readers of values that are replaced with read-copy-update.
+/**
+ * Readers register in one of two counters, selected by the current epoch.
+ * Entering and leaving a read-side section is wait-free: a load and an atomic increment or decrement.
+ *
+ * A writer first publishes a new value and then calls synchronize(),
+ * which flips the epoch twice and waits for both counters to drain.
+ * Afterwards no reader can still hold the old value, so it can be destroyed.
+ */
+class RcuDomain {
+public:
+	RcuDomain() = default;
+	RcuDomain(RcuDomain const &) = delete;
+	RcuDomain & operator=(RcuDomain const &) = delete;
+
+	/// Enter a read-side section and return the token to pass to unlock().
+	unsigned int lock() const noexcept {
+		unsigned int parity = epoch_.load() & 1;
+		readers_[parity].fetch_add(1);
+		return parity;
+	}
+
+	/// Leave a read-side section.
+	void unlock(unsigned int token) const noexcept {
+		readers_[token].fetch_sub(1);
+	}
+
+	/// Wait until all read-side sections that were entered before this call have been left.
+	/**
+	 * Must not be called from inside a read-side section of the same domain, or it will never return.
+	 */
+	void synchronize() {
+		std::lock_guard<std::mutex> lock{writer_mutex_};
+
+		// New readers use the other counter after a flip, so each counter drains even under constant reading.
+		// Waiting for both counters also catches readers that loaded the epoch just before a flip.
+		for (int i = 0; i < 2; ++i) {
+			unsigned int old_parity = epoch_.fetch_add(1) & 1;
+			while (readers_[old_parity].load() != 0) std::this_thread::yield();
+		}
+	}
+
+private:
+	mutable std::atomic<unsigned int> epoch_{0};
+	mutable std::array<std::atomic<std::size_t>, 2> readers_{{{0}, {0}}};
+	std::mutex writer_mutex_;
+};
+
+/// A value that is read wait-free and replaced as a whole with read-copy-update.
+/**
+ * Readers get a guard from read() that keeps the current value alive.
+ * Writers build a new value and publish() it, which waits for readers of the old value before destroying it.
+ * Guards should be short-lived, since a writer waits for all of them.
+ */
+template<typename T>
+class RcuCell {
+public:
+	/// Guard that gives access to the value that was current when it was created.
+	class Reader {
+	public:
+		Reader(Reader && other) noexcept : domain_{other.domain_}, token_{other.token_}, value_{other.value_} {
+			other.domain_ = nullptr;
+		}
+
+		Reader(Reader const &) = delete;
+		Reader & operator=(Reader const &) = delete;
+		Reader & operator=(Reader &&) = delete;
+
+		~Reader() {
+			if (domain_) domain_->unlock(token_);
+		}
+
+		T const & operator*()  const { return *value_; }
+		T const * operator->() const { return value_; }
+		T const * get()        const { return value_; }
+
+	private:
+		explicit Reader(RcuDomain const & domain, std::atomic<T const *> const & value) :
+			domain_{&domain},
+			token_{domain.lock()},
+			value_{value.load()} {}
+
+		RcuDomain const * domain_;
+		unsigned int token_;
+		T const * value_;
+
+		friend class RcuCell;
+	};
+
+	/// Create a cell holding a value.
+	explicit RcuCell(std::unique_ptr<T const> value) : value_{value.release()} {}
+
+	RcuCell(RcuCell const &) = delete;
+	RcuCell & operator=(RcuCell const &) = delete;
+
+	~RcuCell() {
+		delete value_.load();
+	}
+
+	/// Get a guard for the current value.
+	Reader read() const {
+		return Reader{domain_, value_};
+	}
+
+	/// Get the current value without a guard.
+	/**
+	 * Only safe for the thread that publishes new values, while no other thread publishes.
+	 */
+	T const & writerValue() const {
+		return *value_.load();
+	}
+
+	/// Replace the value and destroy the old value once no reader can use it anymore.
+	/**
+	 * Blocks until all readers of the old value are done.
+	 * Must not be called while the calling thread holds a Reader of this cell.
+	 */
+	void publish(std::unique_ptr<T const> value) {
+		std::unique_ptr<T const> old{value_.exchange(value.release())};
+		domain_.synchronize();
+	}
+
+private:
+	RcuDomain domain_;
+	std::atomic<T const *> value_;
+};
+
+}
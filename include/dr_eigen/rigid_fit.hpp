@@ -0,0 +1,239 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+#include <Eigen/Eigenvalues>
+#include <Eigen/SVD>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace dr {
+
+/// Closed form solver used to fit a rigid transformation.
+enum class RigidFitMethod {
+	/// Kabsch / Umeyama: singular value decomposition of the cross-covariance matrix.
+	svd,
+
+	/// Horn: largest eigenvector of the 4x4 quaternion matrix built from the cross-covariance matrix.
+	quaternion,
+};
+
+/// Streaming accumulator to fit a rigid transformation to point correspondences.
+/**
+ * The accumulator only keeps the weighted centroids and the 3x3 cross-covariance of the correspondences,
+ * updated with Welford's online algorithm, so it uses constant memory regardless of the number of correspondences.
+ * Accumulators filled on different threads or batches can be merged.
+ *
+ * The fitted isometry maps source points onto target points in the least squares sense.
+ */
+template<typename DataType>
+class RigidFitAccumulator {
+public:
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+	using Vector3   = Eigen::Matrix<DataType, 3, 1>;
+	using Matrix3   = Eigen::Matrix<DataType, 3, 3>;
+	using Matrix3X  = Eigen::Matrix<DataType, 3, Eigen::Dynamic>;
+	using Isometry3 = Eigen::Transform<DataType, 3, Eigen::Isometry>;
+
+	/// Construct an empty accumulator.
+	RigidFitAccumulator() {
+		clear();
+	}
+
+	/// Remove all correspondences.
+	void clear() {
+		count_         = 0;
+		weight_        = 0;
+		source_mean_   = Vector3::Zero();
+		target_mean_   = Vector3::Zero();
+		cross_         = Matrix3::Zero();
+		source_moment_ = 0;
+		target_moment_ = 0;
+	}
+
+	/// Add a single correspondence.
+	/**
+	 * Correspondences with a weight of zero or less are ignored.
+	 */
+	void add(Vector3 const & source, Vector3 const & target, DataType weight = 1) {
+		if (weight <= 0) return;
+		++count_;
+		weight_ += weight;
+		DataType factor = weight / weight_;
+
+		Vector3 source_delta = source - source_mean_;
+		Vector3 target_delta = target - target_mean_;
+		source_mean_ += factor * source_delta;
+		target_mean_ += factor * target_delta;
+
+		cross_         += weight * source_delta * (target - target_mean_).transpose();
+		source_moment_ += weight * source_delta.dot(source - source_mean_);
+		target_moment_ += weight * target_delta.dot(target - target_mean_);
+	}
+
+	/// Add a batch of correspondences, one per column.
+	template<typename Source, typename Target>
+	void add(Eigen::MatrixBase<Source> const & sources, Eigen::MatrixBase<Target> const & targets) {
+		ensureBatchSize(sources, targets, sources.cols());
+		addBatch(sources, targets, [] (Eigen::Index) { return DataType(1); });
+	}
+
+	/// Add a batch of weighted correspondences, one per column.
+	/**
+	 * Correspondences with a weight of zero or less are ignored.
+	 */
+	template<typename Source, typename Target, typename Weights>
+	void add(Eigen::MatrixBase<Source> const & sources, Eigen::MatrixBase<Target> const & targets, Eigen::MatrixBase<Weights> const & weights) {
+		ensureBatchSize(sources, targets, weights.size());
+		addBatch(sources, targets, [&] (Eigen::Index i) { return DataType(weights(i)); });
+	}
+
+	/// Merge the correspondences of another accumulator into this one.
+	void merge(RigidFitAccumulator const & other) {
+		if (other.weight_ <= 0) return;
+		if (weight_ <= 0) {
+			*this = other;
+			return;
+		}
+
+		DataType weight = weight_ + other.weight_;
+		DataType factor = weight_ * other.weight_ / weight;
+		Vector3 source_delta = other.source_mean_ - source_mean_;
+		Vector3 target_delta = other.target_mean_ - target_mean_;
+
+		cross_         += other.cross_ + factor * source_delta * target_delta.transpose();
+		source_moment_ += other.source_moment_ + factor * source_delta.squaredNorm();
+		target_moment_ += other.target_moment_ + factor * target_delta.squaredNorm();
+		source_mean_   += source_delta * (other.weight_ / weight);
+		target_mean_   += target_delta * (other.weight_ / weight);
+		count_  += other.count_;
+		weight_  = weight;
+	}
+
+	/// Get the number of correspondences with a positive weight.
+	std::size_t count() const { return count_; }
+
+	/// Get the total weight of all correspondences.
+	DataType weight() const { return weight_; }
+
+	/// Get the weighted centroid of the source points.
+	Vector3 const & sourceCentroid() const { return source_mean_; }
+
+	/// Get the weighted centroid of the target points.
+	Vector3 const & targetCentroid() const { return target_mean_; }
+
+	/// Get the weighted cross-covariance of the centered source and target points, not normalized by the total weight.
+	Matrix3 const & crossCovariance() const { return cross_; }
+
+	/// Fit the rigid transformation that maps the source points onto the target points.
+	/**
+	 * \throws std::logic_error if no correspondences have been added.
+	 */
+	Isometry3 solve(RigidFitMethod method = RigidFitMethod::svd) const {
+		if (weight_ <= 0) throw std::logic_error("Cannot fit a rigid transformation without correspondences.");
+
+		Matrix3 rotation = method == RigidFitMethod::svd ? solveSvd() : solveQuaternion();
+		Isometry3 result = Isometry3::Identity();
+		result.linear()      = rotation;
+		result.translation() = target_mean_ - rotation * source_mean_;
+		return result;
+	}
+
+	/// Get the weighted sum of squared distances between the transformed source points and the target points.
+	DataType residual(Isometry3 const & transform) const {
+		Vector3 offset = transform * source_mean_ - target_mean_;
+		DataType result = source_moment_ + target_moment_ - 2 * (transform.linear() * cross_).trace() + weight_ * offset.squaredNorm();
+		return std::max(result, DataType(0));
+	}
+
+private:
+	/// Add a batch of correspondences without copying them.
+	/**
+	 * The batch is accumulated in two passes over the columns, first the weighted means and then the centered moments.
+	 * That is as accurate as centering the whole batch up front, but needs no memory proportional to the batch size.
+	 */
+	template<typename Source, typename Target, typename WeightFunction>
+	void addBatch(Eigen::MatrixBase<Source> const & sources, Eigen::MatrixBase<Target> const & targets, WeightFunction const & weight_of) {
+		RigidFitAccumulator batch;
+		Vector3 source_sum = Vector3::Zero();
+		Vector3 target_sum = Vector3::Zero();
+		for (Eigen::Index i = 0; i < sources.cols(); ++i) {
+			DataType weight = weight_of(i);
+			if (weight <= 0) continue;
+			++batch.count_;
+			batch.weight_ += weight;
+			source_sum    += weight * sources.col(i);
+			target_sum    += weight * targets.col(i);
+		}
+		if (batch.weight_ <= 0) return;
+
+		batch.source_mean_ = source_sum / batch.weight_;
+		batch.target_mean_ = target_sum / batch.weight_;
+		for (Eigen::Index i = 0; i < sources.cols(); ++i) {
+			DataType weight = weight_of(i);
+			if (weight <= 0) continue;
+			Vector3 source_centered = sources.col(i) - batch.source_mean_;
+			Vector3 target_centered = targets.col(i) - batch.target_mean_;
+			batch.cross_         += weight * source_centered * target_centered.transpose();
+			batch.source_moment_ += weight * source_centered.squaredNorm();
+			batch.target_moment_ += weight * target_centered.squaredNorm();
+		}
+		merge(batch);
+	}
+
+	template<typename Source, typename Target>
+	static void ensureBatchSize(Eigen::MatrixBase<Source> const & sources, Eigen::MatrixBase<Target> const & targets, Eigen::Index weights) {
+		if (sources.rows() != 3 || targets.rows() != 3) throw std::logic_error("Correspondences must be given as 3xN matrices.");
+		if (sources.cols() != targets.cols() || sources.cols() != weights) {
+			throw std::logic_error("Number of source points (" + std::to_string(sources.cols()) + "), target points (" + std::to_string(targets.cols()) + ") and weights (" + std::to_string(weights) + ") differ.");
+		}
+	}
+
+	Matrix3 solveSvd() const {
+		Eigen::JacobiSVD<Matrix3> svd(cross_, Eigen::ComputeFullU | Eigen::ComputeFullV);
+		Matrix3 correction = Matrix3::Identity();
+		// Prevent a reflection.
+		correction(2, 2) = (svd.matrixV() * svd.matrixU().transpose()).determinant() < 0 ? -1 : 1;
+		return svd.matrixV() * correction * svd.matrixU().transpose();
+	}
+
+	Matrix3 solveQuaternion() const {
+		Matrix3 const & s = cross_;
+		Eigen::Matrix<DataType, 4, 4> n;
+		n <<
+			s(0, 0) + s(1, 1) + s(2, 2), s(1, 2) - s(2, 1),            s(2, 0) - s(0, 2),            s(0, 1) - s(1, 0),
+			s(1, 2) - s(2, 1),            s(0, 0) - s(1, 1) - s(2, 2), s(0, 1) + s(1, 0),            s(2, 0) + s(0, 2),
+			s(2, 0) - s(0, 2),            s(0, 1) + s(1, 0),           -s(0, 0) + s(1, 1) - s(2, 2), s(1, 2) + s(2, 1),
+			s(0, 1) - s(1, 0),            s(2, 0) + s(0, 2),            s(1, 2) + s(2, 1),           -s(0, 0) - s(1, 1) + s(2, 2);
+		Eigen::SelfAdjointEigenSolver<Eigen::Matrix<DataType, 4, 4>> solver(n);
+		Eigen::Matrix<DataType, 4, 1> largest = solver.eigenvectors().col(3);
+		return Eigen::Quaternion<DataType>(largest(0), largest(1), largest(2), largest(3)).toRotationMatrix();
+	}
+
+	/// The number of correspondences.
+	std::size_t count_;
+
+	/// The total weight of all correspondences.
+	DataType weight_;
+
+	/// The weighted mean of the source points.
+	Vector3 source_mean_;
+
+	/// The weighted mean of the target points.
+	Vector3 target_mean_;
+
+	/// The weighted sum of the outer products of the source and target deviations from their means.
+	Matrix3 cross_;
+
+	/// The weighted sum of the squared deviations of the source points from their mean.
+	DataType source_moment_;
+
+	/// The weighted sum of the squared deviations of the target points from their mean.
+	DataType target_moment_;
+};
+
+}
@@ -0,0 +1,33 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+
+namespace dr {
+
+/// Robust loss applied to the residuals of a least squares problem.
+enum class RobustLoss {
+	/// Plain least squares.
+	squared,
+
+	/// Huber loss: quadratic below the loss scale, linear above it.
+	huber,
+
+	/// Cauchy loss: strongly down-weights residuals far above the loss scale.
+	cauchy,
+};
+
+/// Get the weight of a residual for iteratively reweighted least squares.
+/**
+ * The residual is the non-negative norm of the residual vector, and the scale is where the loss starts to down-weight it.
+ */
+template<typename Scalar>
+Scalar robustWeight(RobustLoss loss, Scalar scale, Scalar residual) {
+	switch (loss) {
+		case RobustLoss::squared: return 1;
+		case RobustLoss::huber:   return residual <= scale ? 1 : scale / residual;
+		case RobustLoss::cauchy:  return 1 / (1 + (residual / scale) * (residual / scale));
+	}
+	return 1;
+}
+
+}
@@ -2,6 +2,8 @@
 
 #pragma once
 #include "eigen.hpp"
+#include "instrument.hpp"
+#include "normalize.hpp"
 
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/Point32.h>
@@ -15,36 +17,60 @@ namespace dr {
 
 /// Convert a ROS Point to an Eigen vector.
 inline Eigen::Vector3d toEigen(geometry_msgs::Point const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
 	return Eigen::Vector3d(vector.x, vector.y, vector.z);
 }
 
 /// Convert a ROS Point32 to an Eigen vector.
 inline Eigen::Vector3f toEigen(geometry_msgs::Point32 const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
 	return Eigen::Vector3f(vector.x, vector.y, vector.z);
 }
 
 /// Convert a ROS Vector3 to an Eigen vector.
 inline Eigen::Vector3d toEigen(geometry_msgs::Vector3 const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
 	return Eigen::Vector3d(vector.x, vector.y, vector.z);
 }
 
 /// Convert a ROS Quaternion to an Eigen quaternion.
 inline Eigen::Quaterniond toEigen(geometry_msgs::Quaternion const & quaternion) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
 	return Eigen::Quaterniond(quaternion.w, quaternion.x, quaternion.y, quaternion.z);
 }
 
+/// Convert a ROS Quaternion to an Eigen quaternion, normalizing it if the mode asks for it.
+inline Eigen::Quaterniond toEigen(geometry_msgs::Quaternion const & quaternion, NormalizeMode mode) {
+	return normalize(toEigen(quaternion), mode);
+}
+
 /// Convert a ROS Pose to an Eigen isometry.
 inline Eigen::Isometry3d toEigen(geometry_msgs::Pose const & pose) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
 	return translate(toEigen(pose.position)) * toEigen(pose.orientation);
 }
 
+/// Convert a ROS Pose to an Eigen isometry, normalizing the orientation if the mode asks for it.
+inline Eigen::Isometry3d toEigen(geometry_msgs::Pose const & pose, NormalizeMode mode) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
+	return translate(toEigen(pose.position)) * toEigen(pose.orientation, mode);
+}
+
 /// Convert a ROS transform to an Eigen isometry.
 inline Eigen::Isometry3d toEigen(geometry_msgs::Transform const & transform) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
 	return translate(toEigen(transform.translation)) * toEigen(transform.rotation);
 }
 
+/// Convert a ROS transform to an Eigen isometry, normalizing the rotation if the mode asks for it.
+inline Eigen::Isometry3d toEigen(geometry_msgs::Transform const & transform, NormalizeMode mode) {
+	DR_EIGEN_INSTRUMENT_COUNT(ros_to_eigen, 1);
+	return translate(toEigen(transform.translation)) * toEigen(transform.rotation, mode);
+}
+
 /// Convert an Eigen vector to a ROS Point.
 inline geometry_msgs::Point toRosPoint(Eigen::Vector3d const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	geometry_msgs::Point result;
 	result.x = vector.x();
 	result.y = vector.y();
@@ -54,6 +80,7 @@ inline geometry_msgs::Point toRosPoint(Eigen::Vector3d const & vector) {
 
 /// Convert an Eigen vector to a ROS Point32.
 inline geometry_msgs::Point32 toRosPoint32(Eigen::Vector3f const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	geometry_msgs::Point32 result;
 	result.x = vector.x();
 	result.y = vector.y();
@@ -63,6 +90,7 @@ inline geometry_msgs::Point32 toRosPoint32(Eigen::Vector3f const & vector) {
 
 /// Convert an Eigen vector to a ROS Vector3.
 inline geometry_msgs::Vector3 toRosVector3(Eigen::Vector3d const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	geometry_msgs::Vector3 result;
 	result.x = vector.x();
 	result.y = vector.y();
@@ -72,6 +100,7 @@ inline geometry_msgs::Vector3 toRosVector3(Eigen::Vector3d const & vector) {
 
 /// Convert an Eigen quaternion to a ROS Quaternion.
 inline geometry_msgs::Quaternion toRosQuaternion(Eigen::Quaterniond const & quaternion) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	geometry_msgs::Quaternion result;
 	result.w = quaternion.w();
 	result.x = quaternion.x();
@@ -82,11 +111,13 @@ inline geometry_msgs::Quaternion toRosQuaternion(Eigen::Quaterniond const & quat
 
 /// Convert an Eigen angle axis to a ROS Quaternion.
 inline geometry_msgs::Quaternion toRosQuaternion(Eigen::AngleAxisd const & angle_axis) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	return toRosQuaternion(Eigen::Quaterniond(angle_axis));
 }
 
 /// Convert an Eigen isometry to a ROS Pose.
 inline geometry_msgs::Pose toRosPose(Eigen::Isometry3d const & pose) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	geometry_msgs::Pose result;
 	result.position    = toRosPoint(pose.translation());
 	result.orientation = toRosQuaternion(Eigen::Quaterniond(pose.rotation()));
@@ -95,6 +126,7 @@ inline geometry_msgs::Pose toRosPose(Eigen::Isometry3d const & pose) {
 
 inline geometry_msgs::PoseStamped toRosPoseStamped(
 	Eigen::Isometry3d const & pose, std::string frame_id, ros::Time const & time = ros::Time::now()) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	geometry_msgs::PoseStamped result;
 	result.header.frame_id  = frame_id;
 	result.header.stamp     = time;
@@ -105,6 +137,7 @@ inline geometry_msgs::PoseStamped toRosPoseStamped(
 
 /// Convert an Eigen isometry to a ROS Transform.
 inline geometry_msgs::Transform toRosTransform(Eigen::Isometry3d const & transform) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_ros, 1);
 	geometry_msgs::Transform result;
 	result.translation = toRosVector3(transform.translation());
 	result.rotation    = toRosQuaternion(Eigen::Quaterniond(transform.rotation()));
@@ -0,0 +1,99 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <vector>
+
+namespace dr {
+
+/// Smooth trajectory through a sequence of timed keyframes.
+/**
+ * The position is interpolated with a natural cubic spline, giving continuous velocity and acceleration at every keyframe.
+ * The orientation is interpolated with SQUAD (spherical quadrangle interpolation), giving a smooth rotation through every keyframe.
+ *
+ * All segment coefficients are computed once on construction.
+ * Evaluating the spline does not allocate and only needs a binary search to find the segment.
+ * Times outside of the keyframe range are clamped to the first or last keyframe.
+ */
+class PoseSpline {
+public:
+	/// Construct a spline through a sequence of poses.
+	/**
+	 * \throws std::invalid_argument if there are less than two keyframes,
+	 *   if the number of poses and times differs or if the times are not strictly increasing.
+	 */
+	PoseSpline(
+		std::vector<Eigen::Isometry3d> const & poses, ///< The keyframe poses.
+		std::vector<double> const & times             ///< The time of each keyframe.
+	);
+
+	/// Get the time of the first keyframe.
+	double startTime() const { return times_.front(); }
+
+	/// Get the time of the last keyframe.
+	double endTime() const { return times_.back(); }
+
+	/// Get the number of segments between keyframes.
+	std::size_t segments() const { return segments_.size(); }
+
+	/// Get the interpolated pose at a given time.
+	Eigen::Isometry3d pose(double time) const;
+
+	/// Get the interpolated position at a given time.
+	Eigen::Vector3d position(double time) const;
+
+	/// Get the linear velocity at a given time.
+	Eigen::Vector3d velocity(double time) const;
+
+	/// Get the linear acceleration at a given time.
+	Eigen::Vector3d acceleration(double time) const;
+
+	/// Get the interpolated orientation at a given time.
+	Eigen::Quaterniond orientation(double time) const;
+
+	/// Get the angular velocity at a given time, expressed in the parent frame of the keyframes.
+	Eigen::Vector3d angularVelocity(double time) const;
+
+private:
+	/// Precomputed coefficients of a single segment.
+	struct Segment {
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+		/// Duration of the segment.
+		double duration;
+
+		/// Inverse of the duration of the segment.
+		double inverse_duration;
+
+		/// Polynomial coefficients of the position, in order of increasing power of the time since the segment start.
+		Eigen::Vector3d position[4];
+
+		/// Orientation at the start of the segment.
+		Eigen::Quaterniond rotation_start;
+
+		/// SQUAD control point at the start of the segment.
+		Eigen::Quaterniond control_start;
+
+		/// Half angle-axis vector of the rotation from the start to the end orientation.
+		Eigen::Vector3d rotation_delta;
+
+		/// Half angle-axis vector of the rotation from the start to the end control point.
+		Eigen::Vector3d control_delta;
+	};
+
+	/// Find the segment for a time and compute the time since the start of that segment, clamped to the segment.
+	Segment const & lookup(double time, double & offset) const;
+
+	/// Evaluate the orientation of a segment at a normalized time in the range [0, 1].
+	static Eigen::Quaterniond squad(Segment const & segment, double factor);
+
+	/// Keyframe times.
+	std::vector<double> times_;
+
+	/// Segment coefficients.
+	std::vector<Segment, Eigen::aligned_allocator<Segment>> segments_;
+};
+
+}
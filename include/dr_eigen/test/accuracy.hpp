@@ -0,0 +1,134 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace dr {
+
+/// Get the error of a vector compared to a reference in units of the last place of the largest reference component.
+/**
+ * Measuring every component in its own ULPs is meaningless for components close to zero,
+ * so the error is measured relative to the magnitude of the whole vector instead.
+ */
+template<typename Derived, typename ReferenceDerived>
+double ulpError(Eigen::MatrixBase<Derived> const & actual, Eigen::MatrixBase<ReferenceDerived> const & reference) {
+	using Scalar = typename Derived::Scalar;
+	long double magnitude = std::max<long double>(reference.template cast<long double>().cwiseAbs().maxCoeff(), std::numeric_limits<Scalar>::min());
+	long double error     = (actual.template cast<long double>() - reference.template cast<long double>()).cwiseAbs().maxCoeff();
+	long double ulp       = std::ldexp(static_cast<long double>(std::numeric_limits<Scalar>::epsilon()), std::ilogb(magnitude));
+	return static_cast<double>(error / ulp);
+}
+
+/// Get the error of a quaternion compared to a reference in ULPs, ignoring the sign of the quaternion.
+template<typename Scalar, typename ReferenceScalar>
+double ulpError(Eigen::Quaternion<Scalar> const & actual, Eigen::Quaternion<ReferenceScalar> const & reference) {
+	Eigen::Matrix<long double, 4, 1> expected = reference.coeffs().template cast<long double>();
+	if (actual.coeffs().template cast<long double>().dot(expected) < 0) expected = -expected;
+	return ulpError(actual.coeffs(), expected);
+}
+
+/// Get the angle in radians of the rotation between two quaternions, ignoring the sign of the quaternions.
+template<typename Scalar, typename ReferenceScalar>
+double angularError(Eigen::Quaternion<Scalar> const & actual, Eigen::Quaternion<ReferenceScalar> const & reference) {
+	Eigen::Quaternion<long double> difference = reference.template cast<long double>().conjugate() * actual.template cast<long double>();
+	return static_cast<double>(2 * std::atan2(difference.vec().norm(), std::abs(difference.w())));
+}
+
+/// Maximum and mean errors of a kernel over an input set.
+struct AccuracyStats {
+	std::size_t count   = 0;
+	double max_ulp      = 0;
+	double mean_ulp     = 0;
+	double max_radians  = 0;
+	double mean_radians = 0;
+
+	/// Add the error of one result.
+	void add(double ulp, double radians = 0) {
+		++count;
+		max_ulp       = std::max(max_ulp, ulp);
+		max_radians   = std::max(max_radians, radians);
+		mean_ulp     += (ulp - mean_ulp) / count;
+		mean_radians += (radians - mean_radians) / count;
+	}
+};
+
+/// The accuracy and speed budget of a kernel on an input set.
+struct AccuracyBudget {
+	/// The maximum error in ULPs.
+	double max_ulp;
+
+	/// The maximum error in radians.
+	double max_radians;
+
+	/// The maximum time per operation relative to a quaternion product measured in the same run.
+	double max_cost;
+};
+
+/// Measure the time per call of a function in nanoseconds, as the fastest of several rounds.
+/**
+ * The function is called with the index of the call in the round, and its results are summed to keep them from being optimized away.
+ */
+template<typename Function>
+double measureNanoseconds(std::size_t count, Function && function, int rounds = 5) {
+	double best = std::numeric_limits<double>::infinity();
+	double volatile sink = 0;
+	for (int round = 0; round < rounds; ++round) {
+		double sum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < count; ++i) sum += function(i);
+		auto end   = std::chrono::steady_clock::now();
+		sink = sink + sum;
+		best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / count);
+	}
+	return best;
+}
+
+/// Print the accuracy and speed of a kernel and check them against a budget.
+/**
+ * Speed is only checked in optimized builds, since the relative cost of kernels differs too much without optimization.
+ */
+inline testing::AssertionResult checkAccuracyBudget(
+	std::string const & kernel,
+	std::string const & inputs,
+	AccuracyStats const & stats,
+	double nanoseconds,
+	double reference_nanoseconds,
+	AccuracyBudget const & budget
+) {
+	double cost = nanoseconds / reference_nanoseconds;
+	std::printf("%-24s %-16s max %9.3g ulp  mean %9.3g ulp  max %9.3g rad  mean %9.3g rad  %8.1f ns/op  %6.2fx\n",
+		kernel.c_str(), inputs.c_str(), stats.max_ulp, stats.mean_ulp, stats.max_radians, stats.mean_radians, nanoseconds, cost);
+
+	if (stats.count == 0) {
+		return testing::AssertionFailure() << kernel << " on " << inputs << ": no results";
+	}
+
+	std::ostringstream failures;
+	if (!(stats.max_ulp <= budget.max_ulp)) {
+		failures << "\n  max error " << stats.max_ulp << " ulp exceeds budget " << budget.max_ulp << " ulp";
+	}
+	if (!(stats.max_radians <= budget.max_radians)) {
+		failures << "\n  max error " << stats.max_radians << " rad exceeds budget " << budget.max_radians << " rad";
+	}
+#ifdef NDEBUG
+	if (!(cost <= budget.max_cost)) {
+		failures << "\n  relative cost " << cost << " exceeds budget " << budget.max_cost;
+	}
+#endif
+	if (failures.tellp() == 0) return testing::AssertionSuccess();
+	return testing::AssertionFailure() << kernel << " on " << inputs << ":" << failures.str();
+}
+
+}
@@ -2,6 +2,8 @@
 
 #pragma once
 #include "eigen.hpp"
+#include "instrument.hpp"
+#include "normalize.hpp"
 
 #include <tf/tf.h>
 #include <tf/LinearMath/Matrix3x3.h>
@@ -14,21 +16,36 @@ namespace dr {
 
 /// Convert a TF vector to an Eigen vector.
 inline Eigen::Vector3d toEigen(tf::Vector3 const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(tf_to_eigen, 1);
 	return Eigen::Vector3d(vector.x(), vector.y(), vector.z());
 }
 
 /// Convert a TF quaternion to an Eigen Quaternion.
 inline Eigen::Quaterniond toEigen(tf::Quaternion const & quaternion) {
+	DR_EIGEN_INSTRUMENT_COUNT(tf_to_eigen, 1);
 	return Eigen::Quaterniond(quaternion.w(), quaternion.x(), quaternion.y(), quaternion.z());
 }
 
+/// Convert a TF quaternion to an Eigen Quaternion, normalizing it if the mode asks for it.
+inline Eigen::Quaterniond toEigen(tf::Quaternion const & quaternion, NormalizeMode mode) {
+	return normalize(toEigen(quaternion), mode);
+}
+
 /// Convert a TF transform to an Eigen isometry.
 inline Eigen::Isometry3d toEigen(tf::Transform const & transform) {
+	DR_EIGEN_INSTRUMENT_COUNT(tf_to_eigen, 1);
 	return Eigen::Isometry3d(translate(toEigen(transform.getOrigin())) * toEigen(transform.getRotation()));
 }
 
-/// Convert a TF transform to an Eigen isometry.
+/// Convert a TF transform to an Eigen isometry, normalizing the rotation if the mode asks for it.
+inline Eigen::Isometry3d toEigen(tf::Transform const & transform, NormalizeMode mode) {
+	DR_EIGEN_INSTRUMENT_COUNT(tf_to_eigen, 1);
+	return Eigen::Isometry3d(translate(toEigen(transform.getOrigin())) * toEigen(transform.getRotation(), mode));
+}
+
+/// Convert a TF matrix to an Eigen matrix.
 inline Eigen::Matrix3d toEigen(tf::Matrix3x3 const & matrix) {
+	DR_EIGEN_INSTRUMENT_COUNT(tf_to_eigen, 1);
 	Eigen::Matrix3d result;
 	result <<
 		matrix[0][0], matrix[0][1], matrix[0][2],
@@ -37,18 +54,29 @@ inline Eigen::Matrix3d toEigen(tf::Matrix3x3 const & matrix) {
 	return result;
 }
 
+/// Convert a TF matrix to an Eigen matrix, orthonormalizing it as rotation matrix if the mode asks for it.
+/**
+ * \throws std::invalid_argument if the matrix needs to be orthonormalized and its determinant is not positive.
+ */
+inline Eigen::Matrix3d toEigen(tf::Matrix3x3 const & matrix, NormalizeMode mode) {
+	return normalize(toEigen(matrix), mode);
+}
+
 /// Convert a TF vector to an Eigen vector.
 inline tf::Vector3 toTfVector3(Eigen::Vector3d const & vector) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_tf, 1);
 	return tf::Vector3(vector.x(), vector.y(), vector.z());
 }
 
 /// Convert a TF quaternion to an Eigen Quaternion.
 inline tf::Quaternion toTfQuaternion(Eigen::Quaterniond const & quaternion) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_tf, 1);
 	return tf::Quaternion(quaternion.x(), quaternion.y(), quaternion.z(), quaternion.w());
 }
 
 /// Convert a TF quaternion to an Eigen Quaternion.
 inline tf::Matrix3x3 toTfMatrix3x3(Eigen::Matrix3d const & matrix) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_tf, 1);
 	return tf::Matrix3x3(
 		matrix(0, 0), matrix(0, 1), matrix(0, 2),
 		matrix(1, 0), matrix(1, 1), matrix(1, 2),
@@ -58,6 +86,7 @@ inline tf::Matrix3x3 toTfMatrix3x3(Eigen::Matrix3d const & matrix) {
 
 /// Convert a TF transform to an Eigen isometry.
 inline tf::Transform toTfTransform(Eigen::Isometry3d const & transform) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_tf, 1);
 	return tf::Transform(
 		toTfMatrix3x3(transform.rotation()),
 		toTfVector3(transform.translation())
@@ -70,6 +99,7 @@ inline tf::StampedTransform toTfStampedTransform(
 	std::string const & child_frame,
 	ros::Time const & time = ros::Time::now()
 ) {
+	DR_EIGEN_INSTRUMENT_COUNT(eigen_to_tf, 1);
 	return tf::StampedTransform(toTfTransform(transform), time, parent_frame, child_frame);
 }
 
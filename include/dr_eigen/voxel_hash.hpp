@@ -0,0 +1,236 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "kd_tree.hpp"
+#include "parallel.hpp"
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+namespace detail {
+	/// Pack voxel coordinates into a single 64 bit key, 21 bits per axis.
+	inline std::uint64_t voxelKey(Eigen::Vector3i const & voxel) {
+		std::uint64_t mask = (std::uint64_t(1) << 21) - 1;
+		return
+			(std::uint64_t(std::uint32_t(voxel.x())) & mask) << 42 |
+			(std::uint64_t(std::uint32_t(voxel.y())) & mask) << 21 |
+			(std::uint64_t(std::uint32_t(voxel.z())) & mask);
+	}
+
+	/// Open addressing hash table with linear probing from voxel keys to 32 bit values.
+	class VoxelTable {
+	public:
+		/// Key of an unused slot, which can not be produced by voxelKey() since it only uses 63 bits.
+		static constexpr std::uint64_t empty_key = ~std::uint64_t(0);
+
+		/// A slot of the table.
+		struct Slot {
+			std::uint64_t key;
+			std::uint32_t value;
+		};
+
+		/// Remove all keys and size the table for a load factor of at most one half with the given number of keys.
+		/**
+		 * The storage is reused if it is large enough.
+		 */
+		void reset(std::size_t keys) {
+			std::size_t capacity = 16;
+			while (capacity < 2 * keys) capacity *= 2;
+			slots_.assign(capacity, Slot{empty_key, 0});
+			mask_ = capacity - 1;
+		}
+
+		/// Find the slot of a key, or the empty slot where it would be inserted.
+		Slot & probe(std::uint64_t key) {
+			std::size_t index = hash(key) & mask_;
+			while (slots_[index].key != key && slots_[index].key != empty_key) index = (index + 1) & mask_;
+			return slots_[index];
+		}
+
+		/// Find the slot of a key, or the empty slot where it would be inserted.
+		Slot const & probe(std::uint64_t key) const {
+			return const_cast<VoxelTable &>(*this).probe(key);
+		}
+
+	private:
+		/// Mix the bits of a voxel key, since the packed coordinates hash poorly with an identity hash.
+		static std::uint64_t hash(std::uint64_t key) {
+			key ^= key >> 33;
+			key *= 0xff51afd7ed558ccdull;
+			key ^= key >> 33;
+			key *= 0xc4ceb9fe1a85ec53ull;
+			key ^= key >> 33;
+			return key;
+		}
+
+		/// The slots, with a power of two size.
+		std::vector<Slot> slots_;
+
+		/// The number of slots minus one.
+		std::size_t mask_ = 0;
+	};
+}
+
+/// Uniform voxel grid over a 3D point set, stored as a flat hash table from voxel to a contiguous block of points.
+/**
+ * Building the grid takes constant time per point: one pass to count the points per voxel and one pass to scatter them.
+ * Radius queries only visit the voxels that overlap the bounding cube of the query sphere,
+ * so they are efficient when the radius is in the order of the voxel size.
+ *
+ * Building the grid is several times cheaper than building a KdTree, while queries are somewhat slower.
+ * That makes the grid the better choice for point sets that only receive a few queries, such as a new frame per sensor update.
+ *
+ * Voxel coordinates are limited to 21 bits per axis, so the extent of the point set should stay below 2^20 voxels per axis.
+ */
+template<typename Scalar>
+class VoxelHash {
+public:
+	using Vector3  = Eigen::Matrix<Scalar, 3, 1>;
+	using Matrix3X = Eigen::Matrix<Scalar, 3, Eigen::Dynamic>;
+	using Neighbor = dr::Neighbor<Scalar>;
+
+	/// Construct an empty grid.
+	VoxelHash() = default;
+
+	/// Build a grid over a set of points, one point per column.
+	VoxelHash(Matrix3X const & points, Scalar voxel_size) {
+		build(points, voxel_size);
+	}
+
+	/// Rebuild the grid over a new set of points, one point per column.
+	/**
+	 * The storage of the previous grid is reused where possible.
+	 *
+	 * \throws std::invalid_argument if the voxel size is not positive.
+	 * \throws std::length_error if there are more than 2^32 - 1 points.
+	 */
+	void build(Matrix3X const & points, Scalar voxel_size) {
+		if (!(voxel_size > 0)) throw std::invalid_argument("voxel size must be positive, got " + std::to_string(voxel_size));
+		if (points.cols() > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("too many points for a voxel hash: " + std::to_string(points.cols()));
+		voxel_size_         = voxel_size;
+		inverse_voxel_size_ = 1 / voxel_size;
+
+		std::size_t count = points.cols();
+		keys_.resize(count);
+		offsets_.clear();
+
+		table_.reset(count);
+
+		// Count the points per voxel, assigning voxel indices in order of first appearance.
+		std::vector<std::uint32_t> & sizes = offsets_;
+		for (std::size_t i = 0; i < count; ++i) {
+			keys_[i] = detail::voxelKey(voxel(points.col(i)));
+			detail::VoxelTable::Slot & slot = table_.probe(keys_[i]);
+			if (slot.key == detail::VoxelTable::empty_key) {
+				slot = detail::VoxelTable::Slot{keys_[i], std::uint32_t(sizes.size())};
+				sizes.push_back(0);
+			}
+			++sizes[slot.value];
+		}
+
+		// Turn the sizes into offsets.
+		std::uint32_t total = 0;
+		for (std::uint32_t & offset : offsets_) {
+			std::uint32_t size = offset;
+			offset = total;
+			total += size;
+		}
+		offsets_.push_back(total);
+
+		// Scatter the points into their voxels.
+		points_.resize(3, count);
+		order_.resize(count);
+		fill_.assign(offsets_.begin(), offsets_.end() - 1);
+		for (std::size_t i = 0; i < count; ++i) {
+			std::uint32_t target = fill_[table_.probe(keys_[i]).value]++;
+			points_.col(target) = points.col(i);
+			order_[target]      = i;
+		}
+	}
+
+	/// Get the number of points in the grid.
+	std::size_t size() const { return order_.size(); }
+
+	/// Get the number of occupied voxels.
+	std::size_t voxels() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+
+	/// Get the voxel size.
+	Scalar voxelSize() const { return voxel_size_; }
+
+	/// Get the integer coordinates of the voxel containing a point.
+	Eigen::Vector3i voxel(Vector3 const & point) const {
+		return (point * inverse_voxel_size_).array().floor().template cast<int>().matrix();
+	}
+
+	/// Find all points within a radius of a query point.
+	/**
+	 * The result is not sorted.
+	 * The result vector is cleared first, so reusing it between queries avoids allocations.
+	 */
+	void radius(Vector3 const & query, Scalar radius, std::vector<Neighbor> & result) const {
+		result.clear();
+		if (order_.empty()) return;
+		Scalar squared_radius = radius * radius;
+		Eigen::Vector3i min = voxel((query.array() - radius).matrix());
+		Eigen::Vector3i max = voxel((query.array() + radius).matrix());
+		for (int x = min.x(); x <= max.x(); ++x) {
+			for (int y = min.y(); y <= max.y(); ++y) {
+				for (int z = min.z(); z <= max.z(); ++z) {
+					detail::VoxelTable::Slot const & slot = table_.probe(detail::voxelKey(Eigen::Vector3i{x, y, z}));
+					if (slot.key == detail::VoxelTable::empty_key) continue;
+					for (std::uint32_t i = offsets_[slot.value]; i < offsets_[slot.value + 1]; ++i) {
+						Scalar distance = (points_.col(i) - query).squaredNorm();
+						if (distance <= squared_radius) result.push_back(Neighbor{order_[i], distance});
+					}
+				}
+			}
+		}
+	}
+
+	/// Find all points within a radius of every column of a query matrix in parallel.
+	/**
+	 * Element i of the result holds the unsorted neighbours of query i.
+	 * The inner vectors are reused, so passing the same result between calls avoids most allocations.
+	 */
+	void radius(Matrix3X const & queries, Scalar radius, std::vector<std::vector<Neighbor>> & result, unsigned int threads = 0) const {
+		result.resize(queries.cols());
+		parallelFor(queries.cols(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+			for (std::size_t i = begin; i < end; ++i) this->radius(queries.col(i), radius, result[i]);
+		}, threads, 64);
+	}
+
+private:
+	/// The voxel size.
+	Scalar voxel_size_ = 1;
+
+	/// The inverse of the voxel size.
+	Scalar inverse_voxel_size_ = 1;
+
+	/// Hash table from voxel key to voxel index.
+	detail::VoxelTable table_;
+
+	/// The index of the first point of every voxel, followed by the total number of points.
+	std::vector<std::uint32_t> offsets_;
+
+	/// The points grouped by voxel.
+	Matrix3X points_;
+
+	/// The original index of every grouped point.
+	std::vector<std::uint32_t> order_;
+
+	/// Scratch space: the voxel key of every input point.
+	std::vector<std::uint64_t> keys_;
+
+	/// Scratch space: the next free slot of every voxel while scattering.
+	std::vector<std::uint32_t> fill_;
+};
+
+}
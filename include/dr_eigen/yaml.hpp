@@ -7,6 +7,30 @@
 
 namespace dr {
 
+/// Append a number to a YAML document.
+/**
+ * The number is written with the shortest decimal representation that parses back to exactly the same double,
+ * independent of the current locale.
+ * The output always contains a decimal point so YAML parsers read it as a float,
+ * and infinity and NaN are written as .inf, -.inf and .nan.
+ */
+void appendYaml(std::string & output, double value);
+
+/// Append a vector to a YAML document.
+void appendYaml(std::string & output, Eigen::Vector3d const & vector);
+
+/// Append a quaternion to a YAML document.
+void appendYaml(std::string & output, Eigen::Quaterniond const & quaternion);
+
+/// Append an isometry to a YAML document.
+void appendYaml(std::string & output, Eigen::Isometry3d const & pose, std::string const & indent = "");
+
+/// Append a pose header to a YAML document.
+void appendYaml(std::string & output, PoseHeader const & header, std::string const & indent = "");
+
+/// Append a pose to a YAML document, in the format read by fromXmlRpc<Pose>.
+void appendYaml(std::string & output, Pose const & pose, std::string const & indent = "");
+
 /// Convert a vector to YAML.
 std::string toYaml(Eigen::Vector3d const & vector);
 
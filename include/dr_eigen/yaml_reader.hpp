@@ -0,0 +1,252 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "eigen.hpp"
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dr {
+
+class YamlDocument;
+
+/// A node in a parsed YAML document.
+/**
+ * A node is a cheap view into a YamlDocument and must not outlive it.
+ */
+class YamlNode {
+public:
+	/// The type of a node.
+	enum class Type : std::uint8_t {
+		null,
+		scalar,
+		sequence,
+		map,
+	};
+
+	/// Forward iterator over the children of a sequence or map.
+	class Iterator {
+	public:
+		YamlNode operator*() const { return {document_, index_}; }
+		Iterator & operator++();
+		bool operator==(Iterator const & other) const { return index_ == other.index_; }
+		bool operator!=(Iterator const & other) const { return index_ != other.index_; }
+
+	private:
+		friend class YamlNode;
+		Iterator(YamlDocument const * document, std::size_t index) : document_{document}, index_{index} {}
+		YamlDocument const * document_;
+		std::size_t index_;
+	};
+
+	/// The type of the node.
+	Type type() const;
+
+	bool isNull()     const { return type() == Type::null;     }
+	bool isScalar()   const { return type() == Type::scalar;   }
+	bool isSequence() const { return type() == Type::sequence; }
+	bool isMap()      const { return type() == Type::map;      }
+
+	/// The line of the node in the document, starting at 1.
+	std::size_t line() const;
+
+	/// The number of children of a sequence or map, or 0 for other nodes.
+	std::size_t size() const;
+
+	/// The value of a scalar node, with quotes and escape sequences removed.
+	/**
+	 * \throws std::runtime_error if the node is not a scalar.
+	 */
+	std::string scalar() const;
+
+	/// The value of an unquoted scalar node as a number.
+	/**
+	 * Accepts decimal integers and floating point numbers, .inf, -.inf and .nan.
+	 *
+	 * \throws std::runtime_error if the node is not a number.
+	 */
+	double number() const;
+
+	/// The key of the node if it is a value in a map, or an empty string otherwise.
+	std::string key() const;
+
+	/// Check if a map has a key.
+	bool hasMember(char const * key) const;
+
+	/// Get the value of a key in a map.
+	/**
+	 * \throws std::runtime_error if the node is not a map or does not have the key.
+	 */
+	YamlNode at(char const * key) const;
+
+	/// Get an item of a sequence or map.
+	/**
+	 * \throws std::out_of_range if the index is out of range.
+	 */
+	YamlNode at(std::size_t index) const;
+
+	Iterator begin() const;
+	Iterator end() const;
+
+private:
+	friend class YamlDocument;
+	YamlNode(YamlDocument const * document, std::size_t index) : document_{document}, index_{index} {}
+
+	YamlDocument const * document_;
+	std::size_t index_;
+};
+
+/// A parsed YAML document.
+/**
+ * The parser reads the input in a single pass into a flat array of nodes.
+ * Plain scalars are not copied but refer to the input,
+ * so a document loaded from a file keeps the file mapped.
+ *
+ * The parser supports the subset of YAML used for configuration and calibration files:
+ * block and flow sequences and maps, plain, single quoted and double quoted scalars and comments.
+ * Anchors, aliases, tags, block scalars and multi-document streams are rejected.
+ */
+class YamlDocument {
+public:
+	/// Parse a YAML document from a string.
+	/**
+	 * \throws std::runtime_error if the document can not be parsed. The message contains the line of the error.
+	 */
+	static YamlDocument parse(std::string text);
+
+	/// Parse a YAML document from a file.
+	/**
+	 * \throws std::system_error if the file can not be read.
+	 * \throws std::runtime_error if the document can not be parsed. The message contains the file name and line of the error.
+	 */
+	static YamlDocument load(std::string const & path);
+
+	/// The root node of the document.
+	YamlNode root() const { return {this, 0}; }
+
+private:
+	friend class YamlNode;
+	friend class YamlParser;
+
+	/// A reference to a string in the input or in the decoded string storage.
+	struct StringRef {
+		std::size_t offset = 0;
+		std::uint32_t size = 0;
+		bool decoded       = false;
+	};
+
+	/// A node, stored in document order. The children of a node directly follow it.
+	struct Node {
+		YamlNode::Type type = YamlNode::Type::null;
+		std::uint32_t line  = 0;
+
+		/// True if the node is a quoted scalar.
+		bool quoted = false;
+
+		/// The number of children of a sequence or map.
+		std::uint32_t size = 0;
+
+		/// The index of the next node that is not a descendant of this node.
+		std::size_t end = 0;
+
+		/// The key of the node in the parent map.
+		StringRef key;
+
+		/// The value of a scalar.
+		StringRef value;
+	};
+
+	YamlDocument() = default;
+
+	/// Parse the input that was set up by parse() or load().
+	void parseInput();
+
+	/// The input text.
+	char const * input() const { return file_.size() ? file_.data() : text_.data(); }
+
+	/// The size of the input text.
+	std::size_t inputSize() const { return file_.size() ? file_.size() : text_.size(); }
+
+	/// Find the last value of a key in the map at the given index, or return the end of the map.
+	std::size_t findMember(std::size_t index, char const * key) const;
+
+	/// Get the characters of a string reference.
+	char const * data(StringRef const & ref) const { return (ref.decoded ? decoded_.data() : input()) + ref.offset; }
+
+	/// The input, if it was parsed from a string.
+	std::string text_;
+
+	/// The input, if it was loaded from a file.
+	MappedFile file_;
+
+	/// Decoded contents of quoted scalars.
+	std::string decoded_;
+
+	/// All nodes in document order.
+	std::vector<Node> nodes_;
+};
+
+/// Convert a YAML node to a value.
+/**
+ * The supported types use the same schema as fromXmlRpc.
+ *
+ * \throws std::runtime_error if the node does not describe a valid value.
+ *         The message contains the line of the offending node.
+ */
+template<typename T> T fromYaml(YamlNode const & node);
+
+/// Convert a YAML node to a double.
+template<> double fromYaml<double>(YamlNode const & node);
+
+/// Convert a YAML node to a string.
+template<> std::string fromYaml<std::string>(YamlNode const & node);
+
+/// Convert a YAML node to an Eigen::Vector3d.
+template<> Eigen::Vector3d fromYaml<Eigen::Vector3d>(YamlNode const & node);
+
+/// Convert a YAML node to an Eigen::Quaterniond, from either r, p, y or w, x, y, z.
+template<> Eigen::Quaterniond fromYaml<Eigen::Quaterniond>(YamlNode const & node);
+
+/// Convert a YAML node to an Eigen::Isometry3d.
+template<> Eigen::Isometry3d fromYaml<Eigen::Isometry3d>(YamlNode const & node);
+
+/// Convert a YAML node to an Eigen::AlignedBox3d, from either center and dimensions or min and max.
+template<> Eigen::AlignedBox3d fromYaml<Eigen::AlignedBox3d>(YamlNode const & node);
+
+/// Convert a YAML node to a PoseHeader.
+template<> PoseHeader fromYaml<PoseHeader>(YamlNode const & node);
+
+/// Convert a YAML node to a Pose.
+template<> Pose fromYaml<Pose>(YamlNode const & node);
+
+/// Load a value from a YAML file.
+/**
+ * \throws std::system_error if the file can not be read.
+ * \throws std::runtime_error if the file can not be parsed or does not describe a valid value.
+ */
+template<typename T> T loadYaml(std::string const & path) {
+	return fromYaml<T>(YamlDocument::load(path).root());
+}
+
+/// Append all poses in a YAML sequence to a vector.
+/**
+ * \throws std::runtime_error if the node is not a sequence or an item is not a valid pose.
+ */
+void posesFromYaml(YamlNode const & sequence, std::vector<Pose> & poses);
+
+/// Append all poses in a YAML sequence to a vector with aligned storage.
+void posesFromYaml(YamlNode const & sequence, std::vector<Pose, Eigen::aligned_allocator<Pose>> & poses);
+
+/// Append all isometries in a YAML sequence to a vector.
+/**
+ * \throws std::runtime_error if the node is not a sequence or an item is not a valid isometry.
+ */
+void posesFromYaml(YamlNode const & sequence, std::vector<Eigen::Isometry3d> & poses);
+
+/// Append all isometries in a YAML sequence to a vector with aligned storage.
+void posesFromYaml(YamlNode const & sequence, std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> & poses);
+
+}
@@ -0,0 +1,211 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#pragma once
+#include "eigen.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dr {
+
+/// Options for a PoseYamlWriter.
+struct PoseYamlWriterOptions {
+	/// Size of the output buffer in bytes. The buffer is written out when it is full.
+	std::size_t buffer_size = 1 << 16;
+
+	/// Write full buffers on a background thread while the next buffer is filled.
+	/**
+	 * This uses a second buffer of the same size.
+	 * Errors from the background thread are rethrown by the next call on the writer.
+	 */
+	bool background_flush = false;
+};
+
+/// Streaming YAML writer for large collections of poses.
+/**
+ * The writer emits a document consisting of sequences and maps of poses,
+ * where every pose has the same format as toYaml(Pose) and can be read with fromXmlRpc<Pose>:
+ *
+ *   left_camera:
+ *     parent_frame: world
+ *     child_frame:  left_camera
+ *     position:    {x: 0.1, y: 0.0, z: 1.2}
+ *     orientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}
+ *   grasps:
+ *     - parent_frame: object
+ *       ...
+ *
+ * The document is written through a fixed size buffer, so memory use does not grow with the number of poses.
+ * Maps and sequences can be nested under the keys of a map. Sequences hold poses or isometries only.
+ *
+ * Keys and frame names are written as plain scalars when that is unambiguous and double quoted otherwise.
+ */
+class PoseYamlWriter {
+public:
+	/// Create a writer that writes to a file descriptor. The file descriptor is not closed by the writer.
+	explicit PoseYamlWriter(int fd, PoseYamlWriterOptions const & options = {});
+
+	/// Create a writer that writes to an output stream. The stream must outlive the writer.
+	explicit PoseYamlWriter(std::ostream & stream, PoseYamlWriterOptions const & options = {});
+
+	PoseYamlWriter(PoseYamlWriter const &) = delete;
+	PoseYamlWriter & operator=(PoseYamlWriter const &) = delete;
+
+	/// Flush and close the writer, ignoring errors. Call close() to see errors.
+	~PoseYamlWriter();
+
+	/// Begin a sequence as the top level node of the document.
+	/**
+	 * \throws std::logic_error if the document already has a top level node.
+	 */
+	void beginSequence();
+
+	/// Begin a sequence as value of a key in the current map.
+	/**
+	 * \throws std::logic_error if the current node is not a map.
+	 */
+	void beginSequence(std::string const & key);
+
+	/// Begin a map as the top level node of the document.
+	/**
+	 * \throws std::logic_error if the document already has a top level node.
+	 */
+	void beginMap();
+
+	/// Begin a map as value of a key in the current map.
+	/**
+	 * \throws std::logic_error if the current node is not a map.
+	 */
+	void beginMap(std::string const & key);
+
+	/// End the current sequence or map.
+	/**
+	 * \throws std::logic_error if there is no open sequence or map.
+	 */
+	void end();
+
+	/// Add a pose to the current sequence.
+	/**
+	 * \throws std::logic_error if the current node is not a sequence.
+	 */
+	void write(Pose const & pose);
+
+	/// Add an isometry to the current sequence.
+	/**
+	 * \throws std::logic_error if the current node is not a sequence.
+	 */
+	void write(Eigen::Isometry3d const & isometry);
+
+	/// Add a pose to the current map.
+	/**
+	 * \throws std::logic_error if the current node is not a map.
+	 */
+	void write(std::string const & key, Pose const & pose);
+
+	/// Add an isometry to the current map.
+	/**
+	 * \throws std::logic_error if the current node is not a map.
+	 */
+	void write(std::string const & key, Eigen::Isometry3d const & isometry);
+
+	/// Write all buffered output and wait for background writes to finish.
+	/**
+	 * \throws std::system_error or std::runtime_error if writing failed.
+	 */
+	void flush();
+
+	/// End all open sequences and maps, then flush.
+	/**
+	 * The writer can not be used anymore after it was closed.
+	 *
+	 * \throws std::system_error or std::runtime_error if writing failed.
+	 */
+	void close();
+
+private:
+	/// An open sequence or map.
+	struct Node {
+		/// True for a map, false for a sequence.
+		bool map;
+
+		/// The indentation of the children.
+		std::size_t indent;
+
+		/// The number of children written so far.
+		std::size_t children;
+	};
+
+	/// Common construction for both sinks.
+	PoseYamlWriter(std::function<void (char const *, std::size_t)> sink, PoseYamlWriterOptions const & options);
+
+	/// Begin a sequence or map, with an optional key in the parent map.
+	void begin(bool map, std::string const * key);
+
+	/// Prepare for a new child of the current node, writing the key or sequence dash.
+	void beginChild(bool map, std::string const * key);
+
+	/// Write the fields of a pose, with the first line already indented.
+	void appendPose(PoseHeader const * header, Eigen::Isometry3d const & isometry, std::size_t indent);
+
+	/// Write the buffer if it is full.
+	void maybeFlush();
+
+	/// Hand the buffer to the sink, directly or through the background thread.
+	void flushBuffer();
+
+	/// Rethrow an error from the background thread.
+	void checkError();
+
+	/// The background thread.
+	void run();
+
+	/// The function that writes data to the file descriptor or stream.
+	std::function<void (char const *, std::size_t)> sink_;
+
+	PoseYamlWriterOptions options_;
+
+	/// The buffer that is being filled.
+	std::string buffer_;
+
+	/// The stack of open nodes.
+	std::vector<Node> nodes_;
+
+	/// True once the top level node has been started.
+	bool started_ = false;
+
+	/// True once the writer has been closed.
+	bool closed_ = false;
+
+	/// Mutex protecting the background state.
+	std::mutex mutex_;
+
+	/// Signals the background thread that there is a buffer to write, or that it should stop.
+	std::condition_variable wake_;
+
+	/// Signals the writer that the background thread finished writing.
+	std::condition_variable done_;
+
+	/// The buffer handed to the background thread.
+	std::string pending_;
+
+	/// True if the background thread has a buffer to write.
+	bool busy_ = false;
+
+	/// True if the background thread should stop.
+	bool stop_ = false;
+
+	/// The first error of the background thread.
+	std::exception_ptr error_;
+
+	/// The background thread, if background flushing is enabled.
+	std::thread thread_;
+};
+
+}
@@ -0,0 +1,186 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "hand_eye.hpp"
+#include "lie.hpp"
+#include "parallel.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace dr {
+
+namespace {
+	using Vector6d = Eigen::Matrix<double, 6, 1>;
+	using Matrix6d = Eigen::Matrix<double, 6, 6>;
+
+	/// Matrix of left multiplication with a quaternion, acting on (w, x, y, z) coefficients.
+	Eigen::Matrix4d leftMatrix(Eigen::Quaterniond const & q) {
+		Eigen::Matrix4d result;
+		result <<
+			q.w(), -q.x(), -q.y(), -q.z(),
+			q.x(),  q.w(), -q.z(),  q.y(),
+			q.y(),  q.z(),  q.w(), -q.x(),
+			q.z(), -q.y(),  q.x(),  q.w();
+		return result;
+	}
+
+	/// Matrix of right multiplication with a quaternion, acting on (w, x, y, z) coefficients.
+	Eigen::Matrix4d rightMatrix(Eigen::Quaterniond const & q) {
+		Eigen::Matrix4d result;
+		result <<
+			q.w(), -q.x(), -q.y(), -q.z(),
+			q.x(),  q.w(),  q.z(), -q.y(),
+			q.y(), -q.z(),  q.w(),  q.x(),
+			q.z(),  q.y(), -q.x(),  q.w();
+		return result;
+	}
+
+	/// Get the rotation of an isometry as quaternion with a non-negative real part.
+	Eigen::Quaterniond canonicalRotation(Eigen::Isometry3d const & isometry) {
+		Eigen::Quaterniond result{isometry.rotation()};
+		if (result.w() < 0) result.coeffs() = -result.coeffs();
+		return result;
+	}
+
+	/// Linear solve of AX = XB: rotation first, then translation.
+	Eigen::Isometry3d solveLinear(std::vector<Eigen::Isometry3d> const & a, std::vector<Eigen::Isometry3d> const & b, unsigned int threads) {
+		std::size_t chunks = parallelChunks(a.size(), threads);
+
+		// Rotation: (L(qa) - R(qb)) * qx = 0 for every pair, solved as the smallest eigenvector of the normal matrix.
+		std::vector<Eigen::Matrix4d> rotation_normals(chunks, Eigen::Matrix4d::Zero());
+		parallelFor(a.size(), [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			for (std::size_t i = begin; i < end; ++i) {
+				Eigen::Matrix4d difference = leftMatrix(canonicalRotation(a[i])) - rightMatrix(canonicalRotation(b[i]));
+				rotation_normals[chunk] += difference.transpose() * difference;
+			}
+		}, threads);
+		Eigen::Matrix4d rotation_normal = Eigen::Matrix4d::Zero();
+		for (Eigen::Matrix4d const & normal : rotation_normals) rotation_normal += normal;
+
+		Eigen::SelfAdjointEigenSolver<Eigen::Matrix4d> solver(rotation_normal);
+		Eigen::Vector4d smallest = solver.eigenvectors().col(0);
+		Eigen::Quaterniond rotation{smallest(0), smallest(1), smallest(2), smallest(3)};
+		rotation.normalize();
+		Eigen::Matrix3d rotation_matrix = rotation.toRotationMatrix();
+
+		// Translation: (Ra - I) * tx = Rx * tb - ta for every pair, solved in the least squares sense.
+		std::vector<Eigen::Matrix3d> translation_normals(chunks, Eigen::Matrix3d::Zero());
+		std::vector<Eigen::Vector3d> translation_rhs(chunks, Eigen::Vector3d::Zero());
+		parallelFor(a.size(), [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			for (std::size_t i = begin; i < end; ++i) {
+				Eigen::Matrix3d coefficients = a[i].linear() - Eigen::Matrix3d::Identity();
+				Eigen::Vector3d constant     = rotation_matrix * b[i].translation() - a[i].translation();
+				translation_normals[chunk] += coefficients.transpose() * coefficients;
+				translation_rhs[chunk]     += coefficients.transpose() * constant;
+			}
+		}, threads);
+		Eigen::Matrix3d translation_normal = Eigen::Matrix3d::Zero();
+		Eigen::Vector3d rhs                = Eigen::Vector3d::Zero();
+		for (std::size_t i = 0; i < chunks; ++i) {
+			translation_normal += translation_normals[i];
+			rhs                += translation_rhs[i];
+		}
+
+		return Eigen::Translation3d{translation_normal.ldlt().solve(rhs)} * rotation;
+	}
+
+	/// Normal equations and errors of the refinement problem at a given solution.
+	struct Evaluation {
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+		Matrix6d hessian  = Matrix6d::Zero();
+		Vector6d gradient = Vector6d::Zero();
+		double rotation_error    = 0;
+		double translation_error = 0;
+
+		void merge(Evaluation const & other) {
+			hessian           += other.hessian;
+			gradient          += other.gradient;
+			rotation_error    += other.rotation_error;
+			translation_error += other.translation_error;
+		}
+	};
+
+	/// Evaluate the residuals E = (AX)^-1 * XB of all motion pairs and their Jacobians to a right perturbation of X.
+	Evaluation evaluate(std::vector<Eigen::Isometry3d> const & a, std::vector<Eigen::Isometry3d> const & b, Eigen::Isometry3d const & x, HandEyeOptions const & options) {
+		Vector6d scale;
+		scale << Eigen::Vector3d::Constant(options.translation_weight), Eigen::Vector3d::Ones();
+
+		std::vector<Evaluation> evaluations(parallelChunks(a.size(), options.threads));
+		Eigen::Isometry3d x_inverse = x.inverse();
+		parallelFor(a.size(), [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			Evaluation & evaluation = evaluations[chunk];
+			for (std::size_t i = begin; i < end; ++i) {
+				Eigen::Isometry3d error = x_inverse * a[i].inverse() * x * b[i];
+				Vector6d residual = se3Log<double>(error);
+				Matrix6d jacobian = se3RightJacobianInverse(residual) * se3Adjoint<double>(b[i].inverse()) - se3LeftJacobianInverse(residual);
+
+				Vector6d weighted_residual = scale.asDiagonal() * residual;
+				Matrix6d weighted_jacobian = scale.asDiagonal() * jacobian;
+				double weight = robustWeight(options.loss, options.loss_scale, weighted_residual.norm());
+
+				evaluation.hessian  += weight * weighted_jacobian.transpose() * weighted_jacobian;
+				evaluation.gradient += weight * weighted_jacobian.transpose() * weighted_residual;
+				evaluation.rotation_error    += residual.tail<3>().squaredNorm();
+				evaluation.translation_error += error.translation().squaredNorm();
+			}
+		}, options.threads);
+
+		for (std::size_t i = 1; i < evaluations.size(); ++i) evaluations[0].merge(evaluations[i]);
+		return evaluations[0];
+	}
+}
+
+HandEyeResult calibrateHandEye(std::vector<Eigen::Isometry3d> const & a, std::vector<Eigen::Isometry3d> const & b, HandEyeOptions const & options) {
+	if (a.size() != b.size()) throw std::invalid_argument("number of A motions (" + std::to_string(a.size()) + ") differs from number of B motions (" + std::to_string(b.size()) + ")");
+	if (a.size() < 2) throw std::invalid_argument("hand-eye calibration needs at least two motion pairs, got " + std::to_string(a.size()));
+
+	HandEyeResult result;
+	result.initial    = solveLinear(a, b, options.threads);
+	result.transform  = result.initial;
+	result.iterations = 0;
+	result.converged  = options.max_iterations <= 0;
+
+	Evaluation evaluation = evaluate(a, b, result.transform, options);
+	while (result.iterations < options.max_iterations) {
+		Vector6d step = evaluation.hessian.ldlt().solve(-evaluation.gradient);
+		result.transform = result.transform * se3Exp(step);
+		++result.iterations;
+		evaluation = evaluate(a, b, result.transform, options);
+		if (step.norm() < options.tolerance) {
+			result.converged = true;
+			break;
+		}
+	}
+
+	result.rotation_error    = std::sqrt(evaluation.rotation_error / a.size());
+	result.translation_error = std::sqrt(evaluation.translation_error / a.size());
+	return result;
+}
+
+HandEyeMotions handEyeMotions(std::vector<Eigen::Isometry3d> const & flange_poses, std::vector<Eigen::Isometry3d> const & target_poses) {
+	if (flange_poses.size() != target_poses.size()) throw std::invalid_argument("number of flange poses (" + std::to_string(flange_poses.size()) + ") differs from number of target poses (" + std::to_string(target_poses.size()) + ")");
+
+	HandEyeMotions result;
+	if (flange_poses.size() < 2) return result;
+	result.a.reserve(flange_poses.size() - 1);
+	result.b.reserve(flange_poses.size() - 1);
+	for (std::size_t i = 0; i + 1 < flange_poses.size(); ++i) {
+		result.a.push_back(flange_poses[i + 1].inverse() * flange_poses[i]);
+		result.b.push_back(target_poses[i + 1] * target_poses[i].inverse());
+	}
+	return result;
+}
+
+HandEyeMotions handEyeMotions(std::vector<Pose> const & flange_poses, std::vector<Pose> const & target_poses) {
+	std::vector<Eigen::Isometry3d> flange;
+	std::vector<Eigen::Isometry3d> target;
+	flange.reserve(flange_poses.size());
+	target.reserve(target_poses.size());
+	for (Pose const & pose : flange_poses) flange.push_back(pose.isometry);
+	for (Pose const & pose : target_poses) target.push_back(pose.isometry);
+	return handEyeMotions(flange, target);
+}
+
+}
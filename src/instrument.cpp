@@ -0,0 +1,86 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "instrument.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace dr {
+
+namespace {
+	/// Sum the counters of all threads. The registry must be locked.
+	InstrumentSnapshot sumCounters(detail::InstrumentRegistry const & registry) {
+		InstrumentSnapshot result{};
+		for (detail::InstrumentThreadCounters const & thread : registry.threads) {
+			for (std::size_t i = 0; i < instrument_probe_count; ++i) {
+				result[i].calls       += thread.counters[i][0].load(std::memory_order_relaxed);
+				result[i].elements    += thread.counters[i][1].load(std::memory_order_relaxed);
+				result[i].nanoseconds += thread.counters[i][2].load(std::memory_order_relaxed);
+			}
+		}
+		return result;
+	}
+}
+
+char const * instrumentProbeName(InstrumentProbe probe) {
+	switch (probe) {
+		case InstrumentProbe::average_quaternions:  return "average_quaternions";
+		case InstrumentProbe::average_positions:    return "average_positions";
+		case InstrumentProbe::average_isometries:   return "average_isometries";
+		case InstrumentProbe::interpolate_rotation: return "interpolate_rotation";
+		case InstrumentProbe::interpolate_isometry: return "interpolate_isometry";
+		case InstrumentProbe::ros_to_eigen:         return "ros_to_eigen";
+		case InstrumentProbe::eigen_to_ros:         return "eigen_to_ros";
+		case InstrumentProbe::tf_to_eigen:          return "tf_to_eigen";
+		case InstrumentProbe::eigen_to_tf:          return "eigen_to_tf";
+		case InstrumentProbe::yaml_output:          return "yaml_output";
+		case InstrumentProbe::xmlrpc_parse:         return "xmlrpc_parse";
+	}
+	throw std::invalid_argument("unknown instrumentation probe: " + std::to_string(std::size_t(probe)));
+}
+
+bool instrumentationEnabled() {
+#ifdef DR_EIGEN_INSTRUMENT
+	return true;
+#else
+	return false;
+#endif
+}
+
+InstrumentSnapshot instrumentationSnapshot() {
+	detail::InstrumentRegistry & registry = detail::instrumentRegistry();
+	std::lock_guard<std::mutex> lock{registry.mutex};
+	InstrumentSnapshot result = sumCounters(registry);
+	for (std::size_t i = 0; i < instrument_probe_count; ++i) {
+		result[i].calls       -= registry.baseline[i].calls;
+		result[i].elements    -= registry.baseline[i].elements;
+		result[i].nanoseconds -= registry.baseline[i].nanoseconds;
+	}
+	return result;
+}
+
+void resetInstrumentation() {
+	detail::InstrumentRegistry & registry = detail::instrumentRegistry();
+	std::lock_guard<std::mutex> lock{registry.mutex};
+	registry.baseline = sumCounters(registry);
+}
+
+void writeInstrumentationJson(std::ostream & stream, InstrumentSnapshot const & snapshot) {
+	stream << "{\"enabled\": " << (instrumentationEnabled() ? "true" : "false") << ", \"probes\": {";
+	for (std::size_t i = 0; i < instrument_probe_count; ++i) {
+		if (i > 0) stream << ", ";
+		stream << '"' << instrumentProbeName(InstrumentProbe(i)) << "\": {"
+			<< "\"calls\": "       << snapshot[i].calls       << ", "
+			<< "\"elements\": "    << snapshot[i].elements    << ", "
+			<< "\"nanoseconds\": " << snapshot[i].nanoseconds << "}";
+	}
+	stream << "}}";
+}
+
+std::string instrumentationJson() {
+	std::ostringstream stream;
+	writeInstrumentationJson(stream, instrumentationSnapshot());
+	return stream.str();
+}
+
+}
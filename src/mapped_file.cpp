@@ -0,0 +1,70 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+namespace dr {
+
+namespace {
+	int adviceFor(MappedFileAccess access) {
+		switch (access) {
+			case MappedFileAccess::normal:     return MADV_NORMAL;
+			case MappedFileAccess::sequential: return MADV_SEQUENTIAL;
+			case MappedFileAccess::random:     return MADV_RANDOM;
+		}
+		return MADV_NORMAL;
+	}
+}
+
+MappedFile::MappedFile(std::string const & path, MappedFileAccess access) {
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) throw std::system_error(errno, std::generic_category(), "failed to open " + path);
+
+	struct stat info;
+	if (::fstat(fd, &info) != 0) {
+		int error = errno;
+		::close(fd);
+		throw std::system_error(error, std::generic_category(), "failed to stat " + path);
+	}
+
+	// Mapping an empty file fails, but an empty mapping is fine.
+	if (info.st_size > 0) {
+		void * data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			int error = errno;
+			::close(fd);
+			throw std::system_error(error, std::generic_category(), "failed to map " + path);
+		}
+		if (access != MappedFileAccess::normal) ::madvise(data, info.st_size, adviceFor(access));
+		data_ = static_cast<char const *>(data);
+		size_ = info.st_size;
+	}
+	::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile && other) noexcept :
+	data_{std::exchange(other.data_, nullptr)},
+	size_{std::exchange(other.size_, 0)} {}
+
+MappedFile & MappedFile::operator=(MappedFile && other) noexcept {
+	if (this != &other) {
+		if (data_) ::munmap(const_cast<char *>(data_), size_);
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile() {
+	if (data_) ::munmap(const_cast<char *>(data_), size_);
+}
+
+}
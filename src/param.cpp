@@ -2,10 +2,18 @@
 
 #include "param.hpp"
 #include "eigen.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <limits>
 
 namespace dr {
 
 template<> Eigen::Vector3d fromXmlRpc<Eigen::Vector3d>(XmlRpc::XmlRpcValue const & value) {
+	DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, 1);
 	ensureXmlRpcType(value, XmlRpc::XmlRpcValue::TypeStruct, "Eigen::Vector3d");
 	if (value.size() != 3) throw std::runtime_error("wrong number of components for Eigen::Vector3d: " + std::to_string(value.size()) + " (expected 3)");
 
@@ -17,6 +25,7 @@ template<> Eigen::Vector3d fromXmlRpc<Eigen::Vector3d>(XmlRpc::XmlRpcValue const
 }
 
 template<> Eigen::Quaterniond fromXmlRpc<Eigen::Quaterniond>(XmlRpc::XmlRpcValue const & value) {
+	DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, 1);
 	ensureXmlRpcType(value, XmlRpc::XmlRpcValue::TypeStruct, "Eigen::Quaterniond");
 
 	// If orientation is in rpy, convert to quaternion first.
@@ -38,6 +47,7 @@ template<> Eigen::Quaterniond fromXmlRpc<Eigen::Quaterniond>(XmlRpc::XmlRpcValue
 }
 
 template<> Eigen::Isometry3d fromXmlRpc<Eigen::Isometry3d>(XmlRpc::XmlRpcValue const & value) {
+	DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, 1);
 	ensureXmlRpcType(value, XmlRpc::XmlRpcValue::TypeStruct, "Eigen::Isometry3d");
 	if (value.size() != 2) throw std::runtime_error("wrong number of components for Eigen::Isometry3d: " + std::to_string(value.size()) + " (expected 2)");
 	// If orientation is in quaternion, just load it in like that.
@@ -47,6 +57,7 @@ template<> Eigen::Isometry3d fromXmlRpc<Eigen::Isometry3d>(XmlRpc::XmlRpcValue c
 }
 
 template<> Eigen::AlignedBox3d fromXmlRpc<Eigen::AlignedBox3d>(XmlRpc::XmlRpcValue const & value) {
+	DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, 1);
 	ensureXmlRpcType(value, XmlRpc::XmlRpcValue::TypeStruct, "Eigen::AlignedBox3d");
 	if (value.size() != 2) throw std::runtime_error("wrong number of components for Eigen::AlignedBox3d: " + std::to_string(value.size()) + " (expected 2)");
 
@@ -64,6 +75,7 @@ template<> Eigen::AlignedBox3d fromXmlRpc<Eigen::AlignedBox3d>(XmlRpc::XmlRpcVal
 }
 
 template<> PoseHeader fromXmlRpc<PoseHeader>(XmlRpc::XmlRpcValue const & value) {
+	DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, 1);
 	ensureXmlRpcType(value, XmlRpc::XmlRpcValue::TypeStruct, "PoseHeader");
 	if (value.size() != 2) throw std::runtime_error("wrong number of components for PoseHeader: " + std::to_string(value.size()) + " (expected 2)");
 
@@ -71,6 +83,7 @@ template<> PoseHeader fromXmlRpc<PoseHeader>(XmlRpc::XmlRpcValue const & value)
 }
 
 template<> Pose fromXmlRpc<Pose>(XmlRpc::XmlRpcValue const & value) {
+	DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, 1);
 	ensureXmlRpcType(value, XmlRpc::XmlRpcValue::TypeStruct, "Pose");
 	if (value.size() != 4) throw std::runtime_error("wrong number of components for Pose: " + std::to_string(value.size()) + " (expected 4)");
 
@@ -79,4 +92,414 @@ template<> Pose fromXmlRpc<Pose>(XmlRpc::XmlRpcValue const & value) {
 	return Pose{header, isometry};
 }
 
+XmlRpcBulkError::XmlRpcBulkError(std::string const & type, std::vector<XmlRpcConversionError> errors) :
+	std::runtime_error([&] () {
+		std::string message = "failed to convert " + std::to_string(errors.size()) + " value" + (errors.size() == 1 ? "" : "s") + " for " + type + ":";
+		for (XmlRpcConversionError const & error : errors) message += "\n\t" + error.path + ": " + error.message;
+		return message;
+	}()),
+	errors_{std::move(errors)} {}
+
+namespace {
+	using XmlRpc::XmlRpcValue;
+
+	/// The path to a value in a parameter tree, only turned into a string for error messages.
+	struct ValuePath {
+		ValuePath const * parent;
+
+		/// The key of a struct member, or nullptr for an array element.
+		std::string const * key;
+
+		/// The index of an array element.
+		std::size_t index;
+
+		std::string str() const {
+			std::string result = parent ? parent->str() : "";
+			if (!key) return result + "[" + std::to_string(index) + "]";
+			return result.empty() ? *key : result + "." + *key;
+		}
+	};
+
+	/// Member names, created once instead of for every lookup.
+	namespace keys {
+		std::string const x            = "x";
+		std::string const y            = "y";
+		std::string const z            = "z";
+		std::string const w            = "w";
+		std::string const r            = "r";
+		std::string const p            = "p";
+		std::string const position     = "position";
+		std::string const orientation  = "orientation";
+		std::string const parent_frame = "parent_frame";
+		std::string const child_frame  = "child_frame";
+		std::string const center       = "center";
+		std::string const dimensions   = "dimensions";
+		std::string const min          = "min";
+		std::string const max          = "max";
+	}
+
+	/// Converts values without throwing, recording every error with its path.
+	class BulkConverter {
+	public:
+		explicit BulkConverter(std::vector<XmlRpcConversionError> & errors) : errors_{errors} {}
+
+		bool convert(XmlRpcValue const & value, ValuePath const & path, double & result) {
+			// XmlRpcValue only has non-const conversion operators.
+			XmlRpcValue & mutable_value = const_cast<XmlRpcValue &>(value);
+			if (value.getType() == XmlRpcValue::TypeDouble) {
+				result = double(mutable_value);
+				return true;
+			} else if (value.getType() == XmlRpcValue::TypeInt) {
+				result = int(mutable_value);
+				return true;
+			}
+			return error(path, "expected a number");
+		}
+
+		bool convert(XmlRpcValue const & value, ValuePath const & path, std::string & result) {
+			if (value.getType() != XmlRpcValue::TypeString) return error(path, "expected a string");
+			result = static_cast<std::string &>(const_cast<XmlRpcValue &>(value));
+			return true;
+		}
+
+		bool convert(XmlRpcValue const & value, ValuePath const & path, Eigen::Vector3d & result) {
+			std::array<XmlRpcValue const *, 3> found;
+			bool valid = checkStruct(value, path, "Eigen::Vector3d", 3);
+			valid &= findMembers(value, path, {{&keys::x, &keys::y, &keys::z}}, found);
+			valid &= member(found[0], path, keys::x, result.x());
+			valid &= member(found[1], path, keys::y, result.y());
+			valid &= member(found[2], path, keys::z, result.z());
+			return valid;
+		}
+
+		bool convert(XmlRpcValue const & value, ValuePath const & path, Eigen::Quaterniond & result) {
+			if (!checkStruct(value, path, "Eigen::Quaterniond", 0)) return false;
+
+			if (value.size() == 3) {
+				std::array<XmlRpcValue const *, 3> found;
+				Eigen::Vector3d rpy = Eigen::Vector3d::Zero();
+				bool valid = findMembers(value, path, {{&keys::r, &keys::p, &keys::y}}, found);
+				valid &= member(found[0], path, keys::r, rpy.x());
+				valid &= member(found[1], path, keys::p, rpy.y());
+				valid &= member(found[2], path, keys::y, rpy.z());
+				if (valid) result = rpyToQuaternion(rpy);
+				return valid;
+			} else if (value.size() == 4) {
+				std::array<XmlRpcValue const *, 4> found;
+				bool valid = findMembers(value, path, {{&keys::w, &keys::x, &keys::y, &keys::z}}, found);
+				valid &= member(found[0], path, keys::w, result.w());
+				valid &= member(found[1], path, keys::x, result.x());
+				valid &= member(found[2], path, keys::y, result.y());
+				valid &= member(found[3], path, keys::z, result.z());
+				return valid;
+			}
+			return error(path, "wrong number of components for Eigen::Quaterniond: " + std::to_string(value.size()) + " (expected 3 or 4)");
+		}
+
+		bool convert(XmlRpcValue const & value, ValuePath const & path, Eigen::Isometry3d & result) {
+			std::array<XmlRpcValue const *, 2> found;
+			Eigen::Vector3d position;
+			Eigen::Quaterniond orientation;
+			bool valid = checkStruct(value, path, "Eigen::Isometry3d", 2);
+			valid &= findMembers(value, path, {{&keys::position, &keys::orientation}}, found);
+			valid &= member(found[0], path, keys::position,    position);
+			valid &= member(found[1], path, keys::orientation, orientation);
+			if (valid) result = Eigen::Translation3d(position) * orientation;
+			return valid;
+		}
+
+		bool convert(XmlRpcValue const & value, ValuePath const & path, Pose & result) {
+			Eigen::Vector3d position;
+			Eigen::Quaterniond orientation;
+			std::array<XmlRpcValue const *, 4> found;
+			bool valid = checkStruct(value, path, "Pose", 4);
+			valid &= findMembers(value, path, {{&keys::parent_frame, &keys::child_frame, &keys::position, &keys::orientation}}, found);
+			valid &= member(found[0], path, keys::parent_frame, result.header.parent_frame);
+			valid &= member(found[1], path, keys::child_frame,  result.header.child_frame);
+			valid &= member(found[2], path, keys::position,     position);
+			valid &= member(found[3], path, keys::orientation,  orientation);
+			if (valid) result.isometry = Eigen::Translation3d(position) * orientation;
+			return valid;
+		}
+
+		bool convert(XmlRpcValue const & value, ValuePath const & path, Eigen::AlignedBox3d & result) {
+			if (!checkStruct(value, path, "Eigen::AlignedBox3d", 2)) return false;
+
+			std::array<XmlRpcValue const *, 2> found;
+			Eigen::Vector3d a;
+			Eigen::Vector3d b;
+			if (value.hasMember(keys::center) && value.hasMember(keys::dimensions)) {
+				bool valid = findMembers(value, path, {{&keys::center, &keys::dimensions}}, found);
+				valid &= member(found[0], path, keys::center,     a);
+				valid &= member(found[1], path, keys::dimensions, b);
+				if (valid) result = makeCenteredBox(a, b);
+				return valid;
+			} else if (value.hasMember(keys::min) && value.hasMember(keys::max)) {
+				bool valid = findMembers(value, path, {{&keys::min, &keys::max}}, found);
+				valid &= member(found[0], path, keys::min, a);
+				valid &= member(found[1], path, keys::max, b);
+				if (valid) result = Eigen::AlignedBox3d{a, b};
+				return valid;
+			}
+			return error(path, "wrong members for Eigen::AlignedBox3d: need either center and dimensions or min and max");
+		}
+
+	private:
+		bool error(ValuePath const & path, std::string message) {
+			errors_.push_back({path.str(), std::move(message)});
+			return false;
+		}
+
+		/// Check that a value is a struct, and if size is not zero, that it has that many members.
+		bool checkStruct(XmlRpcValue const & value, ValuePath const & path, char const * type, int size) {
+			if (value.getType() != XmlRpcValue::TypeStruct) return error(path, std::string{"expected a struct for "} + type);
+			if (size && value.size() != size) {
+				return error(path, std::string{"wrong number of components for "} + type + ": " + std::to_string(value.size()) + " (expected " + std::to_string(size) + ")");
+			}
+			return true;
+		}
+
+		/// Convert a member found by findMembers(), if it was found.
+		template<typename T>
+		bool member(XmlRpcValue const * value, ValuePath const & path, std::string const & key, T & result) {
+			return value && convert(*value, ValuePath{&path, &key, 0}, result);
+		}
+
+		/// Find the members of a struct in a single pass over the struct, instead of looking up every key.
+		template<std::size_t N>
+		bool findMembers(XmlRpcValue const & value, ValuePath const & path, std::array<std::string const *, N> const & names, std::array<XmlRpcValue const *, N> & found) {
+			found.fill(nullptr);
+			if (value.getType() != XmlRpcValue::TypeStruct) return false;
+
+			// XmlRpcValue can only be iterated when it is not const.
+			XmlRpcValue & mutable_value = const_cast<XmlRpcValue &>(value);
+			for (XmlRpcValue::iterator i = mutable_value.begin(); i != mutable_value.end(); ++i) {
+				for (std::size_t n = 0; n < N; ++n) {
+					if (!found[n] && i->first == *names[n]) {
+						found[n] = &i->second;
+						break;
+					}
+				}
+			}
+
+			bool valid = true;
+			for (std::size_t n = 0; n < N; ++n) {
+				if (!found[n]) valid = error(path, "missing member " + *names[n]);
+			}
+			return valid;
+		}
+
+		std::vector<XmlRpcConversionError> & errors_;
+	};
+
+	/// The minimum number of elements converted per thread.
+	constexpr std::size_t bulk_chunk_size = 256;
+
+	/// Merge the errors of all chunks and throw if there are any.
+	void throwBulkErrors(std::vector<std::vector<XmlRpcConversionError>> & chunk_errors, char const * type) {
+		std::vector<XmlRpcConversionError> errors;
+		for (std::vector<XmlRpcConversionError> & chunk : chunk_errors) {
+			std::move(chunk.begin(), chunk.end(), std::back_inserter(errors));
+		}
+		if (!errors.empty()) throw XmlRpcBulkError{type, std::move(errors)};
+	}
+
+	/// Convert an XmlRpc array to a vector, in parallel for large arrays.
+	template<typename Vector>
+	Vector arrayFromXmlRpc(XmlRpcValue const & value, char const * type) {
+		DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, value.size());
+		ensureXmlRpcType(value, XmlRpcValue::TypeArray, type);
+
+		// Allocate all elements up front, so threads can convert them in place.
+		Vector result(value.size());
+		std::vector<std::vector<XmlRpcConversionError>> errors(parallelChunks(result.size(), 0, bulk_chunk_size));
+		parallelFor(result.size(), [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			BulkConverter converter{errors[chunk]};
+			for (std::size_t i = begin; i < end; ++i) {
+				converter.convert(value[int(i)], ValuePath{nullptr, nullptr, i}, result[i]);
+			}
+		}, 0, bulk_chunk_size);
+
+		throwBulkErrors(errors, type);
+		return result;
+	}
+
+	/// Convert an XmlRpc struct to a map of isometries, in parallel for large structs.
+	template<typename Map>
+	Map isometryMapFromXmlRpc(XmlRpcValue const & value, char const * type) {
+		DR_EIGEN_INSTRUMENT_SCOPE(xmlrpc_parse, value.size());
+		ensureXmlRpcType(value, XmlRpcValue::TypeStruct, type);
+
+		// Collect the members first, so they can be split over threads.
+		XmlRpcValue & mutable_value = const_cast<XmlRpcValue &>(value);
+		std::vector<std::pair<std::string const *, XmlRpcValue const *>> members;
+		members.reserve(value.size());
+		for (XmlRpcValue::iterator i = mutable_value.begin(); i != mutable_value.end(); ++i) members.emplace_back(&i->first, &i->second);
+
+		std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> isometries(members.size());
+		std::vector<std::vector<XmlRpcConversionError>> errors(parallelChunks(members.size(), 0, bulk_chunk_size));
+		parallelFor(members.size(), [&] (std::size_t begin, std::size_t end, std::size_t chunk) {
+			BulkConverter converter{errors[chunk]};
+			for (std::size_t i = begin; i < end; ++i) {
+				converter.convert(*members[i].second, ValuePath{nullptr, members[i].first, 0}, isometries[i]);
+			}
+		}, 0, bulk_chunk_size);
+		throwBulkErrors(errors, type);
+
+		// The members of an XmlRpc struct are sorted by key, so every insert goes at the end.
+		Map result;
+		for (std::size_t i = 0; i < members.size(); ++i) result.emplace_hint(result.end(), *members[i].first, isometries[i]);
+		return result;
+	}
+}
+
+template<> std::vector<Pose> fromXmlRpc<std::vector<Pose>>(XmlRpc::XmlRpcValue const & value) {
+	return arrayFromXmlRpc<std::vector<Pose>>(value, "std::vector<Pose>");
+}
+
+template<> std::vector<Pose, Eigen::aligned_allocator<Pose>> fromXmlRpc<std::vector<Pose, Eigen::aligned_allocator<Pose>>>(XmlRpc::XmlRpcValue const & value) {
+	return arrayFromXmlRpc<std::vector<Pose, Eigen::aligned_allocator<Pose>>>(value, "std::vector<Pose>");
+}
+
+template<> std::map<std::string, Eigen::Isometry3d> fromXmlRpc<std::map<std::string, Eigen::Isometry3d>>(XmlRpc::XmlRpcValue const & value) {
+	return isometryMapFromXmlRpc<std::map<std::string, Eigen::Isometry3d>>(value, "std::map<std::string, Eigen::Isometry3d>");
+}
+
+template<> IsometryMap fromXmlRpc<IsometryMap>(XmlRpc::XmlRpcValue const & value) {
+	return isometryMapFromXmlRpc<IsometryMap>(value, "std::map<std::string, Eigen::Isometry3d>");
+}
+
+template<> std::vector<Eigen::AlignedBox3d> fromXmlRpc<std::vector<Eigen::AlignedBox3d>>(XmlRpc::XmlRpcValue const & value) {
+	return arrayFromXmlRpc<std::vector<Eigen::AlignedBox3d>>(value, "std::vector<Eigen::AlignedBox3d>");
+}
+
+namespace detail {
+	namespace {
+		using XmlRpc::XmlRpcValue;
+
+		/// Get the size of a matrix dimension from a struct member.
+		int xmlRpcDimension(XmlRpcValue const & value, char const * key) {
+			XmlRpcValue const & member = xmlRpcAt(value, key);
+			ensureXmlRpcType(member, XmlRpcValue::TypeInt, std::string{"Eigen::Matrix "} + key);
+			int size = const_cast<XmlRpcValue &>(member);
+			if (size < 0) throw std::runtime_error("negative number of " + std::string{key} + " for Eigen::Matrix: " + std::to_string(size));
+			return size;
+		}
+
+		/// Check that a dimension matches the fixed size of the matrix, if it has one.
+		void checkDimension(int size, int fixed, char const * name) {
+			if (fixed != Eigen::Dynamic && size != fixed) {
+				throw std::runtime_error("wrong number of " + std::string{name} + " for Eigen::Matrix: " + std::to_string(size) + " (expected " + std::to_string(fixed) + ")");
+			}
+		}
+
+		/// Determine the size of a dimension from the number of elements of a flat list and the size of the other dimension.
+		int flatDimension(int elements, int other, char const * name) {
+			if (other == 0 || elements % other != 0) {
+				throw std::runtime_error("wrong number of elements for Eigen::Matrix: " + std::to_string(elements) + " (not a multiple of " + std::to_string(other) + " " + name + ")");
+			}
+			return elements / other;
+		}
+
+		/// Compute the number of elements of a matrix, checking that it fits in an int.
+		int elementCount(int rows, int cols) {
+			if (cols != 0 && rows > std::numeric_limits<int>::max() / cols) {
+				throw std::runtime_error("too many elements for Eigen::Matrix: " + std::to_string(rows) + " rows and " + std::to_string(cols) + " columns");
+			}
+			return rows * cols;
+		}
+	}
+
+	XmlRpcMatrixLayout xmlRpcMatrixLayout(XmlRpcValue const & value, int rows, int cols, MatrixOrder order) {
+		bool row_major = order == MatrixOrder::row_major;
+
+		// A struct with explicit dimensions and a flat list of elements.
+		if (value.getType() == XmlRpcValue::TypeStruct) {
+			XmlRpcMatrixLayout layout{&xmlRpcAt(value, "data"), false, xmlRpcDimension(value, "rows"), xmlRpcDimension(value, "cols")};
+			checkDimension(layout.rows, rows, "rows");
+			checkDimension(layout.cols, cols, "columns");
+			ensureXmlRpcType(*layout.data, XmlRpcValue::TypeArray, "Eigen::Matrix data");
+			int elements = elementCount(layout.rows, layout.cols);
+			if (layout.data->size() != elements) {
+				throw std::runtime_error("wrong number of elements for Eigen::Matrix: " + std::to_string(layout.data->size()) + " (expected " + std::to_string(elements) + ")");
+			}
+			return layout;
+		}
+
+		ensureXmlRpcType(value, XmlRpcValue::TypeArray, "Eigen::Matrix");
+		int size = value.size();
+
+		// An empty list is an empty matrix if both dimensions are dynamic.
+		if (size == 0 && rows == Eigen::Dynamic && cols == Eigen::Dynamic) return XmlRpcMatrixLayout{&value, false, 0, 0};
+
+		// A flat list of elements, which needs at least one fixed dimension.
+		if (size == 0 || value[0].getType() != XmlRpcValue::TypeArray) {
+			if (rows == Eigen::Dynamic && cols == Eigen::Dynamic) {
+				throw std::runtime_error("a flat list for Eigen::Matrix needs a fixed number of rows or columns, use a nested list or a struct with rows, cols and data");
+			}
+			XmlRpcMatrixLayout layout{&value, false, rows, cols};
+			if (rows == Eigen::Dynamic) layout.rows = flatDimension(size, cols, "columns");
+			if (cols == Eigen::Dynamic) layout.cols = flatDimension(size, rows, "rows");
+			int elements = elementCount(layout.rows, layout.cols);
+			if (size != elements) {
+				throw std::runtime_error("wrong number of elements for Eigen::Matrix: " + std::to_string(size) + " (expected " + std::to_string(elements) + ")");
+			}
+			return layout;
+		}
+
+		// A nested list of rows or columns, which must all have the same size.
+		char const * outer_name = row_major ? "rows"    : "columns";
+		char const * inner_name = row_major ? "columns" : "rows";
+		int inner_size = value[0].size();
+		for (int i = 0; i < size; ++i) {
+			ensureXmlRpcType(value[i], XmlRpcValue::TypeArray, std::string{"Eigen::Matrix "} + (row_major ? "row" : "column"));
+			if (value[i].size() != inner_size) {
+				throw std::runtime_error("inconsistent number of " + std::string{inner_name} + " for Eigen::Matrix: " + std::to_string(value[i].size()) + " in " + outer_name + " " + std::to_string(i) + " (expected " + std::to_string(inner_size) + ")");
+			}
+		}
+
+		XmlRpcMatrixLayout layout{&value, true, row_major ? size : inner_size, row_major ? inner_size : size};
+		checkDimension(layout.rows, rows, "rows");
+		checkDimension(layout.cols, cols, "columns");
+		return layout;
+	}
+
+}
+
+template<> Eigen::Vector2d fromXmlRpc<Eigen::Vector2d>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::Vector2d>(value);
+}
+
+template<> Eigen::Vector4d fromXmlRpc<Eigen::Vector4d>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::Vector4d>(value);
+}
+
+template<> Eigen::Matrix<double, 6, 1> fromXmlRpc<Eigen::Matrix<double, 6, 1>>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::Matrix<double, 6, 1>>(value);
+}
+
+template<> Eigen::VectorXd fromXmlRpc<Eigen::VectorXd>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::VectorXd>(value);
+}
+
+template<> Eigen::Matrix2d fromXmlRpc<Eigen::Matrix2d>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::Matrix2d>(value);
+}
+
+template<> Eigen::Matrix3d fromXmlRpc<Eigen::Matrix3d>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::Matrix3d>(value);
+}
+
+template<> Eigen::Matrix4d fromXmlRpc<Eigen::Matrix4d>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::Matrix4d>(value);
+}
+
+template<> Eigen::Matrix<double, 6, 6> fromXmlRpc<Eigen::Matrix<double, 6, 6>>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::Matrix<double, 6, 6>>(value);
+}
+
+template<> Eigen::MatrixXd fromXmlRpc<Eigen::MatrixXd>(XmlRpc::XmlRpcValue const & value) {
+	return matrixFromXmlRpc<Eigen::MatrixXd>(value);
+}
+
 }
@@ -0,0 +1,111 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "pose_index.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace dr {
+
+namespace {
+	using Neighbor = PoseIndex::Neighbor;
+
+	/// Scratch space for the query with the flipped quaternion, so queries do not allocate after the first one on a thread.
+	thread_local std::vector<Neighbor> flipped;
+
+	/// Merge two neighbour lists sorted by index, keeping the smallest distance for duplicates.
+	void mergeByIndex(std::vector<Neighbor> & result, std::vector<Neighbor> const & other) {
+		std::size_t size = result.size();
+		for (Neighbor const & neighbor : other) result.push_back(neighbor);
+		std::inplace_merge(result.begin(), result.begin() + size, result.end(), [] (Neighbor const & a, Neighbor const & b) {
+			return a.index < b.index || (a.index == b.index && a.squared_distance < b.squared_distance);
+		});
+		result.erase(std::unique(result.begin(), result.end(), [] (Neighbor const & a, Neighbor const & b) {
+			return a.index == b.index;
+		}), result.end());
+	}
+
+	bool byIndex(Neighbor const & a, Neighbor const & b) {
+		return a.index < b.index;
+	}
+
+	std::vector<Eigen::Isometry3d> isometries(std::vector<Pose> const & poses) {
+		std::vector<Eigen::Isometry3d> result;
+		result.reserve(poses.size());
+		for (Pose const & pose : poses) result.push_back(pose.isometry);
+		return result;
+	}
+}
+
+PoseIndex::PoseIndex(std::vector<Eigen::Isometry3d> const & poses, double rotation_weight, unsigned int threads) {
+	if (!(rotation_weight >= 0)) throw std::invalid_argument("rotation weight must not be negative, got " + std::to_string(rotation_weight));
+	rotation_weight_ = rotation_weight;
+
+	Eigen::Matrix<double, 7, Eigen::Dynamic> points(7, poses.size());
+	parallelFor(poses.size(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		for (std::size_t i = begin; i < end; ++i) points.col(i) = embed(poses[i], false);
+	}, threads);
+	tree_.build(points, 16, threads);
+}
+
+PoseIndex::PoseIndex(std::vector<Pose> const & poses, double rotation_weight, unsigned int threads) :
+	PoseIndex(isometries(poses), rotation_weight, threads) {}
+
+double PoseIndex::distance(Eigen::Isometry3d const & a, Eigen::Isometry3d const & b) const {
+	Embedding embedded = embed(a, false);
+	return std::sqrt(std::min((embedded - embed(b, false)).squaredNorm(), (embedded - embed(b, true)).squaredNorm()));
+}
+
+void PoseIndex::knn(Eigen::Isometry3d const & query, std::size_t k, std::vector<Neighbor> & result) const {
+	tree_.knn(embed(query, false), k, result);
+	tree_.knn(embed(query, true), k, flipped);
+
+	// Every true neighbour is among the k nearest of the query sign that attains its distance.
+	std::sort(result.begin(), result.end(), byIndex);
+	std::sort(flipped.begin(), flipped.end(), byIndex);
+	mergeByIndex(result, flipped);
+	std::sort(result.begin(), result.end());
+	if (result.size() > k) result.resize(k);
+}
+
+PoseIndex::Neighbor PoseIndex::nearest(Eigen::Isometry3d const & query) const {
+	if (size() == 0) throw std::logic_error("Cannot find the nearest pose in an empty pose index.");
+	Neighbor positive = tree_.nearest(embed(query, false));
+	Neighbor negative = tree_.nearest(embed(query, true));
+	return negative.squared_distance < positive.squared_distance ? negative : positive;
+}
+
+void PoseIndex::radius(Eigen::Isometry3d const & query, double radius, std::vector<Neighbor> & result) const {
+	tree_.radius(embed(query, false), radius, result);
+	tree_.radius(embed(query, true), radius, flipped);
+	std::sort(result.begin(), result.end(), byIndex);
+	std::sort(flipped.begin(), flipped.end(), byIndex);
+	mergeByIndex(result, flipped);
+}
+
+void PoseIndex::knn(std::vector<Eigen::Isometry3d> const & queries, std::size_t k, std::vector<std::vector<Neighbor>> & result, unsigned int threads) const {
+	result.resize(queries.size());
+	parallelFor(queries.size(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		for (std::size_t i = begin; i < end; ++i) knn(queries[i], k, result[i]);
+	}, threads, 64);
+}
+
+void PoseIndex::radius(std::vector<Eigen::Isometry3d> const & queries, double radius, std::vector<std::vector<Neighbor>> & result, unsigned int threads) const {
+	result.resize(queries.size());
+	parallelFor(queries.size(), [&] (std::size_t begin, std::size_t end, std::size_t) {
+		for (std::size_t i = begin; i < end; ++i) this->radius(queries[i], radius, result[i]);
+	}, threads, 64);
+}
+
+PoseIndex::Embedding PoseIndex::embed(Eigen::Isometry3d const & pose, bool flip) const {
+	Eigen::Quaterniond rotation{pose.linear()};
+	double scale = 2 * rotation_weight_ * (flip ? -1 : 1);
+	Embedding result;
+	result << pose.translation(), scale * rotation.coeffs();
+	return result;
+}
+
+}
@@ -0,0 +1,451 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "pose_log.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+namespace dr {
+
+namespace {
+	static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "pose logs are read and written in place, which requires a little-endian host");
+
+	char const log_magic[8]   = {'D', 'R', 'P', 'O', 'S', 'L', 'O', 'G'};
+	char const frames_magic[8] = {'D', 'R', 'F', 'R', 'A', 'M', 'E', 'S'};
+
+	/// The decoded fixed part of the header.
+	struct Header {
+		std::uint32_t version;
+		std::uint32_t type;
+		std::uint32_t flags;
+		std::uint32_t stride;
+		std::uint64_t count;
+		std::uint64_t frame_table;
+	};
+
+	template<typename T>
+	T load(char const * data) {
+		T result;
+		std::memcpy(&result, data, sizeof(T));
+		return result;
+	}
+
+	template<typename T>
+	void store(char * data, T value) {
+		std::memcpy(data, &value, sizeof(T));
+	}
+
+	void encodeHeader(char * data, Header const & header) {
+		std::memset(data, 0, PoseLogFormat::header_size);
+		std::memcpy(data, log_magic, 8);
+		store(data +  8, header.version);
+		store(data + 12, header.type);
+		store(data + 16, header.flags);
+		store(data + 20, header.stride);
+		store(data + 24, header.count);
+		store(data + 32, header.frame_table);
+	}
+
+	/// Decode and check a header. The frame table offset is checked against the file size by the caller.
+	Header decodeHeader(char const * data, std::size_t size, std::string const & path) {
+		if (size < PoseLogFormat::header_size || std::memcmp(data, log_magic, 8) != 0) throw std::runtime_error(path + ": not a pose log");
+
+		Header header;
+		header.version     = load<std::uint32_t>(data +  8);
+		header.type        = load<std::uint32_t>(data + 12);
+		header.flags       = load<std::uint32_t>(data + 16);
+		header.stride      = load<std::uint32_t>(data + 20);
+		header.count       = load<std::uint64_t>(data + 24);
+		header.frame_table = load<std::uint64_t>(data + 32);
+
+		if (header.version != PoseLogFormat::version) throw std::runtime_error(path + ": unsupported pose log version " + std::to_string(header.version));
+		if (header.type < 1 || header.type > 4) throw std::runtime_error(path + ": unknown pose log record type " + std::to_string(header.type));
+		if (header.flags & ~PoseLogFormat::timestamp_flag) throw std::runtime_error(path + ": unknown pose log flags " + std::to_string(header.flags));
+
+		std::size_t stride = PoseLogFormat::stride(PoseLogType(header.type), header.flags & PoseLogFormat::timestamp_flag);
+		if (header.stride != stride) throw std::runtime_error(path + ": wrong pose log record stride " + std::to_string(header.stride) + " (expected " + std::to_string(stride) + ")");
+
+		std::uint64_t max_count = (std::numeric_limits<std::uint64_t>::max() - PoseLogFormat::header_size) / stride;
+		if (header.count > max_count || header.frame_table != PoseLogFormat::header_size + header.count * stride) {
+			throw std::runtime_error(path + ": pose log frame table offset does not match the number of records");
+		}
+		return header;
+	}
+
+	/// Decode and check a frame table.
+	std::vector<std::string> decodeFrames(char const * data, std::size_t size, std::string const & path) {
+		if (size < 16 || std::memcmp(data, frames_magic, 8) != 0) throw std::runtime_error(path + ": missing or corrupt pose log frame table");
+		std::uint32_t count = load<std::uint32_t>(data + 8);
+
+		std::vector<std::string> result;
+		result.reserve(std::min<std::size_t>(count, size / 4));
+		std::size_t offset = 16;
+		for (std::uint32_t i = 0; i < count; ++i) {
+			if (size - offset < 4) throw std::runtime_error(path + ": truncated pose log frame table");
+			std::uint32_t length = load<std::uint32_t>(data + offset);
+			offset += 4;
+			if (size - offset < length) throw std::runtime_error(path + ": truncated pose log frame table");
+			result.emplace_back(data + offset, length);
+			offset += length;
+		}
+		if (offset != size) throw std::runtime_error(path + ": trailing data after pose log frame table");
+		return result;
+	}
+
+	bool hasPosition(PoseLogType type) {
+		return type != PoseLogType::quaternion;
+	}
+
+	bool hasOrientation(PoseLogType type) {
+		return type != PoseLogType::vector;
+	}
+
+	char const * typeName(PoseLogType type) {
+		switch (type) {
+			case PoseLogType::vector:     return "vector";
+			case PoseLogType::quaternion: return "quaternion";
+			case PoseLogType::isometry:   return "isometry";
+			case PoseLogType::pose:       return "pose";
+		}
+		return "unknown";
+	}
+
+	/// Write all data at an offset in a file.
+	void writeAt(int fd, char const * data, std::size_t size, std::uint64_t offset) {
+		while (size > 0) {
+			ssize_t written = ::pwrite(fd, data, size, offset);
+			if (written < 0) {
+				if (errno == EINTR) continue;
+				throw std::system_error(errno, std::generic_category(), "failed to write pose log");
+			}
+			data   += written;
+			size   -= written;
+			offset += written;
+		}
+	}
+
+	/// Read exactly the requested amount of data at an offset in a file.
+	void readAt(int fd, char * data, std::size_t size, std::uint64_t offset, std::string const & path) {
+		while (size > 0) {
+			ssize_t read = ::pread(fd, data, size, offset);
+			if (read < 0) {
+				if (errno == EINTR) continue;
+				throw std::system_error(errno, std::generic_category(), "failed to read " + path);
+			}
+			if (read == 0) throw std::runtime_error(path + ": unexpected end of pose log");
+			data   += read;
+			size   -= read;
+			offset += read;
+		}
+	}
+
+	/// Store the position and orientation fields of a record.
+	char * storePosition(char * data, Eigen::Vector3d const & position) {
+		std::memcpy(data, position.data(), 3 * sizeof(double));
+		return data + 3 * sizeof(double);
+	}
+
+	char * storeOrientation(char * data, Eigen::Quaterniond const & orientation) {
+		std::memcpy(data, orientation.coeffs().data(), 4 * sizeof(double));
+		return data + 4 * sizeof(double);
+	}
+}
+
+constexpr std::size_t PoseLogFormat::header_size;
+constexpr std::uint32_t PoseLogFormat::version;
+constexpr std::uint32_t PoseLogFormat::timestamp_flag;
+
+std::size_t PoseLogFormat::stride(PoseLogType type, bool timestamps) {
+	std::size_t result = timestamps ? sizeof(std::int64_t) : 0;
+	if (type == PoseLogType::pose) result += 2 * sizeof(std::uint32_t);
+	if (hasPosition(type))         result += 3 * sizeof(double);
+	if (hasOrientation(type))      result += 4 * sizeof(double);
+	return result;
+}
+
+PoseLogWriter::PoseLogWriter(std::string const & path, PoseLogType type, PoseLogWriterOptions const & options) :
+	type_{type},
+	options_{options},
+	stride_{PoseLogFormat::stride(type, options.timestamps)},
+	last_timestamp_{std::numeric_limits<std::int64_t>::min()}
+{
+	if (options_.buffer_size == 0) throw std::invalid_argument("pose log buffer size must be positive");
+
+	fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (options.append ? 0 : O_TRUNC), 0666);
+	if (fd_ < 0) throw std::system_error(errno, std::generic_category(), "failed to open " + path);
+
+	try {
+		struct stat info;
+		if (::fstat(fd_, &info) != 0) throw std::system_error(errno, std::generic_category(), "failed to stat " + path);
+
+		if (info.st_size > 0) {
+			// Continue an existing log: load the frame table and the last timestamp.
+			std::vector<char> data(std::min<std::size_t>(info.st_size, PoseLogFormat::header_size));
+			readAt(fd_, data.data(), data.size(), 0, path);
+			Header header = decodeHeader(data.data(), data.size(), path);
+			if (PoseLogType(header.type) != type_ || header.stride != stride_) {
+				throw std::runtime_error(path + ": can not append " + typeName(type_) + " records to a pose log of " + typeName(PoseLogType(header.type)) + " records with different timestamp settings");
+			}
+			if (header.frame_table > std::uint64_t(info.st_size)) throw std::runtime_error(path + ": truncated pose log");
+
+			data.resize(info.st_size - header.frame_table);
+			readAt(fd_, data.data(), data.size(), header.frame_table, path);
+			frames_ = decodeFrames(data.data(), data.size(), path);
+			for (std::size_t i = 0; i < frames_.size(); ++i) frame_index_.emplace(frames_[i], i);
+
+			if (options_.timestamps && header.count > 0) {
+				readAt(fd_, reinterpret_cast<char *>(&last_timestamp_), sizeof(last_timestamp_), header.frame_table - stride_, path);
+			}
+			count_       = header.count;
+			records_end_ = header.frame_table;
+		} else {
+			flush();
+		}
+	} catch (...) {
+		::close(fd_);
+		throw;
+	}
+
+	buffer_.reserve(options_.buffer_size + stride_);
+}
+
+PoseLogWriter::~PoseLogWriter() {
+	try {
+		close();
+	} catch (...) {}
+	if (fd_ >= 0) ::close(fd_);
+}
+
+void PoseLogWriter::append(Eigen::Vector3d const & vector) {
+	storePosition(beginRecord(PoseLogType::vector, nullptr), vector);
+	maybeFlush();
+}
+
+void PoseLogWriter::append(Eigen::Quaterniond const & quaternion) {
+	storeOrientation(beginRecord(PoseLogType::quaternion, nullptr), quaternion);
+	maybeFlush();
+}
+
+void PoseLogWriter::append(Eigen::Isometry3d const & isometry) {
+	char * data = beginRecord(PoseLogType::isometry, nullptr);
+	storeOrientation(storePosition(data, isometry.translation()), Eigen::Quaterniond{isometry.linear()});
+	maybeFlush();
+}
+
+void PoseLogWriter::append(Pose const & pose) {
+	appendPose(nullptr, pose);
+}
+
+void PoseLogWriter::append(std::int64_t timestamp, Eigen::Vector3d const & vector) {
+	storePosition(beginRecord(PoseLogType::vector, &timestamp), vector);
+	maybeFlush();
+}
+
+void PoseLogWriter::append(std::int64_t timestamp, Eigen::Quaterniond const & quaternion) {
+	storeOrientation(beginRecord(PoseLogType::quaternion, &timestamp), quaternion);
+	maybeFlush();
+}
+
+void PoseLogWriter::append(std::int64_t timestamp, Eigen::Isometry3d const & isometry) {
+	char * data = beginRecord(PoseLogType::isometry, &timestamp);
+	storeOrientation(storePosition(data, isometry.translation()), Eigen::Quaterniond{isometry.linear()});
+	maybeFlush();
+}
+
+void PoseLogWriter::append(std::int64_t timestamp, Pose const & pose) {
+	appendPose(&timestamp, pose);
+}
+
+void PoseLogWriter::flush() {
+	if (fd_ < 0) throw std::logic_error("pose log writer is closed");
+	writeRecords();
+
+	// The frame table follows the records.
+	std::vector<char> table(16);
+	std::memcpy(table.data(), frames_magic, 8);
+	store(table.data() + 8, std::uint32_t(frames_.size()));
+	for (std::string const & frame : frames_) {
+		std::size_t offset = table.size();
+		table.resize(offset + 4 + frame.size());
+		store(table.data() + offset, std::uint32_t(frame.size()));
+		std::memcpy(table.data() + offset + 4, frame.data(), frame.size());
+	}
+	writeAt(fd_, table.data(), table.size(), records_end_);
+	if (::ftruncate(fd_, records_end_ + table.size()) != 0) throw std::system_error(errno, std::generic_category(), "failed to truncate pose log");
+
+	// Update the header last, so it only refers to data that has been written.
+	char header[PoseLogFormat::header_size];
+	encodeHeader(header, Header{
+		PoseLogFormat::version,
+		std::uint32_t(type_),
+		options_.timestamps ? PoseLogFormat::timestamp_flag : 0,
+		std::uint32_t(stride_),
+		count_,
+		records_end_,
+	});
+	writeAt(fd_, header, sizeof(header), 0);
+}
+
+void PoseLogWriter::close() {
+	if (fd_ < 0) return;
+	flush();
+	int fd = fd_;
+	fd_ = -1;
+	if (::close(fd) != 0) throw std::system_error(errno, std::generic_category(), "failed to close pose log");
+}
+
+void PoseLogWriter::appendPose(std::int64_t const * timestamp, Pose const & pose) {
+	// Check the record before interning the frames, so a rejected pose does not add frames.
+	checkRecord(PoseLogType::pose, timestamp);
+	std::uint32_t parent = internFrame(pose.header.parent_frame);
+	std::uint32_t child  = internFrame(pose.header.child_frame);
+
+	char * data = beginRecord(PoseLogType::pose, timestamp);
+	store(data, parent);
+	store(data + sizeof(std::uint32_t), child);
+	data += 2 * sizeof(std::uint32_t);
+	storeOrientation(storePosition(data, pose.isometry.translation()), Eigen::Quaterniond{pose.isometry.linear()});
+	maybeFlush();
+}
+
+void PoseLogWriter::checkRecord(PoseLogType type, std::int64_t const * timestamp) const {
+	if (fd_ < 0) throw std::logic_error("pose log writer is closed");
+	if (type != type_) throw std::logic_error(std::string{"can not append a "} + typeName(type) + " to a pose log of " + typeName(type_) + " records");
+	if (bool(timestamp) != options_.timestamps) throw std::logic_error(options_.timestamps ? "records in this pose log need a timestamp" : "records in this pose log do not have a timestamp");
+	if (timestamp && *timestamp < last_timestamp_) {
+		throw std::invalid_argument("pose log timestamps must not decrease: " + std::to_string(*timestamp) + " is before " + std::to_string(last_timestamp_));
+	}
+}
+
+char * PoseLogWriter::beginRecord(PoseLogType type, std::int64_t const * timestamp) {
+	checkRecord(type, timestamp);
+
+	std::size_t offset = buffer_.size();
+	buffer_.resize(offset + stride_);
+	char * data = buffer_.data() + offset;
+	if (timestamp) {
+		last_timestamp_ = *timestamp;
+		store(data, *timestamp);
+		data += sizeof(std::int64_t);
+	}
+	++count_;
+	return data;
+}
+
+void PoseLogWriter::maybeFlush() {
+	if (buffer_.size() >= options_.buffer_size) writeRecords();
+}
+
+void PoseLogWriter::writeRecords() {
+	if (buffer_.empty()) return;
+	writeAt(fd_, buffer_.data(), buffer_.size(), records_end_);
+	records_end_ += buffer_.size();
+	buffer_.clear();
+}
+
+std::uint32_t PoseLogWriter::internFrame(std::string const & name) {
+	auto found = frame_index_.find(name);
+	if (found != frame_index_.end()) return found->second;
+	if (frames_.size() == std::numeric_limits<std::uint32_t>::max()) throw std::length_error("too many frames in pose log");
+	if (name.size() > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("frame name too long for pose log");
+	frames_.push_back(name);
+	frame_index_.emplace(name, frames_.size() - 1);
+	return frames_.size() - 1;
+}
+
+PoseLogReader::PoseLogReader(std::string const & path) :
+	file_{path}
+{
+	Header header = decodeHeader(file_.data(), file_.size(), path);
+	if (header.frame_table > file_.size()) throw std::runtime_error(path + ": truncated pose log");
+
+	type_       = PoseLogType(header.type);
+	timestamps_ = header.flags & PoseLogFormat::timestamp_flag;
+	stride_     = header.stride;
+	size_       = header.count;
+	records_    = file_.data() + PoseLogFormat::header_size;
+	frames_     = decodeFrames(file_.data() + header.frame_table, file_.size() - header.frame_table, path);
+
+	std::ptrdiff_t offset = timestamps_ ? sizeof(std::int64_t) : 0;
+	if (type_ == PoseLogType::pose) offset += 2 * sizeof(std::uint32_t);
+	position_offset_    = hasPosition(type_) ? offset : -1;
+	if (hasPosition(type_)) offset += 3 * sizeof(double);
+	orientation_offset_ = hasOrientation(type_) ? offset : -1;
+}
+
+std::int64_t PoseLogReader::timestamp(std::size_t index) const {
+	if (!timestamps_) return 0;
+	return load<std::int64_t>(record(index));
+}
+
+Eigen::Map<Eigen::Vector3d const> PoseLogReader::position(std::size_t index) const {
+	if (position_offset_ < 0) throw std::logic_error(std::string{"pose log of "} + typeName(type_) + " records has no positions");
+	return Eigen::Map<Eigen::Vector3d const>{reinterpret_cast<double const *>(record(index) + position_offset_)};
+}
+
+Eigen::Map<Eigen::Quaterniond const> PoseLogReader::orientation(std::size_t index) const {
+	if (orientation_offset_ < 0) throw std::logic_error(std::string{"pose log of "} + typeName(type_) + " records has no orientations");
+	return Eigen::Map<Eigen::Quaterniond const>{reinterpret_cast<double const *>(record(index) + orientation_offset_)};
+}
+
+Eigen::Isometry3d PoseLogReader::isometry(std::size_t index) const {
+	if (position_offset_ < 0 || orientation_offset_ < 0) throw std::logic_error(std::string{"pose log of "} + typeName(type_) + " records has no isometries");
+	Eigen::Isometry3d result = Eigen::Isometry3d::Identity();
+	result.translation() = position(index);
+	result.linear()      = orientation(index).toRotationMatrix();
+	return result;
+}
+
+std::string const & PoseLogReader::parentFrame(std::size_t index) const {
+	return frame(index, 0);
+}
+
+std::string const & PoseLogReader::childFrame(std::size_t index) const {
+	return frame(index, 1);
+}
+
+Pose PoseLogReader::pose(std::size_t index) const {
+	return Pose{PoseHeader{parentFrame(index), childFrame(index)}, isometry(index)};
+}
+
+std::size_t PoseLogReader::lowerBound(std::int64_t timestamp) const {
+	if (!timestamps_) throw std::logic_error("pose log records have no timestamps");
+	std::size_t begin = 0;
+	std::size_t count = size_;
+	while (count > 0) {
+		std::size_t half = count / 2;
+		if (this->timestamp(begin + half) < timestamp) {
+			begin += half + 1;
+			count -= half + 1;
+		} else {
+			count = half;
+		}
+	}
+	return begin;
+}
+
+std::size_t PoseLogReader::upperBound(std::int64_t timestamp) const {
+	if (timestamp == std::numeric_limits<std::int64_t>::max()) {
+		if (!timestamps_) throw std::logic_error("pose log records have no timestamps");
+		return size_;
+	}
+	return lowerBound(timestamp + 1);
+}
+
+std::string const & PoseLogReader::frame(std::size_t index, std::size_t field) const {
+	if (type_ != PoseLogType::pose) throw std::logic_error(std::string{"pose log of "} + typeName(type_) + " records has no frames");
+	std::size_t offset = (timestamps_ ? sizeof(std::int64_t) : 0) + field * sizeof(std::uint32_t);
+	std::uint32_t frame = load<std::uint32_t>(record(index) + offset);
+	if (frame >= frames_.size()) throw std::runtime_error("pose log record " + std::to_string(index) + " refers to unknown frame " + std::to_string(frame));
+	return frames_[frame];
+}
+
+}
@@ -0,0 +1,162 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "spline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace dr {
+
+namespace {
+	/// Exponential map of a half angle-axis vector to a unit quaternion.
+	Eigen::Quaterniond quaternionExp(Eigen::Vector3d const & vector) {
+		double angle = vector.norm();
+		// sin(x) / x, with a Taylor expansion near zero.
+		double factor = angle < 1e-4 ? 1 - angle * angle / 6 : std::sin(angle) / angle;
+		Eigen::Quaterniond result;
+		result.w()   = std::cos(angle);
+		result.vec() = factor * vector;
+		return result;
+	}
+
+	/// Logarithmic map of a unit quaternion to a half angle-axis vector of the shortest equivalent rotation.
+	Eigen::Vector3d quaternionLog(Eigen::Quaterniond const & quaternion) {
+		double sign  = quaternion.w() < 0 ? -1 : 1;
+		double sine  = quaternion.vec().norm();
+		double angle = std::atan2(sine, sign * quaternion.w());
+		// x / sin(x), with a Taylor expansion near zero.
+		double factor = sine < 1e-4 ? 1 + sine * sine / 6 : angle / sine;
+		return sign * factor * quaternion.vec();
+	}
+}
+
+PoseSpline::PoseSpline(std::vector<Eigen::Isometry3d> const & poses, std::vector<double> const & times) : times_(times) {
+	if (poses.size() != times.size()) throw std::invalid_argument("number of poses (" + std::to_string(poses.size()) + ") differs from number of times (" + std::to_string(times.size()) + ")");
+	if (poses.size() < 2) throw std::invalid_argument("a pose spline needs at least two keyframes");
+	for (std::size_t i = 1; i < times.size(); ++i) {
+		if (!(times[i] > times[i - 1])) throw std::invalid_argument("keyframe times are not strictly increasing at index " + std::to_string(i));
+	}
+
+	std::size_t count = poses.size();
+	segments_.resize(count - 1);
+
+	// Solve the tridiagonal system for the second derivatives of a natural cubic spline (Thomas algorithm).
+	std::vector<Eigen::Vector3d> second(count, Eigen::Vector3d::Zero());
+	std::vector<double> upper(count, 0);
+	for (std::size_t i = 1; i + 1 < count; ++i) {
+		double h0 = times[i] - times[i - 1];
+		double h1 = times[i + 1] - times[i];
+		Eigen::Vector3d slope0 = (poses[i].translation() - poses[i - 1].translation()) / h0;
+		Eigen::Vector3d slope1 = (poses[i + 1].translation() - poses[i].translation()) / h1;
+		double diagonal = 2 * (h0 + h1) - h0 * upper[i - 1];
+		upper[i]  = h1 / diagonal;
+		second[i] = (6 * (slope1 - slope0) - h0 * second[i - 1]) / diagonal;
+	}
+	for (std::size_t i = count - 2; i > 0; --i) {
+		second[i] -= upper[i] * second[i + 1];
+	}
+
+	// Orientations, flipped to the same hemisphere as their predecessor so the spline takes the shortest path.
+	std::vector<Eigen::Quaterniond> rotations(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		rotations[i] = Eigen::Quaterniond{poses[i].rotation()};
+		if (i > 0 && rotations[i].dot(rotations[i - 1]) < 0) rotations[i].coeffs() = -rotations[i].coeffs();
+	}
+
+	// SQUAD control points, equal to the keyframes at the end points.
+	// Every inner keyframe gets a separate incoming and outgoing control point,
+	// scaled with the segment durations so the angular velocity is continuous for non-uniform keyframe times.
+	std::vector<Eigen::Quaterniond> incoming(rotations);
+	std::vector<Eigen::Quaterniond> outgoing(rotations);
+	for (std::size_t i = 1; i + 1 < count; ++i) {
+		double h0 = times[i] - times[i - 1];
+		double h1 = times[i + 1] - times[i];
+		Eigen::Quaterniond inverse = rotations[i].conjugate();
+		Eigen::Vector3d next     = quaternionLog(inverse * rotations[i + 1]);
+		Eigen::Vector3d previous = quaternionLog(inverse * rotations[i - 1]);
+		Eigen::Vector3d tangent  = (next - previous) / (h0 + h1);
+		incoming[i] = rotations[i] * quaternionExp(-0.5 * (h0 * tangent + previous));
+		outgoing[i] = rotations[i] * quaternionExp( 0.5 * (h1 * tangent - next));
+	}
+
+	for (std::size_t i = 0; i + 1 < count; ++i) {
+		Segment & segment = segments_[i];
+		double h = times[i + 1] - times[i];
+		Eigen::Vector3d p0 = poses[i].translation();
+		Eigen::Vector3d p1 = poses[i + 1].translation();
+
+		segment.duration         = h;
+		segment.inverse_duration = 1 / h;
+		segment.position[0] = p0;
+		segment.position[1] = (p1 - p0) / h - h * (2 * second[i] + second[i + 1]) / 6;
+		segment.position[2] = second[i] / 2;
+		segment.position[3] = (second[i + 1] - second[i]) / (6 * h);
+
+		segment.rotation_start = rotations[i];
+		segment.control_start  = outgoing[i];
+		segment.rotation_delta = quaternionLog(rotations[i].conjugate() * rotations[i + 1]);
+		segment.control_delta  = quaternionLog(outgoing[i].conjugate() * incoming[i + 1]);
+	}
+}
+
+PoseSpline::Segment const & PoseSpline::lookup(double time, double & offset) const {
+	// Search only the inner keyframes, so times outside the range map to the first or last segment.
+	auto index = std::upper_bound(times_.begin() + 1, times_.end() - 1, time) - (times_.begin() + 1);
+	Segment const & segment = segments_[index];
+	offset = std::min(std::max(time - times_[index], 0.0), segment.duration);
+	return segment;
+}
+
+Eigen::Quaterniond PoseSpline::squad(Segment const & segment, double factor) {
+	Eigen::Quaterniond outer = segment.rotation_start * quaternionExp(factor * segment.rotation_delta);
+	Eigen::Quaterniond inner = segment.control_start  * quaternionExp(factor * segment.control_delta);
+	return outer.slerp(2 * factor * (1 - factor), inner);
+}
+
+Eigen::Isometry3d PoseSpline::pose(double time) const {
+	double offset;
+	Segment const & segment = lookup(time, offset);
+	Eigen::Vector3d const * c = segment.position;
+	Eigen::Vector3d position = c[0] + offset * (c[1] + offset * (c[2] + offset * c[3]));
+	return Eigen::Translation3d{position} * squad(segment, offset * segment.inverse_duration);
+}
+
+Eigen::Vector3d PoseSpline::position(double time) const {
+	double offset;
+	Eigen::Vector3d const * c = lookup(time, offset).position;
+	return c[0] + offset * (c[1] + offset * (c[2] + offset * c[3]));
+}
+
+Eigen::Vector3d PoseSpline::velocity(double time) const {
+	double offset;
+	Eigen::Vector3d const * c = lookup(time, offset).position;
+	return c[1] + offset * (2 * c[2] + offset * 3 * c[3]);
+}
+
+Eigen::Vector3d PoseSpline::acceleration(double time) const {
+	double offset;
+	Eigen::Vector3d const * c = lookup(time, offset).position;
+	return 2 * c[2] + 6 * offset * c[3];
+}
+
+Eigen::Quaterniond PoseSpline::orientation(double time) const {
+	double offset;
+	Segment const & segment = lookup(time, offset);
+	return squad(segment, offset * segment.inverse_duration);
+}
+
+Eigen::Vector3d PoseSpline::angularVelocity(double time) const {
+	double offset;
+	Segment const & segment = lookup(time, offset);
+
+	// Central difference on the segment polynomial, which is smoothly defined slightly beyond the segment borders.
+	double factor = offset * segment.inverse_duration;
+	double step   = 1e-5;
+	double low    = factor - step;
+	double high   = factor + step;
+	Eigen::Quaterniond delta = squad(segment, high) * squad(segment, low).conjugate();
+	return 2 * quaternionLog(delta) / ((high - low) * segment.duration);
+}
+
+}
@@ -1,85 +1,162 @@
 // Copyright 2014-2022, Fizyr B.V.
 
 #include "yaml.hpp"
+#include "instrument.hpp"
 
-namespace dr {
-
-/// Convert a vector to YAML.
-std::string toYaml(const Eigen::Vector3d & vector) {
-	std::string result;
-	result.reserve(50);
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-	result += "{x: ";
-	result += std::to_string(vector.x());
+namespace dr {
 
-	result += ", y: ";
-	result += std::to_string(vector.y());
+namespace {
+	/// Write the shortest representation of a double that parses back to the same value.
+	/**
+	 * \return A pointer past the last written character.
+	 */
+	char * formatShortest(char * begin, char * end, double value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		return std::to_chars(begin, end, value).ptr;
+#else
+		// Without floating point to_chars, find the shortest precision that round-trips.
+		// These functions use the decimal separator of the C locale, which ROS nodes do not change.
+		int length = 0;
+		for (int precision = 15; precision <= 17; ++precision) {
+			length = std::snprintf(begin, end - begin, "%.*g", precision, value);
+			if (std::strtod(begin, nullptr) == value) break;
+		}
+		return begin + length;
+#endif
+	}
+}
 
-	result += ", z: ";
-	result += std::to_string(vector.z());
+void appendYaml(std::string & output, double value) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	if (std::isnan(value)) {
+		output.append(".nan");
+		return;
+	}
+	if (std::isinf(value)) {
+		output.append(value < 0 ? "-.inf" : ".inf");
+		return;
+	}
+
+	// Shortest round-trip output has at most 17 significant digits, a sign, a decimal point and an exponent like e-308.
+	char buffer[32];
+	char * end = formatShortest(buffer, buffer + sizeof(buffer), value);
+
+	// Make sure there is a decimal point in the mantissa, otherwise YAML 1.1 parsers read an integer or a string.
+	char * exponent = std::find(buffer, end, 'e');
+	if (std::find(buffer, exponent, '.') == exponent) {
+		output.append(buffer, exponent);
+		output.append(".0");
+		output.append(exponent, end);
+	} else {
+		output.append(buffer, end);
+	}
+}
 
-	result += "}";
-	return result;
+void appendYaml(std::string & output, Eigen::Vector3d const & vector) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	output.append("{x: ");
+	appendYaml(output, vector.x());
+	output.append(", y: ");
+	appendYaml(output, vector.y());
+	output.append(", z: ");
+	appendYaml(output, vector.z());
+	output.push_back('}');
 }
 
-/// Convert a quaternion to YAML.
-std::string toYaml(const Eigen::Quaterniond & quaternion) {
-	std::string result;
-	result.reserve(50);
+void appendYaml(std::string & output, Eigen::Quaterniond const & quaternion) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	output.append("{x: ");
+	appendYaml(output, quaternion.x());
+	output.append(", y: ");
+	appendYaml(output, quaternion.y());
+	output.append(", z: ");
+	appendYaml(output, quaternion.z());
+	output.append(", w: ");
+	appendYaml(output, quaternion.w());
+	output.push_back('}');
+}
 
-	result += "{x: ";
-	result += std::to_string(quaternion.x());
+void appendYaml(std::string & output, Eigen::Isometry3d const & pose, std::string const & indent) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	output.append(indent);
+	output.append("position:    ");
+	appendYaml(output, Eigen::Vector3d(pose.translation()));
+	output.push_back('\n');
+	output.append(indent);
+	output.append("orientation: ");
+	appendYaml(output, Eigen::Quaterniond(pose.linear()));
+}
 
-	result += ", y: ";
-	result += std::to_string(quaternion.y());
+void appendYaml(std::string & output, PoseHeader const & header, std::string const & indent) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	output.append(indent);
+	output.append("  ");
+	output.append("parent_frame: ");
+	output.append(header.parent_frame);
+	output.push_back('\n');
+	output.append(indent);
+	output.append("  ");
+	output.append("child_frame:  ");
+	output.append(header.child_frame);
+}
 
-	result += ", z: ";
-	result += std::to_string(quaternion.z());
+void appendYaml(std::string & output, Pose const & pose, std::string const & indent) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	output.append(indent);
+	output.append("parent_frame: ");
+	output.append(pose.header.parent_frame);
+	output.push_back('\n');
+	output.append(indent);
+	output.append("child_frame:  ");
+	output.append(pose.header.child_frame);
+	output.push_back('\n');
+	appendYaml(output, pose.isometry, indent);
+}
 
-	result += ", w: ";
-	result += std::to_string(quaternion.w());
-	result += "}";
+std::string toYaml(Eigen::Vector3d const & vector) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	std::string result;
+	result.reserve(80);
+	appendYaml(result, vector);
 	return result;
 }
 
-/// Convert an isometry to YAML.
-std::string toYaml(const Eigen::Isometry3d & pose, std::string const & indent) {
+std::string toYaml(Eigen::Quaterniond const & quaternion) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
 	std::string result;
 	result.reserve(100);
+	appendYaml(result, quaternion);
+	return result;
+}
 
-	result.append(indent);
-	result.append("position:    ");
-	result.append(toYaml(pose.translation()));
-	result.push_back('\n');
-	result.append(indent);
-	result.append("orientation: ");
-	result.append(toYaml(Eigen::Quaterniond(pose.rotation())));
+std::string toYaml(Eigen::Isometry3d const & pose, std::string const & indent) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	std::string result;
+	result.reserve(200 + 2 * indent.size());
+	appendYaml(result, pose, indent);
 	return result;
 }
 
 std::string toYaml(PoseHeader const & header, std::string const & indent) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
 	std::string result;
-	result.reserve(100);
-
-	result.append(indent);
-	result.append("  ");
-	result.append("parent_frame: ");
-	result.append(header.parent_frame);
-	result.push_back('\n');
-	result.append(indent);
-	result.append("  ");
-	result.append("child_frame:  ");
-	result.append(header.child_frame);
+	result.reserve(40 + 2 * indent.size() + header.parent_frame.size() + header.child_frame.size());
+	appendYaml(result, header, indent);
 	return result;
 }
 
 std::string toYaml(Pose const & pose, std::string const & indent) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
 	std::string result;
-	result.reserve(100);
-
-	result.append(toYaml(pose.header, indent));
-	result.push_back('\n');
-	result.append(toYaml(pose.isometry));
+	result.reserve(240 + 4 * indent.size() + pose.header.parent_frame.size() + pose.header.child_frame.size());
+	appendYaml(result, pose, indent);
 	return result;
 }
 
@@ -0,0 +1,784 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "yaml_reader.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace dr {
+
+/// Single pass parser that builds the node array of a YamlDocument.
+class YamlParser {
+public:
+	using Node      = YamlDocument::Node;
+	using StringRef = YamlDocument::StringRef;
+	using Type      = YamlNode::Type;
+
+	explicit YamlParser(YamlDocument & document) :
+		document_{document},
+		begin_{document.input()},
+		pos_{begin_},
+		end_{begin_ + document.inputSize()},
+		line_start_{begin_} {}
+
+	void parse() {
+		skipBlank();
+		if (atDocumentMarker("---")) {
+			pos_ += 3;
+			skipBlank();
+		}
+
+		if (pos_ == end_ || atDocumentMarker("...")) {
+			addNode(Type::null, {});
+		} else {
+			parseBlockNode({});
+			skipBlank();
+		}
+
+		if (atDocumentMarker("...")) {
+			pos_ += 3;
+			skipBlank();
+		}
+		if (atDocumentMarker("---")) error("multiple documents are not supported");
+		if (pos_ != end_) error("unexpected content after the end of the document");
+	}
+
+private:
+	[[noreturn]] void error(std::string const & message) const {
+		throw std::runtime_error("YAML parse error on line " + std::to_string(line_) + ": " + message);
+	}
+
+	std::size_t column() const {
+		return pos_ - line_start_;
+	}
+
+	bool atEnd(char const * position) const {
+		return position == end_;
+	}
+
+	/// Check if a position holds whitespace, a line break or the end of the input.
+	bool isSeparator(char const * position) const {
+		return atEnd(position) || *position == ' ' || *position == '\t' || *position == '\n' || *position == '\r';
+	}
+
+	/// Check if the current position is a document start or end marker at the start of a line.
+	bool atDocumentMarker(char const * marker) const {
+		return column() == 0 && end_ - pos_ >= 3 && std::memcmp(pos_, marker, 3) == 0 && isSeparator(pos_ + 3);
+	}
+
+	/// Check if the current position is the dash of a block sequence item.
+	bool atSequenceDash() const {
+		return !atEnd(pos_) && *pos_ == '-' && isSeparator(pos_ + 1);
+	}
+
+	/// Check if the current position is a colon that separates a key from its value.
+	bool atKeySeparator(bool flow) const {
+		if (atEnd(pos_) || *pos_ != ':') return false;
+		if (isSeparator(pos_ + 1)) return true;
+		return flow && (pos_[1] == ',' || pos_[1] == ']' || pos_[1] == '}');
+	}
+
+	/// Skip spaces and tabs on the current line.
+	void skipSpaces() {
+		while (!atEnd(pos_) && (*pos_ == ' ' || *pos_ == '\t')) ++pos_;
+	}
+
+	/// Check if the rest of the line is empty, after skipping spaces.
+	bool atLineEnd() {
+		skipSpaces();
+		return atEnd(pos_) || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '#';
+	}
+
+	/// Skip whitespace, comments and line breaks up to the next content.
+	void skipBlank() {
+		bool tab = false;
+		while (!atEnd(pos_)) {
+			char c = *pos_;
+			if (c == ' ' || c == '\r') {
+				++pos_;
+			} else if (c == '\t') {
+				tab = true;
+				++pos_;
+			} else if (c == '#') {
+				while (!atEnd(pos_) && *pos_ != '\n') ++pos_;
+			} else if (c == '\n') {
+				++pos_;
+				++line_;
+				line_start_ = pos_;
+				tab = false;
+			} else {
+				break;
+			}
+		}
+
+		// Tabs are fine after content on a line, but not as indentation.
+		if (tab && !atEnd(pos_) && std::memchr(line_start_, '\t', column())) {
+			bool indentation = true;
+			for (char const * i = line_start_; i < pos_; ++i) indentation = indentation && (*i == ' ' || *i == '\t');
+			if (indentation) error("tabs can not be used for indentation");
+		}
+	}
+
+	/// Skip whitespace, comments and line breaks inside a flow collection.
+	void skipFlowBlank() {
+		while (!atEnd(pos_)) {
+			char c = *pos_;
+			if (c == ' ' || c == '\t' || c == '\r') {
+				++pos_;
+			} else if (c == '#') {
+				while (!atEnd(pos_) && *pos_ != '\n') ++pos_;
+			} else if (c == '\n') {
+				++pos_;
+				++line_;
+				line_start_ = pos_;
+			} else {
+				break;
+			}
+		}
+	}
+
+	/// Reject syntax that is not supported by this parser.
+	void checkSupported() const {
+		switch (*pos_) {
+			case '&': error("anchors are not supported");
+			case '*': error("aliases are not supported");
+			case '!': error("tags are not supported");
+			case '|':
+			case '>': error("block scalars are not supported");
+			case '%': error("directives are not supported");
+			case '@':
+			case '`': error(std::string{"plain scalars can not start with '"} + *pos_ + "'");
+			case '?': if (isSeparator(pos_ + 1)) error("complex keys are not supported"); break;
+			default: break;
+		}
+	}
+
+	/// Add a node without children and return its index.
+	/**
+	 * Sequences and maps get their final end and size in finishNode().
+	 */
+	std::size_t addNode(Type type, StringRef key) {
+		std::size_t index = document_.nodes_.size();
+		Node node;
+		node.type = type;
+		node.line = line_;
+		node.key  = key;
+		node.end  = index + 1;
+		document_.nodes_.push_back(node);
+		return index;
+	}
+
+	/// Finish a sequence or map after all children have been added.
+	void finishNode(std::size_t index, std::size_t size) {
+		Node & node = document_.nodes_[index];
+		if (size > std::numeric_limits<std::uint32_t>::max()) error("too many items in a sequence or map");
+		node.size = size;
+		node.end  = document_.nodes_.size();
+	}
+
+	/// Add a scalar node, or a null node for an empty or null scalar.
+	void addScalar(StringRef key, StringRef value, bool quoted, std::uint32_t line) {
+		char const * data = document_.data(value);
+		bool null = !quoted && (
+			value.size == 0
+			|| (value.size == 1 && data[0] == '~')
+			|| (value.size == 4 && (std::memcmp(data, "null", 4) == 0 || std::memcmp(data, "Null", 4) == 0 || std::memcmp(data, "NULL", 4) == 0))
+		);
+
+		Node node;
+		node.type   = null ? Type::null : Type::scalar;
+		node.line   = line;
+		node.quoted = quoted;
+		node.key    = key;
+		node.value  = value;
+		node.end    = document_.nodes_.size() + 1;
+		document_.nodes_.push_back(node);
+	}
+
+	/// Make a reference to a range of the input.
+	StringRef inputRef(char const * begin, char const * end) const {
+		StringRef result;
+		result.offset = begin - begin_;
+		result.size   = end - begin;
+		return result;
+	}
+
+	/// Parse a plain scalar up to the next key separator, comment or line end.
+	StringRef parsePlainScalar(bool flow) {
+		char const * start = pos_;
+		char const * last  = pos_;
+		while (!atEnd(pos_)) {
+			char c = *pos_;
+			if (c == '\n' || c == '\r') break;
+			if (c == ':' && atKeySeparator(flow)) break;
+			if (c == '#' && pos_ > start && (pos_[-1] == ' ' || pos_[-1] == '\t')) break;
+			if (flow && (c == ',' || c == '[' || c == ']' || c == '{' || c == '}')) break;
+			++pos_;
+			if (c != ' ' && c != '\t') last = pos_;
+		}
+		return inputRef(start, last);
+	}
+
+	/// Append a code point as UTF-8.
+	void appendUtf8(std::string & output, unsigned long code) {
+		if (code < 0x80) {
+			output.push_back(code);
+		} else if (code < 0x800) {
+			output.push_back(0xC0 | (code >> 6));
+			output.push_back(0x80 | (code & 0x3F));
+		} else if (code < 0x10000) {
+			output.push_back(0xE0 | (code >> 12));
+			output.push_back(0x80 | ((code >> 6) & 0x3F));
+			output.push_back(0x80 | (code & 0x3F));
+		} else if (code < 0x110000) {
+			output.push_back(0xF0 | (code >> 18));
+			output.push_back(0x80 | ((code >> 12) & 0x3F));
+			output.push_back(0x80 | ((code >> 6) & 0x3F));
+			output.push_back(0x80 | (code & 0x3F));
+		} else {
+			error("invalid unicode escape sequence");
+		}
+	}
+
+	/// Parse a hexadecimal escape sequence with a fixed number of digits.
+	unsigned long parseHex(int digits) {
+		if (end_ - pos_ < digits) error("unterminated escape sequence");
+		unsigned long result = 0;
+		for (int i = 0; i < digits; ++i) {
+			char c = *pos_++;
+			int digit;
+			if (c >= '0' && c <= '9') digit = c - '0';
+			else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+			else error("invalid hexadecimal escape sequence");
+			result = result * 16 + digit;
+		}
+		return result;
+	}
+
+	/// Parse a single or double quoted scalar on a single line.
+	/**
+	 * Scalars without escape sequences refer to the input, others are decoded into the document.
+	 */
+	StringRef parseQuotedScalar() {
+		char quote = *pos_++;
+		char const * start = pos_;
+
+		// Fast path: no escape sequences.
+		while (!atEnd(pos_) && *pos_ != quote && *pos_ != '\n' && !(quote == '"' && *pos_ == '\\')) ++pos_;
+		if (atEnd(pos_) || *pos_ == '\n') error("unterminated quoted scalar (multi-line scalars are not supported)");
+		if (*pos_ == quote && (quote == '"' || atEnd(pos_ + 1) || pos_[1] != '\'')) {
+			return inputRef(start, pos_++);
+		}
+
+		std::string & decoded = document_.decoded_;
+		StringRef result;
+		result.offset  = decoded.size();
+		result.decoded = true;
+		decoded.append(start, pos_);
+
+		while (true) {
+			if (atEnd(pos_) || *pos_ == '\n') error("unterminated quoted scalar (multi-line scalars are not supported)");
+			char c = *pos_++;
+			if (c == quote) {
+				// A repeated single quote is an escaped single quote.
+				if (quote == '\'' && !atEnd(pos_) && *pos_ == '\'') {
+					decoded.push_back('\'');
+					++pos_;
+					continue;
+				}
+				break;
+			}
+			if (quote == '\'' || c != '\\') {
+				decoded.push_back(c);
+				continue;
+			}
+
+			if (atEnd(pos_)) error("unterminated escape sequence");
+			switch (char escape = *pos_++) {
+				case '0':  decoded.push_back('\0');   break;
+				case 'a':  decoded.push_back('\a');   break;
+				case 'b':  decoded.push_back('\b');   break;
+				case 't':  decoded.push_back('\t');   break;
+				case '\t': decoded.push_back('\t');   break;
+				case 'n':  decoded.push_back('\n');   break;
+				case 'v':  decoded.push_back('\v');   break;
+				case 'f':  decoded.push_back('\f');   break;
+				case 'r':  decoded.push_back('\r');   break;
+				case 'e':  decoded.push_back('\x1B'); break;
+				case ' ':  decoded.push_back(' ');    break;
+				case '"':  decoded.push_back('"');    break;
+				case '/':  decoded.push_back('/');    break;
+				case '\\': decoded.push_back('\\');   break;
+				case 'x':  appendUtf8(decoded, parseHex(2)); break;
+				case 'u':  appendUtf8(decoded, parseHex(4)); break;
+				case 'U':  appendUtf8(decoded, parseHex(8)); break;
+				default: error(std::string{"invalid escape sequence: \\"} + escape);
+			}
+		}
+
+		if (decoded.size() - result.offset > std::numeric_limits<std::uint32_t>::max()) error("scalar too long");
+		result.size = decoded.size() - result.offset;
+		return result;
+	}
+
+	/// Parse a plain or quoted scalar.
+	StringRef parseScalar(bool flow, bool & quoted) {
+		quoted = *pos_ == '"' || *pos_ == '\'';
+		if (quoted) return parseQuotedScalar();
+		checkSupported();
+		return parsePlainScalar(flow);
+	}
+
+	/// Parse a node in block context at the current position.
+	void parseBlockNode(StringRef key) {
+		if (atSequenceDash()) return parseBlockSequence(key, column());
+		if (*pos_ == '[' || *pos_ == '{') {
+			parseFlowNode(key);
+			if (!atLineEnd()) error("unexpected content after a flow collection");
+			return;
+		}
+
+		std::uint32_t line = line_;
+		std::size_t indent = column();
+		bool quoted;
+		StringRef scalar = parseScalar(false, quoted);
+		skipSpaces();
+		if (atKeySeparator(false)) return parseBlockMap(key, indent, scalar, line);
+		if (!atLineEnd()) error("unexpected content after a scalar");
+		addScalar(key, scalar, quoted, line);
+	}
+
+	/// Parse the value of a key in a block map, or a sequence item, when it starts on the same line.
+	void parseInlineValue(StringRef key) {
+		if (*pos_ == '[' || *pos_ == '{') {
+			parseFlowNode(key);
+			if (!atLineEnd()) error("unexpected content after a flow collection");
+			return;
+		}
+		if (atSequenceDash()) error("a block sequence can not start on the same line as a key");
+
+		std::uint32_t line = line_;
+		bool quoted;
+		StringRef scalar = parseScalar(false, quoted);
+		skipSpaces();
+		if (atKeySeparator(false)) error("a block map can not start on the same line as a key");
+		if (!atLineEnd()) error("unexpected content after a scalar");
+		addScalar(key, scalar, quoted, line);
+	}
+
+	/// Parse a block sequence with the dash of the first item at the current position.
+	void parseBlockSequence(StringRef key, std::size_t indent) {
+		std::size_t index = addNode(Type::sequence, key);
+		std::size_t size = 0;
+
+		while (true) {
+			++pos_;
+			++size;
+			if (atLineEnd()) {
+				std::uint32_t line = line_;
+				skipBlank();
+				if (atEnd(pos_) || column() <= indent || atDocumentMarker("---") || atDocumentMarker("...")) {
+					addScalar({}, {}, false, line);
+				} else {
+					parseBlockNode({});
+				}
+			} else {
+				// Items that start on the line of the dash, including compact nested maps and sequences.
+				parseBlockNode({});
+			}
+
+			skipBlank();
+			if (atEnd(pos_) || column() < indent || atDocumentMarker("---") || atDocumentMarker("...")) break;
+			if (column() > indent) error("unexpected indentation");
+			if (!atSequenceDash()) break;
+		}
+
+		finishNode(index, size);
+	}
+
+	/// Parse a block map, with the current position at the colon after the first key.
+	void parseBlockMap(StringRef key, std::size_t indent, StringRef first_key, std::uint32_t line) {
+		std::size_t index = addNode(Type::map, key);
+		document_.nodes_[index].line = line;
+		std::size_t size = 0;
+
+		StringRef child_key = first_key;
+		while (true) {
+			++pos_;
+			++size;
+			if (atLineEnd()) {
+				std::uint32_t value_line = line_;
+				skipBlank();
+				if (atEnd(pos_) || column() < indent || atDocumentMarker("---") || atDocumentMarker("...")) {
+					addScalar(child_key, {}, false, value_line);
+				} else if (column() > indent) {
+					parseBlockNode(child_key);
+				} else if (atSequenceDash()) {
+					// A sequence may be indented at the same level as the key that holds it.
+					parseBlockSequence(child_key, indent);
+				} else {
+					addScalar(child_key, {}, false, value_line);
+				}
+			} else {
+				parseInlineValue(child_key);
+			}
+
+			skipBlank();
+			if (atEnd(pos_) || column() < indent || atDocumentMarker("---") || atDocumentMarker("...")) break;
+			if (column() > indent) error("unexpected indentation");
+			if (atSequenceDash()) error("expected a key in a block map, found a sequence item");
+
+			bool quoted;
+			child_key = parseScalar(false, quoted);
+			skipSpaces();
+			if (!atKeySeparator(false)) error("expected ':' after a key in a block map");
+		}
+
+		finishNode(index, size);
+	}
+
+	/// Parse a flow sequence or flow map at the current position.
+	void parseFlowNode(StringRef key) {
+		std::uint32_t start_line = line_;
+		bool map = *pos_++ == '{';
+		char close = map ? '}' : ']';
+		std::size_t index = addNode(map ? Type::map : Type::sequence, key);
+		std::size_t size = 0;
+
+		while (true) {
+			skipFlowBlank();
+			if (atEnd(pos_)) {
+				line_ = start_line;
+				error(map ? "unterminated flow map" : "unterminated flow sequence");
+			}
+			if (*pos_ == close) break;
+
+			StringRef child_key;
+			if (map) {
+				bool quoted;
+				child_key = parseScalar(true, quoted);
+				skipFlowBlank();
+				if (!atKeySeparator(true)) error("expected ':' after a key in a flow map");
+				++pos_;
+				skipFlowBlank();
+			}
+			parseFlowValue(child_key, map);
+			++size;
+
+			skipFlowBlank();
+			if (!atEnd(pos_) && *pos_ == ',') {
+				++pos_;
+			} else if (atEnd(pos_) || *pos_ != close) {
+				error(map ? "expected ',' or '}' in a flow map" : "expected ',' or ']' in a flow sequence");
+			}
+		}
+
+		++pos_;
+		finishNode(index, size);
+	}
+
+	/// Parse a value in a flow collection.
+	void parseFlowValue(StringRef key, bool map) {
+		if (atEnd(pos_)) return;
+		if (*pos_ == '[' || *pos_ == '{') return parseFlowNode(key);
+
+		// An empty value in a flow map is null, but a sequence item can not be empty.
+		if (*pos_ == ',' || *pos_ == '}' || *pos_ == ']') {
+			if (!map) error("expected a value in a flow sequence");
+			return addScalar(key, {}, false, line_);
+		}
+
+		std::uint32_t line = line_;
+		bool quoted;
+		StringRef scalar = parseScalar(true, quoted);
+		skipFlowBlank();
+		if (atKeySeparator(true)) error("maps inside flow sequences need braces");
+		addScalar(key, scalar, quoted, line);
+	}
+
+	YamlDocument & document_;
+	char const * begin_;
+	char const * pos_;
+	char const * end_;
+	char const * line_start_;
+	std::uint32_t line_ = 1;
+};
+
+YamlDocument YamlDocument::parse(std::string text) {
+	YamlDocument result;
+	result.text_ = std::move(text);
+	result.parseInput();
+	return result;
+}
+
+YamlDocument YamlDocument::load(std::string const & path) {
+	YamlDocument result;
+	result.file_ = MappedFile{path, MappedFileAccess::sequential};
+	try {
+		result.parseInput();
+	} catch (std::runtime_error const & e) {
+		throw std::runtime_error(path + ": " + e.what());
+	}
+	return result;
+}
+
+void YamlDocument::parseInput() {
+	// Dense files like pose lists have about one node per 12 bytes, but a node is much larger than that.
+	// Reserving for dense files would take several times the file size up front, so reserve for sparse files and let dense files grow.
+	nodes_.clear();
+	nodes_.reserve(inputSize() / 64 + 1);
+	YamlParser{*this}.parse();
+}
+
+YamlNode::Iterator & YamlNode::Iterator::operator++() {
+	index_ = document_->nodes_[index_].end;
+	return *this;
+}
+
+YamlNode::Type YamlNode::type() const {
+	return document_->nodes_[index_].type;
+}
+
+std::size_t YamlNode::line() const {
+	return document_->nodes_[index_].line;
+}
+
+std::size_t YamlNode::size() const {
+	return document_->nodes_[index_].size;
+}
+
+std::string YamlNode::scalar() const {
+	YamlDocument::Node const & node = document_->nodes_[index_];
+	if (node.type != Type::scalar) throw std::runtime_error("expected a scalar on line " + std::to_string(node.line));
+	return {document_->data(node.value), node.value.size};
+}
+
+std::string YamlNode::key() const {
+	YamlDocument::Node const & node = document_->nodes_[index_];
+	return {document_->data(node.key), node.key.size};
+}
+
+std::size_t YamlDocument::findMember(std::size_t index, char const * key) const {
+	std::size_t length = std::strlen(key);
+	std::size_t end    = nodes_[index].end;
+	std::size_t found  = end;
+	for (std::size_t i = index + 1; i < end; i = nodes_[i].end) {
+		if (nodes_[i].key.size == length && std::memcmp(data(nodes_[i].key), key, length) == 0) found = i;
+	}
+	return found;
+}
+
+bool YamlNode::hasMember(char const * key) const {
+	if (!isMap()) return false;
+	return document_->findMember(index_, key) != document_->nodes_[index_].end;
+}
+
+YamlNode YamlNode::at(char const * key) const {
+	if (!isMap()) throw std::runtime_error("expected a map on line " + std::to_string(line()) + " to look up key " + key);
+	std::size_t found = document_->findMember(index_, key);
+	if (found == document_->nodes_[index_].end) throw std::runtime_error("missing key " + std::string{key} + " in map on line " + std::to_string(line()));
+	return {document_, found};
+}
+
+YamlNode YamlNode::at(std::size_t index) const {
+	if (index >= size()) throw std::out_of_range("index " + std::to_string(index) + " out of range for node with " + std::to_string(size()) + " items on line " + std::to_string(line()));
+	Iterator i = begin();
+	for (std::size_t n = 0; n < index; ++n) ++i;
+	return *i;
+}
+
+YamlNode::Iterator YamlNode::begin() const {
+	return {document_, index_ + 1};
+}
+
+YamlNode::Iterator YamlNode::end() const {
+	return {document_, document_->nodes_[index_].end};
+}
+
+namespace {
+	/// Throw an error for a node that does not describe a value of the requested type.
+	[[noreturn]] void throwWrongType(YamlNode const & node, char const * expected, char const * type) {
+		throw std::runtime_error(std::string{"expected a "} + expected + " for " + type + " on line " + std::to_string(node.line()));
+	}
+
+	void ensureMap(YamlNode const & node, char const * type) {
+		if (!node.isMap()) throwWrongType(node, "map", type);
+	}
+
+	void ensureSize(YamlNode const & node, std::size_t expected, char const * type) {
+		if (node.size() != expected) {
+			throw std::runtime_error(
+				std::string{"wrong number of components for "} + type + ": " + std::to_string(node.size())
+				+ " (expected " + std::to_string(expected) + ") on line " + std::to_string(node.line())
+			);
+		}
+	}
+
+	/// Append all items of a YAML sequence to a vector, converted with fromYaml<T>.
+	template<typename T, typename Allocator>
+	void appendFromYaml(YamlNode const & sequence, std::vector<T, Allocator> & result, char const * type) {
+		if (!sequence.isSequence()) throwWrongType(sequence, "sequence", type);
+		result.reserve(result.size() + sequence.size());
+		for (YamlNode item : sequence) result.push_back(fromYaml<T>(item));
+	}
+
+	/// Check if a string is one of the spellings of a YAML infinity or NaN, after an optional sign.
+	bool matchSpecial(char const * data, std::size_t size, char const * const (&spellings)[3]) {
+		if (size != 4) return false;
+		for (char const * spelling : spellings) {
+			if (std::memcmp(data, spelling, 4) == 0) return true;
+		}
+		return false;
+	}
+
+	/// Parse a YAML number. Returns false if the string is not a number.
+	bool parseNumber(char const * data, std::size_t size, double & result) {
+		if (size == 0) return false;
+		bool negative = data[0] == '-';
+		char const * digits = data + (data[0] == '-' || data[0] == '+');
+		std::size_t length  = size - (digits - data);
+
+		// Only one sign is allowed, but the number parsers below would accept a second one.
+		if (length > 0 && (digits[0] == '-' || digits[0] == '+')) return false;
+
+		if (matchSpecial(digits, length, {".inf", ".Inf", ".INF"})) {
+			result = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+			return true;
+		}
+		if (digits == data && matchSpecial(digits, length, {".nan", ".NaN", ".NAN"})) {
+			result = std::numeric_limits<double>::quiet_NaN();
+			return true;
+		}
+
+		// Only accept decimal notation, not the hexadecimal, inf and nan forms of the C library.
+		if (length == 0 || length > 400) return false;
+		for (std::size_t i = 0; i < length; ++i) {
+			char c = digits[i];
+			if (!(c >= '0' && c <= '9') && c != '.' && c != 'e' && c != 'E' && c != '-' && c != '+') return false;
+		}
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+		std::from_chars_result parsed = std::from_chars(digits, digits + length, result);
+		if (parsed.ec == std::errc::invalid_argument || parsed.ptr != digits + length) return false;
+		if (parsed.ec == std::errc::result_out_of_range) {
+			// Overflow and underflow behave like strtod.
+			char buffer[401];
+			std::memcpy(buffer, digits, length);
+			buffer[length] = '\0';
+			result = std::strtod(buffer, nullptr);
+		}
+#else
+		// The input is not null terminated. These functions use the decimal separator of the C locale, which ROS nodes do not change.
+		char buffer[401];
+		std::memcpy(buffer, digits, length);
+		buffer[length] = '\0';
+		char * end;
+		result = std::strtod(buffer, &end);
+		if (end != buffer + length) return false;
+#endif
+		if (negative) result = -result;
+		return true;
+	}
+
+	Eigen::Vector3d vectorFromYaml(YamlNode const & node, char const * a, char const * b, char const * c) {
+		return {fromYaml<double>(node.at(a)), fromYaml<double>(node.at(b)), fromYaml<double>(node.at(c))};
+	}
+}
+
+double YamlNode::number() const {
+	YamlDocument::Node const & node = document_->nodes_[index_];
+	double result;
+	if (node.type != Type::scalar || node.quoted || !parseNumber(document_->data(node.value), node.value.size, result)) {
+		std::string got = node.type == Type::scalar ? scalar() : node.type == Type::null ? "null" : "a sequence or map";
+		throw std::runtime_error("expected a number on line " + std::to_string(node.line) + ", got " + got);
+	}
+	return result;
+}
+
+template<> double fromYaml<double>(YamlNode const & node) {
+	return node.number();
+}
+
+template<> std::string fromYaml<std::string>(YamlNode const & node) {
+	if (!node.isScalar()) throwWrongType(node, "scalar", "std::string");
+	return node.scalar();
+}
+
+template<> Eigen::Vector3d fromYaml<Eigen::Vector3d>(YamlNode const & node) {
+	ensureMap(node, "Eigen::Vector3d");
+	ensureSize(node, 3, "Eigen::Vector3d");
+	return vectorFromYaml(node, "x", "y", "z");
+}
+
+template<> Eigen::Quaterniond fromYaml<Eigen::Quaterniond>(YamlNode const & node) {
+	ensureMap(node, "Eigen::Quaterniond");
+
+	if (node.size() == 3) {
+		return rpyToQuaternion(vectorFromYaml(node, "r", "p", "y"));
+	} else if (node.size() == 4) {
+		return {
+			fromYaml<double>(node.at("w")),
+			fromYaml<double>(node.at("x")),
+			fromYaml<double>(node.at("y")),
+			fromYaml<double>(node.at("z")),
+		};
+	}
+	throw std::runtime_error("wrong number of components for Eigen::Quaterniond: " + std::to_string(node.size()) + " (expected 3 or 4) on line " + std::to_string(node.line()));
+}
+
+template<> Eigen::Isometry3d fromYaml<Eigen::Isometry3d>(YamlNode const & node) {
+	ensureMap(node, "Eigen::Isometry3d");
+	ensureSize(node, 2, "Eigen::Isometry3d");
+	return Eigen::Translation3d(fromYaml<Eigen::Vector3d>(node.at("position"))) * fromYaml<Eigen::Quaterniond>(node.at("orientation"));
+}
+
+template<> Eigen::AlignedBox3d fromYaml<Eigen::AlignedBox3d>(YamlNode const & node) {
+	ensureMap(node, "Eigen::AlignedBox3d");
+	ensureSize(node, 2, "Eigen::AlignedBox3d");
+
+	if (node.hasMember("center") && node.hasMember("dimensions")) {
+		return makeCenteredBox(fromYaml<Eigen::Vector3d>(node.at("center")), fromYaml<Eigen::Vector3d>(node.at("dimensions")));
+	} else if (node.hasMember("min") && node.hasMember("max")) {
+		return Eigen::AlignedBox3d{fromYaml<Eigen::Vector3d>(node.at("min")), fromYaml<Eigen::Vector3d>(node.at("max"))};
+	}
+	throw std::runtime_error("wrong members for Eigen::AlignedBox3d on line " + std::to_string(node.line()) + ": need either center and dimensions or min and max");
+}
+
+template<> PoseHeader fromYaml<PoseHeader>(YamlNode const & node) {
+	ensureMap(node, "PoseHeader");
+	ensureSize(node, 2, "PoseHeader");
+	return PoseHeader{fromYaml<std::string>(node.at("parent_frame")), fromYaml<std::string>(node.at("child_frame"))};
+}
+
+template<> Pose fromYaml<Pose>(YamlNode const & node) {
+	ensureMap(node, "Pose");
+	ensureSize(node, 4, "Pose");
+
+	PoseHeader header{fromYaml<std::string>(node.at("parent_frame")), fromYaml<std::string>(node.at("child_frame"))};
+	Eigen::Isometry3d isometry = Eigen::Translation3d(fromYaml<Eigen::Vector3d>(node.at("position"))) * fromYaml<Eigen::Quaterniond>(node.at("orientation"));
+	return Pose{header, isometry};
+}
+
+void posesFromYaml(YamlNode const & sequence, std::vector<Pose> & poses) {
+	appendFromYaml(sequence, poses, "std::vector<Pose>");
+}
+
+void posesFromYaml(YamlNode const & sequence, std::vector<Pose, Eigen::aligned_allocator<Pose>> & poses) {
+	appendFromYaml(sequence, poses, "std::vector<Pose>");
+}
+
+void posesFromYaml(YamlNode const & sequence, std::vector<Eigen::Isometry3d> & poses) {
+	appendFromYaml(sequence, poses, "std::vector<Eigen::Isometry3d>");
+}
+
+void posesFromYaml(YamlNode const & sequence, std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> & poses) {
+	appendFromYaml(sequence, poses, "std::vector<Eigen::Isometry3d>");
+}
+
+}
@@ -0,0 +1,298 @@
+// Copyright 2014-2022, Fizyr B.V.
+
+#include "yaml_writer.hpp"
+#include "instrument.hpp"
+#include "yaml.hpp"
+
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace dr {
+
+namespace {
+	/// Check if a string can be written as plain YAML scalar that reads back as the same string.
+	bool isPlainScalar(std::string const & value) {
+		if (value.empty()) return false;
+		char first = value.front();
+		if (!std::isalpha(static_cast<unsigned char>(first)) && first != '_' && first != '/') return false;
+		for (char c : value) {
+			if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '/' && c != '.' && c != '-') return false;
+		}
+
+		// Words that YAML 1.1 parsers read as booleans or null.
+		if (value.size() > 5) return true;
+		for (char const * word : {"true", "false", "yes", "no", "on", "off", "y", "n", "null"}) {
+			std::size_t i = 0;
+			while (i < value.size() && word[i] && std::tolower(static_cast<unsigned char>(value[i])) == word[i]) ++i;
+			if (i == value.size() && !word[i]) return false;
+		}
+		return true;
+	}
+
+	/// Append a string as YAML scalar, quoted if needed.
+	void appendScalar(std::string & output, std::string const & value) {
+		if (isPlainScalar(value)) {
+			output.append(value);
+			return;
+		}
+		output.push_back('"');
+		for (char c : value) {
+			switch (c) {
+				case '"':  output.append("\\\""); break;
+				case '\\': output.append("\\\\"); break;
+				case '\n': output.append("\\n");  break;
+				case '\t': output.append("\\t");  break;
+				default:   output.push_back(c);
+			}
+		}
+		output.push_back('"');
+	}
+
+	/// Write all data to a file descriptor, or do nothing for a flush request without data.
+	void writeFd(int fd, char const * data, std::size_t size) {
+		while (size > 0) {
+			ssize_t written = ::write(fd, data, size);
+			if (written < 0) {
+				if (errno == EINTR) continue;
+				throw std::system_error(errno, std::generic_category(), "failed to write YAML output");
+			}
+			data += written;
+			size -= written;
+		}
+	}
+
+	/// Write all data to a stream, or flush the stream for a flush request without data.
+	void writeStream(std::ostream & stream, char const * data, std::size_t size) {
+		if (size == 0) {
+			stream.flush();
+		} else {
+			stream.write(data, size);
+		}
+		if (!stream) throw std::runtime_error("failed to write YAML output to stream");
+	}
+}
+
+PoseYamlWriter::PoseYamlWriter(int fd, PoseYamlWriterOptions const & options) :
+	PoseYamlWriter([fd] (char const * data, std::size_t size) { writeFd(fd, data, size); }, options) {}
+
+PoseYamlWriter::PoseYamlWriter(std::ostream & stream, PoseYamlWriterOptions const & options) :
+	PoseYamlWriter([&stream] (char const * data, std::size_t size) { writeStream(stream, data, size); }, options) {}
+
+PoseYamlWriter::PoseYamlWriter(std::function<void (char const *, std::size_t)> sink, PoseYamlWriterOptions const & options) :
+	sink_{std::move(sink)},
+	options_{options}
+{
+	if (options_.buffer_size == 0) throw std::invalid_argument("YAML writer buffer size must be positive");
+
+	// Leave room for one more pose, so a full buffer does not need to grow before it is flushed.
+	buffer_.reserve(options_.buffer_size + 1024);
+	if (options_.background_flush) {
+		pending_.reserve(options_.buffer_size + 1024);
+		thread_ = std::thread{&PoseYamlWriter::run, this};
+	}
+}
+
+PoseYamlWriter::~PoseYamlWriter() {
+	try {
+		close();
+	} catch (...) {}
+
+	if (thread_.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock{mutex_};
+			stop_ = true;
+		}
+		wake_.notify_all();
+		thread_.join();
+	}
+}
+
+void PoseYamlWriter::beginSequence() {
+	begin(false, nullptr);
+}
+
+void PoseYamlWriter::beginSequence(std::string const & key) {
+	begin(false, &key);
+}
+
+void PoseYamlWriter::beginMap() {
+	begin(true, nullptr);
+}
+
+void PoseYamlWriter::beginMap(std::string const & key) {
+	begin(true, &key);
+}
+
+void PoseYamlWriter::end() {
+	if (closed_) throw std::logic_error("YAML writer is closed");
+	if (nodes_.empty()) throw std::logic_error("no open YAML sequence or map to end");
+
+	Node node = nodes_.back();
+	nodes_.pop_back();
+	if (node.children == 0) {
+		// The key of the node is still on an open line, unless this is the top level node.
+		if (!nodes_.empty()) buffer_.push_back(' ');
+		buffer_.append(node.map ? "{}\n" : "[]\n");
+	}
+	maybeFlush();
+}
+
+void PoseYamlWriter::write(Pose const & pose) {
+	beginChild(false, nullptr);
+	appendPose(&pose.header, pose.isometry, nodes_.back().indent + 2);
+	maybeFlush();
+}
+
+void PoseYamlWriter::write(Eigen::Isometry3d const & isometry) {
+	beginChild(false, nullptr);
+	appendPose(nullptr, isometry, nodes_.back().indent + 2);
+	maybeFlush();
+}
+
+void PoseYamlWriter::write(std::string const & key, Pose const & pose) {
+	beginChild(true, &key);
+	std::size_t indent = nodes_.back().indent + 2;
+	buffer_.push_back('\n');
+	buffer_.append(indent, ' ');
+	appendPose(&pose.header, pose.isometry, indent);
+	maybeFlush();
+}
+
+void PoseYamlWriter::write(std::string const & key, Eigen::Isometry3d const & isometry) {
+	beginChild(true, &key);
+	std::size_t indent = nodes_.back().indent + 2;
+	buffer_.push_back('\n');
+	buffer_.append(indent, ' ');
+	appendPose(nullptr, isometry, indent);
+	maybeFlush();
+}
+
+void PoseYamlWriter::flush() {
+	checkError();
+	if (!buffer_.empty()) flushBuffer();
+	if (options_.background_flush) {
+		std::unique_lock<std::mutex> lock{mutex_};
+		done_.wait(lock, [this] { return !busy_; });
+	}
+	checkError();
+	sink_(nullptr, 0);
+}
+
+void PoseYamlWriter::close() {
+	if (closed_) return;
+	while (!nodes_.empty()) end();
+	closed_ = true;
+	flush();
+}
+
+void PoseYamlWriter::begin(bool map, std::string const * key) {
+	if (key) {
+		beginChild(true, key);
+		nodes_.push_back(Node{map, nodes_.back().indent + 2, 0});
+		return;
+	}
+
+	if (closed_) throw std::logic_error("YAML writer is closed");
+	if (started_) throw std::logic_error("YAML document already has a top level node");
+	started_ = true;
+	nodes_.push_back(Node{map, 0, 0});
+}
+
+void PoseYamlWriter::beginChild(bool map, std::string const * key) {
+	if (closed_) throw std::logic_error("YAML writer is closed");
+	if (nodes_.empty()) throw std::logic_error(map ? "no open YAML map to add a key to" : "no open YAML sequence to add an item to");
+	Node & node = nodes_.back();
+	if (node.map != map) throw std::logic_error(node.map ? "values in a YAML map need a key" : "items in a YAML sequence can not have a key");
+
+	// The first child ends the open line with the key of the node.
+	if (node.children++ == 0 && nodes_.size() > 1) buffer_.push_back('\n');
+
+	buffer_.append(node.indent, ' ');
+	if (map) {
+		appendScalar(buffer_, *key);
+		buffer_.push_back(':');
+	} else {
+		buffer_.append("- ");
+	}
+}
+
+void PoseYamlWriter::appendPose(PoseHeader const * header, Eigen::Isometry3d const & isometry, std::size_t indent) {
+	DR_EIGEN_INSTRUMENT_SCOPE(yaml_output, 1);
+	if (header) {
+		buffer_.append("parent_frame: ");
+		appendScalar(buffer_, header->parent_frame);
+		buffer_.push_back('\n');
+		buffer_.append(indent, ' ');
+		buffer_.append("child_frame:  ");
+		appendScalar(buffer_, header->child_frame);
+		buffer_.push_back('\n');
+		buffer_.append(indent, ' ');
+	}
+	buffer_.append("position:    ");
+	appendYaml(buffer_, Eigen::Vector3d(isometry.translation()));
+	buffer_.push_back('\n');
+	buffer_.append(indent, ' ');
+	buffer_.append("orientation: ");
+	appendYaml(buffer_, Eigen::Quaterniond(isometry.linear()));
+	buffer_.push_back('\n');
+}
+
+void PoseYamlWriter::maybeFlush() {
+	if (buffer_.size() >= options_.buffer_size) flushBuffer();
+}
+
+void PoseYamlWriter::flushBuffer() {
+	if (!options_.background_flush) {
+		sink_(buffer_.data(), buffer_.size());
+		buffer_.clear();
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		done_.wait(lock, [this] { return !busy_; });
+		std::swap(buffer_, pending_);
+		busy_ = true;
+	}
+	wake_.notify_one();
+	buffer_.clear();
+	checkError();
+}
+
+void PoseYamlWriter::checkError() {
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		std::swap(error, error_);
+	}
+	if (error) std::rethrow_exception(error);
+}
+
+void PoseYamlWriter::run() {
+	std::unique_lock<std::mutex> lock{mutex_};
+	while (true) {
+		wake_.wait(lock, [this] { return busy_ || stop_; });
+		if (!busy_) return;
+
+		lock.unlock();
+		std::exception_ptr error;
+		try {
+			sink_(pending_.data(), pending_.size());
+		} catch (...) {
+			error = std::current_exception();
+		}
+		lock.lock();
+
+		if (error && !error_) error_ = error;
+		busy_ = false;
+		done_.notify_all();
+	}
+}
+
+}
@@ -0,0 +1,337 @@
+#include "average.hpp"
+#include "eigen.hpp"
+#include "interpolate.hpp"
+#include "test/accuracy.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	using QuaternionL = Eigen::Quaternion<long double>;
+	using Vector3L    = Eigen::Matrix<long double, 3, 1>;
+
+	/// The number of samples in every input set.
+	constexpr std::size_t sample_count = 10000;
+
+	/// The number of samples averaged at once.
+	constexpr std::size_t average_size = 64;
+
+	double const pi = M_PI;
+
+	/// The stored accuracy and speed budgets, by kernel and input set.
+	/**
+	 * The error budgets are about four times the errors measured when they were set,
+	 * the cost budgets about three times the measured time relative to a quaternion product.
+	 * Update a budget together with the change to the kernel it belongs to.
+	 */
+	std::map<std::pair<std::string, std::string>, AccuracyBudget> const budgets = {
+		// kernel                inputs               ulp    radians  cost
+		{{"rpyToQuaternion",     "random"},          {10,    2e-15,   64}},
+		{{"rpyToQuaternion",     "gimbal lock"},     {10,    2e-15,   64}},
+		{{"rpyToQuaternion",     "tiny angles"},     {8,     1e-18,   50}},
+		{{"quaternionToRpy",     "random"},          {8,     2.5e-15, 140}},
+		{{"quaternionToRpy",     "gimbal lock"},     {8,     2.5e-15, 130}},
+		{{"quaternionToRpy",     "tiny angles"},     {1,     2e-18,   75}},
+		{{"interpolateRotation", "random"},          {12,    2e-15,   75}},
+		{{"interpolateRotation", "near antipodal"},  {12,    2.5e-15, 55}},
+		{{"interpolateRotation", "tiny angles"},     {12,    1.5e-15, 35}},
+		{{"interpolateIsometry", "random"},          {60,    1.3e-14, 150}},
+		{{"interpolateIsometry", "near antipodal"},  {120,   2.7e-14, 130}},
+		{{"interpolateIsometry", "tiny angles"},     {64,    1.8e-14, 100}},
+		{{"averageQuaternions",  "random"},          {26,    6e-15,   45}},
+		{{"averageQuaternions",  "near antipodal"},  {26,    6e-15,   45}},
+		{{"averageQuaternions",  "tiny spread"},     {20,    5e-15,   25}},
+		{{"PoseAccumulator",     "random"},          {22,    4e-15,   70}},
+		{{"PoseAccumulator",     "near antipodal"},  {16,    3.5e-15, 70}},
+		{{"PoseAccumulator",     "tiny spread"},     {16,    4e-15,   60}},
+		{{"averagePositions",    "random"},          {52,    0,       1}},
+		{{"averagePositions",    "large offset"},    {20,    0,       1}},
+	};
+
+	AccuracyBudget const & budget(std::string const & kernel, std::string const & inputs) {
+		auto result = budgets.find({kernel, inputs});
+		if (result == budgets.end()) throw std::logic_error("no accuracy budget for " + kernel + " on " + inputs);
+		return result->second;
+	}
+
+	/// The time of a quaternion product, which all budgets are relative to.
+	double referenceNanoseconds() {
+		static double const result = [] {
+			std::mt19937 generator{0};
+			std::normal_distribution<double> normal;
+			std::vector<Eigen::Quaterniond> quaternions;
+			for (std::size_t i = 0; i < 1024; ++i) {
+				quaternions.push_back(Eigen::Quaterniond{normal(generator), normal(generator), normal(generator), normal(generator)}.normalized());
+			}
+			return measureNanoseconds(sample_count, [&] (std::size_t i) {
+				return (quaternions[i % 1024] * quaternions[(i + 1) % 1024]).w();
+			});
+		}();
+		return result;
+	}
+
+	Eigen::Quaterniond randomQuaternion(std::mt19937 & generator) {
+		std::normal_distribution<double> normal;
+		return Eigen::Quaterniond{normal(generator), normal(generator), normal(generator), normal(generator)}.normalized();
+	}
+
+	Eigen::Vector3d randomAxis(std::mt19937 & generator) {
+		std::normal_distribution<double> normal;
+		return Eigen::Vector3d{normal(generator), normal(generator), normal(generator)}.normalized();
+	}
+
+	/// Draw an angle with a uniformly distributed exponent in [min, max].
+	double logUniform(std::mt19937 & generator, double min, double max) {
+		std::uniform_real_distribution<double> exponent{std::log(min), std::log(max)};
+		return std::exp(exponent(generator));
+	}
+
+	/// The rotation of z-y-x roll, pitch and yaw angles in extended precision.
+	QuaternionL referenceRpy(Eigen::Vector3d const & rpy) {
+		Vector3L half = rpy.cast<long double>() / 2;
+		QuaternionL x{std::cos(half.x()), std::sin(half.x()), 0, 0};
+		QuaternionL y{std::cos(half.y()), 0, std::sin(half.y()), 0};
+		QuaternionL z{std::cos(half.z()), 0, 0, std::sin(half.z())};
+		return z * y * x;
+	}
+
+	/// Interpolate along the shortest arc between two rotations in extended precision.
+	QuaternionL referenceSlerp(Eigen::Quaterniond const & a, Eigen::Quaterniond const & b, double factor) {
+		QuaternionL start      = a.cast<long double>();
+		QuaternionL difference = start.conjugate() * b.cast<long double>();
+		if (difference.w() < 0) difference.coeffs() = -difference.coeffs();
+		long double sine = difference.vec().norm();
+		if (sine == 0) return start;
+		long double angle = 2 * std::atan2(sine, difference.w());
+		return start * QuaternionL{Eigen::AngleAxis<long double>{factor * angle, difference.vec() / sine}};
+	}
+
+	/// Input sets of roll, pitch and yaw angles.
+	std::vector<std::pair<std::string, std::vector<Eigen::Vector3d>>> rpyInputs() {
+		std::mt19937 generator{1};
+		std::uniform_real_distribution<double> angle{-pi, pi};
+		std::uniform_real_distribution<double> pitch{-pi / 2, pi / 2};
+		std::bernoulli_distribution sign;
+
+		std::vector<std::pair<std::string, std::vector<Eigen::Vector3d>>> result{{"random", {}}, {"gimbal lock", {}}, {"tiny angles", {}}};
+		for (std::size_t i = 0; i < sample_count; ++i) {
+			result[0].second.emplace_back(angle(generator), pitch(generator), angle(generator));
+			double offset = i % 2 ? 0 : logUniform(generator, 1e-12, 1e-4);
+			result[1].second.emplace_back(angle(generator), (sign(generator) ? 1 : -1) * (pi / 2 - offset), angle(generator));
+			result[2].second.emplace_back(logUniform(generator, 1e-12, 1e-3), -logUniform(generator, 1e-12, 1e-3), logUniform(generator, 1e-12, 1e-3));
+		}
+		return result;
+	}
+
+	/// Input sets of pairs of rotations with an interpolation factor.
+	struct InterpolationInput {
+		Eigen::Quaterniond a;
+		Eigen::Quaterniond b;
+		double factor;
+	};
+
+	std::vector<std::pair<std::string, std::vector<InterpolationInput>>> interpolationInputs() {
+		std::mt19937 generator{2};
+		std::uniform_real_distribution<double> factor{0, 1};
+
+		std::vector<std::pair<std::string, std::vector<InterpolationInput>>> result{{"random", {}}, {"near antipodal", {}}, {"tiny angles", {}}};
+		for (std::size_t i = 0; i < sample_count; ++i) {
+			Eigen::Quaterniond a = randomQuaternion(generator);
+			result[0].second.push_back({a, randomQuaternion(generator), factor(generator)});
+
+			// Rotations almost half a turn apart, where the shortest arc is ill-conditioned.
+			Eigen::Quaterniond far{Eigen::AngleAxisd{pi - logUniform(generator, 1e-9, 1e-3), randomAxis(generator)}};
+			result[1].second.push_back({a, a * far, factor(generator)});
+
+			Eigen::Quaterniond near{Eigen::AngleAxisd{logUniform(generator, 1e-12, 1e-4), randomAxis(generator)}};
+			result[2].second.push_back({a, a * near, factor(generator)});
+		}
+		return result;
+	}
+
+	/// Sets of rotations spread symmetrically around a known mean.
+	struct AverageInput {
+		Eigen::Quaterniond mean;
+		std::vector<Eigen::Quaterniond> samples;
+	};
+
+	std::vector<std::pair<std::string, std::vector<AverageInput>>> averageInputs() {
+		std::mt19937 generator{3};
+		std::bernoulli_distribution sign;
+		std::vector<std::pair<std::string, std::vector<AverageInput>>> result{{"random", {}}, {"near antipodal", {}}, {"tiny spread", {}}};
+
+		for (std::size_t set = 0; set < sample_count / average_size; ++set) {
+			Eigen::Quaterniond mean = randomQuaternion(generator);
+			AverageInput random{mean, {}};
+			AverageInput tiny{mean, {}};
+
+			// A rotation of half a turn has w = 0, so tightly clustered rotations around it have w of both signs.
+			// Combined with random quaternion signs, the samples lie on both sides of the sign ambiguity.
+			Eigen::Quaterniond boundary{Eigen::AngleAxisd{pi, randomAxis(generator)}};
+			AverageInput antipodal{boundary, {}};
+			double cluster = logUniform(generator, 1e-6, 1e-2);
+
+			// Pairs mean * exp(v) and mean * exp(-v) have exactly the given mean.
+			for (std::size_t i = 0; i < average_size / 2; ++i) {
+				Eigen::Vector3d axis = randomAxis(generator);
+				for (double direction : {1.0, -1.0}) {
+					random.samples.push_back(mean * Eigen::Quaterniond{Eigen::AngleAxisd{direction * 0.5, axis}});
+					tiny.samples.push_back(mean * Eigen::Quaterniond{Eigen::AngleAxisd{direction * 1e-9, axis}});
+
+					Eigen::Quaterniond clustered = boundary * Eigen::Quaterniond{Eigen::AngleAxisd{direction * cluster, axis}};
+					antipodal.samples.push_back(sign(generator) ? clustered : Eigen::Quaterniond{-clustered.coeffs()});
+				}
+			}
+			result[0].second.push_back(std::move(random));
+			result[1].second.push_back(std::move(antipodal));
+			result[2].second.push_back(std::move(tiny));
+		}
+		return result;
+	}
+}
+
+TEST(Accuracy, rpyToQuaternion) {
+	for (auto const & input : rpyInputs()) {
+		std::vector<Eigen::Vector3d> const & angles = input.second;
+		AccuracyStats stats;
+		for (Eigen::Vector3d const & rpy : angles) {
+			Eigen::Quaterniond actual = dr::rpyToQuaternion(rpy);
+			QuaternionL expected      = referenceRpy(rpy);
+			stats.add(ulpError(actual, expected), angularError(actual, expected));
+		}
+		double time = measureNanoseconds(angles.size(), [&] (std::size_t i) { return dr::rpyToQuaternion(angles[i]).w(); });
+		EXPECT_TRUE(checkAccuracyBudget("rpyToQuaternion", input.first, stats, time, referenceNanoseconds(), budget("rpyToQuaternion", input.first)));
+	}
+}
+
+TEST(Accuracy, quaternionToRpy) {
+	// The angles are not unique at gimbal lock, so the rotation they describe is compared instead.
+	for (auto const & input : rpyInputs()) {
+		std::vector<Eigen::Quaterniond> rotations;
+		for (Eigen::Vector3d const & rpy : input.second) rotations.push_back(referenceRpy(rpy).cast<double>());
+
+		AccuracyStats stats;
+		for (Eigen::Quaterniond const & rotation : rotations) {
+			QuaternionL actual = referenceRpy(dr::quaternionToRpy(rotation));
+			stats.add(ulpError(actual.cast<double>(), rotation), angularError(actual, rotation));
+		}
+		double time = measureNanoseconds(rotations.size(), [&] (std::size_t i) { return dr::quaternionToRpy(rotations[i]).x(); });
+		EXPECT_TRUE(checkAccuracyBudget("quaternionToRpy", input.first, stats, time, referenceNanoseconds(), budget("quaternionToRpy", input.first)));
+	}
+}
+
+TEST(Accuracy, interpolateRotation) {
+	for (auto const & input : interpolationInputs()) {
+		std::vector<InterpolationInput> const & pairs = input.second;
+		AccuracyStats stats;
+		for (InterpolationInput const & pair : pairs) {
+			Eigen::Quaterniond actual = dr::interpolateRotation(pair.a, pair.b, pair.factor);
+			QuaternionL expected      = referenceSlerp(pair.a, pair.b, pair.factor);
+			stats.add(ulpError(actual, expected), angularError(actual, expected));
+		}
+		double time = measureNanoseconds(pairs.size(), [&] (std::size_t i) { return dr::interpolateRotation(pairs[i].a, pairs[i].b, pairs[i].factor).w(); });
+		EXPECT_TRUE(checkAccuracyBudget("interpolateRotation", input.first, stats, time, referenceNanoseconds(), budget("interpolateRotation", input.first)));
+	}
+}
+
+TEST(Accuracy, interpolateIsometry) {
+	std::mt19937 generator{4};
+	std::uniform_real_distribution<double> coordinate{-10, 10};
+
+	for (auto const & input : interpolationInputs()) {
+		std::vector<std::pair<Eigen::Isometry3d, Eigen::Isometry3d>> isometries;
+		for (InterpolationInput const & pair : input.second) {
+			Eigen::Vector3d a{coordinate(generator), coordinate(generator), coordinate(generator)};
+			Eigen::Vector3d b{coordinate(generator), coordinate(generator), coordinate(generator)};
+			isometries.emplace_back(Eigen::Translation3d{a} * pair.a, Eigen::Translation3d{b} * pair.b);
+		}
+
+		AccuracyStats stats;
+		for (std::size_t i = 0; i < isometries.size(); ++i) {
+			InterpolationInput const & pair = input.second[i];
+			Eigen::Isometry3d actual = dr::interpolateIsometry(isometries[i].first, isometries[i].second, pair.factor);
+			QuaternionL expected     = referenceSlerp(Eigen::Quaterniond{isometries[i].first.linear()}, Eigen::Quaterniond{isometries[i].second.linear()}, pair.factor);
+			Vector3L expected_translation = isometries[i].first.translation().cast<long double>()
+				+ pair.factor * (isometries[i].second.translation() - isometries[i].first.translation()).cast<long double>();
+			Eigen::Quaterniond rotation{actual.linear()};
+			stats.add(std::max(ulpError(rotation, expected), ulpError(actual.translation(), expected_translation)), angularError(rotation, expected));
+		}
+		double time = measureNanoseconds(isometries.size(), [&] (std::size_t i) {
+			return dr::interpolateIsometry(isometries[i].first, isometries[i].second, input.second[i].factor)(0, 3);
+		});
+		EXPECT_TRUE(checkAccuracyBudget("interpolateIsometry", input.first, stats, time, referenceNanoseconds(), budget("interpolateIsometry", input.first)));
+	}
+}
+
+TEST(Accuracy, averageQuaternions) {
+	for (auto const & input : averageInputs()) {
+		std::vector<AverageInput> const & sets = input.second;
+		AccuracyStats stats;
+		for (AverageInput const & set : sets) {
+			Eigen::Quaterniond actual = dr::averageQuaternions<double>(set.samples);
+			stats.add(ulpError(actual, set.mean), angularError(actual, set.mean));
+		}
+		// Time per sample, so the cost is comparable with the other kernels.
+		double time = measureNanoseconds(sets.size(), [&] (std::size_t i) { return dr::averageQuaternions<double>(sets[i].samples).w(); }) / average_size;
+		EXPECT_TRUE(checkAccuracyBudget("averageQuaternions", input.first, stats, time, referenceNanoseconds(), budget("averageQuaternions", input.first)));
+	}
+}
+
+TEST(Accuracy, poseAccumulator) {
+	auto average = [] (std::vector<Eigen::Quaterniond> const & samples) {
+		PoseAccumulator<double> accumulator;
+		for (Eigen::Quaterniond const & sample : samples) accumulator.add(Eigen::Vector3d::Zero(), sample);
+		return accumulator.rotation();
+	};
+
+	for (auto const & input : averageInputs()) {
+		std::vector<AverageInput> const & sets = input.second;
+		AccuracyStats stats;
+		for (AverageInput const & set : sets) {
+			Eigen::Quaterniond actual = average(set.samples);
+			stats.add(ulpError(actual, set.mean), angularError(actual, set.mean));
+		}
+		double time = measureNanoseconds(sets.size(), [&] (std::size_t i) { return average(sets[i].samples).w(); }) / average_size;
+		EXPECT_TRUE(checkAccuracyBudget("PoseAccumulator", input.first, stats, time, referenceNanoseconds(), budget("PoseAccumulator", input.first)));
+	}
+}
+
+TEST(Accuracy, averagePositions) {
+	std::mt19937 generator{5};
+	std::uniform_real_distribution<double> coordinate{-1, 1};
+
+	// Small differences on a large offset, where naive summation loses precision.
+	for (std::pair<std::string, double> input : {std::make_pair(std::string{"random"}, 0.0), std::make_pair(std::string{"large offset"}, 1e6)}) {
+		std::vector<std::vector<Eigen::Vector3d>> sets(sample_count / average_size);
+		for (std::vector<Eigen::Vector3d> & set : sets) {
+			for (std::size_t i = 0; i < average_size; ++i) {
+				set.push_back(Eigen::Vector3d::Constant(input.second) + Eigen::Vector3d{coordinate(generator), coordinate(generator), coordinate(generator)});
+			}
+		}
+
+		AccuracyStats stats;
+		for (std::vector<Eigen::Vector3d> const & set : sets) {
+			Vector3L expected = Vector3L::Zero();
+			for (Eigen::Vector3d const & position : set) expected += position.cast<long double>();
+			expected /= set.size();
+			stats.add(ulpError(dr::averagePositions<double>(set), expected));
+		}
+		double time = measureNanoseconds(sets.size(), [&] (std::size_t i) { return dr::averagePositions<double>(sets[i]).x(); }) / average_size;
+		EXPECT_TRUE(checkAccuracyBudget("averagePositions", input.first, stats, time, referenceNanoseconds(), budget("averagePositions", input.first)));
+	}
+}
+
+}
@@ -51,3 +51,117 @@ TEST(AverageIsometryTest, averageIsometries) {
 	ASSERT_TRUE(testNear(expected, actual));
 }
 
+
+TEST(KarcherMeanTest, symmetricRotations) {
+	std::vector<Eigen::Isometry3d> isometries;
+	isometries.push_back(Eigen::Translation3d(1, 0, 0) * Eigen::AngleAxisd( 0.4, Eigen::Vector3d::UnitZ()));
+	isometries.push_back(Eigen::Translation3d(3, 0, 0) * Eigen::AngleAxisd(-0.4, Eigen::Vector3d::UnitZ()));
+
+	KarcherMeanResult<double> result = karcherMean<double>(isometries);
+	ASSERT_TRUE(result.converged);
+	ASSERT_TRUE(testNear(Eigen::Isometry3d(Eigen::Translation3d(2, 0, 0)), result.mean, 1e-9));
+}
+
+TEST(KarcherMeanTest, zeroMeanResidual) {
+	std::vector<Eigen::Isometry3d> isometries;
+	isometries.push_back(Eigen::Translation3d(0, 1, 2) * Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX()));
+	isometries.push_back(Eigen::Translation3d(1, 0, 2) * Eigen::AngleAxisd(1.2, Eigen::Vector3d::UnitY()));
+	isometries.push_back(Eigen::Translation3d(2, 2, 0) * Eigen::AngleAxisd(0.8, Eigen::Vector3d(1, 1, 1).normalized()));
+
+	for (KarcherSpace space : {KarcherSpace::so3_r3, KarcherSpace::se3}) {
+		KarcherMeanResult<double> result = karcherMean<double>(isometries, space);
+		ASSERT_TRUE(result.converged);
+		ASSERT_LE(result.iterations, 10);
+		ASSERT_LE(result.residual, 1e-12);
+
+		// The Karcher mean is where the tangent vectors of all samples sum to zero.
+		Eigen::Matrix<double, 6, 1> sum = Eigen::Matrix<double, 6, 1>::Zero();
+		for (Eigen::Isometry3d const & isometry : isometries) {
+			Eigen::Isometry3d relative = result.mean.inverse() * isometry;
+			if (space == KarcherSpace::se3) {
+				sum += se3Log(relative);
+			} else {
+				sum.head<3>() += isometry.translation() - result.mean.translation();
+				sum.tail<3>() += so3Log(Eigen::Quaterniond(relative.rotation()));
+			}
+		}
+		ASSERT_LE(sum.norm(), 1e-9);
+	}
+}
+
+TEST(KarcherMeanTest, iterationLimit) {
+	std::vector<Eigen::Isometry3d> isometries;
+	isometries.push_back(Eigen::Translation3d(0, 1, 2) * Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX()));
+	isometries.push_back(Eigen::Translation3d(1, 0, 2) * Eigen::AngleAxisd(1.2, Eigen::Vector3d::UnitY()));
+
+	KarcherMeanResult<double> result = karcherMean<double>(isometries, KarcherSpace::se3, 0.0, 1);
+	ASSERT_FALSE(result.converged);
+	ASSERT_EQ(1, result.iterations);
+	ASSERT_THROW(karcherMean<double>(std::vector<Eigen::Isometry3d>{}), std::logic_error);
+}
+
+TEST(PoseAccumulatorTest, covariance) {
+	Eigen::Isometry3d center = Eigen::Translation3d(1, 2, 3) * Eigen::AngleAxisd(0.7, Eigen::Vector3d(1, 2, 3).normalized());
+
+	// Small perturbations with known covariance in the tangent space of the center.
+	std::vector<Eigen::Matrix<double, 6, 1>> offsets;
+	for (int i = 0; i < 6; ++i) {
+		Eigen::Matrix<double, 6, 1> offset = Eigen::Matrix<double, 6, 1>::Zero();
+		offset(i) = 1e-3 * (i + 1);
+		offset((i + 1) % 6) = 5e-4;
+		offsets.push_back(offset);
+		offsets.push_back(-offset);
+	}
+
+	std::vector<Eigen::Isometry3d> isometries;
+	Eigen::Matrix<double, 6, 6> expected = Eigen::Matrix<double, 6, 6>::Zero();
+	for (auto const & offset : offsets) {
+		Eigen::Vector3d position = center.translation() + offset.head<3>();
+		isometries.push_back(Eigen::Translation3d(position) * Eigen::Quaterniond(center.rotation()) * so3Exp<double>(offset.tail<3>()));
+		expected += offset * offset.transpose() / (offsets.size() - 1);
+	}
+
+	Eigen::Matrix<double, 6, 6> covariance;
+	Eigen::Isometry3d mean = averageIsometries<double>(isometries, covariance);
+	ASSERT_TRUE(testNear(center, mean, 1e-9));
+	ASSERT_TRUE(covariance.isApprox(expected, 1e-4)) << covariance << "\n\n" << expected;
+
+	Eigen::Matrix3d position_covariance;
+	std::vector<Eigen::Vector3d> positions;
+	for (auto const & isometry : isometries) positions.push_back(isometry.translation());
+	ASSERT_TRUE(testNear(center.translation(), averagePositions<double>(positions, position_covariance), {1e-12, 1e-12, 1e-12}));
+	ASSERT_TRUE(position_covariance.isApprox(expected.topLeftCorner<3, 3>(), 1e-12));
+
+	Eigen::Matrix3d rotation_covariance;
+	std::vector<Eigen::Quaterniond> rotations;
+	for (auto const & isometry : isometries) rotations.push_back(Eigen::Quaterniond(isometry.rotation()));
+	averageQuaternions<double>(rotations, rotation_covariance);
+	ASSERT_TRUE(rotation_covariance.isApprox(expected.bottomRightCorner<3, 3>(), 1e-4));
+}
+
+TEST(PoseAccumulatorTest, merge) {
+	std::vector<Eigen::Isometry3d> isometries;
+	for (int i = 0; i < 10; ++i) {
+		isometries.push_back(Eigen::Translation3d(0.1 * i, -0.2 * i * i, 1) * Eigen::AngleAxisd(0.05 * i, Eigen::Vector3d(1, i, 2).normalized()));
+	}
+
+	PoseAccumulator<double> all;
+	PoseAccumulator<double> first;
+	PoseAccumulator<double> second;
+	for (int i = 0; i < 10; ++i) {
+		all.add(isometries[i]);
+		if (i < 4) {
+			first.add(isometries[i]);
+		} else {
+			// Flip the sign of the quaternions of the second batch.
+			second.add(isometries[i].translation(), Eigen::Quaterniond(-Eigen::Quaterniond(isometries[i].rotation()).coeffs()));
+		}
+	}
+	first.merge(second);
+
+	ASSERT_EQ(10u, first.count());
+	ASSERT_TRUE(testNear(all.mean(), first.mean(), 1e-12));
+	ASSERT_TRUE(first.covariance().isApprox(all.covariance(), 1e-12));
+
+	ASSERT_THROW(PoseAccumulator<double>().mean(), std::logic_error);
+}
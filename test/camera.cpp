@@ -0,0 +1,192 @@
+// Allow tests to check that Eigen does not allocate memory.
+#define EIGEN_RUNTIME_NO_MALLOC
+
+#include "eigen.hpp"
+#include "camera.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	BrownConrady<double> distortion() {
+		BrownConrady<double> result;
+		result.k1 = -0.12;
+		result.k2 = 0.05;
+		result.p1 = 0.001;
+		result.p2 = -0.002;
+		result.k3 = -0.01;
+		return result;
+	}
+
+	/// Random points in front of the camera that project inside a 640x480 image.
+	Eigen::Matrix3Xd randomPoints(Eigen::Index count, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::uniform_real_distribution<double> x{-0.5, 0.5};
+		std::uniform_real_distribution<double> y{-0.35, 0.35};
+		std::uniform_real_distribution<double> z{0.3, 2};
+		Eigen::Matrix3Xd result(3, count);
+		for (Eigen::Index i = 0; i < count; ++i) {
+			double depth = z(generator);
+			result.col(i) << x(generator) * depth, y(generator) * depth, depth;
+		}
+		return result;
+	}
+}
+
+TEST(CameraTest, projectPinhole) {
+	PinholeCamera<double> camera{500, 510, 320, 240};
+	EXPECT_TRUE(camera.project(Eigen::Vector3d{0, 0, 2}).isApprox(Eigen::Vector2d{320, 240}));
+	EXPECT_TRUE(camera.project(Eigen::Vector3d{0.2, -0.1, 2}).isApprox(Eigen::Vector2d{370, 214.5}));
+	EXPECT_TRUE(camera.project(Eigen::Vector3d{0.2, -0.1, -2}).hasNaN());
+	EXPECT_TRUE(camera.unproject(Eigen::Vector2d{370, 214.5}, 2).isApprox(Eigen::Vector3d{0.2, -0.1, 2}));
+	EXPECT_TRUE(PinholeCamera<double>{camera.matrix()}.matrix().isApprox(camera.matrix()));
+	EXPECT_THROW((PinholeCamera<double>{0, 500, 320, 240}), std::invalid_argument);
+}
+
+TEST(CameraTest, distortion) {
+	BrownConrady<double> model = distortion();
+	Eigen::ArrayXd x(3);
+	Eigen::ArrayXd y(3);
+	x << 0, 0.3, -0.4;
+	y << 0, -0.2, 0.3;
+	Eigen::ArrayXd original_x = x;
+	Eigen::ArrayXd original_y = y;
+
+	model.distort(x, y);
+	EXPECT_DOUBLE_EQ(x(0), 0);
+	double r2 = 0.3 * 0.3 + 0.2 * 0.2;
+	double radial = 1 + model.k1 * r2 + model.k2 * r2 * r2 + model.k3 * r2 * r2 * r2;
+	EXPECT_NEAR(x(1), 0.3 * radial + 2 * model.p1 * 0.3 * -0.2 + model.p2 * (r2 + 2 * 0.3 * 0.3), 1e-15);
+	EXPECT_NEAR(y(1), -0.2 * radial + model.p1 * (r2 + 2 * 0.2 * 0.2) + 2 * model.p2 * 0.3 * -0.2, 1e-15);
+
+	model.undistort(x, y);
+	EXPECT_LT((x - original_x).abs().maxCoeff(), 1e-9);
+	EXPECT_LT((y - original_y).abs().maxCoeff(), 1e-9);
+}
+
+TEST(CameraTest, distortionDoesNotAllocate) {
+	PinholeCamera<double> camera{500, 500, 320, 240, distortion()};
+	Eigen::ArrayXd x = Eigen::ArrayXd::LinSpaced(300, -0.4, 0.4);
+	Eigen::ArrayXd y = Eigen::ArrayXd::LinSpaced(300, 0.3, -0.3);
+
+	Eigen::internal::set_is_malloc_allowed(false);
+	Eigen::Vector2d pixel = camera.project(Eigen::Vector3d{0.2, -0.1, 2});
+	Eigen::Vector3d ray   = camera.ray(pixel);
+	camera.distortion().distort(x, y);
+	camera.distortion().undistort(x, y);
+	Eigen::internal::set_is_malloc_allowed(true);
+
+	EXPECT_TRUE(ray.isApprox(Eigen::Vector3d{0.1, -0.05, 1}, 1e-9));
+	EXPECT_LT((x - Eigen::ArrayXd::LinSpaced(300, -0.4, 0.4)).abs().maxCoeff(), 1e-9);
+}
+
+TEST(CameraTest, roundTripDistorted) {
+	PinholeCamera<double> camera{500, 500, 320, 240, distortion()};
+	Eigen::Matrix3Xd points = randomPoints(200, 1);
+	for (Eigen::Index i = 0; i < points.cols(); ++i) {
+		Eigen::Vector2d pixel = camera.project(points.col(i));
+		EXPECT_LT((camera.unproject(pixel, points(2, i)) - points.col(i)).norm(), 1e-6);
+	}
+}
+
+TEST(CameraTest, batchedProject) {
+	PinholeCamera<double> camera{500, 510, 320, 240, distortion()};
+	Eigen::Isometry3d camera_from_world = translate(0.1, -0.2, 0.3) * rotate(0.2, Eigen::Vector3d{1, 2, 3}.normalized());
+	Eigen::Matrix3Xd points = camera_from_world.inverse() * randomPoints(3000, 2);
+	points.col(7) = camera_from_world.inverse() * Eigen::Vector3d{0, 0, -1};
+
+	Eigen::Matrix2Xd pixels;
+	camera.project(points, camera_from_world, pixels, 3);
+	ASSERT_EQ(pixels.cols(), points.cols());
+	for (Eigen::Index i = 0; i < points.cols(); ++i) {
+		Eigen::Vector2d expected = camera.project(camera_from_world * points.col(i));
+		if (i == 7) {
+			EXPECT_TRUE(pixels.col(i).hasNaN());
+		} else {
+			EXPECT_LT((pixels.col(i) - expected).norm(), 1e-9);
+		}
+	}
+}
+
+TEST(CameraTest, batchedUnproject) {
+	PinholeCamera<double> camera{500, 510, 320, 240, distortion()};
+	Eigen::Isometry3d world_from_camera = translate(0.1, -0.2, 0.3) * rotate(0.2, Eigen::Vector3d{1, 2, 3}.normalized());
+	Eigen::Matrix3Xd camera_points = randomPoints(1000, 3);
+
+	Eigen::Matrix2Xd pixels;
+	camera.project(camera_points, Eigen::Isometry3d::Identity(), pixels);
+	Eigen::Matrix3Xd points;
+	camera.unproject(pixels, camera_points.row(2).transpose(), world_from_camera, points, 2);
+	ASSERT_EQ(points.cols(), camera_points.cols());
+	for (Eigen::Index i = 0; i < points.cols(); ++i) {
+		EXPECT_LT((points.col(i) - world_from_camera * camera_points.col(i)).norm(), 1e-6);
+	}
+	EXPECT_THROW(camera.unproject(pixels, Eigen::VectorXd(3), world_from_camera, points), std::invalid_argument);
+}
+
+TEST(CameraTest, depthImage) {
+	PinholeCamera<float> camera{50, 50, 15.5, 11.5};
+	Eigen::Matrix<std::uint16_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> depth(24, 32);
+	for (Eigen::Index row = 0; row < depth.rows(); ++row) {
+		for (Eigen::Index col = 0; col < depth.cols(); ++col) depth(row, col) = 1000 + row * 10 + col;
+	}
+	depth(3, 4) = 0;
+	depth(20, 0) = 0;
+
+	Eigen::Isometry3f world_from_camera = Eigen::Translation3f{1, 2, 3} * Eigen::AngleAxisf{0.5, Eigen::Vector3f::UnitZ()};
+	DepthCloudConverter<float> converter{camera, 32, 24};
+	DepthCloudOptions options;
+	options.depth_scale = 0.001;
+	options.threads = 3;
+
+	Eigen::Matrix3Xf points;
+	converter.convert(depth, world_from_camera, points, options);
+	ASSERT_EQ(points.cols(), 32 * 24 - 2);
+	Eigen::Index index = 0;
+	for (Eigen::Index row = 0; row < depth.rows(); ++row) {
+		for (Eigen::Index col = 0; col < depth.cols(); ++col) {
+			if (depth(row, col) == 0) continue;
+			Eigen::Vector3f expected = world_from_camera * camera.unproject(Eigen::Vector2f(col, row), depth(row, col) * 0.001f);
+			EXPECT_LT((points.col(index++) - expected).norm(), 1e-5);
+		}
+	}
+
+	options.organized = true;
+	converter.convert(depth, world_from_camera, points, options);
+	ASSERT_EQ(points.cols(), 32 * 24);
+	EXPECT_TRUE(points.col(3 * 32 + 4).hasNaN());
+	EXPECT_TRUE(points.col(20 * 32).hasNaN());
+	Eigen::Vector3f expected = world_from_camera * camera.unproject(Eigen::Vector2f(5, 3), depth(3, 5) * 0.001f);
+	EXPECT_LT((points.col(3 * 32 + 5) - expected).norm(), 1e-5);
+
+	EXPECT_THROW(converter.convert(depth.topRows(10), world_from_camera, points, options), std::invalid_argument);
+}
+
+TEST(CameraTest, depthImageDistorted) {
+	PinholeCamera<double> camera{500, 500, 319.5, 239.5, distortion()};
+	Eigen::MatrixXf depth = Eigen::MatrixXf::Constant(48, 64, 1.5f);
+	depth(10, 10) = std::numeric_limits<float>::quiet_NaN();
+	DepthCloudConverter<double> converter{camera, 64, 48};
+
+	Eigen::Matrix3Xd points;
+	converter.convert(depth, Eigen::Isometry3d::Identity(), points);
+	ASSERT_EQ(points.cols(), 64 * 48 - 1);
+	EXPECT_LT((points.col(0) - camera.unproject(Eigen::Vector2d(0, 0), 1.5)).norm(), 1e-9);
+	EXPECT_LT((points.col(64 * 10 + 11 - 1) - camera.unproject(Eigen::Vector2d(11, 10), 1.5)).norm(), 1e-9);
+	for (Eigen::Index i = 0; i < points.cols(); ++i) {
+		Eigen::Vector2d pixel = camera.project(points.col(i));
+		EXPECT_NEAR(pixel.x(), std::round(pixel.x()), 1e-6);
+		EXPECT_NEAR(pixel.y(), std::round(pixel.y()), 1e-6);
+	}
+}
+
+}
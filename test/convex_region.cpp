@@ -0,0 +1,187 @@
+#include "eigen.hpp"
+#include "convex_region.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	Eigen::Matrix3Xd randomPoints(Eigen::Index count, double size, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::uniform_real_distribution<double> distribution{-size, size};
+		Eigen::Matrix3Xd result(3, count);
+		for (Eigen::Index i = 0; i < count; ++i) result.col(i) << distribution(generator), distribution(generator), distribution(generator);
+		return result;
+	}
+}
+
+TEST(ConvexRegionTest, empty) {
+	ConvexRegion<double> region;
+	EXPECT_EQ(region.size(), 0);
+	EXPECT_TRUE(region.contains(Eigen::Vector3d{1e9, -1e9, 0}));
+	EXPECT_EQ(region.intersects(Eigen::AlignedBox3d{Eigen::Vector3d{0, 0, 0}, Eigen::Vector3d{1, 1, 1}}), RegionIntersection::inside);
+}
+
+TEST(ConvexRegionTest, planes) {
+	// The half space below the XY plane of a pose, and the half space with x below 1.
+	ConvexRegion<double> region{std::vector<Eigen::Hyperplane<double, 3>>{
+		makeXyPlane(Eigen::Isometry3d{translate(0, 0, 2)}),
+		makePlane(Eigen::Vector3d::UnitX(), Eigen::Vector3d{1, 0, 0}),
+	}};
+	ASSERT_EQ(region.size(), 2);
+	EXPECT_TRUE(region.contains(Eigen::Vector3d{0, 5, 1}));
+	EXPECT_TRUE(region.contains(Eigen::Vector3d{1, 5, 2}));
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{0, 5, 3}));
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{2, 5, 1}));
+	EXPECT_NEAR(region.signedDistance(Eigen::Vector3d{0, 0, 1.5}), -0.5, 1e-12);
+
+	region.addPlane(makePlane(-Eigen::Vector3d::UnitX(), Eigen::Vector3d{-1, 0, 0}));
+	EXPECT_EQ(region.size(), 3);
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{-2, 5, 1}));
+}
+
+TEST(ConvexRegionTest, box) {
+	Eigen::AlignedBox3d box{Eigen::Vector3d{-1, -2, -3}, Eigen::Vector3d{1, 2, 3}};
+	Eigen::Isometry3d pose = translate(1, 2, 3) * rotate(0.7, Eigen::Vector3d{1, 2, 3}.normalized());
+	ConvexRegion<double> region = ConvexRegion<double>::fromBox(box, pose);
+	ASSERT_EQ(region.size(), 6);
+
+	Eigen::Matrix3Xd points = randomPoints(2000, 4, 1);
+	for (Eigen::Index i = 0; i < points.cols(); ++i) {
+		EXPECT_EQ(region.contains(pose * points.col(i)), box.contains(points.col(i)));
+	}
+}
+
+TEST(ConvexRegionTest, transformed) {
+	Eigen::AlignedBox3d box{Eigen::Vector3d{-1, -2, -3}, Eigen::Vector3d{1, 2, 3}};
+	Eigen::Isometry3d pose = translate(-1, 0.5, 3) * rotate(-1.2, Eigen::Vector3d{3, 1, 2}.normalized());
+	ConvexRegion<double> region = ConvexRegion<double>::fromBox(box).transformed(pose);
+	ConvexRegion<double> expected = ConvexRegion<double>::fromBox(box, pose);
+	for (Eigen::Index i = 0; i < region.size(); ++i) {
+		EXPECT_TRUE(region.plane(i).normal().isApprox(expected.plane(i).normal(), 1e-12));
+		EXPECT_NEAR(region.plane(i).offset(), expected.plane(i).offset(), 1e-12);
+	}
+}
+
+TEST(ConvexRegionTest, frustum) {
+	Eigen::Isometry3d camera = translate(0, 0, 1) * rotate(M_PI, Eigen::Vector3d::UnitX());
+	ConvexRegion<double> region = ConvexRegion<double>::fromFrustum(camera, M_PI / 2, M_PI / 3, 0.1, 2);
+
+	// The camera looks down along the world Z axis.
+	EXPECT_TRUE(region.contains(Eigen::Vector3d{0, 0, 0}));
+	EXPECT_TRUE(region.contains(Eigen::Vector3d{0.9, 0, 0}));
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{1.1, 0, 0}));
+	EXPECT_TRUE(region.contains(Eigen::Vector3d{0, std::tan(M_PI / 6) - 0.01, 0}));
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{0, std::tan(M_PI / 6) + 0.01, 0}));
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{0, 0, 0.95}));
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{0, 0, -1.05}));
+	EXPECT_FALSE(region.contains(Eigen::Vector3d{0, 0, 2}));
+
+	EXPECT_THROW(ConvexRegion<double>::fromFrustum(camera, 0, 1, 0.1, 2), std::invalid_argument);
+	EXPECT_THROW(ConvexRegion<double>::fromFrustum(camera, 1, M_PI, 0.1, 2), std::invalid_argument);
+	EXPECT_THROW(ConvexRegion<double>::fromFrustum(camera, 1, 1, 2, 1), std::invalid_argument);
+}
+
+TEST(ConvexRegionTest, containsCloud) {
+	Eigen::Isometry3d camera = translate(0.2, -0.1, 0) * rotate(0.3, Eigen::Vector3d::UnitY());
+	ConvexRegion<double> region = ConvexRegion<double>::fromFrustum(camera, 1.2, 0.9, 0.5, 3);
+	Eigen::Matrix3Xd points = randomPoints(10000, 3, 2);
+
+	Eigen::Array<bool, Eigen::Dynamic, 1> inside;
+	region.contains(points, inside, 3);
+	ASSERT_EQ(inside.size(), points.cols());
+	Eigen::Index count = 0;
+	for (Eigen::Index i = 0; i < points.cols(); ++i) {
+		EXPECT_EQ(inside(i), region.contains(points.col(i)));
+		count += inside(i);
+	}
+	EXPECT_GT(count, 0);
+
+	Eigen::Matrix3Xd cropped = region.crop(points, 2);
+	ASSERT_EQ(cropped.cols(), count);
+	for (Eigen::Index i = 0; i < cropped.cols(); ++i) EXPECT_TRUE(region.contains(cropped.col(i)));
+}
+
+TEST(ConvexRegionTest, containsCloudFloat) {
+	ConvexRegion<float> region = ConvexRegion<float>::fromBox(Eigen::AlignedBox3f{Eigen::Vector3f{0, 0, 0}, Eigen::Vector3f{1, 1, 1}});
+	Eigen::Matrix3Xf points(3, 3);
+	points << 0.5, 1.5, 0.5,
+	          0.5, 0.5, 0.5,
+	          0.5, 0.5, -0.5;
+	Eigen::Array<bool, Eigen::Dynamic, 1> inside;
+	region.contains(points, inside);
+	EXPECT_TRUE(inside(0));
+	EXPECT_FALSE(inside(1));
+	EXPECT_FALSE(inside(2));
+}
+
+TEST(ConvexRegionTest, clip) {
+	ConvexRegion<double> region = ConvexRegion<double>::fromBox(Eigen::AlignedBox3d{Eigen::Vector3d{-1, -1, -1}, Eigen::Vector3d{1, 1, 1}});
+
+	// Crossing the whole box.
+	Eigen::Vector3d start{-3, 0, 0};
+	Eigen::Vector3d end{3, 0, 0};
+	ASSERT_TRUE(region.clip(start, end));
+	EXPECT_TRUE(start.isApprox(Eigen::Vector3d{-1, 0, 0}));
+	EXPECT_TRUE(end.isApprox(Eigen::Vector3d{1, 0, 0}));
+
+	// Starting inside.
+	start = {0, 0, 0};
+	end   = {0, 0, 4};
+	ASSERT_TRUE(region.clip(start, end));
+	EXPECT_TRUE(start.isApprox(Eigen::Vector3d{0, 0, 0}));
+	EXPECT_TRUE(end.isApprox(Eigen::Vector3d{0, 0, 1}));
+
+	// Completely inside.
+	start = {-0.5, 0.5, 0};
+	end   = {0.5, -0.5, 0.2};
+	ASSERT_TRUE(region.clip(start, end));
+	EXPECT_TRUE(start.isApprox(Eigen::Vector3d{-0.5, 0.5, 0}));
+	EXPECT_TRUE(end.isApprox(Eigen::Vector3d{0.5, -0.5, 0.2}));
+
+	// Passing by a corner.
+	start = {0, 3, 0};
+	end   = {3, 0, 0};
+	EXPECT_FALSE(region.clip(start, end));
+	EXPECT_TRUE(start.isApprox(Eigen::Vector3d{0, 3, 0}));
+
+	// Parallel to a face, outside.
+	start = {-3, 2, 0};
+	end   = {3, 2, 0};
+	EXPECT_FALSE(region.clip(start, end));
+}
+
+TEST(ConvexRegionTest, intersectsBox) {
+	ConvexRegion<double> region = ConvexRegion<double>::fromBox(Eigen::AlignedBox3d{Eigen::Vector3d{-1, -1, -1}, Eigen::Vector3d{1, 1, 1}});
+	EXPECT_EQ(region.intersects(Eigen::AlignedBox3d{Eigen::Vector3d{-0.5, -0.5, -0.5}, Eigen::Vector3d{0.5, 0.5, 0.5}}), RegionIntersection::inside);
+	EXPECT_EQ(region.intersects(Eigen::AlignedBox3d{Eigen::Vector3d{0.5, 0.5, 0.5}, Eigen::Vector3d{1.5, 1.5, 1.5}}), RegionIntersection::intersecting);
+	EXPECT_EQ(region.intersects(Eigen::AlignedBox3d{Eigen::Vector3d{1.5, -0.5, -0.5}, Eigen::Vector3d{2.5, 0.5, 0.5}}), RegionIntersection::outside);
+
+	// A box that contains the whole region.
+	EXPECT_EQ(region.intersects(Eigen::AlignedBox3d{Eigen::Vector3d{-2, -2, -2}, Eigen::Vector3d{2, 2, 2}}), RegionIntersection::intersecting);
+
+	// Random boxes must never be classified too optimistically.
+	Eigen::Matrix3Xd centers = randomPoints(500, 2, 3);
+	Eigen::Matrix3Xd samples = randomPoints(200, 1, 4);
+	for (Eigen::Index i = 0; i < centers.cols(); ++i) {
+		Eigen::AlignedBox3d box{centers.col(i) - Eigen::Vector3d::Constant(0.3), centers.col(i) + Eigen::Vector3d::Constant(0.3)};
+		RegionIntersection relation = region.intersects(box);
+		for (Eigen::Index j = 0; j < samples.cols(); ++j) {
+			Eigen::Vector3d point = centers.col(i) + 0.3 * samples.col(j);
+			if (relation == RegionIntersection::inside) {
+				EXPECT_TRUE(region.contains(point));
+			} else if (relation == RegionIntersection::outside) {
+				EXPECT_FALSE(region.contains(point));
+			}
+		}
+	}
+}
+
+}
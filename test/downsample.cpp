@@ -0,0 +1,198 @@
+#include "downsample.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <random>
+#include <tuple>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	Eigen::Matrix3Xd randomPoints(std::size_t count, double offset, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::uniform_real_distribution<double> distribution{-1, 1};
+		Eigen::Matrix3Xd result(3, count);
+		for (std::size_t i = 0; i < count; ++i) result.col(i) << distribution(generator), distribution(generator), distribution(generator);
+		return result.array() + offset;
+	}
+
+	/// Compute the voxel centroids with a std::map, keyed by voxel coordinates.
+	std::map<std::tuple<int, int, int>, std::pair<Eigen::Vector3d, int>> bruteCentroids(Eigen::Matrix3Xd const & points, double voxel_size) {
+		std::map<std::tuple<int, int, int>, std::pair<Eigen::Vector3d, int>> result;
+		for (Eigen::Index i = 0; i < points.cols(); ++i) {
+			Eigen::Vector3i voxel = (points.col(i) / voxel_size).array().floor().cast<int>();
+			auto & entry = result.emplace(std::make_tuple(voxel.x(), voxel.y(), voxel.z()), std::make_pair(Eigen::Vector3d::Zero(), 0)).first->second;
+			entry.first  += points.col(i);
+			entry.second += 1;
+		}
+		for (auto & entry : result) entry.second.first /= entry.second.second;
+		return result;
+	}
+
+	void expectCentroids(Eigen::Matrix3Xd const & points, double voxel_size, VoxelCloud<double> const & cloud) {
+		auto expected = bruteCentroids(points, voxel_size);
+		ASSERT_EQ(std::size_t(cloud.points.cols()), expected.size());
+		ASSERT_EQ(cloud.counts.size(), expected.size());
+		for (Eigen::Index i = 0; i < cloud.points.cols(); ++i) {
+			Eigen::Vector3i voxel = (cloud.points.col(i) / voxel_size).array().floor().cast<int>();
+			auto found = expected.find(std::make_tuple(voxel.x(), voxel.y(), voxel.z()));
+			ASSERT_NE(found, expected.end());
+			EXPECT_TRUE(cloud.points.col(i).isApprox(found->second.first, 1e-12));
+			EXPECT_EQ(int(cloud.counts[i]), found->second.second);
+		}
+	}
+}
+
+TEST(VoxelDownsampleTest, empty) {
+	EXPECT_EQ(voxelDownsample<double>(Eigen::Matrix3Xd(3, 0), 0.1).cols(), 0);
+}
+
+TEST(VoxelDownsampleTest, invalidVoxelSize) {
+	EXPECT_THROW(voxelDownsample<double>(randomPoints(10, 0, 1), 0), std::invalid_argument);
+	EXPECT_THROW(voxelDownsample<double>(randomPoints(10, 0, 1), -1), std::invalid_argument);
+}
+
+TEST(VoxelDownsampleTest, singleVoxel) {
+	Eigen::Matrix3Xd points(3, 3);
+	points <<
+		0.1, 0.2, 0.3,
+		0.5, 0.5, 0.8,
+		0.0, 0.9, 0.3;
+	Eigen::Matrix3Xd result = voxelDownsample<double>(points, 1);
+	ASSERT_EQ(result.cols(), 1);
+	EXPECT_TRUE(result.col(0).isApprox(Eigen::Vector3d(0.2, 0.6, 0.4)));
+}
+
+TEST(VoxelDownsampleTest, nonFinitePoints) {
+	double nan = std::numeric_limits<double>::quiet_NaN();
+	double inf = std::numeric_limits<double>::infinity();
+	Eigen::Matrix3Xd points(3, 6);
+	points <<
+		0.1, nan, 0.2, 0.3, 0.5, inf,
+		0.5, nan, 0.5, 0.8, nan, 0.0,
+		0.0, nan, 0.9, 0.3, 0.5, 0.0;
+
+	VoxelDownsampler<double> downsampler;
+	VoxelCloud<double> cloud;
+	VoxelDownsampleOptions options;
+	options.covariances = true;
+	downsampler.downsample(points, 1, cloud, options);
+	ASSERT_EQ(cloud.points.cols(), 1);
+	EXPECT_EQ(cloud.counts[0], 3u);
+	EXPECT_TRUE(cloud.points.col(0).isApprox(Eigen::Vector3d(0.2, 0.6, 0.4)));
+	EXPECT_TRUE(cloud.covariances[0].allFinite());
+}
+
+TEST(VoxelDownsampleTest, farApartPoints) {
+	// Voxels 2^20 apart would alias in the 21 bit voxel keys.
+	Eigen::Matrix3Xd points(3, 3);
+	points <<
+		0.5, 0.5, -1048575.5,
+		0.5, 0.5, 0.5,
+		0.5, 0.5, 0.5;
+	Eigen::Matrix3Xd result = voxelDownsample<double>(points, 1);
+	ASSERT_EQ(result.cols(), 2);
+	EXPECT_TRUE(result.col(1).isApprox(points.col(2)));
+
+	points(0, 2) = -1048576.5;
+	EXPECT_THROW(voxelDownsample<double>(points, 1), std::out_of_range);
+	points(0, 2) = 1048576.5;
+	EXPECT_THROW(voxelDownsample<double>(points, 1), std::out_of_range);
+	EXPECT_THROW(voxelDownsample<double>(points, 1e-6), std::out_of_range);
+}
+
+TEST(VoxelDownsampleTest, centroids) {
+	Eigen::Matrix3Xd points = randomPoints(20000, 0, 2);
+	VoxelDownsampler<double> downsampler;
+	VoxelCloud<double> cloud;
+	downsampler.downsample(points, 0.2, cloud);
+	expectCentroids(points, 0.2, cloud);
+	EXPECT_EQ(cloud.normals.cols(), 0);
+	EXPECT_TRUE(cloud.covariances.empty());
+}
+
+TEST(VoxelDownsampleTest, threadCountIndependent) {
+	Eigen::Matrix3Xd points = randomPoints(50000, 0, 3);
+	VoxelDownsampler<double> downsampler;
+	VoxelCloud<double> single;
+	VoxelCloud<double> multi;
+	VoxelDownsampleOptions options;
+	options.threads = 1;
+	downsampler.downsample(points, 0.1, single, options);
+	options.threads = 4;
+	downsampler.downsample(points, 0.1, multi, options);
+	ASSERT_EQ(single.points.cols(), multi.points.cols());
+	EXPECT_TRUE(single.points.isApprox(multi.points, 1e-12));
+	EXPECT_EQ(single.counts, multi.counts);
+	expectCentroids(points, 0.1, multi);
+}
+
+TEST(VoxelDownsampleTest, reuse) {
+	VoxelDownsampler<double> downsampler;
+	VoxelCloud<double> cloud;
+	for (unsigned int seed = 4; seed < 7; ++seed) {
+		Eigen::Matrix3Xd points = randomPoints(10000 + 1000 * seed, 0, seed);
+		downsampler.downsample(points, 0.25, cloud);
+		expectCentroids(points, 0.25, cloud);
+	}
+}
+
+TEST(VoxelDownsampleTest, minPoints) {
+	Eigen::Matrix3Xd points = randomPoints(2000, 0, 7);
+	VoxelDownsampler<double> downsampler;
+	VoxelCloud<double> cloud;
+	VoxelDownsampleOptions options;
+	options.min_points = 3;
+	downsampler.downsample(points, 0.2, cloud, options);
+
+	std::size_t expected = 0;
+	for (auto const & entry : bruteCentroids(points, 0.2)) expected += entry.second.second >= 3;
+	EXPECT_EQ(std::size_t(cloud.points.cols()), expected);
+	for (std::uint32_t count : cloud.counts) EXPECT_GE(count, 3u);
+}
+
+TEST(VoxelDownsampleTest, normalsAndCovariances) {
+	// Points on the plane z = 1000.25, far from the origin.
+	std::mt19937 generator{8};
+	std::uniform_real_distribution<double> distribution{1000, 1001};
+	Eigen::Matrix3Xd points(3, 5000);
+	for (Eigen::Index i = 0; i < points.cols(); ++i) points.col(i) << distribution(generator), distribution(generator), 1000.25;
+
+	VoxelDownsampler<double> downsampler;
+	VoxelCloud<double> cloud;
+	VoxelDownsampleOptions options;
+	options.normals     = true;
+	options.covariances = true;
+	options.threads     = 3;
+	downsampler.downsample(points, 0.5, cloud, options);
+	ASSERT_EQ(cloud.points.cols(), 4);
+	ASSERT_EQ(cloud.normals.cols(), 4);
+	ASSERT_EQ(cloud.covariances.size(), 4u);
+
+	for (Eigen::Index i = 0; i < 4; ++i) {
+		EXPECT_NEAR(std::abs(cloud.normals(2, i)), 1, 1e-9);
+		EXPECT_NEAR(cloud.covariances[i](2, 2), 0, 1e-9);
+		// Uniform over an interval of 0.5 has a variance of 0.5^2 / 12.
+		EXPECT_NEAR(cloud.covariances[i](0, 0), 0.25 / 12, 2e-3);
+		EXPECT_NEAR(cloud.covariances[i](1, 1), 0.25 / 12, 2e-3);
+	}
+}
+
+TEST(VoxelDownsampleTest, float) {
+	Eigen::Matrix3Xf points = randomPoints(1000, 5, 9).cast<float>();
+	Eigen::Matrix3Xf result = voxelDownsample<float>(points, 1.f);
+	EXPECT_EQ(result.cols(), 8);
+	for (Eigen::Index i = 0; i < result.cols(); ++i) {
+		EXPECT_NEAR((result.col(i) - Eigen::Vector3f::Constant(5)).cwiseAbs().maxCoeff(), 0.5f, 0.1f);
+	}
+}
+
+}
@@ -0,0 +1,90 @@
+#include "eigen.hpp"
+#include "dual_quaternion.hpp"
+#include "test/compare.hpp"
+
+#include <gtest/gtest.h>
+
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	double pi = 3.1415926536;
+}
+
+TEST(DualQuaternionTest, isometryRoundTrip) {
+	Eigen::Isometry3d isometry = translate(1, -2, 3) * rotateX(0.3) * rotateZ(-1.2);
+	DualQuaterniond transform(isometry);
+
+	ASSERT_TRUE(testNear(isometry, transform.isometry(), 1e-9));
+	ASSERT_TRUE(testNear({1, -2, 3}, transform.translation(), {1e-12, 1e-12, 1e-12}));
+	ASSERT_TRUE(testNear(isometry * Eigen::Vector3d{4, 5, 6}, transform * Eigen::Vector3d{4, 5, 6}, {1e-12, 1e-12, 1e-12}));
+
+	Pose pose = toPose(transform, PoseHeader{"parent", "child"});
+	ASSERT_EQ("parent", pose.header.parent_frame);
+	ASSERT_TRUE(toDualQuaternion(pose).isApprox(transform));
+}
+
+TEST(DualQuaternionTest, composition) {
+	Eigen::Isometry3d a = translate(1, 2, 3) * rotateY(0.5);
+	Eigen::Isometry3d b = translate(-3, 0, 1) * rotateX(-1.5);
+
+	ASSERT_TRUE(testNear(a * b, (DualQuaterniond(a) * DualQuaterniond(b)).isometry(), 1e-9));
+	ASSERT_TRUE(testNear(a.inverse(), DualQuaterniond(a).inverse().isometry(), 1e-9));
+	ASSERT_TRUE((DualQuaterniond(a) * DualQuaterniond(a).inverse()).isApprox(DualQuaterniond::Identity()));
+}
+
+TEST(DualQuaternionTest, screwInterpolation) {
+	DualQuaterniond a(translate(1, 2, 3) * rotateY(0.5));
+	DualQuaterniond b(translate(-3, 0, 1) * rotateX(-1.5));
+
+	ASSERT_TRUE(interpolateDualQuaternion(a, b, 0.0).isApprox(a));
+	ASSERT_TRUE(interpolateDualQuaternion(a, b, 1.0).isApprox(b));
+
+	// Two half steps along the screw give the full motion.
+	DualQuaterniond half = interpolateDualQuaternion(a, b, 0.5);
+	ASSERT_TRUE((half * a.conjugate() * half).isApprox(b));
+}
+
+TEST(DualQuaternionTest, screwInterpolationAroundPivot) {
+	// A pure rotation around an axis not through the origin keeps following that axis.
+	Eigen::Vector3d pivot{1, 1, 0};
+	Eigen::Isometry3d a = Eigen::Isometry3d::Identity();
+	Eigen::Isometry3d b = rotate(0.5 * pi, axes::z(), pivot);
+
+	ASSERT_TRUE(testNear(rotate(0.25 * pi, axes::z(), pivot), interpolateIsometryScrew(a, b, 0.5), 1e-9));
+}
+
+TEST(DualQuaternionTest, screwInterpolationPureTranslation) {
+	Eigen::Isometry3d a = translate(0, 0, 0) * rotateZ(0.2);
+	Eigen::Isometry3d b = translate(2, 4, 6) * rotateZ(0.2);
+
+	ASSERT_TRUE(testNear(translate(0.5, 1, 1.5) * rotateZ(0.2), interpolateIsometryScrew(a, b, 0.25), 1e-9));
+}
+
+TEST(DualQuaternionTest, blend) {
+	std::vector<Eigen::Isometry3d> isometries;
+	isometries.push_back(translate(0, 0, 0) * rotateX(0.2));
+	isometries.push_back(translate(2, 4, 6) * rotateX(0.2));
+
+	// Blending pure translations averages the translation.
+	ASSERT_TRUE(testNear(translate(1, 2, 3) * rotateX(0.2), blendDualQuaternions<double>(isometries).isometry(), 1e-9));
+
+	// Weights select the transformation.
+	ASSERT_TRUE(testNear(isometries[1], blendDualQuaternions<double>(isometries, std::vector<double>{0, 1}).isometry(), 1e-9));
+
+	// The sign of the quaternion does not matter.
+	std::vector<DualQuaterniond> transforms{DualQuaterniond(isometries[0]), DualQuaterniond(isometries[1])};
+	transforms[1].real().coeffs() *= -1;
+	transforms[1].dual().coeffs() *= -1;
+	ASSERT_TRUE(testNear(translate(1, 2, 3) * rotateX(0.2), blendDualQuaternions<double>(transforms).isometry(), 1e-9));
+
+	ASSERT_THROW(blendDualQuaternions<double>(std::vector<Eigen::Isometry3d>{}), std::logic_error);
+	ASSERT_THROW(blendDualQuaternions<double>(isometries, std::vector<double>{1}), std::logic_error);
+}
+
+}
@@ -0,0 +1,101 @@
+#include "eigen.hpp"
+#include "hand_eye.hpp"
+#include "test/compare.hpp"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	Eigen::Isometry3d cameraInFlange() {
+		return translate(0.05, -0.02, 0.1) * rotate(0.4, Eigen::Vector3d(1, -1, 2).normalized());
+	}
+
+	Eigen::Isometry3d targetInBase() {
+		return translate(0.8, 0.1, -0.2) * rotateZ(0.3);
+	}
+
+	/// Generate flange poses and the matching target observations.
+	void generate(std::size_t count, std::vector<Eigen::Isometry3d> & flange, std::vector<Eigen::Isometry3d> & target, double noise = 0) {
+		std::mt19937 generator(42);
+		std::uniform_real_distribution<double> angle(-0.8, 0.8);
+		std::uniform_real_distribution<double> position(-0.2, 0.2);
+		std::normal_distribution<double> error(0, noise > 0 ? noise : 1);
+		for (std::size_t i = 0; i < count; ++i) {
+			Eigen::Isometry3d pose = translate(0.5 + position(generator), position(generator), 0.4 + position(generator)) * rotateX(angle(generator)) * rotateY(angle(generator)) * rotateZ(angle(generator));
+			flange.push_back(pose);
+			Eigen::Isometry3d observation = cameraInFlange().inverse() * pose.inverse() * targetInBase();
+			if (noise > 0) observation = translate(error(generator), error(generator), error(generator)) * observation * rotateZ(error(generator));
+			target.push_back(observation);
+		}
+	}
+}
+
+TEST(HandEyeTest, exact) {
+	std::vector<Eigen::Isometry3d> flange;
+	std::vector<Eigen::Isometry3d> target;
+	generate(20, flange, target);
+
+	HandEyeMotions motions = handEyeMotions(flange, target);
+	ASSERT_EQ(19u, motions.a.size());
+
+	HandEyeResult result = calibrateHandEye(motions.a, motions.b);
+	EXPECT_TRUE(testNear(cameraInFlange(), result.initial, 1e-9));
+	EXPECT_TRUE(testNear(cameraInFlange(), result.transform, 1e-9));
+	EXPECT_TRUE(result.converged);
+	EXPECT_NEAR(0, result.rotation_error, 1e-9);
+	EXPECT_NEAR(0, result.translation_error, 1e-9);
+}
+
+TEST(HandEyeTest, noiseAndOutliers) {
+	std::vector<Eigen::Isometry3d> flange;
+	std::vector<Eigen::Isometry3d> target;
+	generate(1000, flange, target, 1e-4);
+
+	// Corrupt a few observations.
+	for (std::size_t i = 100; i < 1000; i += 100) target[i] = translate(0.1, 0, 0) * target[i] * rotateX(0.2);
+
+	HandEyeMotions motions = handEyeMotions(flange, target);
+	HandEyeOptions options;
+	options.loss       = RobustLoss::cauchy;
+	options.loss_scale = 1e-3;
+	options.threads    = 4;
+	HandEyeResult result = calibrateHandEye(motions.a, motions.b, options);
+
+	EXPECT_TRUE(testNear(cameraInFlange(), result.transform, 2e-4));
+	EXPECT_LE(result.iterations, options.max_iterations);
+}
+
+TEST(HandEyeTest, poses) {
+	std::vector<Eigen::Isometry3d> flange;
+	std::vector<Eigen::Isometry3d> target;
+	generate(5, flange, target);
+
+	std::vector<Pose> flange_poses;
+	std::vector<Pose> target_poses;
+	for (std::size_t i = 0; i < flange.size(); ++i) {
+		flange_poses.push_back(Pose{PoseHeader{"base", "flange"}, flange[i]});
+		target_poses.push_back(Pose{PoseHeader{"camera", "target"}, target[i]});
+	}
+
+	HandEyeMotions motions = handEyeMotions(flange_poses, target_poses);
+	EXPECT_TRUE(testNear(cameraInFlange(), calibrateHandEye(motions.a, motions.b).transform, 1e-9));
+}
+
+TEST(HandEyeTest, invalid) {
+	std::vector<Eigen::Isometry3d> one{Eigen::Isometry3d::Identity()};
+	std::vector<Eigen::Isometry3d> two{Eigen::Isometry3d::Identity(), Eigen::Isometry3d::Identity()};
+	ASSERT_THROW(calibrateHandEye(one, one), std::invalid_argument);
+	ASSERT_THROW(calibrateHandEye(one, two), std::invalid_argument);
+	ASSERT_THROW(handEyeMotions(one, two), std::invalid_argument);
+}
+
+}
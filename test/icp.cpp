@@ -0,0 +1,139 @@
+#include "eigen.hpp"
+#include "icp.hpp"
+#include "test/compare.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	/// Sample points on the surface of a box, so every axis is constrained.
+	Eigen::Matrix3Xd boxSurface(std::size_t count, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::uniform_real_distribution<double> distribution{-1, 1};
+		std::uniform_int_distribution<int> face{0, 5};
+		Eigen::Vector3d size{0.4, 0.3, 0.2};
+		Eigen::Matrix3Xd result(3, count);
+		for (std::size_t i = 0; i < count; ++i) {
+			Eigen::Vector3d point{distribution(generator), distribution(generator), distribution(generator)};
+			int f = face(generator);
+			point[f / 2] = f % 2 ? 1 : -1;
+			result.col(i) = point.cwiseProduct(size);
+		}
+		return result;
+	}
+
+	Eigen::Isometry3d offset() {
+		return translate(0.02, -0.01, 0.015) * rotate(0.05, Eigen::Vector3d(1, 2, 3).normalized());
+	}
+}
+
+TEST(IcpTest, noTarget) {
+	Icp<double> icp;
+	EXPECT_THROW(icp.align(boxSurface(10, 1), Eigen::Isometry3d::Identity()), std::logic_error);
+}
+
+TEST(IcpTest, pointToPoint) {
+	Eigen::Matrix3Xd target = boxSurface(3000, 1);
+	Eigen::Matrix3Xd source = offset().inverse() * target;
+
+	Icp<double> icp{target};
+	IcpOptions options;
+	options.max_iterations = 100;
+	IcpResult<double> result = icp.align(source, Eigen::Isometry3d::Identity(), options);
+	EXPECT_TRUE(result.converged);
+	EXPECT_EQ(result.inliers, 3000u);
+	EXPECT_TRUE(testNear(offset(), result.transform, 1e-6));
+	EXPECT_NEAR(result.rms_error, 0, 1e-6);
+}
+
+TEST(IcpTest, pointToPlane) {
+	Eigen::Matrix3Xd target = boxSurface(20000, 2);
+	// Sample the source independently, so there are no exact point correspondences.
+	Eigen::Matrix3Xd source = offset().inverse() * boxSurface(1000, 3);
+
+	Icp<double> icp{target};
+	IcpOptions options;
+	options.metric = IcpMetric::point_to_plane;
+	IcpResult<double> result = icp.align(source, Eigen::Isometry3d::Identity(), options);
+	EXPECT_TRUE(result.converged);
+	EXPECT_TRUE(testNear(offset(), result.transform, 2e-3));
+	EXPECT_LT(result.rms_error, 1e-3);
+}
+
+TEST(IcpTest, trimmedWithOutliers) {
+	Eigen::Matrix3Xd target = boxSurface(2000, 4);
+	Eigen::Matrix3Xd source(3, 2200);
+	source.leftCols(2000) = offset().inverse() * target;
+	source.rightCols(200) = boxSurface(200, 5) * 3;
+
+	Icp<double> icp{target};
+	IcpOptions options;
+	options.max_iterations = 100;
+	options.trim_ratio     = 0.85;
+	IcpResult<double> result = icp.align(source, Eigen::Isometry3d::Identity(), options);
+	EXPECT_TRUE(result.converged);
+	// Trimming keeps at least 85% of the correspondences, more only if distances tie at the threshold.
+	EXPECT_GE(result.inliers, 1870u);
+	EXPECT_LE(result.inliers, 2000u);
+	EXPECT_TRUE(testNear(offset(), result.transform, 1e-6));
+}
+
+TEST(IcpTest, robustLoss) {
+	Eigen::Matrix3Xd target = boxSurface(2000, 6);
+	Eigen::Matrix3Xd source(3, 2100);
+	source.leftCols(2000) = offset().inverse() * target;
+	source.rightCols(100) = boxSurface(100, 7) * 1.3;
+
+	Icp<double> icp{target};
+	IcpOptions options;
+	options.max_iterations = 100;
+	options.loss           = RobustLoss::cauchy;
+	options.loss_scale     = 0.005;
+	options.max_correspondence_distance = 0.1;
+	IcpResult<double> result = icp.align(source, Eigen::Isometry3d::Identity(), options);
+	EXPECT_TRUE(testNear(offset(), result.transform, 1e-4));
+}
+
+TEST(IcpTest, reuse) {
+	Eigen::Matrix3Xd target = boxSurface(2000, 8);
+	Icp<double> icp{target};
+	for (int i = 1; i <= 3; ++i) {
+		Eigen::Isometry3d expected = translate(0.01 * i, 0, 0) * rotate(0.02 * i, Eigen::Vector3d::UnitZ());
+		IcpOptions options;
+		options.max_iterations = 100;
+		// Change the thread count once, so the worker threads are both reused and restarted.
+		options.threads        = i == 3 ? 2 : 4;
+		IcpResult<double> result = icp.align(expected.inverse() * target, Eigen::Isometry3d::Identity(), options);
+		EXPECT_TRUE(testNear(expected, result.transform, 1e-6));
+	}
+}
+
+TEST(IcpTest, estimateNormals) {
+	Eigen::Matrix3Xd points = boxSurface(2000, 9);
+	KdTree<double> tree{points};
+	Eigen::Matrix3Xd normals;
+	estimateNormals(points, tree, 8, normals);
+	ASSERT_EQ(normals.cols(), 2000);
+
+	// Points away from the edges must get the normal of their face.
+	int checked = 0;
+	for (Eigen::Index i = 0; i < points.cols(); ++i) {
+		Eigen::Vector3d relative = points.col(i).cwiseQuotient(Eigen::Vector3d{0.4, 0.3, 0.2}).cwiseAbs();
+		Eigen::Index axis;
+		relative.maxCoeff(&axis);
+		if ((relative.array() > 0.7).count() > 1) continue;
+		EXPECT_NEAR(std::abs(normals(axis, i)), 1, 1e-6);
+		++checked;
+	}
+	EXPECT_GT(checked, 800);
+}
+
+}
@@ -0,0 +1,121 @@
+#include "average.hpp"
+#include "instrument.hpp"
+#include "interpolate.hpp"
+#include "yaml.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	InstrumentCounters counters(InstrumentProbe probe) {
+		return instrumentationSnapshot()[std::size_t(probe)];
+	}
+
+	/// The expected count, or zero if the code is compiled without instrumentation.
+	std::uint64_t expected(std::uint64_t count) {
+		return instrumentationEnabled() ? count : 0;
+	}
+
+	std::vector<Eigen::Quaterniond> rotations() {
+		return {
+			Eigen::Quaterniond{Eigen::AngleAxisd{0.1, Eigen::Vector3d::UnitX()}},
+			Eigen::Quaterniond{Eigen::AngleAxisd{0.2, Eigen::Vector3d::UnitY()}},
+			Eigen::Quaterniond{Eigen::AngleAxisd{0.3, Eigen::Vector3d::UnitZ()}},
+		};
+	}
+}
+
+TEST(Instrument, countsCallsAndElements) {
+	resetInstrumentation();
+	averageQuaternions<double>(rotations());
+	averageQuaternions<double>(rotations());
+	interpolateRotation(rotations()[0], rotations()[1], 0.5);
+
+	InstrumentCounters average = counters(InstrumentProbe::average_quaternions);
+	EXPECT_EQ(average.calls,    expected(2));
+	EXPECT_EQ(average.elements, expected(6));
+	EXPECT_EQ(counters(InstrumentProbe::interpolate_rotation).calls, expected(1));
+	EXPECT_EQ(counters(InstrumentProbe::average_positions).calls, 0u);
+}
+
+TEST(Instrument, nestedCallsCountOnce) {
+	resetInstrumentation();
+	std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> isometries;
+	for (Eigen::Quaterniond const & rotation : rotations()) isometries.push_back(Eigen::Translation3d{1, 2, 3} * rotation);
+
+	// karcherMean starts from averageIsometries, which uses the other averaging functions.
+	karcherMean<double>(isometries.begin(), isometries.end());
+	EXPECT_EQ(counters(InstrumentProbe::average_isometries).calls,    expected(1));
+	EXPECT_EQ(counters(InstrumentProbe::average_isometries).elements, expected(3));
+	EXPECT_EQ(counters(InstrumentProbe::average_quaternions).calls,   expected(1));
+	EXPECT_EQ(counters(InstrumentProbe::average_positions).calls,     expected(1));
+
+	// interpolateIsometry interpolates the rotation with a different probe.
+	interpolateIsometry(isometries[0], isometries[1], 0.5);
+	EXPECT_EQ(counters(InstrumentProbe::interpolate_isometry).calls, expected(1));
+	EXPECT_EQ(counters(InstrumentProbe::interpolate_rotation).calls, expected(1));
+}
+
+TEST(Instrument, sumsThreads) {
+	resetInstrumentation();
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([] {
+			for (int j = 0; j < 100; ++j) averagePositions<double>(std::vector<Eigen::Vector3d>{{1, 2, 3}, {4, 5, 6}});
+		});
+	}
+
+	// Reading while the threads count must be safe.
+	while (counters(InstrumentProbe::average_positions).calls < expected(400)) std::this_thread::yield();
+	for (std::thread & thread : threads) thread.join();
+
+	InstrumentCounters positions = counters(InstrumentProbe::average_positions);
+	EXPECT_EQ(positions.calls,    expected(400));
+	EXPECT_EQ(positions.elements, expected(800));
+	EXPECT_EQ(positions.nanoseconds > 0, instrumentationEnabled());
+
+	// The counts of finished threads are kept.
+	std::thread{[] { averagePositions<double>(std::vector<Eigen::Vector3d>{{1, 2, 3}}); }}.join();
+	EXPECT_EQ(counters(InstrumentProbe::average_positions).calls, expected(401));
+}
+
+TEST(Instrument, reset) {
+	averageQuaternions<double>(rotations());
+	resetInstrumentation();
+	for (InstrumentCounters const & probe : instrumentationSnapshot()) {
+		EXPECT_EQ(probe.calls,       0u);
+		EXPECT_EQ(probe.elements,    0u);
+		EXPECT_EQ(probe.nanoseconds, 0u);
+	}
+}
+
+TEST(Instrument, libraryProbes) {
+	resetInstrumentation();
+	toYaml(Pose{PoseHeader{"world", "tool"}, Eigen::Isometry3d::Identity()});
+	EXPECT_EQ(counters(InstrumentProbe::yaml_output).calls, expected(1));
+}
+
+TEST(Instrument, json) {
+	resetInstrumentation();
+	averageQuaternions<double>(rotations());
+	std::string json = instrumentationJson();
+	EXPECT_EQ(json.front(), '{');
+	EXPECT_EQ(json.back(),  '}');
+	std::string average = "\"average_quaternions\": {\"calls\": " + std::to_string(expected(1)) + ", \"elements\": " + std::to_string(expected(3)) + ", \"nanoseconds\": ";
+	EXPECT_NE(json.find(average), std::string::npos) << json;
+	EXPECT_NE(json.find("\"xmlrpc_parse\": {\"calls\": 0, \"elements\": 0, \"nanoseconds\": 0}"), std::string::npos) << json;
+	EXPECT_NE(json.find(instrumentationEnabled() ? "\"enabled\": true" : "\"enabled\": false"), std::string::npos) << json;
+}
+
+}
@@ -0,0 +1,187 @@
+#include "kd_tree.hpp"
+#include "voxel_hash.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	Eigen::Matrix3Xd randomPoints(std::size_t count, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::uniform_real_distribution<double> distribution{-1, 1};
+		Eigen::Matrix3Xd result(3, count);
+		for (std::size_t i = 0; i < count; ++i) result.col(i) << distribution(generator), distribution(generator), distribution(generator);
+		return result;
+	}
+
+	/// Find the neighbours within a radius by brute force, sorted by index.
+	std::vector<std::size_t> bruteRadius(Eigen::Matrix3Xd const & points, Eigen::Vector3d const & query, double radius) {
+		std::vector<std::size_t> result;
+		for (Eigen::Index i = 0; i < points.cols(); ++i) {
+			if ((points.col(i) - query).squaredNorm() <= radius * radius) result.push_back(i);
+		}
+		return result;
+	}
+
+	/// Find the k nearest neighbours by brute force.
+	std::vector<Neighbor<double>> bruteKnn(Eigen::Matrix3Xd const & points, Eigen::Vector3d const & query, std::size_t k) {
+		std::vector<Neighbor<double>> result;
+		for (Eigen::Index i = 0; i < points.cols(); ++i) result.push_back(Neighbor<double>{std::size_t(i), (points.col(i) - query).squaredNorm()});
+		std::sort(result.begin(), result.end());
+		result.resize(std::min(k, result.size()));
+		return result;
+	}
+
+	std::vector<std::size_t> indices(std::vector<Neighbor<double>> const & neighbors) {
+		std::vector<std::size_t> result;
+		for (Neighbor<double> const & neighbor : neighbors) result.push_back(neighbor.index);
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+}
+
+TEST(KdTreeTest, empty) {
+	KdTree<double> tree{Eigen::Matrix3Xd(3, 0)};
+	std::vector<Neighbor<double>> result;
+	tree.knn(Eigen::Vector3d::Zero(), 3, result);
+	EXPECT_TRUE(result.empty());
+	tree.radius(Eigen::Vector3d::Zero(), 1, result);
+	EXPECT_TRUE(result.empty());
+	EXPECT_THROW(tree.nearest(Eigen::Vector3d::Zero()), std::logic_error);
+}
+
+TEST(KdTreeTest, knn) {
+	Eigen::Matrix3Xd points  = randomPoints(2000, 1);
+	Eigen::Matrix3Xd queries = randomPoints(50, 2);
+	KdTree<double> tree{points, 8, 4};
+	ASSERT_EQ(tree.size(), 2000u);
+
+	std::vector<Neighbor<double>> result;
+	for (Eigen::Index i = 0; i < queries.cols(); ++i) {
+		std::vector<Neighbor<double>> expected = bruteKnn(points, queries.col(i), 10);
+		tree.knn(queries.col(i), 10, result);
+		ASSERT_EQ(result.size(), 10u);
+		for (std::size_t j = 0; j < result.size(); ++j) {
+			EXPECT_EQ(result[j].index, expected[j].index);
+			EXPECT_DOUBLE_EQ(result[j].squared_distance, expected[j].squared_distance);
+		}
+
+		Neighbor<double> nearest = tree.nearest(queries.col(i));
+		EXPECT_EQ(nearest.index, expected[0].index);
+	}
+}
+
+TEST(KdTreeTest, knnMoreThanSize) {
+	Eigen::Matrix3Xd points = randomPoints(5, 3);
+	KdTree<double> tree{points, 2};
+	std::vector<Neighbor<double>> result;
+	tree.knn(Eigen::Vector3d::Zero(), 8, result);
+	EXPECT_EQ(indices(result), (std::vector<std::size_t>{0, 1, 2, 3, 4}));
+	EXPECT_TRUE(std::is_sorted(result.begin(), result.end()));
+}
+
+TEST(KdTreeTest, radius) {
+	Eigen::Matrix3Xd points  = randomPoints(2000, 4);
+	Eigen::Matrix3Xd queries = randomPoints(50, 5);
+	KdTree<double> tree{points};
+
+	std::vector<Neighbor<double>> result;
+	for (Eigen::Index i = 0; i < queries.cols(); ++i) {
+		tree.radius(queries.col(i), 0.2, result);
+		EXPECT_EQ(indices(result), bruteRadius(points, queries.col(i), 0.2));
+	}
+}
+
+TEST(KdTreeTest, duplicatePoints) {
+	Eigen::Matrix3Xd points = Eigen::Matrix3Xd::Zero(3, 100);
+	points.rightCols(50).setOnes();
+	KdTree<double> tree{points, 4};
+	std::vector<Neighbor<double>> result;
+	tree.radius(Eigen::Vector3d::Zero(), 0.5, result);
+	EXPECT_EQ(result.size(), 50u);
+	tree.knn(Eigen::Vector3d::Ones(), 60, result);
+	EXPECT_EQ(result.size(), 60u);
+	EXPECT_DOUBLE_EQ(result[49].squared_distance, 0);
+	EXPECT_DOUBLE_EQ(result[50].squared_distance, 3);
+}
+
+TEST(KdTreeTest, batched) {
+	Eigen::Matrix3Xd points  = randomPoints(3000, 6);
+	Eigen::Matrix3Xd queries = randomPoints(500, 7);
+	KdTree<double> tree{points, 16, 3};
+
+	Eigen::Matrix<Eigen::Index, Eigen::Dynamic, Eigen::Dynamic> knn_indices;
+	Eigen::MatrixXd knn_distances;
+	tree.knn(queries, 4, knn_indices, knn_distances, 3);
+	ASSERT_EQ(knn_indices.rows(), 4);
+	ASSERT_EQ(knn_indices.cols(), 500);
+
+	std::vector<std::vector<Neighbor<double>>> radius_result;
+	tree.radius(queries, 0.1, radius_result, 3);
+	ASSERT_EQ(radius_result.size(), 500u);
+
+	for (Eigen::Index i = 0; i < queries.cols(); ++i) {
+		std::vector<Neighbor<double>> expected = bruteKnn(points, queries.col(i), 4);
+		for (std::size_t j = 0; j < 4; ++j) {
+			EXPECT_EQ(std::size_t(knn_indices(j, i)), expected[j].index);
+			EXPECT_DOUBLE_EQ(knn_distances(j, i), expected[j].squared_distance);
+		}
+		EXPECT_EQ(indices(radius_result[i]), bruteRadius(points, queries.col(i), 0.1));
+	}
+}
+
+TEST(KdTreeTest, batchedMissing) {
+	KdTree<double> tree{randomPoints(2, 8)};
+	Eigen::Matrix<Eigen::Index, Eigen::Dynamic, Eigen::Dynamic> knn_indices;
+	Eigen::MatrixXd knn_distances;
+	tree.knn(randomPoints(3, 9), 3, knn_indices, knn_distances);
+	for (Eigen::Index i = 0; i < 3; ++i) {
+		EXPECT_EQ(knn_indices(2, i), -1);
+		EXPECT_EQ(knn_distances(2, i), std::numeric_limits<double>::infinity());
+	}
+}
+
+TEST(KdTreeTest, float) {
+	Eigen::Matrix3Xf points = randomPoints(1000, 10).cast<float>();
+	KdTree<float> tree{points};
+	std::vector<Neighbor<float>> result;
+	tree.knn(points.col(17), 1, result);
+	ASSERT_EQ(result.size(), 1u);
+	EXPECT_EQ(result[0].index, 17u);
+	EXPECT_EQ(result[0].squared_distance, 0);
+}
+
+TEST(VoxelHashTest, invalidVoxelSize) {
+	EXPECT_THROW(VoxelHash<double>(randomPoints(10, 11), 0), std::invalid_argument);
+}
+
+TEST(VoxelHashTest, radius) {
+	Eigen::Matrix3Xd points  = randomPoints(2000, 12);
+	Eigen::Matrix3Xd queries = randomPoints(50, 13);
+	VoxelHash<double> grid{points, 0.1};
+	EXPECT_EQ(grid.size(), 2000u);
+	EXPECT_LE(grid.voxels(), 8000u);
+	EXPECT_EQ(grid.voxel(Eigen::Vector3d{-0.05, 0.15, 0.0}), Eigen::Vector3i(-1, 1, 0));
+
+	std::vector<Neighbor<double>> result;
+	for (Eigen::Index i = 0; i < queries.cols(); ++i) {
+		grid.radius(queries.col(i), 0.15, result);
+		EXPECT_EQ(indices(result), bruteRadius(points, queries.col(i), 0.15));
+	}
+
+	std::vector<std::vector<Neighbor<double>>> batched;
+	grid.radius(queries, 0.05, batched, 2);
+	for (Eigen::Index i = 0; i < queries.cols(); ++i) {
+		EXPECT_EQ(indices(batched[i]), bruteRadius(points, queries.col(i), 0.05));
+	}
+}
+
+}
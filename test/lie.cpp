@@ -0,0 +1,129 @@
+#include "eigen.hpp"
+#include "lie.hpp"
+#include "test/compare.hpp"
+
+#include <gtest/gtest.h>
+
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	using Vector6d = Eigen::Matrix<double, 6, 1>;
+
+	std::vector<Eigen::Vector3d> rotationVectors() {
+		return {
+			{0, 0, 0},
+			{1e-9, -2e-9, 3e-9},
+			{1e-3, 2e-3, -1e-3},
+			{0.05, -0.04, 0.03},
+			{0.3, 0.2, -0.1},
+			{-1.0, 2.0, 0.5},
+			{0, 0, 3.1},
+		};
+	}
+
+	bool near(Eigen::Quaterniond const & a, Eigen::Quaterniond const & b, double tolerance) {
+		return std::abs(std::abs(a.dot(b)) - 1) < tolerance;
+	}
+}
+
+TEST(LieTest, so3ExpMatchesAngleAxis) {
+	for (Eigen::Vector3d const & rotation : rotationVectors()) {
+		Eigen::Quaterniond expected{Eigen::AngleAxisd{rotation.norm(), rotation.norm() > 0 ? Eigen::Vector3d(rotation.normalized()) : axes::x()}};
+		EXPECT_TRUE(near(expected, so3Exp(rotation), 1e-14));
+		EXPECT_NEAR(1, so3Exp(rotation).norm(), 1e-15);
+	}
+}
+
+TEST(LieTest, so3RoundTrip) {
+	for (Eigen::Vector3d const & rotation : rotationVectors()) {
+		EXPECT_TRUE(testNear(rotation, so3Log(so3Exp(rotation)), {1e-14, 1e-14, 1e-14}));
+		EXPECT_TRUE(testNear(rotation, so3Log(Eigen::Quaterniond(so3Exp(rotation).coeffs() * -1)), {1e-14, 1e-14, 1e-14}));
+		EXPECT_TRUE(testNear(rotation, so3Log(so3Exp(rotation).toRotationMatrix()), {1e-12, 1e-12, 1e-12}));
+	}
+}
+
+TEST(LieTest, so3Jacobians) {
+	double step = 1e-7;
+	for (Eigen::Vector3d const & rotation : rotationVectors()) {
+		Eigen::Matrix3d left  = so3LeftJacobian(rotation);
+		Eigen::Matrix3d right = so3RightJacobian(rotation);
+		for (int i = 0; i < 3; ++i) {
+			Eigen::Vector3d delta = step * Eigen::Vector3d::Unit(i);
+			Eigen::Vector3d left_numeric  = so3Log(so3Exp<double>(rotation + delta) * so3Exp(rotation).conjugate()) / step;
+			Eigen::Vector3d right_numeric = so3Log(so3Exp(rotation).conjugate() * so3Exp<double>(rotation + delta)) / step;
+			EXPECT_TRUE(testNear(left_numeric, left.col(i), {1e-6, 1e-6, 1e-6}));
+			EXPECT_TRUE(testNear(right_numeric, right.col(i), {1e-6, 1e-6, 1e-6}));
+		}
+		EXPECT_TRUE((so3LeftJacobianInverse(rotation) * left).isIdentity(1e-12));
+		EXPECT_TRUE((so3RightJacobianInverse(rotation) * right).isIdentity(1e-12));
+	}
+}
+
+TEST(LieTest, se3RoundTrip) {
+	for (Eigen::Vector3d const & rotation : rotationVectors()) {
+		Vector6d tangent;
+		tangent << 0.5, -1.5, 2.0, rotation;
+		Eigen::Isometry3d isometry = se3Exp(tangent);
+		EXPECT_TRUE(se3Log(isometry).isApprox(tangent, 1e-12) || tangent.isZero());
+		EXPECT_TRUE(testNear(isometry, se3Exp(se3Log(isometry)), 1e-12));
+	}
+
+	// A pure rotation around an axis through the origin does not translate.
+	Vector6d tangent;
+	tangent << 0, 0, 0, 0, 0, 1;
+	EXPECT_TRUE(testNear(Eigen::Isometry3d{rotateZ(1)}, se3Exp(tangent), 1e-12));
+}
+
+TEST(LieTest, se3Jacobians) {
+	double step = 1e-7;
+	for (Eigen::Vector3d const & rotation : rotationVectors()) {
+		Vector6d tangent;
+		tangent << 0.5, -1.5, 2.0, rotation;
+		Eigen::Matrix<double, 6, 6> left  = se3LeftJacobian(tangent);
+		Eigen::Matrix<double, 6, 6> right = se3RightJacobian(tangent);
+		for (int i = 0; i < 6; ++i) {
+			Vector6d delta = step * Vector6d::Unit(i);
+			Vector6d left_numeric  = se3Log<double>(se3Exp<double>(tangent + delta) * se3Exp(tangent).inverse()) / step;
+			Vector6d right_numeric = se3Log<double>(se3Exp(tangent).inverse() * se3Exp<double>(tangent + delta)) / step;
+			EXPECT_TRUE(left_numeric.isApprox(left.col(i), 1e-5)) << left_numeric.transpose() << " != " << left.col(i).transpose();
+			EXPECT_TRUE(right_numeric.isApprox(right.col(i), 1e-5)) << right_numeric.transpose() << " != " << right.col(i).transpose();
+		}
+		EXPECT_TRUE((se3LeftJacobianInverse(tangent) * left).isIdentity(1e-12));
+		EXPECT_TRUE((se3RightJacobianInverse(tangent) * right).isIdentity(1e-12));
+	}
+}
+
+TEST(LieTest, batched) {
+	std::vector<Eigen::Vector3d> vectors = rotationVectors();
+	Eigen::Matrix3Xd rotations(3, vectors.size());
+	for (std::size_t i = 0; i < vectors.size(); ++i) rotations.col(i) = vectors[i];
+
+	std::vector<Eigen::Quaterniond> quaternions;
+	so3Exp(rotations, std::back_inserter(quaternions));
+	ASSERT_EQ(vectors.size(), quaternions.size());
+	ASSERT_TRUE(so3Log<double>(quaternions.begin(), quaternions.end()).isApprox(rotations, 1e-14));
+
+	Eigen::Matrix<double, 6, Eigen::Dynamic> tangents(6, vectors.size());
+	tangents.topRows<3>().setConstant(0.25);
+	tangents.bottomRows<3>() = rotations;
+
+	std::vector<Eigen::Isometry3d> isometries(vectors.size());
+	se3Exp(tangents, isometries.begin());
+	ASSERT_TRUE(se3Log<double>(isometries.begin(), isometries.end()).isApprox(tangents, 1e-12));
+}
+
+TEST(LieTest, se3Adjoint) {
+	Eigen::Isometry3d isometry = translate(1, -2, 3) * rotate(0.8, Eigen::Vector3d(1, 2, 3).normalized());
+	Eigen::Matrix<double, 6, 1> tangent;
+	tangent << 0.3, -0.2, 0.1, 0.5, 0.25, -0.75;
+
+	EXPECT_TRUE(testNear(isometry * se3Exp(tangent) * isometry.inverse(), se3Exp<double>(se3Adjoint(isometry) * tangent), 1e-12));
+}
+
+}
@@ -0,0 +1,146 @@
+#include "eigen.hpp"
+#include "normalize.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	std::vector<Eigen::Quaterniond> randomQuaternions(std::size_t count, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::normal_distribution<double> distribution;
+		std::vector<Eigen::Quaterniond> result;
+		for (std::size_t i = 0; i < count; ++i) {
+			result.emplace_back(distribution(generator), distribution(generator), distribution(generator), distribution(generator));
+		}
+		return result;
+	}
+
+	double orthogonalityError(Eigen::Matrix3d const & matrix) {
+		return (matrix.transpose() * matrix - Eigen::Matrix3d::Identity()).cwiseAbs().maxCoeff();
+	}
+}
+
+TEST(NormalizeTest, normalizeQuaternions) {
+	std::vector<Eigen::Quaterniond> quaternions = randomQuaternions(10000, 1);
+	quaternions[5] = Eigen::Quaterniond{0, 0, 0, 0};
+	std::vector<Eigen::Quaterniond> original = quaternions;
+
+	normalizeQuaternions(quaternions, 3);
+	for (std::size_t i = 0; i < quaternions.size(); ++i) {
+		if (i == 5) {
+			EXPECT_EQ(quaternions[i].coeffs(), Eigen::Vector4d::Zero());
+			continue;
+		}
+		EXPECT_NEAR(quaternions[i].norm(), 1, 1e-15);
+		EXPECT_TRUE(quaternions[i].coeffs().isApprox(original[i].normalized().coeffs(), 1e-15));
+	}
+}
+
+TEST(NormalizeTest, normalizeQuaternionMatrix) {
+	Eigen::Matrix4Xf coefficients(4, 2);
+	coefficients << 2, 0,
+	                0, 0,
+	                0, 3,
+	                0, 4;
+	normalizeQuaternions(coefficients);
+	EXPECT_TRUE(coefficients.col(0).isApprox(Eigen::Vector4f{1, 0, 0, 0}));
+	EXPECT_TRUE(coefficients.col(1).isApprox(Eigen::Vector4f{0, 0, 0.6f, 0.8f}));
+}
+
+TEST(NormalizeTest, canonicalizeQuaternionMatrix) {
+	Eigen::Matrix4Xd coefficients(4, 3);
+	coefficients << 1,  0, 0,
+	                0,  0, 0,
+	                0,  0, 1,
+	               -1,  1, 0;
+	canonicalizeQuaternions(coefficients);
+	EXPECT_EQ(coefficients.col(0), Eigen::Vector4d(-1, 0, 0, 1));
+	EXPECT_EQ(coefficients.col(1), Eigen::Vector4d(0, 0, 0, 1));
+	EXPECT_EQ(coefficients.col(2), Eigen::Vector4d(0, 0, 1, 0));
+
+	// Fixed-size matrices and maps work too.
+	Eigen::Matrix4d fixed = Eigen::Matrix4d::Identity() * 2;
+	normalizeQuaternions(fixed);
+	EXPECT_EQ(fixed, Eigen::Matrix4d::Identity());
+}
+
+TEST(NormalizeTest, canonicalizeQuaternions) {
+	std::vector<Eigen::Quaterniond> quaternions = randomQuaternions(10000, 2);
+	std::vector<Eigen::Quaterniond> original = quaternions;
+
+	canonicalizeQuaternions(quaternions, Eigen::Quaterniond::Identity(), 3);
+	for (std::size_t i = 0; i < quaternions.size(); ++i) {
+		EXPECT_GE(quaternions[i].w(), 0);
+		EXPECT_TRUE(quaternions[i].coeffs().cwiseAbs() == original[i].coeffs().cwiseAbs());
+	}
+
+	Eigen::Quaterniond reference = Eigen::Quaterniond{1, 2, 3, 4}.normalized();
+	canonicalizeQuaternions(quaternions, reference);
+	for (Eigen::Quaterniond const & quaternion : quaternions) EXPECT_GE(quaternion.dot(reference), 0);
+}
+
+TEST(NormalizeTest, orthonormalizeRotation) {
+	// A rotation with accumulated drift.
+	Eigen::Matrix3d rotation = Eigen::AngleAxisd{0.7, Eigen::Vector3d{1, 2, 3}.normalized()}.toRotationMatrix();
+	Eigen::Matrix3d drifted = rotation;
+	drifted(0, 1) += 1e-4;
+	drifted(2, 0) -= 2e-4;
+	drifted *= 1.001;
+	orthonormalizeRotation(drifted);
+	EXPECT_LT(orthogonalityError(drifted), 1e-14);
+	EXPECT_NEAR(drifted.determinant(), 1, 1e-14);
+	EXPECT_LT((drifted - rotation).cwiseAbs().maxCoeff(), 1e-3);
+
+	// The result matches the orthogonal factor of the polar decomposition.
+	Eigen::Matrix3d matrix;
+	matrix << 2, 0.5, 0.1,
+	          -0.3, 1, 0.4,
+	          0.2, -0.1, 3;
+	Eigen::JacobiSVD<Eigen::Matrix3d> svd{matrix, Eigen::ComputeFullU | Eigen::ComputeFullV};
+	Eigen::Matrix3d expected = svd.matrixU() * svd.matrixV().transpose();
+	orthonormalizeRotation(matrix);
+	EXPECT_LT((matrix - expected).cwiseAbs().maxCoeff(), 1e-12);
+
+	Eigen::Matrix3d reflection = Eigen::Vector3d{1, 1, -1}.asDiagonal();
+	EXPECT_THROW(orthonormalizeRotation(reflection), std::invalid_argument);
+}
+
+TEST(NormalizeTest, orthonormalizeRotations) {
+	std::vector<Eigen::Quaterniond> quaternions = randomQuaternions(3000, 3);
+	std::vector<Eigen::Matrix3d> matrices;
+	std::vector<Eigen::Isometry3d> isometries;
+	for (Eigen::Quaterniond const & quaternion : quaternions) {
+		Eigen::Matrix3d matrix = quaternion.normalized().toRotationMatrix();
+		matrix.col(0) *= 1 + 1e-6;
+		matrices.push_back(matrix);
+		isometries.push_back(Eigen::Translation3d{1, 2, 3} * Eigen::Isometry3d{matrix});
+	}
+
+	orthonormalizeRotations(matrices, 3);
+	orthonormalizeRotations(isometries, 3);
+	for (std::size_t i = 0; i < matrices.size(); ++i) {
+		EXPECT_LT(orthogonalityError(matrices[i]), 1e-14);
+		EXPECT_LT(orthogonalityError(isometries[i].linear()), 1e-14);
+		EXPECT_EQ(isometries[i].translation(), Eigen::Vector3d(1, 2, 3));
+	}
+}
+
+TEST(NormalizeTest, mode) {
+	Eigen::Quaterniond quaternion{2, 0, 0, 0};
+	EXPECT_EQ(normalize(quaternion, NormalizeMode::as_is).w(), 2);
+	EXPECT_EQ(normalize(quaternion, NormalizeMode::normalize).w(), 1);
+
+	Eigen::Matrix3d matrix = 2 * Eigen::Matrix3d::Identity();
+	EXPECT_EQ(normalize(matrix, NormalizeMode::as_is), matrix);
+	EXPECT_TRUE(normalize(matrix, NormalizeMode::normalize).isIdentity(1e-15));
+}
+
+}
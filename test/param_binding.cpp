@@ -0,0 +1,158 @@
+#include "param_binding.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	XmlRpc::XmlRpcValue makeVector(double x, double y, double z) {
+		XmlRpc::XmlRpcValue result;
+		result["x"] = x;
+		result["y"] = y;
+		result["z"] = z;
+		return result;
+	}
+
+	XmlRpc::XmlRpcValue makeBox(double size) {
+		XmlRpc::XmlRpcValue result;
+		result["min"] = makeVector(-size, -size, 0);
+		result["max"] = makeVector(size, size, size);
+		return result;
+	}
+}
+
+TEST(ParamBinding, incrementalUpdate) {
+	XmlRpc::XmlRpcValue params;
+	params["left"]  = makeBox(1);
+	params["right"] = makeBox(2);
+
+	ParamBinding<Eigen::AlignedBox3d> binding{params};
+	std::vector<std::vector<std::string>> notifications;
+	binding.onChange([&] (ParamBinding<Eigen::AlignedBox3d>::Snapshot const & snapshot, std::vector<std::string> const & changed) {
+		EXPECT_EQ(snapshot.version, notifications.size() + 2);
+		notifications.push_back(changed);
+	});
+
+	Eigen::Vector3d const * left;
+	{
+		ParamBinding<Eigen::AlignedBox3d>::Reader snapshot = binding.read();
+		EXPECT_EQ(snapshot->version, 1u);
+		ASSERT_EQ(snapshot->values.size(), 2u);
+		EXPECT_EQ(snapshot->at("right").max(), Eigen::Vector3d(2, 2, 2));
+		left = &snapshot->at("left").max();
+	}
+
+	// Nothing changed, so nothing is published.
+	EXPECT_TRUE(binding.update(params).empty());
+	EXPECT_EQ(binding.read()->version, 1u);
+	EXPECT_EQ(&binding.read()->at("left").max(), left);
+
+	// Change one entry, add one and remove one.
+	params["right"]["max"]["z"] = 5.0;
+	params["center"] = makeBox(0.5);
+	XmlRpc::XmlRpcValue updated;
+	updated["center"] = params["center"];
+	updated["right"]  = params["right"];
+	EXPECT_EQ(binding.update(updated), (std::vector<std::string>{"center", "left", "right"}));
+
+	ParamBinding<Eigen::AlignedBox3d>::Reader snapshot = binding.read();
+	EXPECT_EQ(snapshot->version, 2u);
+	EXPECT_EQ(snapshot->values.size(), 2u);
+	EXPECT_EQ(snapshot->at("right").max(), Eigen::Vector3d(2, 2, 5));
+	EXPECT_EQ(snapshot->at("center").min(), Eigen::Vector3d(-0.5, -0.5, 0));
+	EXPECT_THROW(snapshot->at("left"), std::out_of_range);
+	ASSERT_EQ(notifications.size(), 1u);
+	EXPECT_EQ(notifications[0], (std::vector<std::string>{"center", "left", "right"}));
+}
+
+TEST(ParamBinding, failedUpdateKeepsSnapshot) {
+	XmlRpc::XmlRpcValue params;
+	params["tool"]   = makeVector(1, 2, 3);
+	params["camera"] = makeVector(4, 5, 6);
+	ParamBinding<Eigen::Vector3d> binding{params};
+
+	params["tool"]["z"] = "three";
+	params["camera"] = makeVector(7, 8, 9);
+	params["extra"] = 1.0;
+	try {
+		binding.update(params);
+		FAIL();
+	} catch (XmlRpcBulkError const & e) {
+		ASSERT_EQ(e.errors().size(), 2u);
+		EXPECT_EQ(e.errors()[0].path, "extra");
+		EXPECT_EQ(e.errors()[1].path, "tool");
+	}
+
+	EXPECT_EQ(binding.read()->version, 1u);
+	EXPECT_EQ(binding.read()->at("camera"), Eigen::Vector3d(4, 5, 6));
+
+	// The failed entries are converted again on the next update.
+	params["tool"]["z"] = 3.5;
+	params["extra"] = makeVector(0, 0, 0);
+	EXPECT_EQ(binding.update(params), (std::vector<std::string>{"camera", "extra", "tool"}));
+	EXPECT_EQ(binding.read()->at("tool"), Eigen::Vector3d(1, 2, 3.5));
+
+	EXPECT_THROW(binding.update(XmlRpc::XmlRpcValue{1.0}), std::exception);
+}
+
+TEST(ParamBinding, alignedValues) {
+	XmlRpc::XmlRpcValue params;
+	for (int i = 0; i < 8; ++i) {
+		XmlRpc::XmlRpcValue & value = params["value" + std::to_string(i)];
+		for (int j = 0; j < 4; ++j) value[j] = double(i + j);
+	}
+
+	// Fixed-size vectorizable values must be stored with the alignment Eigen expects.
+	ParamBinding<Eigen::Vector4d> binding{params};
+	ParamBinding<Eigen::Vector4d>::Reader snapshot = binding.read();
+	ASSERT_EQ(snapshot->values.size(), 8u);
+	for (auto const & value : snapshot->values) {
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(value.second.data()) % alignof(Eigen::Vector4d), 0u) << value.first;
+	}
+	EXPECT_EQ(snapshot->at("value2"), Eigen::Vector4d(2, 3, 4, 5));
+}
+
+TEST(ParamBinding, concurrentReaders) {
+	XmlRpc::XmlRpcValue params;
+	params["box"]["min"] = makeVector(0, 0, 0);
+	params["box"]["max"] = makeVector(1, 1, 1);
+	ParamBinding<Eigen::AlignedBox3d> binding{params};
+
+	std::atomic<bool> done{false};
+	std::atomic<int> invalid{0};
+	std::thread reader{[&] {
+		while (!done) {
+			ParamBinding<Eigen::AlignedBox3d>::Reader snapshot = binding.read();
+			Eigen::AlignedBox3d const & box = snapshot->at("box");
+			// Every published box is a cube, so a mix of two versions would show up as a non-cube.
+			Eigen::Vector3d sizes = box.sizes();
+			if (sizes.x() != sizes.z() || sizes.y() != sizes.z()) ++invalid;
+		}
+	}};
+
+	for (int i = 1; i <= 200; ++i) {
+		XmlRpc::XmlRpcValue box;
+		box["min"] = makeVector(-i, -i, -i);
+		box["max"] = makeVector(i, i, i);
+		params["box"] = box;
+		binding.update(params);
+	}
+	done = true;
+	reader.join();
+
+	EXPECT_EQ(invalid, 0);
+	EXPECT_EQ(binding.read()->version, 201u);
+}
+
+}
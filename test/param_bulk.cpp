@@ -0,0 +1,131 @@
+#include "param.hpp"
+
+#include <gtest/gtest.h>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	void setVector(XmlRpc::XmlRpcValue & value, Eigen::Vector3d const & vector) {
+		value["x"] = vector.x();
+		value["y"] = vector.y();
+		value["z"] = vector.z();
+	}
+
+	void setIsometry(XmlRpc::XmlRpcValue & value, Eigen::Isometry3d const & isometry) {
+		Eigen::Quaterniond orientation{isometry.linear()};
+		setVector(value["position"], isometry.translation());
+		value["orientation"]["x"] = orientation.x();
+		value["orientation"]["y"] = orientation.y();
+		value["orientation"]["z"] = orientation.z();
+		value["orientation"]["w"] = orientation.w();
+	}
+
+	Eigen::Isometry3d makeIsometry(int i) {
+		return Eigen::Isometry3d{translate(i, 2 * i, -i) * rotateZ(0.001 * i)};
+	}
+
+	XmlRpc::XmlRpcValue makePoses(int count) {
+		XmlRpc::XmlRpcValue value;
+		value.setSize(count);
+		for (int i = 0; i < count; ++i) {
+			value[i]["parent_frame"] = "world";
+			value[i]["child_frame"]  = "frame_" + std::to_string(i);
+			setIsometry(value[i], makeIsometry(i));
+		}
+		return value;
+	}
+}
+
+TEST(EigenParamBulk, poses) {
+	XmlRpc::XmlRpcValue value = makePoses(2000);
+	std::vector<Pose> poses = fromXmlRpc<std::vector<Pose>>(value);
+	ASSERT_EQ(poses.size(), 2000u);
+	for (int i : {0, 1, 1000, 1999}) {
+		Pose expected = fromXmlRpc<Pose>(value[i]);
+		EXPECT_EQ(poses[i].header.parent_frame, expected.header.parent_frame);
+		EXPECT_EQ(poses[i].header.child_frame, expected.header.child_frame);
+		EXPECT_TRUE(poses[i].isometry.isApprox(expected.isometry));
+		EXPECT_TRUE(poses[i].isometry.isApprox(makeIsometry(i)));
+	}
+
+	std::vector<Pose, Eigen::aligned_allocator<Pose>> aligned = fromXmlRpc<std::vector<Pose, Eigen::aligned_allocator<Pose>>>(value);
+	ASSERT_EQ(aligned.size(), 2000u);
+	EXPECT_EQ(aligned[1500].header.child_frame, "frame_1500");
+}
+
+TEST(EigenParamBulk, collectErrors) {
+	XmlRpc::XmlRpcValue value = makePoses(1000);
+	value[3]["position"]["x"] = "one";
+	value[3]["orientation"] = XmlRpc::XmlRpcValue{};
+	value[3]["orientation"]["r"] = 0.0;
+	value[900]["child_frame"] = 5;
+
+	try {
+		fromXmlRpc<std::vector<Pose>>(value);
+		FAIL();
+	} catch (XmlRpcBulkError const & e) {
+		ASSERT_EQ(e.errors().size(), 3u) << e.what();
+		EXPECT_EQ(e.errors()[0].path, "[3].position.x");
+		EXPECT_EQ(e.errors()[1].path, "[3].orientation");
+		EXPECT_EQ(e.errors()[2].path, "[900].child_frame");
+		EXPECT_NE(std::string{e.what()}.find("[900].child_frame: expected a string"), std::string::npos) << e.what();
+	}
+
+	EXPECT_THROW(fromXmlRpc<std::vector<Pose>>(value[0]), std::runtime_error);
+}
+
+TEST(EigenParamBulk, isometryMap) {
+	XmlRpc::XmlRpcValue value;
+	for (int i = 0; i < 500; ++i) setIsometry(value["camera_" + std::to_string(i)], makeIsometry(i));
+
+	std::map<std::string, Eigen::Isometry3d> isometries = fromXmlRpc<std::map<std::string, Eigen::Isometry3d>>(value);
+	ASSERT_EQ(isometries.size(), 500u);
+	EXPECT_TRUE(isometries.at("camera_42").isApprox(makeIsometry(42)));
+
+	IsometryMap aligned = fromXmlRpc<IsometryMap>(value);
+	ASSERT_EQ(aligned.size(), 500u);
+	EXPECT_TRUE(aligned.at("camera_499").isApprox(makeIsometry(499)));
+
+	value["camera_7"]["position"]["w"] = 1.0;
+	try {
+		fromXmlRpc<IsometryMap>(value);
+		FAIL();
+	} catch (XmlRpcBulkError const & e) {
+		ASSERT_EQ(e.errors().size(), 1u) << e.what();
+		EXPECT_EQ(e.errors()[0].path, "camera_7.position");
+	}
+}
+
+TEST(EigenParamBulk, boxes) {
+	XmlRpc::XmlRpcValue value;
+	value.setSize(3);
+	setVector(value[0]["center"],     {1, 2, 3});
+	setVector(value[0]["dimensions"], {4, 5, 6});
+	setVector(value[1]["min"],        {0, 0, 0});
+	setVector(value[1]["max"],        {1, 1, 1});
+	setVector(value[2]["min"],        {0, 0, 0});
+	setVector(value[2]["max"],        {1, 1, 1});
+
+	std::vector<Eigen::AlignedBox3d> boxes = fromXmlRpc<std::vector<Eigen::AlignedBox3d>>(value);
+	ASSERT_EQ(boxes.size(), 3u);
+	EXPECT_TRUE(boxes[0].isApprox(makeCenteredBox({1, 2, 3}, {4, 5, 6})));
+	EXPECT_TRUE(boxes[1].isApprox(Eigen::AlignedBox3d{Eigen::Vector3d::Zero(), Eigen::Vector3d::Ones()}));
+
+	value[2]["center"] = value[2]["min"];
+	value[1]["max"]["z"] = true;
+	try {
+		fromXmlRpc<std::vector<Eigen::AlignedBox3d>>(value);
+		FAIL();
+	} catch (XmlRpcBulkError const & e) {
+		ASSERT_EQ(e.errors().size(), 2u) << e.what();
+		EXPECT_EQ(e.errors()[0].path, "[1].max.z");
+		EXPECT_EQ(e.errors()[1].path, "[2]");
+	}
+}
+
+}
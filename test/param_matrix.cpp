@@ -0,0 +1,129 @@
+#include "param.hpp"
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <stdexcept>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	XmlRpc::XmlRpcValue makeList(std::initializer_list<double> elements) {
+		XmlRpc::XmlRpcValue result;
+		result.setSize(elements.size());
+		int i = 0;
+		for (double element : elements) result[i++] = element;
+		return result;
+	}
+
+	XmlRpc::XmlRpcValue makeNested(std::initializer_list<std::initializer_list<double>> lists) {
+		XmlRpc::XmlRpcValue result;
+		result.setSize(lists.size());
+		int i = 0;
+		for (auto const & list : lists) result[i++] = makeList(list);
+		return result;
+	}
+}
+
+TEST(EigenParamMatrix, fixedNested) {
+	Eigen::Matrix3d expected;
+	expected << 1, 2, 3, 4, 5, 6, 7, 8, 9;
+
+	XmlRpc::XmlRpcValue value = makeNested({{1, 2, 3}, {4, 5, 6}, {7, 8, 9}});
+	EXPECT_EQ(fromXmlRpc<Eigen::Matrix3d>(value), expected);
+	EXPECT_EQ(matrixFromXmlRpc<Eigen::Matrix3d>(value, MatrixOrder::column_major), expected.transpose());
+
+	// Integers are accepted as well.
+	value[1][1] = int(5);
+	EXPECT_EQ(fromXmlRpc<Eigen::Matrix3d>(value), expected);
+
+	EXPECT_THROW(fromXmlRpc<Eigen::Matrix4d>(value), std::runtime_error);
+	EXPECT_THROW(fromXmlRpc<Eigen::Matrix2d>(value), std::runtime_error);
+	EXPECT_THROW(fromXmlRpc<Eigen::Matrix3d>(makeNested({{1, 2, 3}, {4, 5}, {7, 8, 9}})), std::runtime_error);
+}
+
+TEST(EigenParamMatrix, fixedFlat) {
+	Eigen::Matrix<double, 2, 3> expected;
+	expected << 1, 2, 3, 4, 5, 6;
+
+	XmlRpc::XmlRpcValue value = makeList({1, 2, 3, 4, 5, 6});
+	EXPECT_EQ((matrixFromXmlRpc<Eigen::Matrix<double, 2, 3>>(value)), expected);
+
+	Eigen::Matrix<double, 2, 3> column_major;
+	column_major << 1, 3, 5, 2, 4, 6;
+	EXPECT_EQ((matrixFromXmlRpc<Eigen::Matrix<double, 2, 3>>(value, MatrixOrder::column_major)), column_major);
+
+	// One fixed dimension is enough to interpret a flat list.
+	Eigen::Matrix<double, Eigen::Dynamic, 3> points = matrixFromXmlRpc<Eigen::Matrix<double, Eigen::Dynamic, 3>>(value);
+	EXPECT_EQ(points, expected);
+	EXPECT_THROW(matrixFromXmlRpc<Eigen::Matrix4Xd>(value), std::runtime_error);
+
+	EXPECT_EQ(fromXmlRpc<Eigen::Vector4d>(makeList({1, 2, 3, 4})), Eigen::Vector4d(1, 2, 3, 4));
+	EXPECT_EQ((fromXmlRpc<Eigen::Matrix<double, 6, 1>>(value)), (Eigen::Matrix<double, 6, 1>{} << 1, 2, 3, 4, 5, 6).finished());
+	EXPECT_THROW(fromXmlRpc<Eigen::Vector2d>(value), std::runtime_error);
+}
+
+TEST(EigenParamMatrix, dynamic) {
+	Eigen::VectorXd distortion = fromXmlRpc<Eigen::VectorXd>(makeList({0.1, -0.2, 0.001, 0.002, 0}));
+	ASSERT_EQ(distortion.size(), 5);
+	EXPECT_EQ(distortion[1], -0.2);
+	EXPECT_EQ(fromXmlRpc<Eigen::VectorXd>(makeList({})).size(), 0);
+
+	Eigen::MatrixXd matrix = fromXmlRpc<Eigen::MatrixXd>(makeNested({{1, 2}, {3, 4}, {5, 6}}));
+	ASSERT_EQ(matrix.rows(), 3);
+	ASSERT_EQ(matrix.cols(), 2);
+	EXPECT_EQ(matrix(2, 0), 5);
+	EXPECT_EQ(fromXmlRpc<Eigen::MatrixXd>(makeList({})).size(), 0);
+
+	// A flat list is ambiguous if both dimensions are dynamic.
+	EXPECT_THROW(fromXmlRpc<Eigen::MatrixXd>(makeList({1, 2, 3, 4})), std::runtime_error);
+
+	// Existing storage is reused when the size matches.
+	Eigen::MatrixXf target(3, 2);
+	float const * data = target.data();
+	matrixFromXmlRpc(makeNested({{1, 2}, {3, 4}, {5, 6}}), target);
+	EXPECT_EQ(target.data(), data);
+	EXPECT_EQ(target(1, 1), 4.0f);
+}
+
+TEST(EigenParamMatrix, structWithData) {
+	// The layout used by camera calibration files.
+	XmlRpc::XmlRpcValue value;
+	value["rows"] = 3;
+	value["cols"] = 3;
+	value["data"] = makeList({500, 0, 320, 0, 500, 240, 0, 0, 1});
+
+	Eigen::Matrix3d intrinsics = fromXmlRpc<Eigen::Matrix3d>(value);
+	EXPECT_EQ(intrinsics(0, 2), 320);
+	EXPECT_EQ(intrinsics(1, 2), 240);
+	EXPECT_EQ(fromXmlRpc<Eigen::MatrixXd>(value), intrinsics);
+
+	value["cols"] = 2;
+	EXPECT_THROW(fromXmlRpc<Eigen::MatrixXd>(value), std::runtime_error);
+	EXPECT_THROW(fromXmlRpc<Eigen::Matrix3d>(value), std::runtime_error);
+	value["cols"] = 3.0;
+	EXPECT_THROW(fromXmlRpc<Eigen::MatrixXd>(value), std::runtime_error);
+
+	// The number of elements overflows an int.
+	value["rows"] = 65536;
+	value["cols"] = 65536;
+	EXPECT_THROW(fromXmlRpc<Eigen::MatrixXd>(value), std::runtime_error);
+}
+
+TEST(EigenParamMatrix, wrongTypes) {
+	XmlRpc::XmlRpcValue value = makeList({1, 2, 3, 4});
+	value[2] = "three";
+	EXPECT_THROW(fromXmlRpc<Eigen::Vector4d>(value), std::runtime_error);
+	EXPECT_THROW(fromXmlRpc<Eigen::Vector4d>(XmlRpc::XmlRpcValue{1.0}), std::runtime_error);
+
+	XmlRpc::XmlRpcValue nested = makeNested({{1, 2}, {3, 4}});
+	nested[1] = 3.0;
+	EXPECT_THROW(fromXmlRpc<Eigen::Matrix2d>(nested), std::runtime_error);
+}
+
+}
@@ -0,0 +1,120 @@
+#include "eigen.hpp"
+#include "pose_cluster.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	/// Generate noisy poses around a set of cluster centers, cycling through the centers.
+	std::vector<Eigen::Isometry3d> noisyPoses(std::vector<Eigen::Isometry3d> const & centers, std::size_t count, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::uniform_real_distribution<double> distribution{-1, 1};
+		std::vector<Eigen::Isometry3d> result;
+		for (std::size_t i = 0; i < count; ++i) {
+			Eigen::Vector3d translation{distribution(generator), distribution(generator), distribution(generator)};
+			Eigen::Vector3d rotation{distribution(generator), distribution(generator), distribution(generator)};
+			result.push_back(centers[i % centers.size()] * Eigen::Translation3d{0.001 * translation} * so3Exp<double>(0.01 * rotation));
+		}
+		return result;
+	}
+
+	std::vector<Eigen::Isometry3d> centers() {
+		return {
+			translate(0, 0, 0) * rotate(0.0, Eigen::Vector3d::UnitZ()),
+			translate(0, 0, 0) * rotate(1.0, Eigen::Vector3d::UnitZ()),
+			translate(0.5, 0, 0) * rotate(0.0, Eigen::Vector3d::UnitZ()),
+			translate(0.5, 0.2, -1) * rotate(2.0, Eigen::Vector3d::UnitX()),
+		};
+	}
+}
+
+TEST(PoseClusterTest, invalidOptions) {
+	PoseClusterOptions options;
+	options.translation_threshold = 0;
+	EXPECT_THROW(clusterPoses(centers(), options), std::invalid_argument);
+	options.translation_threshold = 0.1;
+	options.rotation_threshold    = -1;
+	EXPECT_THROW(clusterPoses(centers(), options), std::invalid_argument);
+}
+
+TEST(PoseClusterTest, empty) {
+	PoseClusters<double> clusters = clusterPoses(std::vector<Eigen::Isometry3d>{});
+	EXPECT_TRUE(clusters.labels.empty());
+	EXPECT_TRUE(clusters.members.empty());
+	EXPECT_TRUE(clusters.averages.empty());
+}
+
+TEST(PoseClusterTest, separatesTranslationAndRotation) {
+	std::vector<Eigen::Isometry3d> poses = noisyPoses(centers(), 400, 1);
+	PoseClusterOptions options;
+	options.threads = 3;
+	PoseClusters<double> clusters = clusterPoses(poses, options);
+
+	ASSERT_EQ(clusters.members.size(), 4u);
+	ASSERT_EQ(clusters.averages.size(), 4u);
+	for (std::size_t i = 0; i < poses.size(); ++i) EXPECT_EQ(clusters.labels[i], i % 4);
+	for (std::size_t i = 0; i < 4; ++i) {
+		EXPECT_EQ(clusters.members[i].size(), 100u);
+		Eigen::Isometry3d error = centers()[i].inverse() * clusters.averages[i];
+		EXPECT_LT(error.translation().norm(), 2e-4);
+		EXPECT_LT(Eigen::AngleAxisd(error.linear()).angle(), 2e-3);
+	}
+}
+
+TEST(PoseClusterTest, quaternionSign) {
+	// Rotations of almost pi around the same axis have quaternions with opposite signs.
+	std::vector<Eigen::Isometry3d> poses = {
+		Eigen::Isometry3d{rotate(M_PI - 0.01, Eigen::Vector3d::UnitY())},
+		Eigen::Isometry3d{rotate(M_PI + 0.01, Eigen::Vector3d::UnitY())},
+	};
+	PoseClusters<double> clusters = clusterPoses(poses);
+	EXPECT_EQ(clusters.members.size(), 1u);
+}
+
+TEST(PoseClusterTest, chains) {
+	// Single linkage joins poses that are only connected through other poses.
+	std::vector<Eigen::Isometry3d> poses;
+	for (int i = 0; i < 10; ++i) poses.push_back(Eigen::Isometry3d{translate(0.008 * i, 0, 0)});
+	poses.push_back(Eigen::Isometry3d{translate(1, 0, 0)});
+	PoseClusters<double> clusters = clusterPoses(poses);
+	ASSERT_EQ(clusters.members.size(), 2u);
+	EXPECT_EQ(clusters.members[0].size(), 10u);
+	EXPECT_EQ(clusters.members[1], (std::vector<std::size_t>{10}));
+}
+
+TEST(PoseClusterTest, threadCountIndependent) {
+	std::vector<Eigen::Isometry3d> poses = noisyPoses(centers(), 2000, 2);
+	PoseClusterOptions options;
+	options.translation_threshold = 0.002;
+	options.rotation_threshold    = 0.02;
+	options.threads = 1;
+	PoseClusters<double> single = clusterPoses(poses, options);
+	options.threads = 4;
+	PoseClusters<double> multi = clusterPoses(poses, options);
+	EXPECT_EQ(single.labels, multi.labels);
+	EXPECT_EQ(single.members, multi.members);
+}
+
+TEST(PoseClusterTest, suppressNonMaxima) {
+	std::vector<Eigen::Isometry3d> poses = noisyPoses(centers(), 40, 3);
+	std::vector<double> scores;
+	for (std::size_t i = 0; i < poses.size(); ++i) scores.push_back(i);
+
+	PoseClusterOptions options;
+	options.translation_threshold = 0.1;
+	options.rotation_threshold    = 0.5;
+	std::vector<std::size_t> kept = suppressNonMaxima(poses, scores, options);
+	EXPECT_EQ(kept, (std::vector<std::size_t>{39, 38, 37, 36}));
+
+	EXPECT_THROW(suppressNonMaxima(poses, std::vector<double>(3), options), std::invalid_argument);
+}
+
+}
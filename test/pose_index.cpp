@@ -0,0 +1,145 @@
+#include "eigen.hpp"
+#include "lie.hpp"
+#include "pose_index.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	std::vector<Eigen::Isometry3d> randomPoses(std::size_t count, unsigned int seed) {
+		std::mt19937 generator{seed};
+		std::uniform_real_distribution<double> distribution{-1, 1};
+		std::vector<Eigen::Isometry3d> result;
+		for (std::size_t i = 0; i < count; ++i) {
+			Eigen::Vector3d translation{distribution(generator), distribution(generator), distribution(generator)};
+			Eigen::Vector3d rotation{distribution(generator), distribution(generator), distribution(generator)};
+			result.push_back(Eigen::Translation3d{translation} * so3Exp<double>(M_PI * rotation.normalized() * std::abs(distribution(generator))));
+		}
+		return result;
+	}
+
+	/// Find the k nearest poses by brute force.
+	std::vector<std::size_t> bruteKnn(PoseIndex const & index, std::vector<Eigen::Isometry3d> const & poses, Eigen::Isometry3d const & query, std::size_t k) {
+		std::vector<std::pair<double, std::size_t>> distances;
+		for (std::size_t i = 0; i < poses.size(); ++i) distances.emplace_back(index.distance(query, poses[i]), i);
+		std::sort(distances.begin(), distances.end());
+		std::vector<std::size_t> result;
+		for (std::size_t i = 0; i < std::min(k, distances.size()); ++i) result.push_back(distances[i].second);
+		return result;
+	}
+
+	std::vector<std::size_t> indices(std::vector<PoseIndex::Neighbor> const & neighbors) {
+		std::vector<std::size_t> result;
+		for (PoseIndex::Neighbor const & neighbor : neighbors) result.push_back(neighbor.index);
+		return result;
+	}
+}
+
+TEST(PoseIndexTest, distance) {
+	PoseIndex index{std::vector<Eigen::Isometry3d>{}, 0.5};
+	Eigen::Isometry3d a = translate(1, 2, 3) * rotate(0.3, Eigen::Vector3d::UnitZ());
+	Eigen::Isometry3d b = translate(1, 2, 4) * rotate(0.3, Eigen::Vector3d::UnitZ());
+	EXPECT_NEAR(index.distance(a, b), 1, 1e-12);
+
+	// The rotation term is 4 * weight * sin(angle / 4).
+	Eigen::Isometry3d c = translate(1, 2, 3) * rotate(0.3 + 2.0, Eigen::Vector3d::UnitZ());
+	EXPECT_NEAR(index.distance(a, c), 4 * 0.5 * std::sin(2.0 / 4), 1e-12);
+
+	// The sign of the quaternion does not matter.
+	Eigen::Isometry3d d{Eigen::Quaterniond{-Eigen::Quaterniond(a.linear()).coeffs()}};
+	d.translation() = a.translation();
+	EXPECT_NEAR(index.distance(a, d), 0, 1e-12);
+
+	EXPECT_THROW(PoseIndex(std::vector<Eigen::Isometry3d>{}, -1), std::invalid_argument);
+}
+
+TEST(PoseIndexTest, empty) {
+	PoseIndex index{std::vector<Eigen::Isometry3d>{}};
+	std::vector<PoseIndex::Neighbor> result;
+	index.knn(Eigen::Isometry3d::Identity(), 3, result);
+	EXPECT_TRUE(result.empty());
+	EXPECT_THROW(index.nearest(Eigen::Isometry3d::Identity()), std::logic_error);
+}
+
+TEST(PoseIndexTest, knn) {
+	std::vector<Eigen::Isometry3d> poses   = randomPoses(3000, 1);
+	std::vector<Eigen::Isometry3d> queries = randomPoses(50, 2);
+	PoseIndex index{poses, 0.3};
+	ASSERT_EQ(index.size(), 3000u);
+
+	std::vector<PoseIndex::Neighbor> result;
+	for (Eigen::Isometry3d const & query : queries) {
+		index.knn(query, 5, result);
+		std::vector<std::size_t> expected = bruteKnn(index, poses, query, 5);
+		EXPECT_EQ(indices(result), expected);
+		EXPECT_NEAR(std::sqrt(result[0].squared_distance), index.distance(query, poses[expected[0]]), 1e-12);
+		EXPECT_EQ(index.nearest(query).index, expected[0]);
+	}
+}
+
+TEST(PoseIndexTest, quaternionSign) {
+	// Stored rotations near pi have quaternions near w = 0, where q and -q are far apart in the embedding.
+	std::vector<Eigen::Isometry3d> poses = {
+		Eigen::Isometry3d{rotate(M_PI - 0.01, Eigen::Vector3d::UnitX())},
+		Eigen::Isometry3d{translate(0, 0, 0.5)},
+	};
+	PoseIndex index{poses};
+	Eigen::Isometry3d query{rotate(M_PI + 0.01, Eigen::Vector3d::UnitX())};
+	PoseIndex::Neighbor nearest = index.nearest(query);
+	EXPECT_EQ(nearest.index, 0u);
+	EXPECT_NEAR(std::sqrt(nearest.squared_distance), 4 * std::sin(0.02 / 4), 1e-9);
+
+	std::vector<PoseIndex::Neighbor> result;
+	index.knn(query, 2, result);
+	EXPECT_EQ(indices(result), (std::vector<std::size_t>{0, 1}));
+}
+
+TEST(PoseIndexTest, radius) {
+	std::vector<Eigen::Isometry3d> poses   = randomPoses(3000, 3);
+	std::vector<Eigen::Isometry3d> queries = randomPoses(50, 4);
+	PoseIndex index{poses, 0.2};
+
+	std::vector<std::vector<PoseIndex::Neighbor>> result;
+	index.radius(queries, 0.3, result, 3);
+	ASSERT_EQ(result.size(), queries.size());
+	for (std::size_t i = 0; i < queries.size(); ++i) {
+		std::vector<std::size_t> expected;
+		for (std::size_t j = 0; j < poses.size(); ++j) {
+			if (index.distance(queries[i], poses[j]) <= 0.3) expected.push_back(j);
+		}
+		EXPECT_EQ(indices(result[i]), expected);
+	}
+}
+
+TEST(PoseIndexTest, batchedKnn) {
+	std::vector<Eigen::Isometry3d> poses   = randomPoses(2000, 5);
+	std::vector<Eigen::Isometry3d> queries = randomPoses(200, 6);
+	PoseIndex index{poses, 1, 2};
+
+	std::vector<std::vector<PoseIndex::Neighbor>> result;
+	index.knn(queries, 3, result, 3);
+	ASSERT_EQ(result.size(), queries.size());
+	for (std::size_t i = 0; i < queries.size(); ++i) {
+		EXPECT_EQ(indices(result[i]), bruteKnn(index, poses, queries[i], 3));
+	}
+}
+
+TEST(PoseIndexTest, fromPoses) {
+	std::vector<Eigen::Isometry3d> isometries = randomPoses(100, 7);
+	std::vector<Pose> poses;
+	for (Eigen::Isometry3d const & isometry : isometries) poses.push_back(Pose{PoseHeader{"world", "grasp"}, isometry});
+	PoseIndex index{poses};
+	EXPECT_EQ(index.size(), 100u);
+	EXPECT_EQ(index.nearest(isometries[42]).index, 42u);
+}
+
+}
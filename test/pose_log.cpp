@@ -0,0 +1,160 @@
+#include "pose_log.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <system_error>
+
+#include <unistd.h>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	/// A temporary file that is removed when it goes out of scope.
+	struct TemporaryFile {
+		std::string path;
+
+		TemporaryFile() {
+			char buffer[] = "/tmp/dr_eigen_pose_log_XXXXXX";
+			int fd = mkstemp(buffer);
+			if (fd < 0) throw std::system_error(errno, std::generic_category(), "failed to create temporary file");
+			::close(fd);
+			path = buffer;
+		}
+
+		~TemporaryFile() {
+			std::remove(path.c_str());
+		}
+	};
+
+	Eigen::Isometry3d makePose(int i) {
+		return Eigen::Isometry3d{translate(i, -0.5 * i, 1e-3 * i) * rotateZ(0.01 * i) * rotateX(-0.02 * i)};
+	}
+}
+
+TEST(PoseLog, strides) {
+	EXPECT_EQ(PoseLogFormat::stride(PoseLogType::vector,     false), 24u);
+	EXPECT_EQ(PoseLogFormat::stride(PoseLogType::quaternion, false), 32u);
+	EXPECT_EQ(PoseLogFormat::stride(PoseLogType::isometry,   false), 56u);
+	EXPECT_EQ(PoseLogFormat::stride(PoseLogType::pose,       false), 64u);
+	EXPECT_EQ(PoseLogFormat::stride(PoseLogType::pose,       true),  72u);
+}
+
+TEST(PoseLog, poses) {
+	TemporaryFile file;
+	{
+		PoseLogWriter writer{file.path, PoseLogType::pose};
+		for (int i = 0; i < 1000; ++i) writer.append(Pose{{"world", "tool" + std::to_string(i % 3)}, makePose(i)});
+		EXPECT_EQ(writer.size(), 1000u);
+	}
+
+	PoseLogReader reader{file.path};
+	ASSERT_EQ(reader.type(), PoseLogType::pose);
+	ASSERT_FALSE(reader.hasTimestamps());
+	ASSERT_EQ(reader.size(), 1000u);
+	EXPECT_EQ(reader.frames(), (std::vector<std::string>{"world", "tool0", "tool1", "tool2"}));
+
+	for (int i : {0, 1, 500, 999}) {
+		Pose pose = reader.pose(i);
+		EXPECT_EQ(pose.header.parent_frame, "world");
+		EXPECT_EQ(pose.header.child_frame, "tool" + std::to_string(i % 3));
+		EXPECT_TRUE(pose.isometry.isApprox(makePose(i), 1e-14)) << i;
+		EXPECT_EQ(reader.position(i), makePose(i).translation());
+	}
+	EXPECT_EQ(reader.timestamp(3), 0);
+	EXPECT_THROW(reader.lowerBound(0), std::logic_error);
+}
+
+TEST(PoseLog, otherTypes) {
+	TemporaryFile file;
+	{
+		PoseLogWriter writer{file.path, PoseLogType::quaternion, PoseLogWriterOptions{false, false, 64}};
+		for (int i = 0; i < 10; ++i) writer.append(Eigen::Quaterniond{makePose(i).linear()});
+		EXPECT_THROW(writer.append(Eigen::Vector3d{1, 2, 3}), std::logic_error);
+		EXPECT_THROW(writer.append(5, Eigen::Quaterniond::Identity()), std::logic_error);
+	}
+
+	PoseLogReader reader{file.path};
+	ASSERT_EQ(reader.type(), PoseLogType::quaternion);
+	ASSERT_EQ(reader.size(), 10u);
+	EXPECT_TRUE(reader.orientation(7).isApprox(Eigen::Quaterniond{makePose(7).linear()}));
+	EXPECT_THROW(reader.position(0), std::logic_error);
+	EXPECT_THROW(reader.isometry(0), std::logic_error);
+	EXPECT_THROW(reader.parentFrame(0), std::logic_error);
+
+	{
+		PoseLogWriter writer{file.path, PoseLogType::vector};
+		writer.append(Eigen::Vector3d{1, 2, 3});
+	}
+	PoseLogReader vectors{file.path};
+	ASSERT_EQ(vectors.size(), 1u);
+	EXPECT_EQ(vectors.position(0), Eigen::Vector3d(1, 2, 3));
+	EXPECT_THROW(vectors.orientation(0), std::logic_error);
+}
+
+TEST(PoseLog, timestampsAndAppend) {
+	TemporaryFile file;
+	PoseLogWriterOptions options;
+	options.timestamps = true;
+	{
+		PoseLogWriter writer{file.path, PoseLogType::isometry, options};
+		for (int i = 0; i < 100; ++i) writer.append(std::int64_t(i / 2) * 10, makePose(i));
+		EXPECT_THROW(writer.append(0, makePose(0)), std::invalid_argument);
+		EXPECT_THROW(writer.append(makePose(0)), std::logic_error);
+	}
+
+	// Appending must continue after the existing records and keep timestamps ordered.
+	options.append = true;
+	{
+		PoseLogWriter writer{file.path, PoseLogType::isometry, options};
+		EXPECT_EQ(writer.size(), 100u);
+		EXPECT_THROW(writer.append(480, makePose(0)), std::invalid_argument);
+		for (int i = 100; i < 150; ++i) writer.append(std::int64_t(i / 2) * 10, makePose(i));
+	}
+	EXPECT_THROW((PoseLogWriter{file.path, PoseLogType::pose, options}), std::runtime_error);
+
+	PoseLogReader reader{file.path};
+	ASSERT_EQ(reader.size(), 150u);
+	EXPECT_EQ(reader.timestamp(149), 740);
+	EXPECT_TRUE(reader.isometry(120).isApprox(makePose(120), 1e-14));
+
+	EXPECT_EQ(reader.lowerBound(-1),  0u);
+	EXPECT_EQ(reader.lowerBound(0),   0u);
+	EXPECT_EQ(reader.lowerBound(5),   2u);
+	EXPECT_EQ(reader.lowerBound(10),  2u);
+	EXPECT_EQ(reader.upperBound(10),  4u);
+	EXPECT_EQ(reader.lowerBound(740), 148u);
+	EXPECT_EQ(reader.upperBound(740), 150u);
+	EXPECT_EQ(reader.lowerBound(741), 150u);
+}
+
+TEST(PoseLog, invalidFiles) {
+	TemporaryFile file;
+	EXPECT_THROW(PoseLogReader{file.path}, std::runtime_error);
+
+	{
+		std::ofstream stream{file.path};
+		stream << "not a pose log, but long enough to hold a header of sixty four bytes";
+	}
+	EXPECT_THROW(PoseLogReader{file.path}, std::runtime_error);
+
+	{
+		PoseLogWriter writer{file.path, PoseLogType::vector};
+		writer.append(Eigen::Vector3d{1, 2, 3});
+	}
+	// Truncate the frame table.
+	ASSERT_EQ(::truncate(file.path.c_str(), PoseLogFormat::header_size + 24 + 8), 0);
+	EXPECT_THROW(PoseLogReader{file.path}, std::runtime_error);
+
+	EXPECT_THROW(PoseLogReader{"/nonexistent/pose/log"}, std::system_error);
+}
+
+}
@@ -0,0 +1,88 @@
+#include "rcu.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	/// A value that counts live instances and detects use after destruction.
+	struct Tracked {
+		static std::atomic<int> alive;
+
+		explicit Tracked(int value) : value{value}, check{~value} { ++alive; }
+		~Tracked() { check = value; --alive; }
+
+		bool valid() const { return check == ~value; }
+
+		int value;
+		int check;
+	};
+
+	std::atomic<int> Tracked::alive{0};
+}
+
+TEST(Rcu, publishReplacesValue) {
+	{
+		RcuCell<Tracked> cell{std::unique_ptr<Tracked const>{new Tracked{1}}};
+		EXPECT_EQ(cell.read()->value, 1);
+
+		std::thread writer;
+		{
+			RcuCell<Tracked>::Reader reader = cell.read();
+			writer = std::thread{[&] { cell.publish(std::unique_ptr<Tracked const>{new Tracked{2}}); }};
+
+			// The old value stays alive while it is being read.
+			while (cell.writerValue().value != 2) std::this_thread::yield();
+			EXPECT_EQ(reader->value, 1);
+			EXPECT_TRUE(reader->valid());
+			EXPECT_EQ(Tracked::alive, 2);
+
+			RcuCell<Tracked>::Reader moved = std::move(reader);
+			EXPECT_EQ(moved->value, 1);
+		}
+
+		writer.join();
+		EXPECT_EQ(Tracked::alive, 1);
+		EXPECT_EQ(cell.read()->value, 2);
+	}
+	EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(Rcu, concurrentReaders) {
+	RcuCell<Tracked> cell{std::unique_ptr<Tracked const>{new Tracked{0}}};
+	std::atomic<bool> done{false};
+	std::atomic<int> invalid{0};
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 3; ++i) {
+		readers.emplace_back([&] {
+			int last = 0;
+			while (!done) {
+				RcuCell<Tracked>::Reader reader = cell.read();
+				// Values are published in order, so a reader never sees an older value.
+				if (!reader->valid() || reader->value < last) ++invalid;
+				last = reader->value;
+			}
+		});
+	}
+
+	for (int i = 1; i <= 1000; ++i) cell.publish(std::unique_ptr<Tracked const>{new Tracked{i}});
+	done = true;
+	for (std::thread & reader : readers) reader.join();
+
+	EXPECT_EQ(invalid, 0);
+	EXPECT_EQ(cell.read()->value, 1000);
+	EXPECT_EQ(Tracked::alive, 1);
+}
+
+}
@@ -0,0 +1,118 @@
+#include "eigen.hpp"
+#include "rigid_fit.hpp"
+#include "test/compare.hpp"
+
+#include <gtest/gtest.h>
+
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	Eigen::Matrix3Xd points() {
+		Eigen::Matrix3Xd result(3, 6);
+		result <<
+			0, 1, 0, 0, 1, -2,
+			0, 0, 1, 0, 1,  3,
+			0, 0, 0, 1, 1,  0.5;
+		return result;
+	}
+
+	Eigen::Isometry3d transform() {
+		return translate(1, -2, 0.5) * rotate(1.2, Eigen::Vector3d(1, 2, -1).normalized());
+	}
+}
+
+TEST(RigidFitTest, exactFit) {
+	Eigen::Matrix3Xd source = points();
+	Eigen::Matrix3Xd target = transform() * source;
+
+	RigidFitAccumulator<double> accumulator;
+	for (int i = 0; i < source.cols(); ++i) accumulator.add(source.col(i), target.col(i));
+
+	ASSERT_EQ(6u, accumulator.count());
+	ASSERT_TRUE(testNear(transform(), accumulator.solve(RigidFitMethod::svd), 1e-9));
+	ASSERT_TRUE(testNear(transform(), accumulator.solve(RigidFitMethod::quaternion), 1e-9));
+	ASSERT_NEAR(0, accumulator.residual(accumulator.solve()), 1e-9);
+	ASSERT_NEAR((target - source).squaredNorm(), accumulator.residual(Eigen::Isometry3d::Identity()), 1e-9);
+}
+
+TEST(RigidFitTest, batchesAndMerge) {
+	Eigen::Matrix3Xd source = points();
+	Eigen::Matrix3Xd target = transform() * source;
+	target(0, 5) += 0.1;
+
+	RigidFitAccumulator<double> single;
+	for (int i = 0; i < source.cols(); ++i) single.add(source.col(i), target.col(i));
+
+	RigidFitAccumulator<double> first;
+	RigidFitAccumulator<double> second;
+	first.add(source.leftCols(2), target.leftCols(2));
+	second.add(source.rightCols(4), target.rightCols(4), Eigen::Vector4d::Ones());
+	first.merge(second);
+
+	ASSERT_EQ(single.count(), first.count());
+	ASSERT_TRUE(testNear(single.sourceCentroid(), first.sourceCentroid(), {1e-12, 1e-12, 1e-12}));
+	ASSERT_TRUE(single.crossCovariance().isApprox(first.crossCovariance(), 1e-12));
+	ASSERT_TRUE(testNear(single.solve(), first.solve(), 1e-9));
+	ASSERT_NEAR(single.residual(single.solve()), first.residual(first.solve()), 1e-12);
+}
+
+TEST(RigidFitTest, weights) {
+	Eigen::Matrix3Xd source = points();
+	Eigen::Matrix3Xd target = transform() * source;
+
+	// An outlier with zero weight does not change the result.
+	Eigen::Matrix3Xd outlier_source(3, 7);
+	Eigen::Matrix3Xd outlier_target(3, 7);
+	outlier_source << source, Eigen::Vector3d{5, 5, 5};
+	outlier_target << target, Eigen::Vector3d{-5, 0, 3};
+	Eigen::VectorXd weights = Eigen::VectorXd::Ones(7);
+	weights(6) = 0;
+
+	RigidFitAccumulator<double> accumulator;
+	accumulator.add(outlier_source, outlier_target, weights);
+	ASSERT_EQ(6u, accumulator.count());
+	ASSERT_TRUE(testNear(transform(), accumulator.solve(), 1e-9));
+
+	// An outlier with negative weight is ignored too, like in the single correspondence add().
+	weights(6) = -1;
+	RigidFitAccumulator<double> negative;
+	negative.add(outlier_source, outlier_target, weights);
+	ASSERT_EQ(6u, negative.count());
+	ASSERT_DOUBLE_EQ(6, negative.weight());
+	ASSERT_TRUE(testNear(transform(), negative.solve(), 1e-9));
+
+	// Scaling all weights does not change the result.
+	RigidFitAccumulator<double> scaled;
+	for (int i = 0; i < source.cols(); ++i) scaled.add(source.col(i), target.col(i), 0.25);
+	ASSERT_TRUE(testNear(transform(), scaled.solve(), 1e-9));
+}
+
+TEST(RigidFitTest, planarPoints) {
+	// Coplanar points must not produce a reflection.
+	Eigen::Matrix3Xd source(3, 4);
+	source <<
+		0, 1, 0, 1,
+		0, 0, 1, 1,
+		0, 0, 0, 0;
+	Eigen::Matrix3Xd target = transform() * source;
+
+	RigidFitAccumulator<double> accumulator;
+	accumulator.add(source, target);
+	ASSERT_TRUE(testNear(transform(), accumulator.solve(RigidFitMethod::svd), 1e-9));
+	ASSERT_TRUE(testNear(transform(), accumulator.solve(RigidFitMethod::quaternion), 1e-9));
+	ASSERT_GT(accumulator.solve().linear().determinant(), 0);
+}
+
+TEST(RigidFitTest, invalid) {
+	RigidFitAccumulator<double> accumulator;
+	ASSERT_THROW(accumulator.solve(), std::logic_error);
+	ASSERT_THROW(accumulator.add(points(), points().leftCols(3)), std::logic_error);
+}
+
+}
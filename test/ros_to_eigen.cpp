@@ -110,6 +110,37 @@ TEST(rosToEigen, quaternion) {
 	ASSERT_NEAR(4.9, q2.w(), 1e-5);
 }
 
+TEST(rosToEigen, quaternionNormalize) {
+	Eigen::Quaterniond q1 = toEigen(makeQuaternion(0, 3, 0, 4), NormalizeMode::normalize);
+	Eigen::Quaterniond q2 = toEigen(makeQuaternion(0, 3, 0, 4), NormalizeMode::as_is);
+
+	ASSERT_NEAR(0.0, q1.x(), 1e-5);
+	ASSERT_NEAR(0.6, q1.y(), 1e-5);
+	ASSERT_NEAR(0.0, q1.z(), 1e-5);
+	ASSERT_NEAR(0.8, q1.w(), 1e-5);
+	ASSERT_NEAR(3.0, q2.y(), 1e-5);
+	ASSERT_NEAR(4.0, q2.w(), 1e-5);
+}
+
+TEST(rosToEigen, poseNormalize) {
+	Eigen::Isometry3d pose = toEigen(makePose(makePoint(0, 1.5, 2), makeQuaternion(0, 0, 0, 2)), NormalizeMode::normalize);
+	ASSERT_TRUE(pose.linear().isIdentity(1e-12));
+	ASSERT_NEAR(1.5, pose.translation().y(), 1e-5);
+
+	Eigen::Isometry3d transform = toEigen(makeTransform(makeVector3(0, 1.5, 2), makeQuaternion(0, 0, 0, 2)), NormalizeMode::normalize);
+	ASSERT_TRUE(transform.linear().isIdentity(1e-12));
+}
+
+TEST(rosToEigen, functionPointers) {
+	// The conversions without normalize mode can still be used as one-argument functions.
+	Eigen::Quaterniond (*quaternion)(geometry_msgs::Quaternion const &) = &toEigen;
+	Eigen::Isometry3d (*pose)(geometry_msgs::Pose const &)              = &toEigen;
+	Eigen::Isometry3d (*transform)(geometry_msgs::Transform const &)    = &toEigen;
+	ASSERT_NEAR(4.0, quaternion(makeQuaternion(0, 3, 0, 4)).w(), 1e-5);
+	ASSERT_NEAR(1.5, pose(makePose(makePoint(0, 1.5, 2), makeQuaternion(0, 0, 0, 1))).translation().y(), 1e-5);
+	ASSERT_NEAR(2.0, transform(makeTransform(makeVector3(0, 1.5, 2), makeQuaternion(0, 0, 0, 1))).translation().z(), 1e-5);
+}
+
 TEST(rosToEigen, pose) {
 	Eigen::Isometry3d pose1 = toEigen(makePose(makePoint(0, 1.5, 2), makeQuaternion(1, 0, 0, 0)));
 	Eigen::Isometry3d pose2 = toEigen(makePose(makePoint(-1.5, -2.6, -3.7), makeQuaternion(0, 0, 0, 1)));
@@ -0,0 +1,81 @@
+#include "eigen.hpp"
+#include "spline.hpp"
+#include "test/compare.hpp"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	double pi = 3.1415926536;
+
+	std::vector<Eigen::Isometry3d> keyframes() {
+		std::vector<Eigen::Isometry3d> poses;
+		poses.push_back(translate(0, 0, 0) * rotateZ(0));
+		poses.push_back(translate(1, 2, 0) * rotateZ(0.5 * pi));
+		poses.push_back(translate(3, 1, 1) * rotateX(0.25 * pi) * rotateZ(0.5 * pi));
+		poses.push_back(translate(4, 0, 2) * rotateY(0.5 * pi));
+		return poses;
+	}
+}
+
+TEST(PoseSplineTest, passesThroughKeyframes) {
+	std::vector<Eigen::Isometry3d> poses = keyframes();
+	std::vector<double> times{0, 1, 2.5, 3};
+	PoseSpline spline(poses, times);
+
+	ASSERT_EQ(3u, spline.segments());
+	ASSERT_DOUBLE_EQ(0, spline.startTime());
+	ASSERT_DOUBLE_EQ(3, spline.endTime());
+	for (std::size_t i = 0; i < poses.size(); ++i) {
+		EXPECT_TRUE(testNear(poses[i], spline.pose(times[i]), 1e-6));
+	}
+}
+
+TEST(PoseSplineTest, continuousVelocity) {
+	PoseSpline spline(keyframes(), {0, 1, 2.5, 3});
+
+	for (double knot : {1.0, 2.5}) {
+		EXPECT_TRUE(testNear(spline.velocity(knot - 1e-9), spline.velocity(knot + 1e-9), {1e-6, 1e-6, 1e-6}));
+		EXPECT_TRUE(testNear(spline.acceleration(knot - 1e-9), spline.acceleration(knot + 1e-9), {1e-6, 1e-6, 1e-6}));
+		EXPECT_TRUE(testNear(spline.angularVelocity(knot - 1e-7), spline.angularVelocity(knot + 1e-7), {1e-4, 1e-4, 1e-4}));
+	}
+
+	// Natural spline: zero acceleration at the end points.
+	EXPECT_TRUE(testNear(Eigen::Vector3d::Zero(), spline.acceleration(0), {1e-9, 1e-9, 1e-9}));
+	EXPECT_TRUE(testNear(Eigen::Vector3d::Zero(), spline.acceleration(3), {1e-9, 1e-9, 1e-9}));
+}
+
+TEST(PoseSplineTest, twoKeyframesIsLinear) {
+	std::vector<Eigen::Isometry3d> poses{translate(0, 0, 0) * rotateZ(0), translate(2, 4, 6) * rotateZ(0.5 * pi)};
+	PoseSpline spline(poses, {1, 3});
+
+	EXPECT_TRUE(testNear(translate(1, 2, 3) * rotateZ(0.25 * pi), spline.pose(2), 1e-9));
+	EXPECT_TRUE(testNear({1, 2, 3}, spline.velocity(1.5), {1e-9, 1e-9, 1e-9}));
+	EXPECT_TRUE(testNear({0, 0, 0.25 * pi}, spline.angularVelocity(2), {1e-6, 1e-6, 1e-6}));
+	EXPECT_TRUE(testNear({0, 0, 0.25 * pi}, spline.angularVelocity(1), {1e-6, 1e-6, 1e-6}));
+}
+
+TEST(PoseSplineTest, clampsOutsideRange) {
+	std::vector<Eigen::Isometry3d> poses = keyframes();
+	PoseSpline spline(poses, {0, 1, 2.5, 3});
+
+	EXPECT_TRUE(testNear(poses.front(), spline.pose(-1), 1e-9));
+	EXPECT_TRUE(testNear(poses.back(),  spline.pose(10), 1e-9));
+}
+
+TEST(PoseSplineTest, invalidKeyframes) {
+	std::vector<Eigen::Isometry3d> poses = keyframes();
+	ASSERT_THROW(PoseSpline(poses, {0, 1, 2}), std::invalid_argument);
+	ASSERT_THROW(PoseSpline(poses, {0, 1, 1, 2}), std::invalid_argument);
+	ASSERT_THROW(PoseSpline({poses[0]}, {0}), std::invalid_argument);
+}
+
+}
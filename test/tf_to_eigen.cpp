@@ -62,6 +62,33 @@ TEST(tfToEigen, matrix3x3) {
 	ASSERT_NEAR(8.1, m2(2, 2), 1e-5);
 }
 
+TEST(tfToEigen, normalize) {
+	Eigen::Quaterniond q = toEigen(tf::Quaternion(0, 3, 0, 4), NormalizeMode::normalize);
+	ASSERT_NEAR(0.0, q.x(), 1e-5);
+	ASSERT_NEAR(0.6, q.y(), 1e-5);
+	ASSERT_NEAR(0.0, q.z(), 1e-5);
+	ASSERT_NEAR(0.8, q.w(), 1e-5);
+
+	Eigen::Matrix3d m = toEigen(tf::Matrix3x3(1.001, 0, 0, 0, 1, 0.001, 0, 0, 0.999), NormalizeMode::normalize);
+	ASSERT_NEAR(0, (m.transpose() * m - Eigen::Matrix3d::Identity()).norm(), 1e-12);
+	ASSERT_NEAR(1, m.determinant(), 1e-12);
+	ASSERT_THROW(toEigen(tf::Matrix3x3(-1, 0, 0, 0, 1, 0, 0, 0, 1), NormalizeMode::normalize), std::invalid_argument);
+
+	Eigen::Isometry3d t = toEigen(tf::Transform(tf::Matrix3x3(1.001, 0, 0, 0, 1, 0.001, 0, 0, 0.999), tf::Vector3(0, 1.5, 2)), NormalizeMode::normalize);
+	ASSERT_NEAR(0, (t.linear().transpose() * t.linear() - Eigen::Matrix3d::Identity()).norm(), 1e-12);
+	ASSERT_NEAR(1.5, t.translation().y(), 1e-12);
+}
+
+TEST(tfToEigen, functionPointers) {
+	// The conversions without normalize mode can still be used as one-argument functions.
+	Eigen::Quaterniond (*quaternion)(tf::Quaternion const &) = &toEigen;
+	Eigen::Isometry3d (*transform)(tf::Transform const &)    = &toEigen;
+	Eigen::Matrix3d (*matrix)(tf::Matrix3x3 const &)         = &toEigen;
+	ASSERT_NEAR(4.0, quaternion(tf::Quaternion(0, 3, 0, 4)).w(), 1e-5);
+	ASSERT_NEAR(1.5, transform(tf::Transform(tf::Quaternion(0, 0, 0, 1), tf::Vector3(0, 1.5, 2))).translation().y(), 1e-5);
+	ASSERT_NEAR(2.0, matrix(tf::Matrix3x3(2, 0, 0, 0, 1, 0, 0, 0, 1))(0, 0), 1e-5);
+}
+
 TEST(tfToEigen, transform) {
 	Eigen::Isometry3d transform1 = toEigen(tf::Transform(tf::Quaternion(1, 0, 0, 0), tf::Vector3(0, 1.5, 2)));
 	Eigen::Isometry3d transform2 = toEigen(tf::Transform(tf::Quaternion(0, 0, 0, 1), tf::Vector3(-1.5, -2.6, -3.7)));
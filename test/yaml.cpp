@@ -3,6 +3,9 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdlib>
+#include <limits>
+#include <random>
 
 using namespace dr;
 
@@ -13,24 +16,78 @@ int main(int argc, char * * argv) {
 
 namespace dr {
 
+namespace {
+	std::string yaml(double value) {
+		std::string result;
+		appendYaml(result, value);
+		return result;
+	}
+}
+
+TEST(Yaml, number) {
+	ASSERT_EQ("-0.1", yaml(-0.1));
+	ASSERT_EQ("1.0", yaml(1));
+	ASSERT_EQ("0.0", yaml(0));
+	ASSERT_EQ("-0.0", yaml(-0.0));
+	ASSERT_EQ("123456.0", yaml(123456));
+	ASSERT_EQ("1.0e-07", yaml(1e-7));
+	ASSERT_EQ("1.5e+300", yaml(1.5e300));
+	ASSERT_EQ("0.30000000000000004", yaml(0.1 + 0.2));
+	ASSERT_EQ(".inf", yaml(std::numeric_limits<double>::infinity()));
+	ASSERT_EQ("-.inf", yaml(-std::numeric_limits<double>::infinity()));
+	ASSERT_EQ(".nan", yaml(std::numeric_limits<double>::quiet_NaN()));
+}
+
+TEST(Yaml, numberRoundTrip) {
+	std::mt19937_64 generator{1};
+	std::uniform_real_distribution<double> mantissa{-1, 1};
+	std::uniform_int_distribution<int> exponent{-300, 300};
+	for (int i = 0; i < 10000; ++i) {
+		double value = std::ldexp(mantissa(generator), exponent(generator));
+		std::string text = yaml(value);
+		ASSERT_EQ(value, std::strtod(text.c_str(), nullptr)) << text;
+		ASSERT_LE(text.size(), 26u) << text;
+	}
+	ASSERT_EQ(std::numeric_limits<double>::max(), std::strtod(yaml(std::numeric_limits<double>::max()).c_str(), nullptr));
+	ASSERT_EQ(std::numeric_limits<double>::denorm_min(), std::strtod(yaml(std::numeric_limits<double>::denorm_min()).c_str(), nullptr));
+}
+
 TEST(Yaml, vector) {
-	ASSERT_EQ("{x: -0.100000, y: 1.200000, z: 2.300000}", toYaml(Eigen::Vector3d{-0.1, 1.2, 2.3}));
+	ASSERT_EQ("{x: -0.1, y: 1.2, z: 2.3}", toYaml(Eigen::Vector3d{-0.1, 1.2, 2.3}));
 }
 
 TEST(Yaml, quaternion) {
-	ASSERT_EQ("{x: -0.100000, y: 1.200000, z: 2.300000, w: -1.900000}", toYaml(Eigen::Quaterniond{-1.9, -0.1, 1.2, 2.3}));
+	ASSERT_EQ("{x: -0.1, y: 1.2, z: 2.3, w: -1.9}", toYaml(Eigen::Quaterniond{-1.9, -0.1, 1.2, 2.3}));
 }
 
 TEST(Yaml, pose) {
 	std::string expected;
-	expected += "position:    {x: -0.100000, y: 1.200000, z: 2.300000}\n";
-	expected += "orientation: {x: 0.000000, y: 0.000000, z: 0.000000, w: 1.000000}";
+	expected += "position:    {x: -0.1, y: 1.2, z: 2.3}\n";
+	expected += "orientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}";
 	ASSERT_EQ(expected, toYaml(Eigen::Isometry3d{Eigen::Translation3d{-0.1, 1.2, 2.3} * Eigen::Quaterniond{1, 0, 0, 0}}));
 
 	expected = "";
-	expected += "\tposition:    {x: -0.100000, y: 1.200000, z: 2.300000}\n";
-	expected += "\torientation: {x: 0.000000, y: 0.000000, z: 0.000000, w: 1.000000}";
+	expected += "\tposition:    {x: -0.1, y: 1.2, z: 2.3}\n";
+	expected += "\torientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}";
 	ASSERT_EQ(expected, toYaml(Eigen::Isometry3d{Eigen::Translation3d{-0.1, 1.2, 2.3} * Eigen::Quaterniond{1, 0, 0, 0}}, "\t"));
 }
 
+TEST(Yaml, poseWithHeader) {
+	Pose pose{PoseHeader{"world", "tool"}, Eigen::Isometry3d{Eigen::Translation3d{-0.1, 1.2, 2.3}}};
+	std::string expected;
+	expected += "\tparent_frame: world\n";
+	expected += "\tchild_frame:  tool\n";
+	expected += "\tposition:    {x: -0.1, y: 1.2, z: 2.3}\n";
+	expected += "\torientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}";
+	ASSERT_EQ(expected, toYaml(pose, "\t"));
+}
+
+TEST(Yaml, append) {
+	std::string output = "poses:\n";
+	appendYaml(output, Eigen::Vector3d{1, 2, 3});
+	output.push_back('\n');
+	appendYaml(output, Eigen::Quaterniond::Identity());
+	ASSERT_EQ("poses:\n{x: 1.0, y: 2.0, z: 3.0}\n{x: 0.0, y: 0.0, z: 0.0, w: 1.0}", output);
+}
+
 }
@@ -0,0 +1,274 @@
+#include "yaml_reader.hpp"
+#include "yaml_writer.hpp"
+#include "yaml.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include <unistd.h>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+TEST(YamlReader, blockAndFlowCollections) {
+	YamlDocument document = YamlDocument::parse(
+		"# A comment.\n"
+		"name: \"quoted \\\"name\\\"\"  # trailing comment\n"
+		"other: 'it''s'\n"
+		"list:\n"
+		"- 1\n"
+		"- [2, 3]\n"
+		"-\n"
+		"nested:\n"
+		"  flow: {a: 1, b: [x, y],\n"
+		"         c: ~}\n"
+		"  items:\n"
+		"    - key: value\n"
+		"      empty:\n"
+		"    - - deep\n"
+		"empty_map: {}\n"
+	);
+
+	YamlNode root = document.root();
+	ASSERT_TRUE(root.isMap());
+	ASSERT_EQ(root.size(), 5u);
+	EXPECT_EQ(root.at("name").scalar(), "quoted \"name\"");
+	EXPECT_EQ(root.at("other").scalar(), "it's");
+
+	YamlNode list = root.at("list");
+	ASSERT_TRUE(list.isSequence());
+	ASSERT_EQ(list.size(), 3u);
+	EXPECT_EQ(list.at(std::size_t(0)).scalar(), "1");
+	EXPECT_EQ(list.at(1).size(), 2u);
+	EXPECT_EQ(list.at(1).at(1).scalar(), "3");
+	EXPECT_TRUE(list.at(2).isNull());
+
+	YamlNode flow = root.at("nested").at("flow");
+	ASSERT_EQ(flow.size(), 3u);
+	EXPECT_EQ(flow.at("b").at(std::size_t(0)).scalar(), "x");
+	EXPECT_TRUE(flow.at("c").isNull());
+	EXPECT_EQ(flow.at("c").line(), 10u);
+
+	YamlNode items = root.at("nested").at("items");
+	ASSERT_EQ(items.size(), 2u);
+	EXPECT_EQ(items.at(std::size_t(0)).at("key").scalar(), "value");
+	EXPECT_TRUE(items.at(std::size_t(0)).at("empty").isNull());
+	EXPECT_EQ(items.at(1).at(std::size_t(0)).scalar(), "deep");
+
+	EXPECT_TRUE(root.at("empty_map").isMap());
+	EXPECT_EQ(root.at("empty_map").size(), 0u);
+
+	std::vector<std::string> keys;
+	for (YamlNode child : root) keys.push_back(child.key());
+	EXPECT_EQ(keys, (std::vector<std::string>{"name", "other", "list", "nested", "empty_map"}));
+}
+
+TEST(YamlReader, emptyDocument) {
+	for (char const * text : {"", "\n", "---\n", "--- \n...\n", "# comment\n"}) {
+		YamlDocument document = YamlDocument::parse(text);
+		YamlNode root = document.root();
+		EXPECT_TRUE(root.isNull()) << text;
+		EXPECT_EQ(root.size(), 0u) << text;
+		std::size_t children = 0;
+		for (YamlNode child : root) {
+			static_cast<void>(child);
+			++children;
+		}
+		EXPECT_EQ(children, 0u) << text;
+	}
+}
+
+TEST(YamlReader, parseErrors) {
+	for (char const * text : {
+		"a: 1\n  b: 2\n",
+		"a: [1, 2\n",
+		"a: b: c\n",
+		"a: \"unterminated\n",
+		"a: &anchor 1\n",
+		"a: *alias\n",
+		"a: |\n  text\n",
+		"a: 1\n---\nb: 2\n",
+		"a:\n\tb: 1\n",
+		"- a\nb: 1\n",
+	}) {
+		EXPECT_THROW(YamlDocument::parse(text), std::runtime_error) << text;
+	}
+
+	try {
+		YamlDocument::parse("a: 1\nb: 2\n  c: 3\n");
+		FAIL();
+	} catch (std::runtime_error const & e) {
+		EXPECT_NE(std::string{e.what()}.find("line 3"), std::string::npos) << e.what();
+	}
+}
+
+TEST(YamlReader, numbers) {
+	YamlDocument document = YamlDocument::parse("[1, -2.5, +3e2, 1.0e-07, .inf, -.Inf, .nan, 0x10, inf, '1.0', ~, abc]");
+	YamlNode root = document.root();
+	EXPECT_EQ(fromYaml<double>(root.at(std::size_t(0))), 1);
+	EXPECT_EQ(fromYaml<double>(root.at(1)), -2.5);
+	EXPECT_EQ(fromYaml<double>(root.at(2)), 300);
+	EXPECT_EQ(fromYaml<double>(root.at(3)), 1e-7);
+	EXPECT_EQ(fromYaml<double>(root.at(4)), std::numeric_limits<double>::infinity());
+	EXPECT_EQ(fromYaml<double>(root.at(5)), -std::numeric_limits<double>::infinity());
+	EXPECT_TRUE(std::isnan(fromYaml<double>(root.at(6))));
+	for (std::size_t i = 7; i < root.size(); ++i) {
+		EXPECT_THROW(fromYaml<double>(root.at(i)), std::runtime_error) << i;
+	}
+}
+
+TEST(YamlReader, specialNumbers) {
+	YamlDocument document = YamlDocument::parse("[.inf, .Inf, .INF, +.inf, -.INF, .nan, .NaN, .NAN, .iNF, .NAn, -.nan, .Nan]");
+	YamlNode root = document.root();
+	for (std::size_t i = 0; i < 4; ++i) EXPECT_EQ(fromYaml<double>(root.at(i)), std::numeric_limits<double>::infinity()) << i;
+	EXPECT_EQ(fromYaml<double>(root.at(4)), -std::numeric_limits<double>::infinity());
+	for (std::size_t i = 5; i < 8; ++i) EXPECT_TRUE(std::isnan(fromYaml<double>(root.at(i)))) << i;
+	for (std::size_t i = 8; i < root.size(); ++i) {
+		EXPECT_THROW(fromYaml<double>(root.at(i)), std::runtime_error) << i;
+	}
+}
+
+TEST(YamlReader, doubleSign) {
+	YamlDocument document = YamlDocument::parse("[--5, +-5, -+5, ++5, --.inf, +-1e3]");
+	YamlNode root = document.root();
+	for (std::size_t i = 0; i < root.size(); ++i) {
+		EXPECT_THROW(fromYaml<double>(root.at(i)), std::runtime_error) << i;
+	}
+}
+
+TEST(YamlReader, eigenTypes) {
+	YamlDocument document = YamlDocument::parse(
+		"vector: {x: 1, y: 2, z: 3}\n"
+		"rpy: {r: 0.1, p: 0.2, y: 0.3}\n"
+		"quaternion: {w: 0, x: 1, y: 0, z: 0}\n"
+		"isometry:\n"
+		"  position: {x: 1, y: 2, z: 3}\n"
+		"  orientation: {w: 1, x: 0, y: 0, z: 0}\n"
+		"box_center: {center: {x: 1, y: 1, z: 1}, dimensions: {x: 2, y: 4, z: 6}}\n"
+		"box_minmax: {min: {x: 0, y: -1, z: -2}, max: {x: 2, y: 3, z: 4}}\n"
+		"bad_vector: {x: 1, y: 2}\n"
+		"bad_box: {center: {x: 1, y: 1, z: 1}, max: {x: 2, y: 4, z: 6}}\n"
+	);
+	YamlNode root = document.root();
+
+	EXPECT_TRUE(fromYaml<Eigen::Vector3d>(root.at("vector")).isApprox(Eigen::Vector3d{1, 2, 3}));
+	EXPECT_TRUE(fromYaml<Eigen::Quaterniond>(root.at("rpy")).isApprox(rpyToQuaternion(0.1, 0.2, 0.3)));
+	EXPECT_TRUE(fromYaml<Eigen::Quaterniond>(root.at("quaternion")).isApprox(Eigen::Quaterniond{0, 1, 0, 0}));
+	EXPECT_TRUE(fromYaml<Eigen::Isometry3d>(root.at("isometry")).isApprox(Eigen::Isometry3d{translate(1, 2, 3)}));
+
+	Eigen::AlignedBox3d box_center = fromYaml<Eigen::AlignedBox3d>(root.at("box_center"));
+	EXPECT_TRUE(box_center.min().isApprox(Eigen::Vector3d{0, -1, -2}));
+	EXPECT_TRUE(box_center.max().isApprox(Eigen::Vector3d{2, 3, 4}));
+	Eigen::AlignedBox3d box_minmax = fromYaml<Eigen::AlignedBox3d>(root.at("box_minmax"));
+	EXPECT_TRUE(box_minmax.min().isApprox(box_center.min()));
+	EXPECT_TRUE(box_minmax.max().isApprox(box_center.max()));
+
+	EXPECT_THROW(fromYaml<Eigen::Vector3d>(root.at("bad_vector")), std::runtime_error);
+	EXPECT_THROW(fromYaml<Eigen::Vector3d>(root.at("rpy")), std::runtime_error);
+	EXPECT_THROW(fromYaml<Eigen::Quaterniond>(root.at("bad_vector")), std::runtime_error);
+	EXPECT_THROW(fromYaml<Eigen::AlignedBox3d>(root.at("bad_box")), std::runtime_error);
+	EXPECT_THROW(fromYaml<Eigen::Isometry3d>(root.at("vector")), std::runtime_error);
+	EXPECT_THROW(fromYaml<Eigen::Vector3d>(root.at("missing")), std::runtime_error);
+}
+
+TEST(YamlReader, poseRoundTrip) {
+	Pose pose{{"world", "tool frame"}, Eigen::Isometry3d{translate(0.1, -0.2, 1e-9) * rotateZ(0.3) * rotateX(-1.2)}};
+
+	YamlDocument document = YamlDocument::parse(toYaml(pose));
+	Pose result = fromYaml<Pose>(document.root());
+	EXPECT_EQ(result.header.parent_frame, "world");
+	EXPECT_EQ(result.header.child_frame, "tool frame");
+	EXPECT_TRUE(result.isometry.isApprox(pose.isometry, 1e-15));
+
+	PoseHeader header = fromYaml<PoseHeader>(YamlDocument::parse(toYaml(pose.header)).root());
+	EXPECT_EQ(header.parent_frame, "world");
+}
+
+TEST(YamlReader, bulkPoses) {
+	std::vector<Pose> poses;
+	for (int i = 0; i < 100; ++i) {
+		poses.push_back(Pose{{"base", "pose_" + std::to_string(i)}, Eigen::Isometry3d{translate(i, i * 0.5, -i) * rotateY(i * 0.01)}});
+	}
+
+	std::ostringstream stream;
+	{
+		PoseYamlWriter writer{stream};
+		writer.beginMap();
+		writer.beginSequence("poses");
+		for (Pose const & pose : poses) writer.write(pose);
+		writer.end();
+		writer.beginSequence("isometries");
+		for (Pose const & pose : poses) writer.write(pose.isometry);
+		writer.close();
+	}
+
+	YamlDocument document = YamlDocument::parse(stream.str());
+	std::vector<Pose> result;
+	posesFromYaml(document.root().at("poses"), result);
+	ASSERT_EQ(result.size(), poses.size());
+	for (std::size_t i = 0; i < poses.size(); ++i) {
+		EXPECT_EQ(result[i].header.child_frame, poses[i].header.child_frame);
+		EXPECT_TRUE(result[i].isometry.isApprox(poses[i].isometry, 1e-15)) << i;
+	}
+
+	std::vector<Eigen::Isometry3d> isometries;
+	posesFromYaml(document.root().at("isometries"), isometries);
+	ASSERT_EQ(isometries.size(), poses.size());
+	EXPECT_TRUE(isometries.back().isApprox(poses.back().isometry, 1e-15));
+
+	std::vector<Pose, Eigen::aligned_allocator<Pose>> aligned_poses;
+	posesFromYaml(document.root().at("poses"), aligned_poses);
+	ASSERT_EQ(aligned_poses.size(), poses.size());
+	EXPECT_TRUE(aligned_poses.back().isometry.isApprox(poses.back().isometry, 1e-15));
+
+	std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> aligned_isometries;
+	posesFromYaml(document.root().at("isometries"), aligned_isometries);
+	ASSERT_EQ(aligned_isometries.size(), poses.size());
+	EXPECT_TRUE(aligned_isometries.front().isApprox(poses.front().isometry, 1e-15));
+
+	EXPECT_THROW(posesFromYaml(document.root(), result), std::runtime_error);
+}
+
+TEST(YamlReader, loadFile) {
+	char path[] = "/tmp/dr_eigen_yaml_reader_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_GE(fd, 0);
+	close(fd);
+
+	{
+		std::ofstream file{path};
+		file << "position: {x: 1, y: 2, z: 3}\norientation: {r: 0, p: 0, y: 0}";
+	}
+	EXPECT_TRUE(loadYaml<Eigen::Isometry3d>(path).isApprox(Eigen::Isometry3d{translate(1, 2, 3)}));
+
+	{
+		std::ofstream file{path};
+		file << "position: {x: 1, y: 2, z: 3}\norientation: [1, 2";
+	}
+	try {
+		loadYaml<Eigen::Isometry3d>(path);
+		FAIL();
+	} catch (std::runtime_error const & e) {
+		EXPECT_EQ(std::string{e.what()}.find(path), 0u) << e.what();
+	}
+
+	{
+		std::ofstream file{path};
+	}
+	EXPECT_TRUE(YamlDocument::load(path).root().isNull());
+
+	std::remove(path);
+	EXPECT_THROW(YamlDocument::load(path), std::system_error);
+}
+
+}
@@ -0,0 +1,168 @@
+#include "yaml_writer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+
+int main(int argc, char * * argv) {
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+namespace dr {
+
+namespace {
+	Pose makePose(std::string const & parent, std::string const & child, double x) {
+		return Pose{PoseHeader{parent, child}, Eigen::Isometry3d{Eigen::Translation3d{x, 0.5, -1}}};
+	}
+
+	/// Write a document with many poses in a nested structure.
+	void writeDocument(PoseYamlWriter & writer, std::size_t count) {
+		writer.beginMap();
+		writer.write("camera", makePose("world", "camera", 0.25));
+		writer.beginSequence("grasps");
+		for (std::size_t i = 0; i < count; ++i) writer.write(makePose("object", "gripper", double(i)));
+		writer.end();
+		writer.beginMap("frames");
+		writer.write("tool", Eigen::Isometry3d::Identity());
+		writer.end();
+		writer.end();
+	}
+}
+
+TEST(PoseYamlWriter, map) {
+	std::ostringstream stream;
+	PoseYamlWriter writer{stream};
+	writeDocument(writer, 2);
+	writer.close();
+
+	std::string expected;
+	expected += "camera:\n";
+	expected += "  parent_frame: world\n";
+	expected += "  child_frame:  camera\n";
+	expected += "  position:    {x: 0.25, y: 0.5, z: -1.0}\n";
+	expected += "  orientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}\n";
+	expected += "grasps:\n";
+	expected += "  - parent_frame: object\n";
+	expected += "    child_frame:  gripper\n";
+	expected += "    position:    {x: 0.0, y: 0.5, z: -1.0}\n";
+	expected += "    orientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}\n";
+	expected += "  - parent_frame: object\n";
+	expected += "    child_frame:  gripper\n";
+	expected += "    position:    {x: 1.0, y: 0.5, z: -1.0}\n";
+	expected += "    orientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}\n";
+	expected += "frames:\n";
+	expected += "  tool:\n";
+	expected += "    position:    {x: 0.0, y: 0.0, z: 0.0}\n";
+	expected += "    orientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}\n";
+	ASSERT_EQ(expected, stream.str());
+}
+
+TEST(PoseYamlWriter, sequence) {
+	std::ostringstream stream;
+	PoseYamlWriter writer{stream};
+	writer.beginSequence();
+	writer.write(makePose("world", "a", 1));
+	writer.close();
+
+	std::string expected;
+	expected += "- parent_frame: world\n";
+	expected += "  child_frame:  a\n";
+	expected += "  position:    {x: 1.0, y: 0.5, z: -1.0}\n";
+	expected += "  orientation: {x: 0.0, y: 0.0, z: 0.0, w: 1.0}\n";
+	ASSERT_EQ(expected, stream.str());
+}
+
+TEST(PoseYamlWriter, empty) {
+	std::ostringstream stream;
+	{
+		PoseYamlWriter writer{stream};
+		writer.beginMap();
+		writer.beginSequence("poses");
+		writer.end();
+		writer.beginMap("frames");
+		// Closing the writer ends all open nodes.
+	}
+	ASSERT_EQ("poses: []\nframes: {}\n", stream.str());
+
+	std::ostringstream empty;
+	PoseYamlWriter writer{empty};
+	writer.beginSequence();
+	writer.end();
+	writer.close();
+	ASSERT_EQ("[]\n", empty.str());
+}
+
+TEST(PoseYamlWriter, quoting) {
+	std::ostringstream stream;
+	PoseYamlWriter writer{stream};
+	writer.beginMap();
+	writer.write("1: \"odd\" key", makePose("/world", "yes", 0));
+	writer.close();
+	std::string output = stream.str();
+	ASSERT_EQ(0u, output.find("\"1: \\\"odd\\\" key\":\n  parent_frame: /world\n  child_frame:  \"yes\"\n"));
+}
+
+TEST(PoseYamlWriter, misuse) {
+	std::ostringstream stream;
+	PoseYamlWriter writer{stream};
+	ASSERT_THROW(writer.write(makePose("a", "b", 0)), std::logic_error);
+	ASSERT_THROW(writer.end(), std::logic_error);
+	writer.beginSequence();
+	ASSERT_THROW(writer.write("key", makePose("a", "b", 0)), std::logic_error);
+	ASSERT_THROW(writer.beginMap("key"), std::logic_error);
+	ASSERT_THROW(writer.beginMap(), std::logic_error);
+	writer.close();
+	ASSERT_THROW(writer.write(makePose("a", "b", 0)), std::logic_error);
+	ASSERT_THROW(PoseYamlWriter(stream, PoseYamlWriterOptions{0, false}), std::invalid_argument);
+}
+
+TEST(PoseYamlWriter, bufferedOutputMatches) {
+	std::ostringstream reference;
+	{
+		PoseYamlWriter writer{reference};
+		writeDocument(writer, 5000);
+	}
+
+	for (bool background : {false, true}) {
+		std::ostringstream stream;
+		PoseYamlWriter writer{stream, PoseYamlWriterOptions{100, background}};
+		writeDocument(writer, 5000);
+		writer.close();
+		ASSERT_EQ(reference.str(), stream.str());
+	}
+}
+
+TEST(PoseYamlWriter, fileDescriptor) {
+	std::FILE * file = std::tmpfile();
+	ASSERT_NE(file, nullptr);
+	{
+		PoseYamlWriter writer{fileno(file), PoseYamlWriterOptions{4096, true}};
+		writeDocument(writer, 1000);
+	}
+
+	std::ostringstream reference;
+	{
+		PoseYamlWriter writer{reference};
+		writeDocument(writer, 1000);
+	}
+
+	std::rewind(file);
+	std::string contents;
+	char buffer[4096];
+	while (std::size_t read = std::fread(buffer, 1, sizeof(buffer), file)) contents.append(buffer, read);
+	std::fclose(file);
+	ASSERT_EQ(reference.str(), contents);
+}
+
+TEST(PoseYamlWriter, writeError) {
+	std::ostringstream stream;
+	stream.setstate(std::ios::badbit);
+	PoseYamlWriter writer{stream, PoseYamlWriterOptions{10, true}};
+	writer.beginSequence();
+	writer.write(makePose("a", "b", 0));
+	ASSERT_THROW(writer.flush(), std::runtime_error);
+}
+
+}